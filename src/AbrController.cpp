@@ -0,0 +1,337 @@
+/**
+ * @file AbrController.cpp
+ * @brief 自适应码率控制实现
+ */
+
+#include "AbrController.h"
+
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+#if FFMPEG_AVAILABLE
+
+namespace {
+
+/**
+ * @brief 标称码率：HLS / DASH 解复用器把播放列表中的带宽写入 variant_bitrate
+ */
+qint64 streamBandwidth(const AVStream *stream)
+{
+    if (const AVDictionaryEntry *entry = av_dict_get(stream->metadata, "variant_bitrate", nullptr, 0)) {
+        const qint64 bandwidth = QByteArray(entry->value).toLongLong();
+        if (bandwidth > 0) return bandwidth;
+    }
+    return stream->codecpar->bit_rate;
+}
+
+/**
+ * @brief 音频解码器与重采样器可以不重建地接着使用
+ */
+bool sameAudio(const AVStream *a, const AVStream *b)
+{
+    return a->codecpar->codec_id == b->codecpar->codec_id
+        && a->codecpar->sample_rate == b->codecpar->sample_rate
+        && a->codecpar->ch_layout.nb_channels == b->codecpar->ch_layout.nb_channels
+        && av_cmp_q(a->time_base, b->time_base) == 0;
+}
+
+} // namespace
+
+AbrController::AbrController(PlaybackMetrics &metrics)
+    : m_metrics(metrics)
+{
+}
+
+bool AbrController::open(AVFormatContext *formatCtx, int videoStream)
+{
+    close();
+
+    const AVStream *reference = formatCtx->streams[videoStream];
+    const int referenceAudio = av_find_best_stream(formatCtx, AVMEDIA_TYPE_AUDIO, -1, videoStream, nullptr, 0);
+    const AVStream *audioReference = referenceAudio >= 0 ? formatCtx->streams[referenceAudio] : nullptr;
+
+    for (unsigned i = 0; i < formatCtx->nb_streams; i++) {
+        AVStream *stream = formatCtx->streams[i];
+        const AVCodecParameters *codecpar = stream->codecpar;
+        if (codecpar->codec_type != AVMEDIA_TYPE_VIDEO || (stream->disposition & AV_DISPOSITION_ATTACHED_PIC)) {
+            continue;
+        }
+        // 解码器与时间戳换算沿用参照流，编码或时间基不同的变体不参与切换
+        if (codecpar->codec_id != reference->codecpar->codec_id
+            || av_cmp_q(stream->time_base, reference->time_base) != 0) {
+            qDebug() << "[ABR] 跳过编码或时间基不同的视频流" << i << avcodec_get_name(codecpar->codec_id);
+            continue;
+        }
+
+        AbrVariant variant;
+        variant.videoStream = static_cast<int>(i);
+        if (audioReference) {
+            const int audio = av_find_best_stream(formatCtx, AVMEDIA_TYPE_AUDIO, -1, variant.videoStream, nullptr, 0);
+            if (audio < 0 || !sameAudio(formatCtx->streams[audio], audioReference)) {
+                qDebug() << "[ABR] 跳过音频参数不同的变体" << i;
+                continue;
+            }
+            variant.audioStream = audio;
+        }
+        variant.bandwidth = streamBandwidth(stream);
+        variant.width = codecpar->width;
+        variant.height = codecpar->height;
+        variant.fps = av_q2d(av_guess_frame_rate(formatCtx, stream, nullptr));
+        m_variants.append(variant);
+    }
+
+    if (m_variants.size() < 2) {
+        m_variants.clear();
+        return false;
+    }
+
+    std::sort(m_variants.begin(), m_variants.end(), [](const AbrVariant &a, const AbrVariant &b) {
+        return a.bandwidth != b.bandwidth ? a.bandwidth < b.bandwidth : a.pixelRate() < b.pixelRate();
+    });
+
+    m_formatCtx = formatCtx;
+    m_current = 0;
+    applyDiscard();
+
+    qDebug() << "[ABR] 变体阶梯:" << m_variants.size() << "档";
+    for (int i = 0; i < m_variants.size(); i++) {
+        const AbrVariant &variant = m_variants[i];
+        qDebug().nospace() << "  [" << i << "] " << variant.width << "x" << variant.height
+                           << " @" << variant.fps << "fps " << variant.bandwidth / 1000 << " kbps";
+    }
+
+    const PlaybackMetricsSnapshot snapshot = m_metrics.snapshot();
+    m_lastDecodeCount = snapshot.decodeTimeCount();
+    m_lastDecodeTotalUs = snapshot.decodeTimeTotalUs;
+    m_lastPresented = snapshot.presentedFrames;
+    m_lastDropped = snapshot.droppedFrames;
+    m_clock.start();
+    m_lastEvaluateMs = 0;
+    m_lastSwitchMs = -UPSWITCH_HOLD_MS;     // 起播后可以立即升档
+    m_metrics.setAbrVariant(m_current, current().bandwidth);
+    return true;
+}
+
+void AbrController::close()
+{
+    m_formatCtx = nullptr;
+    m_variants.clear();
+    m_current = 0;
+    m_target = -1;
+    m_pixelRateCeiling = 0;
+    m_bandwidthCeiling = 0;
+    m_lastVideoTime = AV_NOPTS_VALUE;
+    m_lastAudioTime = AV_NOPTS_VALUE;
+    m_videoExtradataPending = false;
+    m_audioExtradataPending = false;
+    m_windowBytes = 0;
+    m_windowReadNs = 0;
+    m_throughputBps = 0;
+    m_metrics.setAbrVariant(-1, 0);
+    m_metrics.setAbrThroughput(0);
+}
+
+void AbrController::addRead(int bytes, qint64 elapsedNs)
+{
+    m_windowBytes += bytes;
+    m_windowReadNs += elapsedNs;
+}
+
+bool AbrController::evaluate()
+{
+    if (!isActive()) return false;
+    const qint64 now = m_clock.elapsed();
+    if (now - m_lastEvaluateMs < EVALUATE_INTERVAL_MS) return false;
+    m_lastEvaluateMs = now;
+
+    if (m_windowReadNs > 0) {
+        const double bps = m_windowBytes * 8.0 * 1e9 / m_windowReadNs;
+        m_throughputBps = m_throughputBps > 0
+            ? THROUGHPUT_WEIGHT * bps + (1.0 - THROUGHPUT_WEIGHT) * m_throughputBps : bps;
+        m_metrics.setAbrThroughput(m_throughputBps);
+    }
+    m_windowBytes = 0;
+    m_windowReadNs = 0;
+
+    const PlaybackMetricsSnapshot snapshot = m_metrics.snapshot();
+    const quint64 decoded = snapshot.decodeTimeCount() - m_lastDecodeCount;
+    const double decodeUs = snapshot.decodeTimeTotalUs - m_lastDecodeTotalUs;
+    const quint64 presented = snapshot.presentedFrames - m_lastPresented;
+    const quint64 dropped = snapshot.droppedFrames - m_lastDropped;
+    m_lastDecodeCount = snapshot.decodeTimeCount();
+    m_lastDecodeTotalUs = snapshot.decodeTimeTotalUs;
+    m_lastPresented = snapshot.presentedFrames;
+    m_lastDropped = snapshot.droppedFrames;
+
+    if (m_target >= 0) return false;
+
+    const AbrVariant &variant = current();
+    const bool decodeWindow = decoded >= MIN_WINDOW_FRAMES;     // 下载跟不上时解码帧数可能不足一个窗口
+    const double budgetUs = 1e6 / (variant.fps > 0 ? variant.fps : 25.0);
+    const double load = decodeWindow ? decodeUs / decoded / budgetUs : 0.0;
+    const double dropRate = presented + dropped > 0 ? double(dropped) / double(presented + dropped) : 0.0;
+    const double usableBps = m_throughputBps * BANDWIDTH_SAFETY;
+    auto fits = [usableBps](const AbrVariant &v) { return v.bandwidth <= 0 || v.bandwidth <= usableBps; };
+    if (m_bandwidthCeiling > 0 && now - m_bandwidthCeilingMs >= BANDWIDTH_RETRY_MS) {
+        m_bandwidthCeiling = 0;
+    }
+
+    int target = m_current;
+    const char *reason = nullptr;
+    if (m_throughputBps > 0 && !fits(variant)) {
+        // 先判断带宽：下载跟不上时呈现端同样会丢帧，不能算作解码能力不足
+        // 不阻塞时读包可能直接取自缓冲，吞吐偏高，因此记下上限，一段时间内不再试探
+        m_bandwidthCeiling = variant.bandwidth;
+        m_bandwidthCeilingMs = now;
+        target = 0;
+        for (int i = m_current - 1; i > 0; i--) {
+            if (fits(m_variants[i])) {
+                target = i;
+                break;
+            }
+        }
+        reason = "带宽不足";
+    } else if (decodeWindow && (load > MAX_DECODE_LOAD || dropRate > MAX_DROP_RATE)) {
+        // 本机跟不上：记下像素率上限，之后不再尝试同等或更高的变体
+        m_pixelRateCeiling = variant.pixelRate();
+        for (int i = m_current - 1; i >= 0; i--) {
+            if (m_variants[i].pixelRate() < m_pixelRateCeiling) {
+                target = i;
+                break;
+            }
+        }
+        reason = "解码余量不足";
+    } else if (decodeWindow && m_current + 1 < m_variants.size() && now - m_lastSwitchMs >= UPSWITCH_HOLD_MS
+               && m_throughputBps > 0 && dropped == 0) {
+        const AbrVariant &next = m_variants[m_current + 1];
+        const double predictedLoad = variant.pixelRate() > 0 ? load * next.pixelRate() / variant.pixelRate() : load;
+        if (fits(next) && predictedLoad < UPSWITCH_DECODE_LOAD
+            && (m_pixelRateCeiling <= 0 || next.pixelRate() < m_pixelRateCeiling)
+            && (m_bandwidthCeiling <= 0 || next.bandwidth < m_bandwidthCeiling)) {
+            target = m_current + 1;
+            reason = "余量充足";
+        }
+    }
+
+    if (target == m_current) return false;
+
+    qDebug().nospace() << "[ABR] " << reason << "：变体 " << m_current << " → " << target
+                       << "，吞吐 " << qRound64(m_throughputBps / 1000) << " kbps，解码负载 "
+                       << qRound(load * 100) << "%，丢帧率 " << dropRate * 100 << "%";
+    beginSwitch(target);
+    return true;
+}
+
+void AbrController::beginSwitch(int target)
+{
+    m_target = target;
+    m_lastSwitchMs = m_clock.elapsed();
+    applyDiscard();
+}
+
+void AbrController::finishSwitch()
+{
+    const AbrVariant &from = current();
+    const AbrVariant &to = m_variants[m_target];
+    m_videoExtradataPending = to.videoStream != from.videoStream;
+    m_audioExtradataPending = to.audioStream != from.audioStream;
+    m_current = m_target;
+    m_target = -1;
+    applyDiscard();
+
+    qDebug().nospace() << "[ABR] 已切换到变体 " << m_current << "（" << to.width << "x" << to.height
+                       << "，" << to.bandwidth / 1000 << " kbps）";
+    m_metrics.setAbrVariant(m_current, to.bandwidth);
+    m_metrics.addAbrSwitch();
+}
+
+void AbrController::applyDiscard()
+{
+    // 只保留当前变体（切换进行中时加上目标变体）的音视频流，其余变体的分片不再下载
+    const AbrVariant &variant = current();
+    const AbrVariant *target = m_target >= 0 ? &m_variants[m_target] : nullptr;
+    for (unsigned i = 0; i < m_formatCtx->nb_streams; i++) {
+        AVStream *stream = m_formatCtx->streams[i];
+        const AVMediaType type = stream->codecpar->codec_type;
+        if (type != AVMEDIA_TYPE_VIDEO && type != AVMEDIA_TYPE_AUDIO) continue;
+
+        const int index = static_cast<int>(i);
+        const bool keep = index == variant.videoStream || index == variant.audioStream
+            || (target && (index == target->videoStream || index == target->audioStream));
+        stream->discard = keep ? AVDISCARD_DEFAULT : AVDISCARD_ALL;
+    }
+}
+
+int64_t AbrController::packetTime(const AVPacket *packet) const
+{
+    const int64_t time = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+    if (time == AV_NOPTS_VALUE) return AV_NOPTS_VALUE;
+    return av_rescale_q(time, m_formatCtx->streams[packet->stream_index]->time_base, AV_TIME_BASE_Q);
+}
+
+void AbrController::attachExtradata(AVPacket *packet, const AVStream *stream)
+{
+    const AVCodecParameters *codecpar = stream->codecpar;
+    if (codecpar->extradata_size <= 0) return;
+    uint8_t *data = av_packet_new_side_data(packet, AV_PKT_DATA_NEW_EXTRADATA, codecpar->extradata_size);
+    if (data) {
+        std::memcpy(data, codecpar->extradata, codecpar->extradata_size);
+    }
+}
+
+int AbrController::route(AVPacket *packet, int videoStream, int audioStream, bool &switched)
+{
+    switched = false;
+    const int index = packet->stream_index;
+    const int64_t time = packetTime(packet);
+
+    if (m_target >= 0 && index == m_variants[m_target].videoStream && index != current().videoStream) {
+        // 新变体从分片开头的关键帧切入；与旧变体已转发部分重叠的分片丢弃，等下一个分片
+        const bool overlaps = time != AV_NOPTS_VALUE && m_lastVideoTime != AV_NOPTS_VALUE
+                              && time <= m_lastVideoTime;
+        if (!(packet->flags & AV_PKT_FLAG_KEY) || overlaps) return -1;
+        finishSwitch();
+        switched = true;
+    }
+
+    const AbrVariant &variant = current();
+    if (index == variant.videoStream) {
+        if (m_videoExtradataPending) {
+            attachExtradata(packet, m_formatCtx->streams[index]);
+            m_videoExtradataPending = false;
+        }
+        if (time != AV_NOPTS_VALUE) {
+            m_lastVideoTime = m_lastVideoTime == AV_NOPTS_VALUE ? time : qMax(m_lastVideoTime, time);
+        }
+        return videoStream;
+    }
+    if (index == variant.audioStream) {
+        if (m_audioExtradataPending) {
+            // 换到新变体的音轨：跳过旧音轨已经覆盖的时间
+            if (time != AV_NOPTS_VALUE && m_lastAudioTime != AV_NOPTS_VALUE && time <= m_lastAudioTime) {
+                return -1;
+            }
+            attachExtradata(packet, m_formatCtx->streams[index]);
+            m_audioExtradataPending = false;
+        }
+        if (time != AV_NOPTS_VALUE) {
+            m_lastAudioTime = time;
+        }
+        return audioStream;
+    }
+    return -1;
+}
+
+bool AbrController::resetTimeline()
+{
+    const bool switched = m_target >= 0;
+    if (switched) {
+        finishSwitch();
+    }
+    m_lastVideoTime = AV_NOPTS_VALUE;
+    m_lastAudioTime = AV_NOPTS_VALUE;
+    return switched;
+}
+
+#endif // FFMPEG_AVAILABLE
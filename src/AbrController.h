@@ -0,0 +1,139 @@
+/**
+ * @file AbrController.h
+ * @brief 自适应码率：按下载吞吐与本机解码余量在 HLS / DASH 变体间切换
+ *
+ * FFmpeg 打开多变体输入时保留所有变体的流。控制器把与参照流同编码、同时间基的视频流
+ * 整理为按码率升序的阶梯，用 AVStream::discard 只保留当前变体用到的流，
+ * HLS / DASH 解复用器据此只下载需要的分片。
+ *
+ * 切换在分片边界完成：新变体从分片开头开始下载，旧变体读完当前分片后停止；
+ * 新变体的第一个关键帧到达前仍转发旧变体的包，之后只转发新变体。
+ * 解码器不重建，参数集变化走流中途重配置路径（带外参数集以 NEW_EXTRADATA 附在首包上）。
+ *
+ * 每 EVALUATE_INTERVAL_MS 评估一次：
+ * - 吞吐：av_read_frame 阻塞期间读到的字节数 / 耗时，指数平均
+ * - 解码余量：窗口内平均单帧解码耗时相对帧间隔的比例
+ * - 呈现丢帧率
+ * 因解码或丢帧降档时记下像素率上限，之后不再升到同等或更高像素率的变体，
+ * 性能不足的设备停在能全速解码的变体上，不会来回振荡；
+ * 因带宽降档时记下码率上限，BANDWIDTH_RETRY_MS 后才重新试探。
+ *
+ * 起播选码率最低的变体，余量足够时逐档上升。open() / close() 在 GUI 线程调用
+ * （管线未运行），其余方法只在 demux 协程中调用。
+ */
+
+#ifndef ABRCONTROLLER_H
+#define ABRCONTROLLER_H
+
+#include "PlaybackMetrics.h"
+
+#include <QElapsedTimer>
+#include <QList>
+
+#if FFMPEG_AVAILABLE
+extern "C" {
+#include <libavformat/avformat.h>
+}
+
+/**
+ * @brief 一个码率变体
+ */
+struct AbrVariant {
+    int videoStream = -1;
+    int audioStream = -1;       ///< 与视频同节目的音频流，-1 表示无音频
+    qint64 bandwidth = 0;       ///< 标称码率（bit/s），来自播放列表或流参数，0 表示未知
+    int width = 0;
+    int height = 0;
+    double fps = 0;
+
+    double pixelRate() const { return double(width) * height * fps; }
+};
+
+class AbrController
+{
+public:
+    explicit AbrController(PlaybackMetrics &metrics);
+
+    /**
+     * @brief 整理变体阶梯，选出起始变体并设置丢弃标志
+     * @param videoStream av_find_best_stream 选出的视频流，作为编码与时间基的参照
+     * @return 是否启用（可切换的变体不少于两个）
+     */
+    bool open(AVFormatContext *formatCtx, int videoStream);
+    void close();
+
+    bool isActive() const { return m_variants.size() > 1; }
+    int currentIndex() const { return m_current; }
+    const AbrVariant &current() const { return m_variants[m_current]; }
+
+    /**
+     * @brief 记录一次读包（字节数与 av_read_frame 阻塞时间）
+     */
+    void addRead(int bytes, qint64 elapsedNs);
+
+    /**
+     * @brief 到评估间隔时决定是否切换；开始切换时更新丢弃标志并返回 true
+     */
+    bool evaluate();
+
+    /**
+     * @brief 把包映射到解码器对应的流序号
+     * @param videoStream / audioStream 解码器打开时使用的流序号
+     * @param switched 本包完成了一次切换
+     * @return 当前变体的视频 / 音频包返回对应序号，其余返回 -1（丢弃）
+     */
+    int route(AVPacket *packet, int videoStream, int audioStream, bool &switched);
+
+    /**
+     * @brief 时间轴不连续（跳转、循环回到开头）之前调用：未完成的切换立即生效
+     * @return 是否因此完成了一次切换
+     */
+    bool resetTimeline();
+
+private:
+    void beginSwitch(int target);
+    void finishSwitch();
+    void applyDiscard();
+    int64_t packetTime(const AVPacket *packet) const;
+    static void attachExtradata(AVPacket *packet, const AVStream *stream);
+
+    static constexpr qint64 EVALUATE_INTERVAL_MS = 2000;
+    static constexpr qint64 UPSWITCH_HOLD_MS = 10000;      ///< 切换后至少保持此时长才升档
+    static constexpr qint64 BANDWIDTH_RETRY_MS = 60000;    ///< 带宽降档后重新试探更高码率的间隔
+    static constexpr double THROUGHPUT_WEIGHT = 0.3;        ///< 新窗口在吞吐平均中的权重
+    static constexpr double BANDWIDTH_SAFETY = 0.8;         ///< 只使用吞吐估计的此比例
+    static constexpr double MAX_DECODE_LOAD = 0.85;         ///< 单帧解码耗时超过帧间隔的此比例即降档
+    static constexpr double UPSWITCH_DECODE_LOAD = 0.6;     ///< 按像素率推算升档后仍低于此比例才升档
+    static constexpr double MAX_DROP_RATE = 0.02;
+    static constexpr quint64 MIN_WINDOW_FRAMES = 12;        ///< 窗口内帧数太少（暂停、缓冲）不评估
+
+    PlaybackMetrics &m_metrics;
+    AVFormatContext *m_formatCtx = nullptr;
+    QList<AbrVariant> m_variants;       // 按码率升序
+    int m_current = 0;
+    int m_target = -1;                  // 进行中的切换目标
+    double m_pixelRateCeiling = 0;      // 0 表示尚无上限
+    qint64 m_bandwidthCeiling = 0;      // 0 表示尚无上限
+    qint64 m_bandwidthCeilingMs = 0;
+
+    // 切换点：按 AV_TIME_BASE 比较，旧变体已转发过的时间之前的新包丢弃
+    int64_t m_lastVideoTime = AV_NOPTS_VALUE;
+    int64_t m_lastAudioTime = AV_NOPTS_VALUE;
+    bool m_videoExtradataPending = false;
+    bool m_audioExtradataPending = false;
+
+    // 评估窗口
+    QElapsedTimer m_clock;
+    qint64 m_lastEvaluateMs = 0;
+    qint64 m_lastSwitchMs = 0;
+    qint64 m_windowBytes = 0;
+    qint64 m_windowReadNs = 0;
+    double m_throughputBps = 0;
+    quint64 m_lastDecodeCount = 0;
+    double m_lastDecodeTotalUs = 0;
+    quint64 m_lastPresented = 0;
+    quint64 m_lastDropped = 0;
+};
+#endif // FFMPEG_AVAILABLE
+
+#endif // ABRCONTROLLER_H
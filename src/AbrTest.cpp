@@ -0,0 +1,320 @@
+/**
+ * @file AbrTest.cpp
+ * @brief 自适应码率测试实现
+ */
+
+#include "AbrTest.h"
+#include "SyntheticClip.h"
+#include "VideoRendererBase.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QTimer>
+#include <atomic>
+#include <limits>
+#include <memory>
+
+#if FFMPEG_AVAILABLE
+
+namespace {
+
+static constexpr int LADDER_FPS = 24;
+static constexpr int LADDER_FRAMES = 240;           // 10 秒，循环播放
+static constexpr int PHASE_SECONDS = 45;
+static constexpr int SETTLE_SECONDS = 12;           // 阶段最后这段时间内不应再切换
+static constexpr int THROTTLE_TICK_MS = 20;
+static constexpr qint64 MAX_SOCKET_BACKLOG = 16 * 1024;     // Qt 写缓冲上限，保持限速平滑
+static constexpr qint64 UNLIMITED_CHUNK = 1024 * 1024;
+
+struct Rung {
+    const char *name;
+    int width;
+    int height;
+};
+
+const Rung LADDER[] = {
+    { "v0", 320, 180 },
+    { "v1", 640, 360 },
+    { "v2", 1280, 720 },
+};
+static constexpr int LADDER_SIZE = 3;
+
+/**
+ * @brief 本地 HTTP 文件服务（运行在独立线程），按设定速率向所有连接分配发送量
+ *
+ * 播放器在 GUI 线程打开输入时会同步等待应答，服务不能与其共用线程。
+ */
+class LadderServer : public QObject
+{
+public:
+    explicit LadderServer(const QString &root) : m_root(root) {}
+
+    bool listen()
+    {
+        m_server = new QTcpServer(this);
+        if (!m_server->listen(QHostAddress::LocalHost, 0)) {
+            qWarning() << "[ABR 测试] 无法监听:" << m_server->errorString();
+            return false;
+        }
+        connect(m_server, &QTcpServer::newConnection, this, [this]() {
+            while (QTcpSocket *socket = m_server->nextPendingConnection()) {
+                serve(socket);
+            }
+        });
+        m_timer = new QTimer(this);
+        connect(m_timer, &QTimer::timeout, this, &LadderServer::pump);
+        m_timer->start(THROTTLE_TICK_MS);
+        return true;
+    }
+
+    quint16 port() const { return m_server ? m_server->serverPort() : 0; }
+
+    /**
+     * @brief 设置总发送速率（字节/秒，0 表示不限速），任何线程可调用
+     */
+    void setRate(qint64 bytesPerSecond) { m_rate.store(bytesPerSecond, std::memory_order_relaxed); }
+
+private:
+    struct Response {
+        QByteArray data;
+        qint64 sent = 0;
+    };
+
+    void serve(QTcpSocket *socket)
+    {
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            m_responses.remove(socket);
+            socket->deleteLater();
+        });
+        connect(socket, &QIODevice::readyRead, this, [this, socket]() {
+            QByteArray request = socket->property("request").toByteArray() + socket->readAll();
+            if (!request.contains("\r\n\r\n")) {
+                socket->setProperty("request", request);
+                return;
+            }
+            const QList<QByteArray> requestLine = request.left(request.indexOf('\n')).trimmed().split(' ');
+            const QString path = QString::fromUtf8(requestLine.value(1)).section('?', 0, 0);
+
+            QByteArray status = "200 OK";
+            QByteArray body;
+            QFile file(m_root + path);
+            if (requestLine.value(0) != "GET" || path.contains(QStringLiteral(".."))) {
+                status = "400 Bad Request";
+            } else if (!file.open(QIODevice::ReadOnly)) {
+                status = "404 Not Found";
+            } else {
+                body = file.readAll();
+            }
+            const QByteArray contentType = path.endsWith(QStringLiteral(".m3u8"))
+                ? "application/vnd.apple.mpegurl" : "video/mp2t";
+
+            Response &response = m_responses[socket];
+            response.data = "HTTP/1.1 " + status + "\r\n"
+                + "Content-Type: " + contentType + "\r\n"
+                + "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                + "Connection: close\r\n\r\n" + body;
+            response.sent = 0;
+        });
+    }
+
+    void pump()
+    {
+        const qint64 rate = m_rate.load(std::memory_order_relaxed);
+        qint64 budget = rate > 0 ? rate * THROTTLE_TICK_MS / 1000 : std::numeric_limits<qint64>::max();
+        for (auto it = m_responses.begin(); it != m_responses.end() && budget > 0;) {
+            QTcpSocket *socket = it.key();
+            Response &response = it.value();
+            if (socket->bytesToWrite() > MAX_SOCKET_BACKLOG) {
+                ++it;
+                continue;
+            }
+            const qint64 chunk = qMin(qMin(budget, UNLIMITED_CHUNK), response.data.size() - response.sent);
+            socket->write(response.data.constData() + response.sent, chunk);
+            response.sent += chunk;
+            budget -= chunk;
+            if (response.sent >= response.data.size()) {
+                socket->disconnectFromHost();   // 写完后关闭
+                it = m_responses.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    QString m_root;
+    QTcpServer *m_server = nullptr;
+    QTimer *m_timer = nullptr;
+    std::atomic<qint64> m_rate{0};
+    QHash<QTcpSocket*, Response> m_responses;
+};
+
+/**
+ * @brief 生成阶梯与主播放列表，返回各档平均码率（bit/s）
+ */
+bool writeLadder(const QString &root, qint64 (&bandwidth)[LADDER_SIZE])
+{
+    QByteArray master = "#EXTM3U\n#EXT-X-VERSION:3\n";
+    for (int i = 0; i < LADDER_SIZE; i++) {
+        const Rung &rung = LADDER[i];
+        QDir dir(root);
+        if (!dir.mkpath(QString::fromLatin1(rung.name)) || !dir.cd(QString::fromLatin1(rung.name))) {
+            return false;
+        }
+
+        SyntheticClipSpec spec;
+        spec.name = rung.name;
+        spec.width = rung.width;
+        spec.height = rung.height;
+        spec.frames = LADDER_FRAMES;
+        spec.fps = LADDER_FPS;
+        spec.codec = AV_CODEC_ID_MPEG4;
+        spec.container = "hls";
+        if (!SyntheticClip::write(spec, dir.filePath(QStringLiteral("index.m3u8")))) {
+            return false;
+        }
+
+        qint64 bytes = 0;
+        for (const QFileInfo &segment : dir.entryInfoList({ QStringLiteral("*.ts") }, QDir::Files)) {
+            bytes += segment.size();
+        }
+        bandwidth[i] = bytes * 8 * LADDER_FPS / LADDER_FRAMES;
+        master += "#EXT-X-STREAM-INF:BANDWIDTH=" + QByteArray::number(bandwidth[i])
+                + ",RESOLUTION=" + QByteArray::number(rung.width) + "x" + QByteArray::number(rung.height) + "\n"
+                + rung.name + "/index.m3u8\n";
+        qDebug().nospace() << "[ABR 测试] " << rung.name << " " << rung.width << "x" << rung.height
+                           << " " << bandwidth[i] / 1000 << " kbps";
+    }
+
+    QFile file(QDir(root).filePath(QStringLiteral("master.m3u8")));
+    return file.open(QIODevice::WriteOnly) && file.write(master) == master.size();
+}
+
+struct Phase {
+    const char *name;
+    qint64 rateBps;     ///< 限速（bit/s），0 表示不限速
+    int expected;       ///< 预期停留的变体，-1 表示按本机解码能力
+};
+
+} // namespace
+
+int AbrTest::run()
+{
+    QTemporaryDir root;
+    qint64 bandwidth[LADDER_SIZE] = {};
+    if (!root.isValid() || !writeLadder(root.path(), bandwidth)) {
+        qCritical() << "生成 HLS 阶梯失败";
+        return 1;
+    }
+
+    QThread serverThread;
+    auto *server = new LadderServer(root.path());
+    server->moveToThread(&serverThread);
+    serverThread.start();
+    bool listening = false;
+    quint16 port = 0;
+    QMetaObject::invokeMethod(server, [server, &listening, &port]() {
+        listening = server->listen();
+        port = server->port();
+    }, Qt::BlockingQueuedConnection);
+    auto shutdown = [&]() {
+        QMetaObject::invokeMethod(server, [server]() { delete server; }, Qt::BlockingQueuedConnection);
+        serverThread.quit();
+        serverThread.wait();
+    };
+    if (!listening) {
+        shutdown();
+        return 1;
+    }
+    const QString url = QStringLiteral("http://127.0.0.1:%1/master.m3u8").arg(port);
+
+    const Phase phases[] = {
+        { "限速介于第 1、2 档之间", (bandwidth[0] + bandwidth[1]) / 2, 0 },
+        { "限速介于第 2、3 档之间", (bandwidth[1] + bandwidth[2]) / 2, 1 },
+        { "不限速", 0, -1 },
+    };
+
+    std::unique_ptr<VideoRendererBase> renderer(createVideoRenderer(nullptr));
+    renderer->resize(640, 360);
+    renderer->show();
+    qDebug() << "自适应码率测试:" << renderer->rendererName() << url;
+
+    int failures = 0;
+    for (const Phase &phase : phases) {
+        server->setRate(phase.rateBps / 8);
+        qDebug().noquote() << QString("[阶段] %1（%2 kbps）").arg(QString::fromUtf8(phase.name))
+                                  .arg(phase.rateBps / 1000);
+
+        QElapsedTimer clock;
+        int variant = -1;
+        qint64 lastSwitchMs = -1;
+        QMetaObject::Connection connection = QObject::connect(renderer.get(), &VideoRendererBase::variantSwitched,
+            [&](int index, const QSize &size, qint64 variantBandwidth) {
+            variant = index;
+            lastSwitchMs = clock.elapsed();
+            qDebug().noquote() << QString("  %1 s: 变体 %2（%3x%4，%5 kbps）")
+                                      .arg(lastSwitchMs / 1000.0, 0, 'f', 1).arg(index)
+                                      .arg(size.width()).arg(size.height()).arg(variantBandwidth / 1000);
+        });
+
+        clock.start();
+        renderer->loadFile(url);
+
+        // 稳定窗口开始时记下丢帧计数，阶段结束时比较
+        QEventLoop loop;
+        PlaybackMetricsSnapshot settleStart;
+        QTimer::singleShot((PHASE_SECONDS - SETTLE_SECONDS) * 1000, &loop, [&]() {
+            if (PlaybackMetrics *metrics = renderer->metrics()) settleStart = metrics->snapshot();
+        });
+        QTimer::singleShot(PHASE_SECONDS * 1000, &loop, &QEventLoop::quit);
+        loop.exec();
+        QObject::disconnect(connection);
+
+        PlaybackMetricsSnapshot settleEnd;
+        if (PlaybackMetrics *metrics = renderer->metrics()) settleEnd = metrics->snapshot();
+        renderer->stop();
+
+        const quint64 dropped = settleEnd.droppedFrames - settleStart.droppedFrames;
+        if (variant < 0) {
+            qWarning() << "[失败] 渲染器未启用自适应码率";
+            failures++;
+            break;
+        }
+        if (lastSwitchMs > (PHASE_SECONDS - SETTLE_SECONDS) * 1000) {
+            qWarning() << "[失败] 最后" << SETTLE_SECONDS << "秒内仍在切换";
+            failures++;
+        } else if (phase.expected >= 0 && variant != phase.expected) {
+            qWarning() << "[失败] 停在变体" << variant << "，预期" << phase.expected;
+            failures++;
+        } else if (phase.expected < 0 && dropped > 0) {
+            qWarning() << "[失败] 停在变体" << variant << "但仍丢帧" << dropped;
+            failures++;
+        } else {
+            qDebug() << "[通过] 停在变体" << variant << "，吞吐估计"
+                     << qRound64(settleEnd.abrThroughputBps / 1000) << "kbps";
+        }
+    }
+
+    renderer.reset();
+    shutdown();
+    return failures ? 1 : 0;
+}
+
+#else
+
+int AbrTest::run()
+{
+    qCritical("此版本未启用 FFmpeg，无法运行自适应码率测试");
+    return 1;
+}
+
+#endif
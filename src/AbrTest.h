@@ -0,0 +1,29 @@
+/**
+ * @file AbrTest.h
+ * @brief 自适应码率测试
+ *
+ * 在本地生成三档 HLS 阶梯（320x180 / 640x360 / 1280x720，1 秒分片），
+ * 由独立线程上的限速 HTTP 服务提供，分三个阶段播放：
+ * - 限速介于第 1、2 档码率之间：应停在第 1 档
+ * - 限速介于第 2、3 档码率之间：应停在第 2 档
+ * - 不限速：停在本机能全速解码的一档（最后一段时间内不再切换、不丢帧）
+ * 每个阶段最后 SETTLE_SECONDS 秒内发生切换即视为未稳定，判为失败。
+ *
+ * 用法：
+ *   LoopVideoPlayer --abr-test
+ */
+
+#ifndef ABRTEST_H
+#define ABRTEST_H
+
+namespace AbrTest {
+
+/**
+ * @brief 运行自适应码率测试
+ * @return 进程退出码：0 表示各阶段都停在预期的变体上
+ */
+int run();
+
+} // namespace AbrTest
+
+#endif // ABRTEST_H
@@ -0,0 +1,130 @@
+/**
+ * @file AudioTelemetry.cpp
+ * @brief 音频输出遥测实现
+ */
+
+#include "AudioTelemetry.h"
+
+QString AudioTelemetrySnapshot::summary() const
+{
+    return QString("欠载 %1 次（解码 %2 / 写入 %3）共 %4 ms，设备延迟 %5 ms，缓冲 %6 ms，"
+                   "漂移 %7 ppm，写入 平均 %8 us / 最长 %9 us，最长间隔 %10 ms")
+        .arg(underruns)
+        .arg(decoderStarvedUnderruns)
+        .arg(deviceStarvedUnderruns)
+        .arg(underrunMs, 0, 'f', 0)
+        .arg(deviceLatencyMs, 0, 'f', 1)
+        .arg(bufferedMs, 0, 'f', 1)
+        .arg(driftPpm, 0, 'f', 0)
+        .arg(writeCalls ? writeTotalUs / writeCalls : 0.0, 0, 'f', 1)
+        .arg(writeMaxUs, 0, 'f', 0)
+        .arg(maxWriteIntervalMs, 0, 'f', 1);
+}
+
+AudioTelemetry::AudioTelemetry()
+{
+    m_clock.start();
+}
+
+void AudioTelemetry::addDouble(std::atomic<double> &target, double value)
+{
+    // 只有写入端修改，load + store 即可
+    target.store(target.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+void AudioTelemetry::maxDouble(std::atomic<double> &target, double value)
+{
+    if (value > target.load(std::memory_order_relaxed)) {
+        target.store(value, std::memory_order_relaxed);
+    }
+}
+
+void AudioTelemetry::beginWrite()
+{
+    m_writeStartNs = m_clock.nsecsElapsed();
+    if (m_lastWriteNs >= 0) {
+        maxDouble(m_maxWriteIntervalMs, (m_writeStartNs - m_lastWriteNs) / 1e6);
+    }
+    m_lastWriteNs = m_writeStartNs;
+}
+
+void AudioTelemetry::endWrite(double bufferedMs, bool sourceEmpty, double playedSeconds)
+{
+    const qint64 now = m_clock.nsecsElapsed();
+    const double writeUs = (now - m_writeStartNs) / 1e3;
+    m_writeCalls.fetch_add(1, std::memory_order_relaxed);
+    addDouble(m_writeTotalUs, writeUs);
+    maxDouble(m_writeMaxUs, writeUs);
+
+    m_bufferedMs.store(bufferedMs, std::memory_order_relaxed);
+    int bucket = 0;
+    while (bucket < AUDIO_BUFFER_BUCKET_COUNT - 1 && bufferedMs > AUDIO_BUFFER_BUCKETS_MS[bucket]) {
+        bucket++;
+    }
+    m_histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+
+    // 欠载：缓冲建立后又降到阈值以下，直到重新建立
+    const bool low = bufferedMs < UNDERRUN_THRESHOLD_MS;
+    if (!m_started) {
+        m_started = !low;
+    } else if (low && !m_inUnderrun) {
+        m_inUnderrun = true;
+        m_underrunStartNs = now;
+        m_underruns.fetch_add(1, std::memory_order_relaxed);
+        (sourceEmpty ? m_decoderStarved : m_deviceStarved).fetch_add(1, std::memory_order_relaxed);
+        m_driftBaseValid = false;
+    } else if (!low && m_inUnderrun) {
+        m_inUnderrun = false;
+        addDouble(m_underrunMs, (now - m_underrunStartNs) / 1e6);
+    }
+
+    // 漂移：连续播放期间，设备已播放时长与单调时钟的差
+    // 已播放时长回退说明写入计数被清零（清空音频队列），重新取基准
+    const bool rewound = playedSeconds < m_lastPlayed;
+    m_lastPlayed = playedSeconds;
+    if (m_inUnderrun || !m_started) return;
+    if (!m_driftBaseValid || rewound) {
+        m_driftBaseValid = true;
+        m_driftBaseNs = now;
+        m_driftBasePlayed = playedSeconds;
+        return;
+    }
+    const qint64 wallNs = now - m_driftBaseNs;
+    if (wallNs >= DRIFT_MIN_WINDOW_NS) {
+        const double wall = wallNs / 1e9;
+        const double played = playedSeconds - m_driftBasePlayed;
+        m_driftPpm.store((played - wall) / wall * 1e6, std::memory_order_relaxed);
+    }
+}
+
+void AudioTelemetry::reset()
+{
+    if (m_inUnderrun) {
+        addDouble(m_underrunMs, (m_clock.nsecsElapsed() - m_underrunStartNs) / 1e6);
+    }
+    m_started = false;
+    m_inUnderrun = false;
+    m_driftBaseValid = false;
+    m_lastWriteNs = -1;
+    m_lastPlayed = 0;
+}
+
+AudioTelemetrySnapshot AudioTelemetry::snapshot() const
+{
+    AudioTelemetrySnapshot snapshot;
+    snapshot.underruns = m_underruns.load(std::memory_order_relaxed);
+    snapshot.decoderStarvedUnderruns = m_decoderStarved.load(std::memory_order_relaxed);
+    snapshot.deviceStarvedUnderruns = m_deviceStarved.load(std::memory_order_relaxed);
+    snapshot.underrunMs = m_underrunMs.load(std::memory_order_relaxed);
+    snapshot.deviceLatencyMs = m_deviceLatencyMs.load(std::memory_order_relaxed);
+    snapshot.bufferedMs = m_bufferedMs.load(std::memory_order_relaxed);
+    for (int i = 0; i < AUDIO_BUFFER_BUCKET_COUNT; i++) {
+        snapshot.bufferedHistogram[i] = m_histogram[i].load(std::memory_order_relaxed);
+    }
+    snapshot.driftPpm = m_driftPpm.load(std::memory_order_relaxed);
+    snapshot.writeCalls = m_writeCalls.load(std::memory_order_relaxed);
+    snapshot.writeTotalUs = m_writeTotalUs.load(std::memory_order_relaxed);
+    snapshot.writeMaxUs = m_writeMaxUs.load(std::memory_order_relaxed);
+    snapshot.maxWriteIntervalMs = m_maxWriteIntervalMs.load(std::memory_order_relaxed);
+    return snapshot;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file AudioTelemetry.h
+ * @brief 音频输出遥测
+ *
+ * 由音频写入路径（GUI 线程的音频定时器）每次调用一次 beginWrite/endWrite，记录：
+ * - 欠载次数与时长，并按起因区分：解码队列为空（解码太慢）/ 队列有数据但没写进去（事件循环没按时调度）
+ * - 设备报告的延迟、设备缓冲的毫秒数（直方图）
+ * - 音频时钟相对单调时钟的漂移（ppm）
+ * - 写入路径耗时、两次写入之间的最大间隔
+ *
+ * 写入端单线程，读取端任意线程通过 snapshot() 获取，字段均为 relaxed 原子量。
+ */
+
+#ifndef AUDIOTELEMETRY_H
+#define AUDIOTELEMETRY_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <atomic>
+
+/**
+ * @brief 缓冲直方图的分桶上界（毫秒），最后一桶为超过最大上界
+ */
+static constexpr double AUDIO_BUFFER_BUCKETS_MS[] = {10, 20, 50, 100, 200, 500};
+static constexpr int AUDIO_BUFFER_BUCKET_COUNT = 7;
+
+/**
+ * @brief 音频遥测快照
+ */
+struct AudioTelemetrySnapshot {
+    quint64 underruns = 0;                  ///< 欠载次数
+    quint64 decoderStarvedUnderruns = 0;    ///< 欠载时解码队列为空（解码跟不上）
+    quint64 deviceStarvedUnderruns = 0;     ///< 欠载时解码队列有数据（写入不及时）
+    double underrunMs = 0;                  ///< 欠载累计时长
+    double deviceLatencyMs = 0;             ///< 设备报告的缓冲延迟
+    double bufferedMs = 0;                  ///< 最近一次写入后设备侧缓冲
+    quint64 bufferedHistogram[AUDIO_BUFFER_BUCKET_COUNT] = {};
+    double driftPpm = 0;                    ///< 音频时钟相对单调时钟的漂移（正值表示音频偏快）
+    quint64 writeCalls = 0;                 ///< 写入路径调用次数
+    double writeTotalUs = 0;                ///< 写入路径累计耗时
+    double writeMaxUs = 0;                  ///< 单次写入路径最长耗时
+    double maxWriteIntervalMs = 0;          ///< 两次写入之间的最长间隔（事件循环延迟）
+
+    /**
+     * @brief 单行摘要（用于日志）
+     */
+    QString summary() const;
+};
+
+/**
+ * @brief 音频输出遥测
+ */
+class AudioTelemetry
+{
+public:
+    AudioTelemetry();
+
+    /**
+     * @brief 设备打开后记录设备报告的缓冲延迟
+     */
+    void setDeviceLatency(double ms) { m_deviceLatencyMs.store(ms, std::memory_order_relaxed); }
+
+    /**
+     * @brief 写入路径开始
+     */
+    void beginWrite();
+
+    /**
+     * @brief 写入路径结束
+     * @param bufferedMs 写入后设备侧仍未播放的数据（毫秒）
+     * @param sourceEmpty 解码出的音频是否已耗尽
+     * @param playedSeconds 设备已播放的时长（用于漂移计算）
+     */
+    void endWrite(double bufferedMs, bool sourceEmpty, double playedSeconds);
+
+    /**
+     * @brief 时间轴不连续（seek、循环、暂停、重开设备）：结束当前欠载与漂移基准
+     */
+    void reset();
+
+    AudioTelemetrySnapshot snapshot() const;
+
+private:
+    static constexpr double UNDERRUN_THRESHOLD_MS = 1.0;   ///< 缓冲低于此值视为欠载
+    static constexpr qint64 DRIFT_MIN_WINDOW_NS = 2000000000LL;    ///< 漂移至少在 2 秒窗口上计算
+
+    static void addDouble(std::atomic<double> &target, double value);
+    static void maxDouble(std::atomic<double> &target, double value);
+
+    // 写入端状态（仅音频写入线程访问）
+    QElapsedTimer m_clock;
+    qint64 m_writeStartNs = 0;
+    qint64 m_lastWriteNs = -1;
+    bool m_started = false;         ///< 复位后缓冲是否已建立（之前的空缓冲不算欠载）
+    bool m_inUnderrun = false;
+    qint64 m_underrunStartNs = 0;
+    bool m_driftBaseValid = false;
+    qint64 m_driftBaseNs = 0;
+    double m_driftBasePlayed = 0;
+    double m_lastPlayed = 0;
+
+    std::atomic<quint64> m_underruns{0};
+    std::atomic<quint64> m_decoderStarved{0};
+    std::atomic<quint64> m_deviceStarved{0};
+    std::atomic<double> m_underrunMs{0};
+    std::atomic<double> m_deviceLatencyMs{0};
+    std::atomic<double> m_bufferedMs{0};
+    std::atomic<quint64> m_histogram[AUDIO_BUFFER_BUCKET_COUNT] = {};
+    std::atomic<double> m_driftPpm{0};
+    std::atomic<quint64> m_writeCalls{0};
+    std::atomic<double> m_writeTotalUs{0};
+    std::atomic<double> m_writeMaxUs{0};
+    std::atomic<double> m_maxWriteIntervalMs{0};
+};
+
+#endif // AUDIOTELEMETRY_H
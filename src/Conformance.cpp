@@ -0,0 +1,626 @@
+/**
+ * @file Conformance.cpp
+ * @brief 输出一致性检查实现
+ */
+
+#include "Conformance.h"
+#include "FFmpegPlayer.h"
+#include "SyntheticClip.h"
+#include "YuvConverter.h"
+
+#if RHI_RENDERER_AVAILABLE
+#include "RhiRenderer.h"
+#endif
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QThread>
+#include <cmath>
+
+#if FFMPEG_AVAILABLE
+extern "C" {
+#include <libavutil/crc.h>
+}
+#endif
+
+#if FFMPEG_AVAILABLE
+
+namespace {
+
+// ==================== 参考片段 ====================
+
+// 宽度刻意不取 32 的倍数，覆盖 SIMD 内核的行尾标量路径
+SyntheticClipSpec clipSpec(const char *name, AVPixelFormat format, int width, int height, int fps)
+{
+    SyntheticClipSpec spec;
+    spec.name = name;
+    spec.format = format;
+    spec.width = width;
+    spec.height = height;
+    spec.frames = 24;
+    spec.fps = fps;
+    return spec;
+}
+
+// 流中途改变分辨率：MPEG4 在切换帧处带内发送新参数集，覆盖解码输出的重配置路径
+SyntheticClipSpec switchClipSpec(const char *name, int width, int height, int switchWidth, int switchHeight)
+{
+    SyntheticClipSpec spec = clipSpec(name, AV_PIX_FMT_YUV420P, width, height, 24);
+    spec.codec = AV_CODEC_ID_MPEG4;
+    spec.switchFrame = spec.frames / 2;
+    spec.switchWidth = switchWidth;
+    spec.switchHeight = switchHeight;
+    return spec;
+}
+
+const SyntheticClipSpec CLIPS[] = {
+    clipSpec("yuv420p_334x190", AV_PIX_FMT_YUV420P, 334, 190, 24),
+    clipSpec("nv12_320x180",    AV_PIX_FMT_NV12,    320, 180, 30),
+    switchClipSpec("mpeg4_switch_320x180_240x136", 320, 180, 240, 136),
+};
+
+// ==================== 校验值 ====================
+
+enum class Check { Crc, Signature };
+
+struct FrameRecord {
+    double pts = 0;
+    QString value;      ///< CRC32（8 位十六进制）或签名（十六进制）
+};
+
+struct VariantResult {
+    QString name;
+    Check check = Check::Crc;
+    int tolerance = 0;      ///< 签名每个分量允许的最大差值
+    bool skipped = false;   ///< 当前环境无法运行（如无 GPU），不计为失败
+    bool ffmpegDependent = false;   ///< 结果随 FFmpeg 版本变化（sws_scale / 有损解码 / GPU），golden 按版本固定
+    QString error;
+    QList<FrameRecord> frames;
+};
+
+static constexpr int SIGNATURE_GRID = 8;
+
+/**
+ * @brief 图像可见像素的 CRC32（不含行尾填充）
+ */
+QString frameCrc(const QImage &image)
+{
+    const AVCRC *table = av_crc_get_table(AV_CRC_32_IEEE_LE);
+    const int rowBytes = image.width() * image.depth() / 8;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (int y = 0; y < image.height(); y++) {
+        crc = av_crc(table, crc, image.constScanLine(y), rowBytes);
+    }
+    return QString::asprintf("%08x", crc ^ 0xFFFFFFFFu);
+}
+
+/**
+ * @brief 8x8 分块的 B/G/R 均值（对 GPU 采样与缩放滤波的细微差异不敏感）
+ */
+QByteArray frameSignature(const QImage &source)
+{
+    const QImage image = source.convertToFormat(QImage::Format_RGB32);
+    QByteArray signature(SIGNATURE_GRID * SIGNATURE_GRID * 3, 0);
+    for (int gy = 0; gy < SIGNATURE_GRID; gy++) {
+        const int y0 = gy * image.height() / SIGNATURE_GRID;
+        const int y1 = qMax(y0 + 1, (gy + 1) * image.height() / SIGNATURE_GRID);
+        for (int gx = 0; gx < SIGNATURE_GRID; gx++) {
+            const int x0 = gx * image.width() / SIGNATURE_GRID;
+            const int x1 = qMax(x0 + 1, (gx + 1) * image.width() / SIGNATURE_GRID);
+            qint64 sum[3] = {0, 0, 0};
+            for (int y = y0; y < y1; y++) {
+                const uchar *row = image.constScanLine(y);
+                for (int x = x0; x < x1; x++) {
+                    for (int c = 0; c < 3; c++) sum[c] += row[x * 4 + c];
+                }
+            }
+            const qint64 count = qint64(y1 - y0) * (x1 - x0);
+            for (int c = 0; c < 3; c++) {
+                signature[(gy * SIGNATURE_GRID + gx) * 3 + c] = static_cast<char>((sum[c] + count / 2) / count);
+            }
+        }
+    }
+    return signature;
+}
+
+void recordFrame(VariantResult &result, double pts, const QImage &image)
+{
+    FrameRecord record;
+    record.pts = pts;
+    record.value = result.check == Check::Crc
+        ? frameCrc(image)
+        : QString::fromLatin1(frameSignature(image).toHex());
+    result.frames.append(record);
+}
+
+// ==================== 软件路径（DecodeThread） ====================
+
+/**
+ * @brief 软件输出路径变体
+ *
+ * divisor 为 0 表示缩放到 3/5（非整数倍，走 sws_scale 回退）。
+ */
+struct SoftwareVariant {
+    const char *name;
+    FrameFormat format;
+    int divisor;
+    Check check;
+    int tolerance;
+};
+
+const SoftwareVariant SOFTWARE_VARIANTS[] = {
+    { "rgb32",            FrameFormat::RGB32, 1, Check::Crc,       0 },
+    { "rgb32_half",       FrameFormat::RGB32, 2, Check::Crc,       0 },
+    { "rgb32_quarter",    FrameFormat::RGB32, 4, Check::Crc,       0 },
+    { "rgb32_sws_scaled", FrameFormat::RGB32, 0, Check::Signature, 2 },
+    { "nv12",             FrameFormat::NV12,  1, Check::Crc,       0 },
+};
+
+static constexpr qint64 DECODE_TIMEOUT_MS = 30000;
+
+VariantResult runSoftwareVariant(const SyntheticClipSpec &clip, const SoftwareVariant &variant, const QString &path)
+{
+    VariantResult result;
+    result.name = QString::fromLatin1(variant.name);
+    result.check = variant.check;
+    result.tolerance = variant.tolerance;
+    // 只有 rawvideo 经专用内核（或 NV12 直接复制）的结果与 FFmpeg 版本无关
+    result.ffmpegDependent = clip.codec != AV_CODEC_ID_RAWVIDEO || variant.divisor == 0
+        || (variant.format == FrameFormat::NV12 && clip.format != AV_PIX_FMT_NV12);
+
+    DecodeThread decoder;
+    if (!decoder.openFile(path)) {
+        result.error = "无法打开参考片段";
+        return result;
+    }
+
+    const QSize outputSize = variant.divisor > 0
+        ? QSize(clip.width / variant.divisor, clip.height / variant.divisor)
+        : QSize(clip.width * 3 / 5, clip.height * 3 / 5);
+    decoder.setOutputFormat(variant.format);
+    decoder.setOutputSize(outputSize);
+    decoder.startDecoding();
+
+    QElapsedTimer timer;
+    timer.start();
+    VideoFrame frame;
+    while (true) {
+        if (decoder.getVideoFrame(frame)) {
+            recordFrame(result, frame.pts, frame.image);
+            continue;
+        }
+        if (decoder.isFinished()) {
+            // 线程结束后队列中可能还有帧
+            while (decoder.getVideoFrame(frame)) {
+                recordFrame(result, frame.pts, frame.image);
+            }
+            break;
+        }
+        if (timer.elapsed() > DECODE_TIMEOUT_MS) {
+            result.error = "解码超时";
+            break;
+        }
+        QThread::msleep(1);
+    }
+
+    decoder.stopDecoding();
+    decoder.closeFile();
+    return result;
+}
+
+// ==================== RHI 路径（离屏回读） ====================
+
+#if RHI_RENDERER_AVAILABLE
+
+VariantResult runRhiVariant(const SyntheticClipSpec &clip, const QString &path)
+{
+    VariantResult result;
+    result.name = "rhi_readback";
+    result.check = Check::Signature;
+    result.tolerance = 6;
+    result.ffmpegDependent = true;
+
+    AVFormatContext *formatCtx = nullptr;
+    if (avformat_open_input(&formatCtx, path.toUtf8().constData(), nullptr, nullptr) != 0) {
+        result.error = "无法打开参考片段";
+        return result;
+    }
+
+    AVCodecContext *codecCtx = nullptr;
+    SwsContext *swsCtx = nullptr;
+    const int streamIndex = avformat_find_stream_info(formatCtx, nullptr) >= 0
+        ? av_find_best_stream(formatCtx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0) : -1;
+    if (streamIndex >= 0) {
+        const AVCodecParameters *codecpar = formatCtx->streams[streamIndex]->codecpar;
+        const AVCodec *codec = avcodec_find_decoder(codecpar->codec_id);
+        codecCtx = codec ? avcodec_alloc_context3(codec) : nullptr;
+        if (codecCtx && (avcodec_parameters_to_context(codecCtx, codecpar) < 0
+                         || avcodec_open2(codecCtx, codec, nullptr) < 0)) {
+            avcodec_free_context(&codecCtx);
+        }
+    }
+    if (!codecCtx) {
+        result.error = "无法打开解码器";
+        avformat_close_input(&formatCtx);
+        return result;
+    }
+
+    // 不显示的 QRhiWidget 也可以离屏渲染并回读
+    RhiVideoView view;
+    view.resize(clip.width, clip.height);
+
+    const double timeBase = av_q2d(formatCtx->streams[streamIndex]->time_base);
+    AVPacket *packet = av_packet_alloc();
+    AVFrame *frame = av_frame_alloc();
+
+    auto receiveFrames = [&]() {
+        while (!result.skipped && avcodec_receive_frame(codecCtx, frame) >= 0) {
+            RhiVideoFrame vf;
+            if (!RhiRenderer::fillFrame(frame, swsCtx, vf)) continue;
+            view.setFrame(std::move(vf));
+
+            const QImage image = view.grabFramebuffer();
+            if (image.isNull()) {
+                // 没有可用的图形 API（如纯 CPU 的 CI 机器）
+                result.skipped = true;
+                break;
+            }
+            const double pts = frame->best_effort_timestamp != AV_NOPTS_VALUE
+                ? frame->best_effort_timestamp * timeBase : 0.0;
+            recordFrame(result, pts, image);
+        }
+    };
+
+    while (!result.skipped && av_read_frame(formatCtx, packet) >= 0) {
+        if (packet->stream_index == streamIndex && avcodec_send_packet(codecCtx, packet) >= 0) {
+            receiveFrames();
+        }
+        av_packet_unref(packet);
+    }
+    if (!result.skipped && avcodec_send_packet(codecCtx, nullptr) >= 0) {
+        receiveFrames();
+    }
+
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+    sws_freeContext(swsCtx);
+    avcodec_free_context(&codecCtx);
+    avformat_close_input(&formatCtx);
+    return result;
+}
+
+#endif
+
+// ==================== 取值范围（内存帧直接经过转换内核） ====================
+
+/**
+ * @brief 取值范围用例
+ *
+ * rawvideo 写入容器后 YUVJ420P 会读回为 YUV420P、color_range 也不保存，
+ * 所以在内存中生成帧，直接交给转换内核。
+ */
+struct RangeCase {
+    const char *name;
+    AVPixelFormat format;
+    AVColorRange range;
+};
+
+const RangeCase RANGE_CASES[] = {
+    { "range_yuv420p_limited", AV_PIX_FMT_YUV420P,  AVCOL_RANGE_MPEG },
+    { "range_yuv420p_full",    AV_PIX_FMT_YUV420P,  AVCOL_RANGE_JPEG },
+    { "range_yuvj420p",        AV_PIX_FMT_YUVJ420P, AVCOL_RANGE_JPEG },
+};
+
+static constexpr int RANGE_FRAMES = 8;
+static constexpr int RANGE_FPS = 24;
+static constexpr int RANGE_WIDTH = 334;
+static constexpr int RANGE_HEIGHT = 190;
+// 与浮点参考的逐像素偏差上限：6 位定点误差最大为 3，范围用错时偏差在 10 以上
+static constexpr int REFERENCE_TOLERANCE = 3;
+
+/**
+ * @brief BT.601 浮点参考与转换结果的最大逐像素偏差（原尺寸，色度取样方式与内核相同）
+ *
+ * 逐像素比较而不用分块签名：测试图样的渐变覆盖 0..255，
+ * 分块均值会把有限/全范围的差异平均掉。
+ */
+int maxReferenceDiff(const AVFrame *frame, bool fullRange, const QImage &image)
+{
+    const double yOffset = fullRange ? 0.0 : 16.0;
+    const double yScale = fullRange ? 1.0 : 255.0 / 219.0;
+    const double cScale = fullRange ? 1.0 : 255.0 / 224.0;
+    int maxDiff = 0;
+    for (int y = 0; y < frame->height; y++) {
+        const uint8_t *yRow = frame->data[0] + y * frame->linesize[0];
+        const uint8_t *uRow = frame->data[1] + (y >> 1) * frame->linesize[1];
+        const uint8_t *vRow = frame->data[2] + (y >> 1) * frame->linesize[2];
+        const uchar *out = image.constScanLine(y);
+        for (int x = 0; x < frame->width; x++) {
+            const double luma = (yRow[x] - yOffset) * yScale;
+            const double u = (uRow[x >> 1] - 128) * cScale;
+            const double v = (vRow[x >> 1] - 128) * cScale;
+            const double bgr[3] = {
+                luma + 1.772 * u,
+                luma - 0.344136 * u - 0.714136 * v,
+                luma + 1.402 * v,
+            };
+            for (int c = 0; c < 3; c++) {
+                const int expected = static_cast<int>(std::lround(qBound(0.0, bgr[c], 255.0)));
+                maxDiff = qMax(maxDiff, std::abs(expected - int(out[x * 4 + c])));
+            }
+        }
+    }
+    return maxDiff;
+}
+
+/**
+ * @brief 一个取值范围用例的全部缩小倍数：记录 CRC，并检查 FrameConverter 选中的特化与内核一致，
+ *        原尺寸另与浮点参考比较（不依赖 golden）
+ */
+QList<VariantResult> runRangeCase(const RangeCase &rangeCase)
+{
+    static const struct { const char *name; int downscale; } SCALES[] = {
+        { "bgra", 1 }, { "bgra_half", 2 }, { "bgra_quarter", 4 },
+    };
+
+    QList<VariantResult> results;
+    AVFrame *frame = av_frame_alloc();
+    frame->format = rangeCase.format;
+    frame->width = RANGE_WIDTH;
+    frame->height = RANGE_HEIGHT;
+    frame->color_range = rangeCase.range;
+    if (av_frame_get_buffer(frame, 0) < 0) {
+        av_frame_free(&frame);
+        VariantResult result;
+        result.name = "bgra";
+        result.error = "无法分配帧";
+        return { result };
+    }
+
+    YuvConverter::SourceFormat layout = YuvConverter::YUV420P;
+    YuvConverter::sourceFormatFor(frame->format, &layout);
+    const YuvConverter::ColorRange range = YuvConverter::colorRangeFor(frame->format, frame->color_range);
+    // 期望的范围由用例本身给出，不经过 colorRangeFor，选择逻辑出错也能发现
+    const bool expectFullRange = rangeCase.format == AV_PIX_FMT_YUVJ420P || rangeCase.range == AVCOL_RANGE_JPEG;
+
+    FrameConverter converter;
+    for (const auto &scale : SCALES) {
+        VariantResult result;
+        result.name = QString::fromLatin1(scale.name);
+        const QSize outputSize(RANGE_WIDTH / scale.downscale, RANGE_HEIGHT / scale.downscale);
+        for (int i = 0; i < RANGE_FRAMES && result.error.isEmpty(); i++) {
+            SyntheticClip::fillPattern(frame, i);
+            QImage image(outputSize, QImage::Format_RGB32);
+            YuvConverter::convertToBgra(layout, frame->data, frame->linesize, RANGE_WIDTH, RANGE_HEIGHT,
+                                        image.bits(), static_cast<int>(image.bytesPerLine()),
+                                        scale.downscale, range);
+            recordFrame(result, double(i) / RANGE_FPS, image);
+
+            // 播放路径经 FrameConverter 分派，选中的特化必须与直接调用内核的结果一致
+            if (!converter.configure(rangeCase.format, QSize(RANGE_WIDTH, RANGE_HEIGHT),
+                                     FrameFormat::RGB32, outputSize, rangeCase.range)) {
+                result.error = "FrameConverter 无法选择转换函数";
+            } else if (frameCrc(converter.convert(frame)) != result.frames.last().value) {
+                result.error = QString("第 %1 帧 FrameConverter（%2）与转换内核输出不一致")
+                                   .arg(i).arg(QString::fromLatin1(converter.name()));
+            }
+
+            if (scale.downscale == 1 && result.error.isEmpty()) {
+                const int maxDiff = maxReferenceDiff(frame, expectFullRange, image);
+                if (maxDiff > REFERENCE_TOLERANCE) {
+                    result.error = QString("第 %1 帧与 BT.601 参考偏差 %2 超出容差 %3（取值范围处理错误？）")
+                                       .arg(i).arg(maxDiff).arg(REFERENCE_TOLERANCE);
+                }
+            }
+        }
+        results.append(result);
+    }
+
+    av_frame_free(&frame);
+    return results;
+}
+
+// ==================== golden 比较 ====================
+
+QJsonObject toJson(const VariantResult &result)
+{
+    QJsonArray pts;
+    QJsonArray values;
+    for (const FrameRecord &frame : result.frames) {
+        pts.append(frame.pts);
+        values.append(frame.value);
+    }
+    QJsonObject object;
+    object["check"] = result.check == Check::Crc ? "crc32" : "signature";
+    object["tolerance"] = result.tolerance;
+    object["pts"] = pts;
+    object["values"] = values;
+    if (result.ffmpegDependent) {
+        object["ffmpeg_version"] = QString::fromLatin1(av_version_info());
+    }
+    return object;
+}
+
+/**
+ * @brief 与 golden 比较
+ * @return 不一致的描述，一致时为空
+ */
+QString compare(const VariantResult &result, const QJsonObject &golden)
+{
+    const QJsonArray pts = golden["pts"].toArray();
+    const QJsonArray values = golden["values"].toArray();
+    if (pts.size() != result.frames.size()) {
+        return QString("帧数不一致: %1（golden %2）").arg(result.frames.size()).arg(pts.size());
+    }
+
+    for (int i = 0; i < result.frames.size(); i++) {
+        const FrameRecord &frame = result.frames[i];
+        if (std::abs(frame.pts - pts[i].toDouble()) > 1e-6) {
+            return QString("第 %1 帧 PTS 不一致: %2（golden %3）").arg(i).arg(frame.pts).arg(pts[i].toDouble());
+        }
+
+        const QString expected = values[i].toString();
+        if (result.check == Check::Crc) {
+            if (frame.value != expected) {
+                return QString("第 %1 帧 CRC 不一致: %2（golden %3）").arg(i).arg(frame.value, expected);
+            }
+            continue;
+        }
+
+        const QByteArray actual = QByteArray::fromHex(frame.value.toLatin1());
+        const QByteArray reference = QByteArray::fromHex(expected.toLatin1());
+        if (actual.size() != reference.size()) {
+            return QString("第 %1 帧签名长度不一致").arg(i);
+        }
+        int maxDiff = 0;
+        for (int j = 0; j < actual.size(); j++) {
+            maxDiff = qMax(maxDiff, std::abs(int(uchar(actual[j])) - int(uchar(reference[j]))));
+        }
+        if (maxDiff > result.tolerance) {
+            return QString("第 %1 帧签名偏差 %2 超出容差 %3").arg(i).arg(maxDiff).arg(result.tolerance);
+        }
+    }
+    return QString();
+}
+
+/**
+ * @brief 报告一个片段的结果：update 时返回待写入的 golden，否则与 golden 比较
+ * @param expectedFrames >0 时要求帧数一致（流中途切换分辨率的片段）
+ * @param failures 失败计数（累加）
+ */
+QJsonObject checkResults(const QString &clipName, const QList<VariantResult> &results,
+                         const QJsonObject &clipGoldens, bool update, int expectedFrames, int &failures)
+{
+    QJsonObject clipUpdated;
+    for (const VariantResult &result : results) {
+        const QString label = clipName + "/" + result.name;
+        if (!result.error.isEmpty()) {
+            qWarning().noquote() << "[失败]" << label << result.error;
+            failures++;
+            continue;
+        }
+        if (result.skipped) {
+            qDebug().noquote() << "[跳过]" << label << "当前环境不支持";
+            continue;
+        }
+        if (expectedFrames > 0 && result.frames.size() != expectedFrames) {
+            // 切换点丢帧也要在 --conformance-update 时暴露，不能被记入 golden
+            qWarning().noquote() << "[失败]" << label << "切换分辨率后帧数不一致:"
+                                 << result.frames.size() << "/" << expectedFrames;
+            failures++;
+            continue;
+        }
+
+        if (update) {
+            clipUpdated[result.name] = toJson(result);
+            qDebug().noquote() << "[记录]" << label << result.frames.size() << "帧";
+            continue;
+        }
+
+        const QJsonObject golden = clipGoldens[result.name].toObject();
+        if (result.ffmpegDependent && golden["ffmpeg_version"].toString() != QString::fromLatin1(av_version_info())) {
+            // 随版本变化的结果只与同一 FFmpeg 版本记录的 golden 比较
+            qDebug().noquote() << "[未固定]" << label << "没有 FFmpeg" << av_version_info()
+                               << "记录的 golden（用该版本运行 --conformance-update 固定）";
+            continue;
+        }
+        if (!clipGoldens.contains(result.name)) {
+            qWarning().noquote() << "[失败]" << label << "缺少 golden";
+            failures++;
+            continue;
+        }
+        const QString mismatch = compare(result, golden);
+        if (mismatch.isEmpty()) {
+            qDebug().noquote() << "[通过]" << label << result.frames.size() << "帧";
+        } else {
+            qWarning().noquote() << "[失败]" << label << mismatch;
+            failures++;
+        }
+    }
+    return clipUpdated;
+}
+
+} // namespace
+
+// ==================== 入口 ====================
+
+int Conformance::run(const QString &goldenPath, bool update)
+{
+    QTemporaryDir clipDir;
+    if (!clipDir.isValid()) {
+        qCritical() << "无法创建临时目录";
+        return 1;
+    }
+
+    QJsonObject goldens;
+    if (!update) {
+        QFile file(goldenPath);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qCritical() << "无法读取 golden 文件:" << goldenPath << "（首次使用请加 --conformance-update）";
+            return 1;
+        }
+        goldens = QJsonDocument::fromJson(file.readAll()).object()["clips"].toObject();
+    }
+
+    QJsonObject updated;
+    int failures = 0;
+
+    for (const SyntheticClipSpec &clip : CLIPS) {
+        const QString clipName = QString::fromLatin1(clip.name);
+        const QString path = clipDir.filePath(clipName + ".nut");
+        if (!SyntheticClip::write(clip, path)) {
+            qCritical() << "生成参考片段失败:" << clipName;
+            return 1;
+        }
+
+        QList<VariantResult> results;
+        for (const SoftwareVariant &variant : SOFTWARE_VARIANTS) {
+            results.append(runSoftwareVariant(clip, variant, path));
+        }
+#if RHI_RENDERER_AVAILABLE
+        results.append(runRhiVariant(clip, path));
+#endif
+
+        updated[clipName] = checkResults(clipName, results, goldens[clipName].toObject(), update,
+                                         clip.switchFrame > 0 ? clip.frames : 0, failures);
+    }
+
+    for (const RangeCase &rangeCase : RANGE_CASES) {
+        const QString caseName = QString::fromLatin1(rangeCase.name);
+        updated[caseName] = checkResults(caseName, runRangeCase(rangeCase), goldens[caseName].toObject(),
+                                         update, 0, failures);
+    }
+
+    if (update) {
+        QFile file(goldenPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qCritical() << "无法写入 golden 文件:" << goldenPath;
+            return 1;
+        }
+        QJsonObject root;
+        root["clips"] = updated;
+        file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+        qDebug() << "golden 已更新:" << goldenPath;
+        return failures ? 1 : 0;
+    }
+
+    qDebug() << "一致性检查完成，失败:" << failures;
+    return failures ? 1 : 0;
+}
+
+#else
+
+int Conformance::run(const QString &goldenPath, bool update)
+{
+    Q_UNUSED(goldenPath)
+    Q_UNUSED(update)
+    qCritical("此版本未启用 FFmpeg，无法运行一致性检查");
+    return 1;
+}
+
+#endif
@@ -0,0 +1,41 @@
+/**
+ * @file Conformance.h
+ * @brief 输出一致性检查（golden 帧校验）
+ *
+ * 在本地生成确定性的参考片段（rawvideo 无损编码），让它们经过各条输出路径：
+ * - 软件 RGB32 路径（DecodeThread + FrameConverter：原尺寸 / 1/2 / 1/4 / 任意缩放）
+ * - NV12 输出路径（KMS overlay 使用）
+ * - RHI 着色器路径（RhiVideoView 离屏渲染后回读）
+ * - 取值范围：内存中的 YUV420P（有限 / 全范围）与 YUVJ420P 帧直接经过转换内核，
+ *   除 golden 外原尺寸输出还与 BT.601 浮点参考逐像素比较，范围处理错误不依赖 golden 也会失败
+ *
+ * 每帧记录 PTS 与校验值，与已保存的 golden 文件比较：
+ * - 逐位一致的路径使用 CRC32
+ * - GPU 路径与 sws 任意缩放使用 8x8 分块均值签名，按容差比较
+ *
+ * 与 FFmpeg 版本无关的结果（rawvideo 经专用内核 / 直接复制）总是比较；
+ * 经 sws_scale、有损解码或 GPU 的结果只与同一 FFmpeg 版本记录的 golden 比较。
+ *
+ * 用法：
+ *   LoopVideoPlayer --conformance conformance/goldens.json            # 比较
+ *   LoopVideoPlayer --conformance conformance/goldens.json --conformance-update   # 重新生成
+ */
+
+#ifndef CONFORMANCE_H
+#define CONFORMANCE_H
+
+#include <QString>
+
+namespace Conformance {
+
+/**
+ * @brief 运行一致性检查
+ * @param goldenPath golden 文件路径（JSON）
+ * @param update true 时把本次结果写入 golden 文件而不比较
+ * @return 进程退出码：0 表示全部一致
+ */
+int run(const QString &goldenPath, bool update);
+
+} // namespace Conformance
+
+#endif // CONFORMANCE_H
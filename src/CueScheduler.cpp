@@ -0,0 +1,69 @@
+/**
+ * @file CueScheduler.cpp
+ * @brief 排期切换的截止时间管理实现
+ */
+
+#include "CueScheduler.h"
+
+#include <QDeadlineTimer>
+#include <QDebug>
+
+CueScheduler::CueScheduler(QObject *parent)
+    : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &CueScheduler::arm);
+}
+
+qint64 CueScheduler::nowNs()
+{
+    return QDeadlineTimer::current(Qt::PreciseTimer).deadlineNSecs();
+}
+
+void CueScheduler::schedule(const QString &file, const QDateTime &at, bool atLoopBoundary)
+{
+    cancel();
+    m_file = file;
+    m_at = at;
+    m_atLoopBoundary = atLoopBoundary;
+    m_pending = true;
+    qDebug().noquote() << "[排期] 切换到" << file << "于" << at.toString(Qt::ISODateWithMs)
+                       << (atLoopBoundary ? "（循环边界）" : "");
+    arm();
+}
+
+void CueScheduler::cancel()
+{
+    m_timer.stop();
+    m_pending = false;
+    m_due = false;
+    m_file.clear();
+}
+
+double CueScheduler::lateMs() const
+{
+    return (nowNs() - m_deadlineNs) / 1e6;
+}
+
+void CueScheduler::arm()
+{
+    if (!m_pending || m_due) return;
+
+    // 每次都按墙钟重新换算，墙钟的毫秒精度相对帧间隔足够
+    const qint64 remainingMs = QDateTime::currentDateTimeUtc().msecsTo(m_at.toUTC());
+    m_deadlineNs = nowNs() + remainingMs * 1000000LL;
+
+    if (remainingMs > REARM_LEAD_MS) {
+        m_timer.start(static_cast<int>(qMin<qint64>(remainingMs - REARM_LEAD_MS, INT_MAX)));
+        return;
+    }
+    if (remainingMs > 0) {
+        // 精确定时器可能提前约 1ms 触发，到时再检查一次
+        m_timer.start(static_cast<int>(remainingMs));
+        return;
+    }
+
+    m_due = true;
+    emit due();
+}
@@ -0,0 +1,84 @@
+/**
+ * @file CueScheduler.h
+ * @brief 排期切换的截止时间管理（墙钟时刻 → 单调时钟截止时间）
+ *
+ * 信息屏按整点等墙钟时刻切换内容、多屏同时切换（各屏墙钟由 NTP 对齐）。
+ * 截止时间换算到单调时钟后用精确定时器等待；距截止时间较远时先定到提前量处，
+ * 再按墙钟重新换算一次，吸收这段时间内 NTP 对墙钟的调整。
+ *
+ * 只负责计时，切换动作由渲染器在 due() 后执行；所有方法在 GUI 线程调用。
+ */
+
+#ifndef CUESCHEDULER_H
+#define CUESCHEDULER_H
+
+#include <QDateTime>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+class CueScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CueScheduler(QObject *parent = nullptr);
+
+    /**
+     * @brief 排期（替换尚未执行的排期）
+     * @param at 切换的墙钟时刻，已过去时立即到期
+     * @param atLoopBoundary 到期后等当前循环播完、在接缝处切换
+     */
+    void schedule(const QString &file, const QDateTime &at, bool atLoopBoundary);
+
+    /**
+     * @brief 取消排期
+     */
+    void cancel();
+
+    /**
+     * @brief 切换已完成，清除排期
+     */
+    void finish() { cancel(); }
+
+    bool isPending() const { return m_pending; }
+    bool isDue() const { return m_due; }
+    const QString &file() const { return m_file; }
+    bool atLoopBoundary() const { return m_atLoopBoundary; }
+
+    /**
+     * @brief 截止时间（单调时钟纳秒，与 QDeadlineTimer::current(Qt::PreciseTimer) 同一时基）
+     */
+    qint64 deadlineNs() const { return m_deadlineNs; }
+
+    /**
+     * @brief 当前相对截止时间的偏差（毫秒，正值表示已过截止时间）
+     */
+    double lateMs() const;
+
+    /**
+     * @brief 当前单调时钟（纳秒）
+     */
+    static qint64 nowNs();
+
+signals:
+    /**
+     * @brief 到达截止时间（每次排期只触发一次）
+     */
+    void due();
+
+private:
+    void arm();
+
+    static constexpr qint64 REARM_LEAD_MS = 1000;   ///< 距截止时间超过此值时先等到提前量处重新换算
+
+    QTimer m_timer;
+    QString m_file;
+    QDateTime m_at;
+    qint64 m_deadlineNs = 0;
+    bool m_atLoopBoundary = false;
+    bool m_pending = false;
+    bool m_due = false;
+};
+
+#endif // CUESCHEDULER_H
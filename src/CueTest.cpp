@@ -0,0 +1,188 @@
+/**
+ * @file CueTest.cpp
+ * @brief 排期切换精度测试实现
+ */
+
+#include "CueTest.h"
+#include "CueScheduler.h"
+#include "SyntheticClip.h"
+#include "VideoRendererBase.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QEventLoop>
+#include <QFileInfo>
+#include <QGuiApplication>
+#include <QList>
+#include <QScreen>
+#include <QTemporaryDir>
+#include <QTimer>
+#include <cstring>
+#include <memory>
+
+#if FFMPEG_AVAILABLE
+
+namespace {
+
+static constexpr int SWITCH_INTERVAL_MS = 1500;     // 相邻两次切换的间隔（预加载在此期间完成）
+static constexpr double EARLY_TOLERANCE_MS = 1.0;   // 墙钟毫秒精度带来的提前量
+static constexpr double LATE_MARGIN_MS = 2.0;       // 刷新周期之外的余量
+static constexpr int FOLLOW_FRAMES = 12;            // 切换后继续检查的帧数（24fps 下 0.5 秒）
+static constexpr double FOLLOW_EARLY_MS = 6.0;      // 呈现定时器提前 5ms 取帧，另加 1ms 墙钟精度
+static constexpr int CLIP_COUNT = 3;
+static constexpr int TS_START_FRAME = 48;           // MPEG-TS 片段的首帧 pts（2 秒，容器 start_time 不为 0）
+
+SyntheticClipSpec clipSpec(const char *name, int width, int height)
+{
+    SyntheticClipSpec spec;
+    spec.name = name;
+    spec.width = width;
+    spec.height = height;
+    spec.frames = 48;
+    spec.fps = 24;
+    spec.codec = AV_CODEC_ID_MPEG4;
+    return spec;
+}
+
+} // namespace
+
+int CueTest::run(int switches)
+{
+    if (switches <= 0) {
+        qCritical() << "切换次数无效:" << switches;
+        return 1;
+    }
+
+    QTemporaryDir clipDir;
+    // 第三个片段为起点不为 0 的 MPEG-TS：预卷帧与后续帧须在同一条减去 start_time 的时间轴上
+    SyntheticClipSpec specs[CLIP_COUNT] = {
+        clipSpec("cue_a", 320, 180),
+        clipSpec("cue_b", 384, 216),
+        clipSpec("cue_ts", 320, 180),
+    };
+    specs[2].container = "mpegts";
+    specs[2].startFrame = TS_START_FRAME;
+    QString paths[CLIP_COUNT];
+    for (int i = 0; i < CLIP_COUNT; i++) {
+        const char *extension = std::strcmp(specs[i].container, "mpegts") == 0 ? ".ts" : ".nut";
+        paths[i] = clipDir.filePath(QString::fromLatin1(specs[i].name) + QLatin1String(extension));
+        if (!clipDir.isValid() || !SyntheticClip::write(specs[i], paths[i])) {
+            qCritical() << "生成排期测试片段失败";
+            return 1;
+        }
+    }
+
+    QScreen *screen = QGuiApplication::primaryScreen();
+    const double refreshRate = (screen && screen->refreshRate() > 1) ? screen->refreshRate() : 60.0;
+    const double limitMs = 1000.0 / refreshRate + LATE_MARGIN_MS;
+
+    std::unique_ptr<VideoRendererBase> renderer(createVideoRenderer(nullptr));
+    renderer->resize(640, 360);
+    renderer->show();
+    renderer->loadFile(paths[0]);
+    qDebug() << "排期切换测试:" << renderer->rendererName() << "刷新率" << refreshRate << "Hz，上限" << limitMs << "ms";
+
+    QEventLoop loop;
+    QList<double> errors;
+    QList<double> followErrors;     // 切换后各帧相对「截止时间 + PTS 差」的偏差
+    int followFailures = 0;
+    qint64 deadlineNs = 0;
+    qint64 switchDeadlineNs = 0;    // 上一次已发生切换的截止时间（下一次排期会覆盖 deadlineNs）
+    double basePosition = -1;       // 预卷帧的位置，-1 表示尚未取得
+    int followRemaining = 0;
+    int next = 1;
+
+    auto scheduleNext = [&]() {
+        const QDateTime at = QDateTime::currentDateTimeUtc().addMSecs(SWITCH_INTERVAL_MS);
+        deadlineNs = CueScheduler::nowNs() + qint64(SWITCH_INTERVAL_MS) * 1000000;
+        renderer->scheduleSwitch(paths[next], at);
+        next = (next + 1) % CLIP_COUNT;
+    };
+
+    QObject::connect(renderer.get(), &VideoRendererBase::cueSwitched, &loop,
+                     [&](const QString &file, double lateMs) {
+        // 独立于渲染器自身的测量：以排期时刻的单调时钟推算截止时间
+        const double errorMs = (CueScheduler::nowNs() - deadlineNs) / 1e6;
+        errors.append(errorMs);
+        qDebug().noquote() << QString("[切换 %1] %2 偏差 %3 ms（渲染器报告 %4 ms）")
+                                  .arg(errors.size()).arg(QFileInfo(file).fileName())
+                                  .arg(errorMs, 0, 'f', 2).arg(lateMs, 0, 'f', 2);
+        switchDeadlineNs = deadlineNs;
+        basePosition = -1;
+        followRemaining = FOLLOW_FRAMES;
+    });
+
+    // 切换后的帧：新时间轴应锚定在截止时间，第 n 帧在「截止时间 + 与预卷帧的 PTS 差」时上屏，预卷帧不重复显示
+    QObject::connect(renderer.get(), &VideoRendererBase::positionChanged, &loop, [&](double position) {
+        if (followRemaining <= 0) return;
+        if (basePosition < 0) {
+            basePosition = position;    // 接管时报告的预卷帧位置
+            return;
+        }
+        if (position <= basePosition) {
+            qWarning() << "[失败] 切换" << errors.size() << "后预卷帧重复显示，位置" << position;
+            followFailures++;
+        } else {
+            const double expectedNs = switchDeadlineNs + (position - basePosition) * 1e9;
+            const double errorMs = (CueScheduler::nowNs() - expectedNs) / 1e6;
+            followErrors.append(errorMs);
+            if (errorMs < -FOLLOW_EARLY_MS || errorMs > limitMs) {
+                qWarning() << "[失败] 切换" << errors.size() << "后位置" << position << "偏差" << errorMs << "ms 超出范围";
+                followFailures++;
+            }
+        }
+        if (--followRemaining > 0) return;
+        if (errors.size() >= switches) {
+            loop.quit();
+        } else {
+            scheduleNext();
+        }
+    });
+
+    // 超时保护：切换未发生时不无限等待
+    QTimer::singleShot((switches + 2) * SWITCH_INTERVAL_MS * 2, &loop, &QEventLoop::quit);
+    QTimer::singleShot(SWITCH_INTERVAL_MS, &loop, scheduleNext);
+    loop.exec();
+
+    int failures = switches - static_cast<int>(errors.size());
+    if (failures > 0) {
+        qWarning() << "[失败]" << failures << "次切换未发生";
+    }
+    double sum = 0;
+    double worst = 0;
+    for (double errorMs : errors) {
+        sum += errorMs;
+        worst = qMax(worst, errorMs);
+        if (errorMs < -EARLY_TOLERANCE_MS || errorMs > limitMs) {
+            qWarning() << "[失败] 切换偏差" << errorMs << "ms 超出范围";
+            failures++;
+        }
+    }
+    if (!errors.isEmpty()) {
+        qDebug() << "排期切换完成:" << errors.size() << "次，平均偏差" << sum / errors.size()
+                 << "ms，最大" << worst << "ms";
+    }
+    if (!followErrors.isEmpty()) {
+        double followSum = 0;
+        double followWorst = 0;
+        for (double errorMs : followErrors) {
+            followSum += errorMs;
+            followWorst = qMax(followWorst, qAbs(errorMs));
+        }
+        qDebug() << "切换后续帧:" << followErrors.size() << "帧，平均偏差" << followSum / followErrors.size()
+                 << "ms，最大" << followWorst << "ms";
+    }
+    failures += followFailures;
+    return failures ? 1 : 0;
+}
+
+#else
+
+int CueTest::run(int switches)
+{
+    Q_UNUSED(switches)
+    qCritical("此版本未启用 FFmpeg，无法运行排期切换测试");
+    return 1;
+}
+
+#endif
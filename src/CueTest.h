@@ -0,0 +1,29 @@
+/**
+ * @file CueTest.h
+ * @brief 排期切换精度测试
+ *
+ * 生成三个参考片段（其中一个为起点不为 0 的 MPEG-TS），用当前平台的渲染器轮流排期切换，
+ * 以单调时钟测量新画面上屏时刻相对截止时间的偏差：
+ * - 任一次切换未发生、提前切换或迟于一个刷新周期（另加 2ms 余量）即失败
+ * - 切换后继续检查 12 帧：以截止时间加与预卷帧的 PTS 差为期望时刻，偏差超出范围或预卷帧重复显示即失败
+ * - 输出每次偏差与均值 / 最大值
+ *
+ * 用法：
+ *   LoopVideoPlayer --cue-test 20
+ */
+
+#ifndef CUETEST_H
+#define CUETEST_H
+
+namespace CueTest {
+
+/**
+ * @brief 运行排期切换测试
+ * @param switches 切换次数
+ * @return 进程退出码：0 表示全部切换都在一个刷新周期内完成
+ */
+int run(int switches);
+
+} // namespace CueTest
+
+#endif // CUETEST_H
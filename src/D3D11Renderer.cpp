@@ -1,10 +1,22 @@
 #include "D3D11Renderer.h"
+#include "MediaProbe.h"
+#include "PipelineWatchdog.h"
+#include "StartupTimeline.h"
 #include <QDebug>
 #include <QResizeEvent>
 #include <QPainter>
 #include <QDateTime>
+#include <QDeadlineTimer>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
 #include <d3dcompiler.h>
 #include <d3d10.h>  // ID3D10Multithread
+#include <cmath>
+#include <cstring>
+#include <limits>
 #include <vector>
 
 #pragma comment(lib, "d3d11.lib")
@@ -81,6 +93,87 @@ struct Vertex {
     float u, v;
 };
 
+#ifdef _WIN32
+/**
+ * @brief 编译 HLSL，字节码按 (源码, profile, 编译器版本) 缓存到磁盘
+ *
+ * 冷启动时 D3DCompile 三个着色器约需数十毫秒；命中缓存只需读文件。
+ * @param fromCache 输出：字节码是否来自缓存
+ * @param readCache false 时删除已有缓存项，从源码重新编译并重写缓存
+ */
+static HRESULT compileShaderCached(const char *source, const char *target,
+                                   ID3DBlob **blob, ID3DBlob **errorBlob,
+                                   bool *fromCache, bool readCache = true)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArrayView(source));
+    hash.addData(QByteArrayView(target));
+    hash.addData(QByteArray::number(D3D_COMPILER_VERSION));
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+                      + QStringLiteral("/shaders");
+    const QString path = dir + QLatin1Char('/') + QString::fromLatin1(hash.result().toHex()) + QStringLiteral(".cso");
+
+    *fromCache = false;
+    QFile cached(path);
+    if (!readCache) {
+        QFile::remove(path);
+    } else if (cached.open(QIODevice::ReadOnly)) {
+        const QByteArray bytecode = cached.readAll();
+        if (!bytecode.isEmpty() && SUCCEEDED(D3DCreateBlob(bytecode.size(), blob))) {
+            memcpy((*blob)->GetBufferPointer(), bytecode.constData(), bytecode.size());
+            *fromCache = true;
+            return S_OK;
+        }
+    }
+
+    HRESULT hr = D3DCompile(source, strlen(source), nullptr, nullptr, nullptr,
+                            "main", target, 0, 0, blob, errorBlob);
+    if (FAILED(hr)) return hr;
+
+    // 写缓存失败不影响本次使用
+    QDir().mkpath(dir);
+    QSaveFile out(path);
+    if (out.open(QIODevice::WriteOnly)) {
+        out.write(static_cast<const char*>((*blob)->GetBufferPointer()),
+                  static_cast<qint64>((*blob)->GetBufferSize()));
+        if (!out.commit()) {
+            qWarning() << "着色器缓存写入失败:" << path;
+        }
+    }
+    return hr;
+}
+
+/**
+ * @brief 取字节码并创建着色器
+ *
+ * 缓存文件截断或损坏时 Create*Shader 会拒绝字节码：删除该缓存项，从源码重新编译后再创建一次。
+ * @param create 用字节码创建着色器（及依赖字节码的对象，如输入布局）
+ */
+template <typename Create>
+static HRESULT createShaderCached(const char *source, const char *target, const char *label,
+                                  ComPtr<ID3DBlob> &blob, Create create)
+{
+    ComPtr<ID3DBlob> errorBlob;
+    bool fromCache = false;
+    HRESULT hr = compileShaderCached(source, target, &blob, &errorBlob, &fromCache);
+    if (SUCCEEDED(hr)) {
+        hr = create(blob.Get());
+        if (FAILED(hr) && fromCache) {
+            qWarning() << "着色器缓存无效，重新编译:" << label;
+            blob.Reset();
+            hr = compileShaderCached(source, target, &blob, &errorBlob, &fromCache, false);
+            if (SUCCEEDED(hr)) {
+                hr = create(blob.Get());
+            }
+        }
+    }
+    if (FAILED(hr) && errorBlob) {
+        qCritical() << label << "compile error:" << (char*)errorBlob->GetBufferPointer();
+    }
+    return hr;
+}
+#endif
+
 D3D11Renderer::D3D11Renderer(QWidget *parent)
     : VideoRendererBase(parent)
 {
@@ -104,6 +197,10 @@ D3D11Renderer::D3D11Renderer(QWidget *parent)
     m_audioTimer = new QTimer(this);
     m_audioTimer->setTimerType(Qt::PreciseTimer);
     connect(m_audioTimer, &QTimer::timeout, this, &D3D11Renderer::onAudioTimer);
+    
+    // 停滞看门狗：呈现停住时逐级恢复（动作在 GUI 线程执行）
+    m_watchdog = new PipelineWatchdog(m_metrics, this);
+    m_watchdog->setRecoveryHandler([this](RecoveryAction action) { return runRecovery(action); });
 }
 
 D3D11Renderer::~D3D11Renderer()
@@ -172,6 +269,7 @@ bool D3D11Renderer::initD3D11()
     }
     
     m_d3dInitialized = true;
+    StartupTimeline::mark("d3d11 initialize");
     return true;
 #else
     return false;
@@ -232,62 +330,38 @@ bool D3D11Renderer::createShaders()
 {
 #ifdef _WIN32
     HRESULT hr;
-    ComPtr<ID3DBlob> vsBlob, psBlob, errorBlob;
+    ComPtr<ID3DBlob> vsBlob, psBlob;
     
-    // 编译顶点着色器
-    hr = D3DCompile(g_vertexShader, strlen(g_vertexShader), nullptr, nullptr, nullptr,
-                    "main", "vs_5_0", 0, 0, &vsBlob, &errorBlob);
-    if (FAILED(hr)) {
-        if (errorBlob) {
-            qCritical() << "VS compile error:" << (char*)errorBlob->GetBufferPointer();
-        }
-        return false;
-    }
-    
-    hr = m_device->CreateVertexShader(vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(),
-                                       nullptr, &m_vertexShader);
-    if (FAILED(hr)) return false;
-    
-    // 创建输入布局
+    // 顶点着色器与输入布局（输入布局按字节码中的签名校验，同样可能因缓存损坏失败）
     D3D11_INPUT_ELEMENT_DESC inputDesc[] = {
         {"POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0},
         {"TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0},
     };
-    hr = m_device->CreateInputLayout(inputDesc, 2, vsBlob->GetBufferPointer(),
-                                      vsBlob->GetBufferSize(), &m_inputLayout);
+    hr = createShaderCached(g_vertexShader, "vs_5_0", "VS", vsBlob, [&](ID3DBlob *blob) {
+        HRESULT result = m_device->CreateVertexShader(blob->GetBufferPointer(), blob->GetBufferSize(),
+                                                      nullptr, &m_vertexShader);
+        if (FAILED(result)) return result;
+        return m_device->CreateInputLayout(inputDesc, 2, blob->GetBufferPointer(),
+                                           blob->GetBufferSize(), &m_inputLayout);
+    });
     if (FAILED(hr)) return false;
     
-    // 编译 NV12 像素着色器
-    hr = D3DCompile(g_pixelShaderNV12, strlen(g_pixelShaderNV12), nullptr, nullptr, nullptr,
-                    "main", "ps_5_0", 0, 0, &psBlob, &errorBlob);
-    if (FAILED(hr)) {
-        if (errorBlob) {
-            qCritical() << "PS NV12 compile error:" << (char*)errorBlob->GetBufferPointer();
-        }
-        return false;
-    }
-    
-    hr = m_device->CreatePixelShader(psBlob->GetBufferPointer(), psBlob->GetBufferSize(),
-                                      nullptr, &m_pixelShader);
+    // NV12 像素着色器
+    hr = createShaderCached(g_pixelShaderNV12, "ps_5_0", "PS NV12", psBlob, [&](ID3DBlob *blob) {
+        return m_device->CreatePixelShader(blob->GetBufferPointer(), blob->GetBufferSize(),
+                                           nullptr, &m_pixelShader);
+    });
     if (FAILED(hr)) return false;
     
-    // 编译 BGRA 像素着色器（软件解码用）
+    // BGRA 像素着色器（软件解码用）
     psBlob.Reset();
-    errorBlob.Reset();
-    hr = D3DCompile(g_pixelShaderBGRA, strlen(g_pixelShaderBGRA), nullptr, nullptr, nullptr,
-                    "main", "ps_5_0", 0, 0, &psBlob, &errorBlob);
-    if (FAILED(hr)) {
-        if (errorBlob) {
-            qCritical() << "PS BGRA compile error:" << (char*)errorBlob->GetBufferPointer();
-        }
-        return false;
-    }
-    
-    hr = m_device->CreatePixelShader(psBlob->GetBufferPointer(), psBlob->GetBufferSize(),
-                                      nullptr, &m_pixelShaderBGRA);
+    hr = createShaderCached(g_pixelShaderBGRA, "ps_5_0", "PS BGRA", psBlob, [&](ID3DBlob *blob) {
+        return m_device->CreatePixelShader(blob->GetBufferPointer(), blob->GetBufferSize(),
+                                           nullptr, &m_pixelShaderBGRA);
+    });
     if (FAILED(hr)) return false;
     
-    // 创建顶点缓冲（全屏四边形）
+    // 创建顶点缓冲（全屏四边形，绘制前按几何变换与黑边重写）
     Vertex vertices[] = {
         {-1.0f,  1.0f, 0.0f, 0.0f, 0.0f},  // 左上
         { 1.0f,  1.0f, 0.0f, 1.0f, 0.0f},  // 右上
@@ -297,14 +371,16 @@ bool D3D11Renderer::createShaders()
     
     D3D11_BUFFER_DESC bufferDesc = {};
     bufferDesc.ByteWidth = sizeof(vertices);
-    bufferDesc.Usage = D3D11_USAGE_DEFAULT;
+    bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
     bufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+    bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
     
     D3D11_SUBRESOURCE_DATA initData = {};
     initData.pSysMem = vertices;
     
     hr = m_device->CreateBuffer(&bufferDesc, &initData, &m_vertexBuffer);
     if (FAILED(hr)) return false;
+    m_quadValid = false;
     
     qDebug() << "D3D11 shaders created successfully";
     return true;
@@ -375,17 +451,24 @@ bool D3D11Renderer::openFile(const QString &filename)
 {
 #if FFMPEG_AVAILABLE
     closeFile();
-    
-    m_formatCtx = avformat_alloc_context();
-    if (avformat_open_input(&m_formatCtx, filename.toUtf8().constData(), nullptr, nullptr) != 0) {
-        emit errorOccurred("无法打开文件: " + filename);
-        return false;
+    if (filename != m_currentFile) {
+        m_hardwareAllowed = true;   // 看门狗的软件回退只对出问题的文件生效
     }
     
-    if (avformat_find_stream_info(m_formatCtx, nullptr) < 0) {
-        emit errorOccurred("无法获取流信息");
-        closeFile();
-        return false;
+    // 优先使用启动时后台预探测的结果（与窗口、D3D11 初始化并行完成）
+    m_formatCtx = MediaProbe::take(filename);
+    if (!m_formatCtx) {
+        m_formatCtx = avformat_alloc_context();
+        if (avformat_open_input(&m_formatCtx, filename.toUtf8().constData(), nullptr, nullptr) != 0) {
+            emit errorOccurred("无法打开文件: " + filename);
+            return false;
+        }
+        
+        if (avformat_find_stream_info(m_formatCtx, nullptr) < 0) {
+            emit errorOccurred("无法获取流信息");
+            closeFile();
+            return false;
+        }
     }
     
     if (m_formatCtx->duration != AV_NOPTS_VALUE) {
@@ -413,37 +496,32 @@ bool D3D11Renderer::openFile(const QString &filename)
             return false;
         }
         
-        m_videoCodecCtx = avcodec_alloc_context3(codec);
-        avcodec_parameters_to_context(m_videoCodecCtx, codecpar);
+        const AVStream *videoStream = m_formatCtx->streams[m_videoStreamIndex];
+        const AVRational frameRate = videoStream->avg_frame_rate.num > 0 ? videoStream->avg_frame_rate
+                                                                         : videoStream->r_frame_rate;
+        m_sourceFps = frameRate.num > 0 && frameRate.den > 0 ? av_q2d(frameRate) : 0;
+        m_skipNonRef = true;
+        m_presentRestart = true;
         
-        // 根据解码模式初始化
-        if (m_decodeMode == Software) {
-            qDebug() << "强制使用软件解码";
-        } else {
-            // Auto 或 Hardware 模式，尝试硬件解码
-            if (!initHardwareDecoder(codec)) {
-                if (m_decodeMode == Hardware) {
-                    emit errorOccurred("硬件解码初始化失败，且设置为强制硬件模式");
-                    closeFile();
-                    return false;
-                }
-                qWarning() << "D3D11VA 硬件解码初始化失败，回退到软件解码";
-            }
-        }
-        
-        // 软件解码时创建颜色转换上下文
-        if (!m_hwDeviceCtx) {
-            // 将在解码时根据实际格式创建 SwsContext
-        }
-        
-        if (avcodec_open2(m_videoCodecCtx, codec, nullptr) < 0) {
-            emit errorOccurred("无法打开视频解码器");
+        QString error;
+        if (!openVideoDecoder(codec, codecpar, error)) {
+            emit errorOccurred(error);
             closeFile();
             return false;
         }
         
         m_videoWidth = m_videoCodecCtx->width;
         m_videoHeight = m_videoCodecCtx->height;
+        
+        // 手机拍摄的片段带显示矩阵旋转
+        const AVPacketSideData *displayMatrix = av_packet_side_data_get(
+            codecpar->coded_side_data, codecpar->nb_coded_side_data, AV_PKT_DATA_DISPLAYMATRIX);
+        m_streamRotation = displayMatrix
+            ? VideoGeometry::rotationFromDisplayMatrix(reinterpret_cast<const int32_t *>(displayMatrix->data)) : 0;
+        if (m_streamRotation != 0) {
+            qDebug() << "流旋转:" << m_streamRotation << "度";
+        }
+        m_quadValid = false;
     }
     
     // 初始化音频解码器
@@ -476,7 +554,10 @@ bool D3D11Renderer::openFile(const QString &filename)
     qDebug() << "========================================";
     
     m_currentFile = filename;
+    m_firstFramePending = true;
+    m_metrics.setHardwareDecoding(m_hwDeviceCtx != nullptr);
     emit fileLoaded();
+    StartupTimeline::mark("decoder open");
     return true;
 #else
     emit errorOccurred("FFmpeg 未配置");
@@ -484,6 +565,77 @@ bool D3D11Renderer::openFile(const QString &filename)
 #endif
 }
 
+#if FFMPEG_AVAILABLE
+/**
+ * @brief 创建并打开视频解码器（openFile 与看门狗重建解码器共用）
+ * @param error 失败时的错误信息
+ */
+bool D3D11Renderer::openVideoDecoder(const AVCodec *codec, const AVCodecParameters *codecpar, QString &error)
+{
+    m_videoCodecCtx = avcodec_alloc_context3(codec);
+    avcodec_parameters_to_context(m_videoCodecCtx, codecpar);
+    
+    // 根据解码模式初始化（软件解码的颜色转换在解码时按实际格式创建）
+    if (m_decodeMode == Software) {
+        qDebug() << "强制使用软件解码";
+    } else if (!m_hardwareAllowed) {
+        qDebug() << "看门狗已回退软件解码";
+    } else if (!initHardwareDecoder(codec)) {
+        // Auto 或 Hardware 模式，尝试硬件解码
+        if (m_decodeMode == Hardware) {
+            error = "硬件解码初始化失败，且设置为强制硬件模式";
+            return false;
+        }
+        qWarning() << "D3D11VA 硬件解码初始化失败，回退到软件解码";
+    }
+    
+    m_bufferPools.install(m_videoCodecCtx);
+    
+    if (avcodec_open2(m_videoCodecCtx, codec, nullptr) < 0) {
+        error = "无法打开视频解码器";
+        return false;
+    }
+    return true;
+}
+#endif
+
+/**
+ * @brief 看门狗恢复：停止三线程，释放并重新打开视频解码器，从当前位置重新播放
+ *
+ * 容器与音频解码器保留。停止线程最多等待 1 秒：解码调用本身卡死（驱动不返回）时
+ * 线程无法被强制结束，这一级同样无法恢复。
+ */
+bool D3D11Renderer::reopenVideoDecoder()
+{
+#if FFMPEG_AVAILABLE
+    if (!m_formatCtx || m_videoStreamIndex < 0) return false;
+    
+    const double position = m_currentPts;
+    stop();
+    m_shownFrame = VideoFrame();
+    m_frameConverter.reset();
+    m_frameParams = FrameParams();
+    avcodec_free_context(&m_videoCodecCtx);
+    av_buffer_unref(&m_hwDeviceCtx);
+    
+    const AVCodecParameters *codecpar = m_formatCtx->streams[m_videoStreamIndex]->codecpar;
+    QString error;
+    const bool opened = openVideoDecoder(avcodec_find_decoder(codecpar->codec_id), codecpar, error);
+    m_metrics.setHardwareDecoding(opened && m_hwDeviceCtx);
+    if (!opened) {
+        qWarning() << "[看门狗] 重建解码器失败:" << error;
+        return false;
+    }
+    
+    m_presentRestart = true;
+    play();
+    seek(position);
+    return true;
+#else
+    return false;
+#endif
+}
+
 bool D3D11Renderer::initHardwareDecoder(const AVCodec *codec)
 {
 #if FFMPEG_AVAILABLE && defined(_WIN32)
@@ -534,9 +686,7 @@ void D3D11Renderer::closeFile()
 #if FFMPEG_AVAILABLE
     // 停止所有线程
     m_running = false;
-    m_frameCondition.wakeAll();
-    m_videoPacketCondition.wakeAll();
-    m_audioPacketCondition.wakeAll();
+    wakeStages();
     
     // 等待线程结束
     if (m_demuxThread && m_demuxThread->isRunning()) {
@@ -562,18 +712,25 @@ void D3D11Renderer::closeFile()
         QMutexLocker locker(&m_frameMutex);
         m_frameQueue.clear();
     }
+    m_shownFrame = VideoFrame();
     {
         QMutexLocker locker(&m_videoPacketMutex);
         while (!m_videoPacketQueue.isEmpty()) {
             AVPacket *pkt = m_videoPacketQueue.dequeue();
-            if (pkt) av_packet_free(&pkt);
+            if (pkt) {
+                m_metrics.memory().release(MemoryCategory::PacketQueue, pkt->size);
+                av_packet_free(&pkt);
+            }
         }
     }
     {
         QMutexLocker locker(&m_audioPacketMutex);
         while (!m_audioPacketQueue.isEmpty()) {
             AVPacket *pkt = m_audioPacketQueue.dequeue();
-            if (pkt) av_packet_free(&pkt);
+            if (pkt) {
+                m_metrics.memory().release(MemoryCategory::PacketQueue, pkt->size);
+                av_packet_free(&pkt);
+            }
         }
     }
     {
@@ -586,10 +743,8 @@ void D3D11Renderer::closeFile()
         m_swrCtx = nullptr;
     }
     
-    if (m_swsCtx) {
-        sws_freeContext(m_swsCtx);
-        m_swsCtx = nullptr;
-    }
+    m_frameConverter.reset();
+    m_frameParams = FrameParams();
     
     if (m_videoCodecCtx) {
         avcodec_free_context(&m_videoCodecCtx);
@@ -605,6 +760,7 @@ void D3D11Renderer::closeFile()
         av_buffer_unref(&m_hwDeviceCtx);
         m_hwDeviceCtx = nullptr;
     }
+    m_metrics.setHardwareDecoding(false);
     
     if (m_formatCtx) {
         avformat_close_input(&m_formatCtx);
@@ -617,23 +773,15 @@ void D3D11Renderer::closeFile()
     m_duration = 0;
     m_videoWidth = 0;
     m_videoHeight = 0;
+    m_streamRotation = 0;
 #endif
 }
 
-void D3D11Renderer::loadFile(const QString &filename)
-{
-    stop();
-    if (openFile(filename)) {
-        play();
-    }
-}
-
 void D3D11Renderer::play()
 {
     if (m_playing && !m_paused) return;
     
     if (!m_playing) {
-        setupAudio();
         m_loopStartMs = QDateTime::currentMSecsSinceEpoch();
         m_holdAudioAfterLoop = false; // 首次播放不阻塞音频
         
@@ -673,6 +821,11 @@ void D3D11Renderer::play()
         qDebug() << "  - 音频解码线程: FFmpeg 软解码";
         qDebug() << "========================================";
 #endif
+        // 音频设备在解码线程启动后再打开，设备初始化与首批解码并行
+        if (m_hasAudio) {
+            setupAudio();
+            StartupTimeline::mark("audio ready");
+        }
     }
     
     m_playing = true;
@@ -686,6 +839,7 @@ void D3D11Renderer::play()
     m_avSyncOffset = 0;
     m_audioClock = 0;
     m_audioWrittenBytes = 0;
+    m_metrics.audio().reset();
     m_skipRenderCount = 0;
     m_frameTimer = 0;
     m_lastFramePts = 0;
@@ -694,6 +848,7 @@ void D3D11Renderer::play()
     
     m_renderTimer->start(8);  // ~120 fps 检查（实际帧率由 delay 控制）
     m_audioTimer->start(5);
+    armWatchdog();
     
     emit playbackStateChanged(true);
 }
@@ -703,8 +858,10 @@ void D3D11Renderer::pause()
     if (!m_playing) return;
     
     m_paused = true;
+    m_watchdog->disarm();
     m_renderTimer->stop();
     m_audioTimer->stop();
+    m_metrics.audio().reset();
     
     emit playbackStateChanged(false);
 }
@@ -721,12 +878,14 @@ void D3D11Renderer::stop()
     m_videoStartPts = 0;
     m_avSyncOffset = 0;
     m_audioWrittenBytes = 0;
+    m_metrics.audio().reset();
     m_skipRenderCount = 0;
     m_frameTimer = 0;
     m_lastFramePts = 0;
     m_lastDelay = 0.033;
     m_consecutiveFastRender = 0;
     
+    m_watchdog->disarm();
     m_renderTimer->stop();
     m_audioTimer->stop();
     
@@ -734,9 +893,7 @@ void D3D11Renderer::stop()
     m_running = false;
     
     // 唤醒所有等待的线程
-    m_frameCondition.wakeAll();
-    m_videoPacketCondition.wakeAll();
-    m_audioPacketCondition.wakeAll();
+    wakeStages();
     
     // 等待线程结束
     if (m_demuxThread && m_demuxThread->isRunning()) {
@@ -769,14 +926,20 @@ void D3D11Renderer::stop()
         QMutexLocker locker(&m_videoPacketMutex);
         while (!m_videoPacketQueue.isEmpty()) {
             AVPacket *pkt = m_videoPacketQueue.dequeue();
-            if (pkt) av_packet_free(&pkt);
+            if (pkt) {
+                m_metrics.memory().release(MemoryCategory::PacketQueue, pkt->size);
+                av_packet_free(&pkt);
+            }
         }
     }
     {
         QMutexLocker locker(&m_audioPacketMutex);
         while (!m_audioPacketQueue.isEmpty()) {
             AVPacket *pkt = m_audioPacketQueue.dequeue();
-            if (pkt) av_packet_free(&pkt);
+            if (pkt) {
+                m_metrics.memory().release(MemoryCategory::PacketQueue, pkt->size);
+                av_packet_free(&pkt);
+            }
         }
     }
     {
@@ -813,16 +976,21 @@ void D3D11Renderer::seek(double seconds)
     m_avSyncOffset = 0;
     m_audioClock = 0;
     m_audioWrittenBytes = 0;
+    m_metrics.audio().reset();
+    m_metrics.resetPresentation();
     m_skipRenderCount = 0;
     m_frameTimer = 0;
     m_lastFramePts = 0;
     m_lastDelay = 0.033;
     m_consecutiveFastRender = 0;
+    if (m_playing && !m_paused) {
+        armWatchdog();  // 播完后已停止监视的片段跳回时重新开始
+    } else {
+        m_watchdog->resetProgress();
+    }
     
     // 唤醒可能在等待的线程
-    m_videoPacketCondition.wakeAll();
-    m_audioPacketCondition.wakeAll();
-    m_frameCondition.wakeAll();
+    wakeStages();
     
 #if SDL3_AVAILABLE
     // 清空 SDL 音频队列
@@ -845,6 +1013,92 @@ void D3D11Renderer::setVolume(int volume)
     // SDL3: 音量在 processAudio() 中处理
 }
 
+// ========================================
+// 线程间唤醒
+// 各级队列的等待都不带超时：改变等待条件的一方负责唤醒
+// ========================================
+
+/**
+ * @brief 唤醒阻塞在各级队列上的线程
+ *
+ * m_running / m_seeking 在锁外修改，唤醒前先持有对应队列锁：
+ * 等待方要么已在 wait 中被唤醒，要么尚未检查条件、随后看到新值。
+ */
+void D3D11Renderer::wakeStages()
+{
+    {
+        QMutexLocker locker(&m_videoPacketMutex);
+        m_videoPacketCondition.wakeAll();
+    }
+    {
+        QMutexLocker locker(&m_audioPacketMutex);
+        m_audioPacketCondition.wakeAll();
+    }
+    {
+        QMutexLocker locker(&m_frameMutex);
+        m_frameCondition.wakeAll();
+    }
+    {
+        QMutexLocker locker(&m_audioMutex);
+        m_audioCondition.wakeAll();
+    }
+    notifyDrained();
+}
+
+/**
+ * @brief 某级队列变空（或停止）时通知循环边界的排空等待
+ *
+ * 可在持有任意队列锁时调用：m_drainMutex 总是最内层的锁。
+ */
+void D3D11Renderer::notifyDrained()
+{
+    QMutexLocker locker(&m_drainMutex);
+    ++m_drainSeq;
+    m_drainCondition.wakeAll();
+}
+
+/**
+ * @brief 等待 Packet、帧、音频队列全部排空
+ * @return 已排空返回 true；超时或停止返回 false
+ *
+ * 先记下通知序号再检查队列（检查时不持有 m_drainMutex），
+ * 检查之后发生的出队会改变序号，因此不会错过通知。
+ */
+bool D3D11Renderer::waitDrained()
+{
+#if FFMPEG_AVAILABLE
+    const QDeadlineTimer deadline(2000);
+    while (m_running) {
+        quint64 seq;
+        {
+            QMutexLocker locker(&m_drainMutex);
+            seq = m_drainSeq;
+        }
+        bool pktEmpty, frameEmpty, audioEmpty;
+        {
+            QMutexLocker l1(&m_videoPacketMutex);
+            QMutexLocker l2(&m_audioPacketMutex);
+            pktEmpty = m_videoPacketQueue.isEmpty() && m_audioPacketQueue.isEmpty();
+        }
+        {
+            QMutexLocker l3(&m_frameMutex);
+            frameEmpty = m_frameQueue.isEmpty();
+        }
+        {
+            QMutexLocker l4(&m_audioMutex);
+            audioEmpty = m_audioQueue.isEmpty();
+        }
+        if (pktEmpty && frameEmpty && audioEmpty) return true;
+
+        QMutexLocker locker(&m_drainMutex);
+        while (m_drainSeq == seq && m_running) {
+            if (!m_drainCondition.wait(&m_drainMutex, deadline)) return false;
+        }
+    }
+#endif
+    return false;
+}
+
 // ========================================
 // Demux 线程：读取 Packet 并分发到音视频队列
 // 不做任何解码，只负责 I/O 和分发
@@ -867,14 +1121,23 @@ void D3D11Renderer::demuxThread()
                 QMutexLocker locker(&m_videoPacketMutex);
                 while (!m_videoPacketQueue.isEmpty()) {
                     AVPacket *pkt = m_videoPacketQueue.dequeue();
-                    if (pkt) av_packet_free(&pkt);
+                    if (pkt) {
+                        m_metrics.memory().release(MemoryCategory::PacketQueue, pkt->size);
+                        av_packet_free(&pkt);
+                    }
+                }
+                if (m_flushVideo.exchange(false)) {
+                    m_videoPacketQueue.enqueue(nullptr);  // 空包：解码线程 flush 解码器并清空帧队列
                 }
             }
             {
                 QMutexLocker locker(&m_audioPacketMutex);
                 while (!m_audioPacketQueue.isEmpty()) {
                     AVPacket *pkt = m_audioPacketQueue.dequeue();
-                    if (pkt) av_packet_free(&pkt);
+                    if (pkt) {
+                        m_metrics.memory().release(MemoryCategory::PacketQueue, pkt->size);
+                        av_packet_free(&pkt);
+                    }
                 }
             }
             
@@ -911,28 +1174,8 @@ void D3D11Renderer::demuxThread()
             m_audioPacketCondition.wakeOne();
         }
 
-        qint64 waitStart = QDateTime::currentMSecsSinceEpoch();
-        while (m_running) {
-            bool pktEmpty, frameEmpty, audioEmpty;
-            {
-                QMutexLocker l1(&m_videoPacketMutex);
-                QMutexLocker l2(&m_audioPacketMutex);
-                pktEmpty = m_videoPacketQueue.isEmpty() && m_audioPacketQueue.isEmpty();
-            }
-            {
-                QMutexLocker l3(&m_frameMutex);
-                frameEmpty = m_frameQueue.isEmpty();
-            }
-            {
-                QMutexLocker l4(&m_audioMutex);
-                audioEmpty = m_audioQueue.isEmpty();
-            }
-            if (pktEmpty && frameEmpty && audioEmpty) break;
-            if (QDateTime::currentMSecsSinceEpoch() - waitStart > 2000) {
-                qDebug() << "[Loop] drain timeout, force restart";
-                break;
-            }
-            QThread::msleep(5);
+        if (!waitDrained() && m_running) {
+            qDebug() << "[Loop] drain timeout, force restart";
         }
 
         QMetaObject::invokeMethod(this, [this]() {
@@ -940,24 +1183,34 @@ void D3D11Renderer::demuxThread()
         }, Qt::QueuedConnection);
 
         // 重绕
+        m_metrics.addLoop();
         av_seek_frame(m_formatCtx, -1, 0, AVSEEK_FLAG_BACKWARD);
         continue;
                 }
+                QMetaObject::invokeMethod(this, [this]() {
+                    m_watchdog->disarm();   // 播完后呈现不再前进，不是停滞
+                }, Qt::QueuedConnection);
                 emit endOfFile();
             }
             break;
         }
         
+        if (packet->pts != AV_NOPTS_VALUE) {
+            m_metrics.markProgress(PipelineStage::Demux,
+                                   packet->pts * av_q2d(m_formatCtx->streams[packet->stream_index]->time_base));
+        }
+        
         // 分发到对应队列
         if (packet->stream_index == m_videoStreamIndex) {
             QMutexLocker locker(&m_videoPacketMutex);
             
             // 队列满时等待（不阻塞音频！）
             while (m_videoPacketQueue.size() >= MAX_VIDEO_PACKET_QUEUE && m_running && !m_seeking) {
-                m_videoPacketCondition.wait(&m_videoPacketMutex, 10);
+                m_videoPacketCondition.wait(&m_videoPacketMutex);
             }
             
             if (m_running && !m_seeking) {
+                m_metrics.memory().add(MemoryCategory::PacketQueue, packet->size);
                 m_videoPacketQueue.enqueue(packet);
                 m_videoPacketCondition.wakeOne();
             } else {
@@ -969,10 +1222,11 @@ void D3D11Renderer::demuxThread()
             
             // 队列满时等待（不阻塞视频！）
             while (m_audioPacketQueue.size() >= MAX_AUDIO_PACKET_QUEUE && m_running && !m_seeking) {
-                m_audioPacketCondition.wait(&m_audioPacketMutex, 10);
+                m_audioPacketCondition.wait(&m_audioPacketMutex);
             }
             
             if (m_running && !m_seeking) {
+                m_metrics.memory().add(MemoryCategory::PacketQueue, packet->size);
                 m_audioPacketQueue.enqueue(packet);
                 m_audioPacketCondition.wakeOne();
             } else {
@@ -1012,15 +1266,17 @@ void D3D11Renderer::videoDecodeThread()
             QMutexLocker locker(&m_videoPacketMutex);
             
             while (m_videoPacketQueue.isEmpty() && m_running) {
-                m_videoPacketCondition.wait(&m_videoPacketMutex, 50);
+                m_videoPacketCondition.wait(&m_videoPacketMutex);
             }
             
             if (!m_running) break;
             if (m_videoPacketQueue.isEmpty()) continue;
             
             packet = m_videoPacketQueue.dequeue();  // 取出指针，由此函数负责释放
+            if (packet) m_metrics.memory().release(MemoryCategory::PacketQueue, packet->size);
             
             m_videoPacketCondition.wakeOne();  // 通知 Demux 线程
+            if (m_videoPacketQueue.isEmpty()) notifyDrained();
         }
         
         // 空 Packet = flush 信号
@@ -1031,15 +1287,22 @@ void D3D11Renderer::videoDecodeThread()
             {
                 QMutexLocker locker(&m_frameMutex);
                 m_frameQueue.clear();
+                notifyDrained();
             }
             
             // 重置视频时钟
             m_videoClockValid = false;
             m_videoStartPts = 0;
+            m_presentRestart = true;
             continue;
         }
         
+        // 限制呈现帧率时不解码永远不会呈现的非参考帧
+        m_videoCodecCtx->skip_frame = presentStride() > 1 && m_skipNonRef ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+        
         // 解码
+        QElapsedTimer decodeTimer;
+        decodeTimer.start();
         int ret = avcodec_send_packet(m_videoCodecCtx, packet);
         av_packet_free(&packet);
         
@@ -1047,15 +1310,29 @@ void D3D11Renderer::videoDecodeThread()
             ret = avcodec_receive_frame(m_videoCodecCtx, frame);
             if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) break;
             if (ret < 0) break;
+            m_metrics.addDecodeTime(decodeTimer.nsecsElapsed() / 1000.0);
             
             double pts = 0;
             AVStream *stream = m_formatCtx->streams[m_videoStreamIndex];
             if (frame->pts != AV_NOPTS_VALUE) {
                 pts = frame->pts * av_q2d(stream->time_base);
             }
+            
+            // 限制呈现帧率：不呈现的帧不复制纹理、不做颜色转换
+            if (!selectPresentFrame(pts)) {
+                decodeTimer.restart();
+                continue;
+            }
 
+            // 流中途改变分辨率 / 格式：纹理按帧创建、转换函数按帧参数重新选择，不重开解码器
+            if (m_frameParams.update(frame, "D3D11")) {
+                m_metrics.addReconfiguration();
+            }
+            
             VideoFrame vf;
             vf.pts = pts;
+            vf.width = frame->width;
+            vf.height = frame->height;
             
             // ========================================
             // 硬件解码路径：D3D11VA
@@ -1088,34 +1365,24 @@ void D3D11Renderer::videoDecodeThread()
                 if (copyTexture) {
                     vf.texture = copyTexture;
                     vf.textureIndex = 0;
+                    vf.charge = MemoryCharge::shared(m_metrics.memory(), MemoryCategory::GpuTextures,
+                                                     qint64(desc.Width) * desc.Height * 3 / 2);
                 }
             }
             // ========================================
             // 软件解码路径：CPU → BGRA → D3D11 Texture
             // ========================================
             else {
+                // 转换函数按流选定一次（QImage::Format_RGB32 内存布局即 BGRA）
                 AVPixelFormat srcFmt = static_cast<AVPixelFormat>(frame->format);
-                if (!m_swsCtx) {
-                    m_swsCtx = sws_getContext(
-                        m_videoWidth, m_videoHeight, srcFmt,
-                        m_videoWidth, m_videoHeight, AV_PIX_FMT_BGRA,
-                        SWS_FAST_BILINEAR, nullptr, nullptr, nullptr
-                    );
-                    qDebug() << "软件解码: 创建颜色转换，格式:" << av_get_pix_fmt_name(srcFmt) << "→ BGRA";
-                }
-                
-                if (m_swsCtx) {
-                    int bgraLinesize = m_videoWidth * 4;
-                    std::vector<uint8_t> bgraBuffer(bgraLinesize * m_videoHeight);
-                    uint8_t *bgraData[1] = {bgraBuffer.data()};
-                    int bgraLinesizes[1] = {bgraLinesize};
-                    
-                    sws_scale(m_swsCtx, frame->data, frame->linesize, 0, m_videoHeight,
-                             bgraData, bgraLinesizes);
+                const QSize videoSize(frame->width, frame->height);
+                if (m_frameConverter.configure(srcFmt, videoSize, FrameFormat::RGB32, videoSize,
+                                              frame->color_range)) {
+                    const QImage bgraImage = m_frameConverter.convert(frame);
                     
                     D3D11_TEXTURE2D_DESC desc = {};
-                    desc.Width = m_videoWidth;
-                    desc.Height = m_videoHeight;
+                    desc.Width = frame->width;
+                    desc.Height = frame->height;
                     desc.MipLevels = 1;
                     desc.ArraySize = 1;
                     desc.Format = DXGI_FORMAT_B8G8R8A8_UNORM;
@@ -1124,8 +1391,8 @@ void D3D11Renderer::videoDecodeThread()
                     desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
                     
                     D3D11_SUBRESOURCE_DATA initData = {};
-                    initData.pSysMem = bgraBuffer.data();
-                    initData.SysMemPitch = bgraLinesize;
+                    initData.pSysMem = bgraImage.constBits();
+                    initData.SysMemPitch = static_cast<UINT>(bgraImage.bytesPerLine());
                     
                     ComPtr<ID3D11Texture2D> softTexture;
                     {
@@ -1137,6 +1404,8 @@ void D3D11Renderer::videoDecodeThread()
                         vf.texture = softTexture;
                         vf.textureIndex = 0;
                         vf.isBGRA = true;
+                        vf.charge = MemoryCharge::shared(m_metrics.memory(), MemoryCategory::GpuTextures,
+                                                         qint64(desc.Width) * desc.Height * 4);
                     }
                 }
             }
@@ -1147,13 +1416,16 @@ void D3D11Renderer::videoDecodeThread()
                 
                 // 等待队列有空间
                 while (m_frameQueue.size() >= MAX_FRAME_QUEUE && m_running) {
-                    m_frameCondition.wait(&m_frameMutex, 10);
+                    m_frameCondition.wait(&m_frameMutex);
                 }
                 
                 if (m_running) {
                     m_frameQueue.enqueue(vf);
+                    m_metrics.addVideoFrame(m_frameQueue.size());
+                    m_metrics.markProgress(PipelineStage::Decode, vf.pts);
                 }
             }
+            decodeTimer.restart();
         }
     }
     
@@ -1162,6 +1434,49 @@ void D3D11Renderer::videoDecodeThread()
 #endif
 }
 
+void D3D11Renderer::setMaxPresentRate(double fps)
+{
+    VideoRendererBase::setMaxPresentRate(fps);
+    m_presentRateCap = fps;
+    if (m_watchdog->isArmed()) {
+        armWatchdog();  // 停滞阈值按新的呈现帧间隔
+    }
+}
+
+int D3D11Renderer::presentStride() const
+{
+    const double cap = m_presentRateCap;
+    if (cap <= 0 || m_sourceFps <= cap) return 1;
+    // 整数步长：60 → 30 每两帧取一帧；59.94 / 30 的微小超出不增加步长
+    return static_cast<int>(std::ceil(m_sourceFps / cap - 0.01));
+}
+
+bool D3D11Renderer::selectPresentFrame(double pts)
+{
+    // 打开、跳转或循环回到开头（flush 包 / PTS 回退）后第一帧总是呈现，步长从它开始计
+    if (m_presentRestart || pts < m_lastDecodedPts) {
+        m_presentRestart = false;
+        m_nextPresentPts = -std::numeric_limits<double>::infinity();
+        m_lastDecodedPts = pts;
+    }
+    const int stride = presentStride();
+    const double interval = stride > 1 ? 1.0 / m_sourceFps : 0;
+    // 跳过非参考帧后解出的帧间隔已超过步长（非参考帧比要跳过的帧还密）：恢复完整解码，保持节奏均匀
+    if (stride > 1 && m_skipNonRef && pts - m_lastDecodedPts > (stride + 0.5) * interval) {
+        m_skipNonRef = false;
+        qDebug() << "[限帧] 非参考帧间隔超过步长" << stride << "，恢复完整解码";
+    }
+    m_lastDecodedPts = pts;
+    if (stride <= 1) return true;
+
+    if (pts < m_nextPresentPts - interval / 2) {
+        m_metrics.addSkippedFrame();
+        return false;
+    }
+    m_nextPresentPts = pts + stride * interval;
+    return true;
+}
+
 // ========================================
 // 音频解码线程：独立解码，不受视频影响
 // ========================================
@@ -1181,15 +1496,17 @@ void D3D11Renderer::audioDecodeThread()
             QMutexLocker locker(&m_audioPacketMutex);
             
             while (m_audioPacketQueue.isEmpty() && m_running) {
-                m_audioPacketCondition.wait(&m_audioPacketMutex, 50);
+                m_audioPacketCondition.wait(&m_audioPacketMutex);
             }
             
             if (!m_running) break;
             if (m_audioPacketQueue.isEmpty()) continue;
             
             packet = m_audioPacketQueue.dequeue();  // 取出指针，由此函数负责释放
+            if (packet) m_metrics.memory().release(MemoryCategory::PacketQueue, packet->size);
             
             m_audioPacketCondition.wakeOne();
+            if (m_audioPacketQueue.isEmpty()) notifyDrained();
         }
         
         // 空 Packet = flush 信号
@@ -1200,6 +1517,7 @@ void D3D11Renderer::audioDecodeThread()
             {
                 QMutexLocker locker(&m_audioMutex);
                 m_audioQueue.clear();
+                notifyDrained();
             }
             
             // 重置音频时钟
@@ -1246,19 +1564,18 @@ void D3D11Renderer::audioDecodeThread()
                 ad.data = audioData;
                 ad.pts = pts;
                 ad.volumeAdjusted = false;
+                ad.charge = MemoryCharge::shared(m_metrics.memory(), MemoryCategory::AudioBuffers, audioData.size());
                 
                 QMutexLocker locker(&m_audioMutex);
                 
-                // 等待队列有空间
-                while (m_audioQueue.size() >= 100 && m_running) {
-                    // 音频队列满时，短暂等待
-                    locker.unlock();
-                    QThread::msleep(5);
-                    locker.relock();
+                // 等待队列有空间（processAudio 取走数据或停止时唤醒）
+                while (m_audioQueue.size() >= MAX_AUDIO_QUEUE && m_running) {
+                    m_audioCondition.wait(&m_audioMutex);
                 }
                 
                 if (m_running) {
                     m_audioQueue.enqueue(ad);
+                    m_metrics.addAudioFrame(m_audioQueue.size());
                 }
             }
         }
@@ -1378,6 +1695,7 @@ void D3D11Renderer::onRenderTimer()
                         }
                     }
                     if (dropped > 0) {
+                        m_metrics.addDroppedFrames(dropped);
                         qDebug() << "[AVSync] 视频落后严重，丢帧追赶 dropped=" << dropped
                                  << "diff(ms)=" << diff * 1000;
                     }
@@ -1418,7 +1736,14 @@ void D3D11Renderer::onRenderTimer()
         // 取出帧
         frame = m_frameQueue.dequeue();
         m_frameCondition.wakeOne();
+        if (m_frameQueue.isEmpty()) notifyDrained();
         hasFrame = true;
+        if (m_audioClockValid) {
+            m_metrics.setAvOffset(diff * 1000.0);
+        }
+        m_metrics.setVideoQueueDepth(m_frameQueue.size());
+        m_metrics.addPresentedFrame(framePts);
+        m_metrics.markProgress(PipelineStage::Present, framePts);
         
         // 计算下一帧的显示时间
         m_frameTimer = currentTime + delay;
@@ -1437,6 +1762,12 @@ void D3D11Renderer::onRenderTimer()
     
     // 渲染
     if (hasFrame && frame.texture) {
+        if (frame.width != m_videoWidth || frame.height != m_videoHeight) {
+            // 流中途分辨率变化：只需重新计算顶点
+            m_videoWidth = frame.width;
+            m_videoHeight = frame.height;
+            m_quadValid = false;
+        }
         if (frame.isBGRA) {
             renderBGRAFrame(frame.texture.Get());
         } else {
@@ -1444,11 +1775,88 @@ void D3D11Renderer::onRenderTimer()
         }
         m_currentPts = frame.pts;
         emit positionChanged(m_currentPts);
+        m_shownFrame = std::move(frame);
+        if (m_firstFramePending) {
+            m_firstFramePending = false;
+            emit firstFrameShown();
+        }
+    }
+#endif
+}
+
+void D3D11Renderer::setVideoGeometry(const VideoGeometry &geometry)
+{
+    m_videoGeometry = geometry;
+    m_quadValid = false;
+}
+
+QImage D3D11Renderer::grabFrame()
+{
+#ifdef _WIN32
+    // 翻转模型的后备缓冲在 Present 后内容未定义：把最近显示的帧重绘一遍再回读
+    if (!m_shownFrame.texture || !m_swapChain) return QImage();
+    if (m_shownFrame.isBGRA) {
+        renderBGRAFrame(m_shownFrame.texture.Get(), false);
+    } else {
+        renderNV12Frame(m_shownFrame.texture.Get(), m_shownFrame.textureIndex, false);
     }
+    
+    QMutexLocker d3dLock(&m_d3dMutex);
+    ComPtr<ID3D11Texture2D> backBuffer;
+    if (FAILED(m_swapChain->GetBuffer(0, IID_PPV_ARGS(&backBuffer)))) return QImage();
+    
+    D3D11_TEXTURE2D_DESC desc;
+    backBuffer->GetDesc(&desc);
+    desc.Usage = D3D11_USAGE_STAGING;
+    desc.BindFlags = 0;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_READ;
+    desc.MiscFlags = 0;
+    ComPtr<ID3D11Texture2D> staging;
+    if (FAILED(m_device->CreateTexture2D(&desc, nullptr, &staging))) return QImage();
+    m_context->CopyResource(staging.Get(), backBuffer.Get());
+    
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    if (FAILED(m_context->Map(staging.Get(), 0, D3D11_MAP_READ, 0, &mapped))) return QImage();
+    // 后备缓冲为 B8G8R8A8，小端内存布局与 QImage::Format_RGB32 一致
+    QImage image(static_cast<int>(desc.Width), static_cast<int>(desc.Height), QImage::Format_RGB32);
+    for (UINT y = 0; y < desc.Height; y++) {
+        std::memcpy(image.scanLine(static_cast<int>(y)),
+                    static_cast<const uchar *>(mapped.pData) + y * mapped.RowPitch, desc.Width * 4);
+    }
+    m_context->Unmap(staging.Get(), 0);
+    return image;
+#else
+    return QImage();
 #endif
 }
 
-void D3D11Renderer::renderBGRAFrame(ID3D11Texture2D *texture)
+void D3D11Renderer::updateQuad(int textureWidth, int textureHeight)
+{
+#ifdef _WIN32
+    // 旋转、翻转、裁剪、变焦与黑边都折算进 4 个顶点；纹理坐标按分配尺寸归一化，
+    // 硬解纹理的对齐填充行不会显示出来
+    VideoQuadVertex quad[4];
+    m_videoGeometry.quad(m_streamRotation, QSize(m_videoWidth, m_videoHeight),
+                         QSize(textureWidth, textureHeight), size(), quad);
+    if (m_quadValid && std::memcmp(quad, m_quad, sizeof(quad)) == 0) return;
+    
+    D3D11_MAPPED_SUBRESOURCE mapped = {};
+    if (FAILED(m_context->Map(m_vertexBuffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) return;
+    auto *vertices = static_cast<Vertex *>(mapped.pData);
+    for (int i = 0; i < 4; i++) {
+        vertices[i] = { quad[i].x, quad[i].y, 0.0f, quad[i].u, quad[i].v };
+    }
+    m_context->Unmap(m_vertexBuffer.Get(), 0);
+    
+    std::memcpy(m_quad, quad, sizeof(quad));
+    m_quadValid = true;
+#else
+    Q_UNUSED(textureWidth)
+    Q_UNUSED(textureHeight)
+#endif
+}
+
+void D3D11Renderer::renderBGRAFrame(ID3D11Texture2D *texture, bool present)
 {
 #ifdef _WIN32
     if (!m_device || !m_context || !m_swapChain) return;
@@ -1464,6 +1872,10 @@ void D3D11Renderer::renderBGRAFrame(ID3D11Texture2D *texture)
     ComPtr<ID3D11ShaderResourceView> srv;
     m_device->CreateShaderResourceView(texture, &srvDesc, &srv);
     
+    D3D11_TEXTURE2D_DESC texDesc;
+    texture->GetDesc(&texDesc);
+    updateQuad(static_cast<int>(texDesc.Width), static_cast<int>(texDesc.Height));
+    
     // 设置渲染状态
     D3D11_VIEWPORT viewport = {};
     viewport.Width = static_cast<float>(width());
@@ -1490,13 +1902,16 @@ void D3D11Renderer::renderBGRAFrame(ID3D11Texture2D *texture)
     m_context->PSSetSamplers(0, 1, m_sampler.GetAddressOf());
     
     m_context->Draw(4, 0);
+    if (!present) return;
     m_swapChain->Present(1, 0);
+    StartupTimeline::firstFrame();
 #else
     Q_UNUSED(texture)
+    Q_UNUSED(present)
 #endif
 }
 
-void D3D11Renderer::renderNV12Frame(ID3D11Texture2D *texture, int textureIndex)
+void D3D11Renderer::renderNV12Frame(ID3D11Texture2D *texture, int textureIndex, bool present)
 {
 #ifdef _WIN32
     if (!m_device || !m_context || !m_swapChain) return;
@@ -1521,6 +1936,8 @@ void D3D11Renderer::renderNV12Frame(ID3D11Texture2D *texture, int textureIndex)
     srvDesc.Format = DXGI_FORMAT_R8G8_UNORM;
     m_device->CreateShaderResourceView(texture, &srvDesc, &srvUV);
     
+    updateQuad(static_cast<int>(texDesc.Width), static_cast<int>(texDesc.Height));
+    
     // 设置渲染状态
     D3D11_VIEWPORT viewport = {};
     viewport.Width = static_cast<float>(width());
@@ -1552,10 +1969,13 @@ void D3D11Renderer::renderNV12Frame(ID3D11Texture2D *texture, int textureIndex)
     m_context->Draw(4, 0);
     
     // 呈现
+    if (!present) return;
     m_swapChain->Present(1, 0);
+    StartupTimeline::firstFrame();
 #else
     Q_UNUSED(texture)
     Q_UNUSED(textureIndex)
+    Q_UNUSED(present)
 #endif
 }
 
@@ -1595,7 +2015,16 @@ void D3D11Renderer::setupAudio()
     
     // 开始播放
     SDL_ResumeAudioStreamDevice(m_sdlAudioStream);
+    
+    // 设备缓冲周期即设备报告的延迟
+    SDL_AudioSpec deviceSpec;
+    int deviceFrames = 0;
+    if (SDL_GetAudioDeviceFormat(SDL_GetAudioStreamDevice(m_sdlAudioStream), &deviceSpec, &deviceFrames)
+        && deviceSpec.freq > 0) {
+        m_metrics.audio().setDeviceLatency(deviceFrames * 1000.0 / deviceSpec.freq);
+    }
     m_audioWrittenBytes = 0;
+    m_metrics.audio().reset();
     qDebug() << "SDL3 音频初始化成功";
     
 #else
@@ -1609,6 +2038,8 @@ void D3D11Renderer::setupAudio()
     m_audioSink->setBufferSize(44100 * 2 * 2 / 5);
     m_audioSink->setVolume(m_volume / 100.0f);
     m_audioDevice = m_audioSink->start();
+    m_metrics.audio().setDeviceLatency(m_audioSink->bufferSize() / 176.4);
+    m_metrics.audio().reset();
 #endif
 }
 
@@ -1620,6 +2051,7 @@ void D3D11Renderer::cleanupAudio()
         m_sdlAudioStream = nullptr;
     }
     m_audioWrittenBytes = 0;
+    m_metrics.audio().reset();
 #else
     if (m_audioSink) {
         m_audioSink->stop();
@@ -1651,6 +2083,7 @@ void D3D11Renderer::processAudio()
     }
     
     QMutexLocker locker(&m_audioMutex);
+    m_metrics.audio().beginWrite();
     
     // 获取 SDL 音频流中排队的数据量
     int queued = SDL_GetAudioStreamQueued(m_sdlAudioStream);
@@ -1662,6 +2095,7 @@ void D3D11Renderer::processAudio()
         qDebug() << "[状态] 音频队列:" << m_audioQueue.size() 
                  << "SDL:" << queued / 1000 << "KB"
                  << "时钟:" << QString::number(m_audioClock, 'f', 2);
+        qDebug().noquote() << "[音频遥测]" << m_metrics.audio().snapshot().summary();
     }
     
     // 如果队列太满（超过 200ms 的数据），等待
@@ -1701,6 +2135,8 @@ void D3D11Renderer::processAudio()
             if (SDL_PutAudioStreamData(m_sdlAudioStream, ad.data.constData(), ad.data.size())) {
                 m_audioWrittenBytes += ad.data.size();
                 m_audioQueue.dequeue();
+                m_audioCondition.wakeOne();
+                if (m_audioQueue.isEmpty()) notifyDrained();
                 queued = SDL_GetAudioStreamQueued(m_sdlAudioStream);
             } else {
                 qWarning() << "SDL 音频写入失败:" << SDL_GetError();
@@ -1719,6 +2155,18 @@ void D3D11Renderer::processAudio()
         m_audioClock = m_audioStartPts + playedSeconds;
     }
     
+    // 设备消耗进度：已播放字节前进，或数据已播完处于空闲（欠载不算设备故障）
+    const qint64 playedBytes = qMax<qint64>(0, m_audioWrittenBytes - queued);
+    if (playedBytes != m_lastAudioPlayed || queued == 0) {
+        m_lastAudioPlayed = playedBytes;
+        m_metrics.markProgress(PipelineStage::Audio, playedBytes);
+    }
+    
+    // SDL 流中排队的数据即设备侧缓冲（不含设备内部的一个周期）
+    m_metrics.setAudioQueueDepth(m_audioQueue.size());
+    m_metrics.audio().endWrite(queued / 176.4, m_audioQueue.isEmpty(),
+                               qMax<qint64>(0, m_audioWrittenBytes - queued) / 176400.0);
+    
     // 每 2 秒输出同步状态
     static int logCounter = 0;
     if (++logCounter >= 400) {  // 5ms * 400 = 2秒
@@ -1759,6 +2207,7 @@ void D3D11Renderer::processAudio()
     }
     
     QMutexLocker locker(&m_audioMutex);
+    m_metrics.audio().beginWrite();
     
     QAudio::State state = m_audioSink->state();
     if (state == QAudio::SuspendedState) {
@@ -1809,6 +2258,8 @@ void D3D11Renderer::processAudio()
         if (remaining == 0) {
             // 完整写入，弹出队列
             m_audioQueue.dequeue();
+            m_audioCondition.wakeOne();
+            if (m_audioQueue.isEmpty()) notifyDrained();
         } else {
             // 仅写入部分，保留未写入的数据
             ad.data = ad.data.mid(offset);
@@ -1821,6 +2272,17 @@ void D3D11Renderer::processAudio()
         qint64 processedUs = m_audioSink->processedUSecs();
         m_audioClock = m_audioStartPts + processedUs / 1000000.0;
     }
+    
+    const qint64 processedUs = m_audioSink->processedUSecs();
+    if (processedUs != m_lastAudioPlayed || m_audioSink->state() == QAudio::IdleState) {
+        m_lastAudioPlayed = processedUs;
+        m_metrics.markProgress(PipelineStage::Audio, processedUs * 176400.0 / 1e6);
+    }
+    
+    const qint64 bufferedBytes = m_audioSink->bufferSize() - m_audioSink->bytesFree();
+    m_metrics.setAudioQueueDepth(m_audioQueue.size());
+    m_metrics.audio().endWrite(bufferedBytes / 176.4, m_audioQueue.isEmpty(),
+                               m_audioSink->processedUSecs() / 1000000.0);
 #endif
 }
 
@@ -1834,6 +2296,7 @@ void D3D11Renderer::resetSyncStateOnLoop()
     m_avSyncOffset = 0;
     m_audioClock = 0;
     m_audioWrittenBytes = 0;
+    m_metrics.audio().reset();
     m_skipRenderCount = 0;
     m_frameTimer = 0;
     m_lastFramePts = 0;
@@ -1849,6 +2312,8 @@ void D3D11Renderer::resetSyncStateOnLoop()
     {
         QMutexLocker locker(&m_audioMutex);
         m_audioQueue.clear();
+        m_audioCondition.wakeOne();
+        notifyDrained();
     }
     
 #if SDL3_AVAILABLE
@@ -1865,9 +2330,82 @@ void D3D11Renderer::resetSyncStateOnLoop()
     }
 #endif
 
+    m_watchdog->resetProgress();    // 排空等待期间呈现停住属于正常
     qDebug() << "[Loop] reset sync state, holdAudio" << m_holdAudioAfterLoop;
 }
 
+// ========================================
+// 停滞看门狗
+// ========================================
+bool D3D11Renderer::hasAudioOutput() const
+{
+#if SDL3_AVAILABLE
+    return m_sdlAudioStream != nullptr;
+#else
+    return m_audioDevice != nullptr;
+#endif
+}
+
+void D3D11Renderer::armWatchdog()
+{
+#if FFMPEG_AVAILABLE
+    const double fps = m_sourceFps > 0 ? m_sourceFps / presentStride() : 0;
+    m_watchdog->arm(fps > 0 ? 1.0 / fps : 0.04, m_videoCodecCtx != nullptr, m_hasAudio && hasAudioOutput());
+#endif
+}
+
+/**
+ * @brief 执行看门狗下发的恢复动作
+ * @return false 表示动作不适用，看门狗直接升级
+ */
+bool D3D11Renderer::runRecovery(RecoveryAction action)
+{
+#if FFMPEG_AVAILABLE
+    if (!m_formatCtx || !m_playing) return false;
+    
+    const double position = m_currentPts;
+    switch (action) {
+    case RecoveryAction::FlushResync:
+        // 跳转本身不 flush 解码器：由 demux 在清空包队列后送入空包
+        m_flushVideo = true;
+        seek(position);
+        return true;
+    case RecoveryAction::SoftwareFallback:
+        if (!m_hwDeviceCtx || m_decodeMode == Hardware) {
+            return false;
+        }
+        m_hardwareAllowed = false;
+        [[fallthrough]];
+    case RecoveryAction::ReopenDecoder:
+        return reopenVideoDecoder();
+    case RecoveryAction::ReopenFile: {
+        const QString file = m_currentFile;
+        stop();
+        if (!openFile(file)) {
+            return false;
+        }
+        play();
+        seek(position);
+        return true;
+    }
+    case RecoveryAction::ReopenAudio:
+        setupAudio();
+        if (!hasAudioOutput()) {
+            return false;
+        }
+        // 新设备的已播放进度从 0 开始，以下一块音频重新建立时钟
+        m_audioClockValid = false;
+        m_audioWrittenBytes = 0;
+        m_lastAudioPlayed = -1;
+        return true;
+    }
+    return false;
+#else
+    Q_UNUSED(action)
+    return false;
+#endif
+}
+
 void D3D11Renderer::paintEvent(QPaintEvent *event)
 {
     Q_UNUSED(event)
@@ -6,6 +6,8 @@
 #include <memory>
 #include <atomic>
 
+class PipelineWatchdog;
+
 #ifdef _WIN32
 #include <d3d11.h>
 #include <dxgi1_2.h>
@@ -23,6 +25,7 @@ extern "C" {
 #include <libswresample/swresample.h>
 #include <libswscale/swscale.h>
 }
+#include "FrameConverter.h"
 #endif
 
 #include <QThread>
@@ -46,6 +49,7 @@ struct AudioData {
     QByteArray data;
     double pts = 0;
     bool volumeAdjusted = false; // 避免重复缩放导致失真
+    std::shared_ptr<MemoryCharge> charge;
 };
 
 
@@ -79,21 +83,19 @@ public:
     void togglePause() override;
     void seek(double seconds) override;
     void setVolume(int volume) override;
+    void setMaxPresentRate(double fps) override;
+    bool supportsMaxPresentRate() const override { return true; }
     
     QString rendererName() const override { return "D3D11 (Windows)"; }
     bool isHardwareDecoding() const override { return m_hwDeviceCtx != nullptr; }
+    PlaybackMetrics *metrics() override { return &m_metrics; }
+    void setVideoGeometry(const VideoGeometry &geometry) override;
+    QImage grabFrame() override;
     
     // 使用基类的 DecodeMode
     using VideoRendererBase::DecodeMode;
     using VideoRendererBase::setDecodeMode;
     using VideoRendererBase::decodeMode;
-    
-    // 兼容旧接口（停止当前播放，打开新文件并自动播放）
-    void loadFile(const QString &filename);
-
-signals:
-    // 额外信号（基类已有基本信号）
-    void durationChanged(double seconds);
 
 protected:
     void paintEvent(QPaintEvent *event) override;
@@ -115,16 +117,29 @@ private:
     
     // FFmpeg 初始化
     bool initHardwareDecoder(const AVCodec *codec);
+#if FFMPEG_AVAILABLE
+    bool openVideoDecoder(const AVCodec *codec, const AVCodecParameters *codecpar, QString &error);
+#endif
+    bool reopenVideoDecoder();
     
     // 三线程架构
     void demuxThread();       // Demux 线程：读取 packet 并分发到音视频队列
     void videoDecodeThread(); // 视频解码线程：从 packet 队列解码到帧队列
     void audioDecodeThread(); // 音频解码线程：从 packet 队列解码到音频队列
+    void wakeStages();        // 持锁唤醒所有阻塞的线程（停止 / 跳转）
+    void notifyDrained();     // 某级队列变空，唤醒等待排空的 demux
+    bool waitDrained();       // 循环边界：等待各级队列排空（最长 2 秒）
+    
+    // 限制呈现帧率：按固定步长选帧（视频解码线程调用）
+    int presentStride() const;
+    bool selectPresentFrame(double pts);
     
     // 渲染
     void renderFrame(ID3D11Texture2D *texture, int textureIndex);
-    void renderNV12Frame(ID3D11Texture2D *texture, int textureIndex);
-    void renderBGRAFrame(ID3D11Texture2D *texture);
+    // present=false 只绘制到后备缓冲（grabFrame 回读用）
+    void renderNV12Frame(ID3D11Texture2D *texture, int textureIndex, bool present = true);
+    void renderBGRAFrame(ID3D11Texture2D *texture, bool present = true);
+    void updateQuad(int textureWidth, int textureHeight);  // 几何变换写入顶点缓冲（调用方持有 m_d3dMutex）
     
     // 音频
     void setupAudio();
@@ -134,6 +149,11 @@ private:
     // 循环播放时重置同步与音频输出状态
     void resetSyncStateOnLoop();
 
+    // 停滞看门狗
+    void armWatchdog();
+    bool runRecovery(RecoveryAction action);
+    bool hasAudioOutput() const;
+
 private:
 #ifdef _WIN32
     // D3D11 对象
@@ -145,11 +165,13 @@ private:
     ComPtr<ID3D11PixelShader> m_pixelShader;      // NV12 → RGB
     ComPtr<ID3D11PixelShader> m_pixelShaderBGRA;  // BGRA 直接采样
     ComPtr<ID3D11InputLayout> m_inputLayout;
-    ComPtr<ID3D11Buffer> m_vertexBuffer;
+    ComPtr<ID3D11Buffer> m_vertexBuffer;         // 动态：几何变换 / 窗口尺寸变化时重写
     ComPtr<ID3D11SamplerState> m_sampler;
     ComPtr<ID3D11ShaderResourceView> m_textureSRV_Y;
     ComPtr<ID3D11ShaderResourceView> m_textureSRV_UV;
 #endif
+    VideoQuadVertex m_quad[4] = {};     // 顶点缓冲当前内容
+    bool m_quadValid = false;
 
 #if FFMPEG_AVAILABLE
     // FFmpeg 对象
@@ -158,7 +180,8 @@ private:
     AVCodecContext *m_audioCodecCtx = nullptr;
     AVBufferRef *m_hwDeviceCtx = nullptr;
     SwrContext *m_swrCtx = nullptr;
-    SwsContext *m_swsCtx = nullptr;  // 软解码时的颜色转换
+    FrameConverter m_frameConverter;  // 软解码时的颜色转换
+    FrameParams m_frameParams;        // 最近解码帧的尺寸 / 格式（仅视频解码线程访问）
     
     int m_videoStreamIndex = -1;
     int m_audioStreamIndex = -1;
@@ -173,6 +196,7 @@ private:
     
     std::atomic<bool> m_running{false};
     std::atomic<bool> m_seeking{false};
+    std::atomic<bool> m_flushVideo{false};  // 看门狗恢复：跳转时让视频解码线程 flush 解码器
     double m_seekTarget = 0;
     
 #if FFMPEG_AVAILABLE
@@ -191,6 +215,13 @@ private:
     // 音频帧队列（解码后）
     QQueue<AudioData> m_audioQueue;
     QMutex m_audioMutex;
+    QWaitCondition m_audioCondition;  // 音频帧队列有空位
+    static constexpr int MAX_AUDIO_QUEUE = 100;
+    
+    // 循环边界的排空等待：队列变空时递增序号并唤醒，demux 比较序号判断是否错过通知
+    QMutex m_drainMutex;
+    QWaitCondition m_drainCondition;
+    quint64 m_drainSeq = 0;
     
 #if SDL3_AVAILABLE
     // SDL3 音频（精确同步）
@@ -201,6 +232,13 @@ private:
     QIODevice *m_audioDevice = nullptr;
 #endif
     qint64 m_audioWrittenBytes = 0;  // 已写入音频设备的字节数
+    PlaybackMetrics m_metrics;       // 音频遥测、内存记账
+    qint64 m_lastAudioPlayed = -1;   // 上次读到的设备消耗进度（SDL：已播放字节；Qt：已播放微秒）
+    PipelineWatchdog *m_watchdog = nullptr;
+    bool m_hardwareAllowed = true;   // 看门狗回退软件解码后，本文件不再尝试硬件解码
+#if FFMPEG_AVAILABLE
+    AccountedBufferPools m_bufferPools{m_metrics.memory()};
+#endif
     
     // 播放状态 (基类已有: m_playing, m_paused, m_loop, m_volume, m_duration, m_currentPts)
     double m_audioClock = 0;           // 音频主时钟（秒）
@@ -209,6 +247,14 @@ private:
     double m_avSyncOffset = 0;         // 音视频 PTS 偏移 (videoStart - audioStart)
     bool m_audioClockValid = false;    // 音频时钟是否有效
     bool m_videoClockValid = false;    // 视频时钟是否有效
+    
+    // 呈现帧率上限：步长 = ceil(源帧率 / 上限)，不呈现的帧不做纹理复制与颜色转换
+    std::atomic<double> m_presentRateCap{0};
+    double m_sourceFps = 0;             // openFile 时确定，解码线程运行期间只读
+    bool m_skipNonRef = true;           // 以下仅视频解码线程访问；非参考帧过密时关闭
+    double m_nextPresentPts = 0;
+    double m_lastDecodedPts = 0;
+    bool m_presentRestart = true;       // 下一帧重新开始计步（打开、跳转、循环后）
     int m_skipRenderCount = 0;         // 连续跳过渲染的次数
     
     // 动态 delay 同步
@@ -237,9 +283,14 @@ private:
 #endif
         int textureIndex = 0;
         double pts = 0;
+        int width = 0;        // 画面尺寸（流中途可能变化，呈现时更新几何）
+        int height = 0;
         bool isBGRA = false;  // true = 软解码(BGRA), false = 硬解码(NV12)
+        std::shared_ptr<MemoryCharge> charge;  // 纹理显存记账
     };
     QQueue<VideoFrame> m_frameQueue;
+    VideoFrame m_shownFrame;           // 最近显示的帧（grabFrame 重绘用，仅 GUI 线程访问）
+    bool m_firstFramePending = false;  // openFile 后尚未显示过帧
     QMutex m_frameMutex;
     QMutex m_d3dMutex;  // D3D11 上下文访问保护
     QWaitCondition m_frameCondition;
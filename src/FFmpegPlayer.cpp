@@ -1,4 +1,7 @@
 #include "FFmpegPlayer.h"
+#include "MediaProbe.h"
+#include "PipelineWatchdog.h"
+#include "StartupTimeline.h"
 #include <QTimer>
 #include <QDebug>
 #include <QElapsedTimer>
@@ -128,18 +131,21 @@ bool DecodeThread::openFile(const QString &filename)
 #if FFMPEG_AVAILABLE
     closeFile();
     
-    // 打开文件
-    m_formatCtx = avformat_alloc_context();
-    if (avformat_open_input(&m_formatCtx, filename.toUtf8().constData(), nullptr, nullptr) != 0) {
-        emit errorOccurred("无法打开文件: " + filename);
-        return false;
-    }
-    
-    // 获取流信息
-    if (avformat_find_stream_info(m_formatCtx, nullptr) < 0) {
-        emit errorOccurred("无法获取流信息");
-        closeFile();
-        return false;
+    // 打开文件（优先使用启动时后台预探测的结果）
+    m_formatCtx = MediaProbe::take(filename);
+    if (!m_formatCtx) {
+        m_formatCtx = avformat_alloc_context();
+        if (avformat_open_input(&m_formatCtx, filename.toUtf8().constData(), nullptr, nullptr) != 0) {
+            emit errorOccurred("无法打开文件: " + filename);
+            return false;
+        }
+        
+        // 获取流信息
+        if (avformat_find_stream_info(m_formatCtx, nullptr) < 0) {
+            emit errorOccurred("无法获取流信息");
+            closeFile();
+            return false;
+        }
     }
     
     // 获取时长
@@ -161,22 +167,13 @@ bool DecodeThread::openFile(const QString &filename)
     // ========================================
     if (m_videoStreamIndex >= 0) {
         AVCodecParameters *codecpar = m_formatCtx->streams[m_videoStreamIndex]->codecpar;
-        const AVCodec *codec = avcodec_find_decoder(codecpar->codec_id);
-        if (!codec) {
+        if (!avcodec_find_decoder(codecpar->codec_id)) {
             emit errorOccurred("找不到视频解码器");
             closeFile();
             return false;
         }
         
-        // 分配解码器上下文
-        m_videoCodecCtx = avcodec_alloc_context3(codec);
-        avcodec_parameters_to_context(m_videoCodecCtx, codecpar);
-        
-        // 【重要】在 avcodec_open2 之前尝试初始化硬件解码
-        initHardwareDecoder(codec);
-        
-        // 打开解码器
-        if (avcodec_open2(m_videoCodecCtx, codec, nullptr) < 0) {
+        if (!openVideoDecoder()) {
             emit errorOccurred("无法打开视频解码器");
             closeFile();
             return false;
@@ -185,7 +182,13 @@ bool DecodeThread::openFile(const QString &filename)
         m_videoWidth = m_videoCodecCtx->width;
         m_videoHeight = m_videoCodecCtx->height;
         
-        // 注意：sws_scale 上下文将在解码时根据实际帧格式创建
+        AVRational frameRate = av_guess_frame_rate(m_formatCtx, m_formatCtx->streams[m_videoStreamIndex], nullptr);
+        if (frameRate.num > 0 && frameRate.den > 0) {
+            m_frameDuration = av_q2d(av_inv_q(frameRate));
+        }
+        m_hasVideo = true;
+        
+        // 注意：帧转换函数将在解码时根据实际帧格式选择
         // 因为硬件解码和软件解码的源格式不同
     }
     
@@ -216,6 +219,7 @@ bool DecodeThread::openFile(const QString &filename)
                 
                 m_audioSampleRate = 44100;
                 m_audioChannels = 2;
+                m_hasAudio = true;
             }
         }
     }
@@ -229,6 +233,7 @@ bool DecodeThread::openFile(const QString &filename)
     qDebug() << "========================================";
     
     emit fileOpened();
+    StartupTimeline::mark("decoder open");
     return true;
 #else
     Q_UNUSED(filename)
@@ -243,31 +248,18 @@ void DecodeThread::closeFile()
     stopDecoding();
     flushQueues();
     
-    if (m_swsCtx) {
-        sws_freeContext(m_swsCtx);
-        m_swsCtx = nullptr;
-    }
+    closeVideoDecoder();
     
     if (m_swrCtx) {
         swr_free(&m_swrCtx);
         m_swrCtx = nullptr;
     }
     
-    if (m_videoCodecCtx) {
-        avcodec_free_context(&m_videoCodecCtx);
-        m_videoCodecCtx = nullptr;
-    }
-    
     if (m_audioCodecCtx) {
         avcodec_free_context(&m_audioCodecCtx);
         m_audioCodecCtx = nullptr;
     }
     
-    if (m_hwDeviceCtx) {
-        av_buffer_unref(&m_hwDeviceCtx);
-        m_hwDeviceCtx = nullptr;
-    }
-    
     if (m_formatCtx) {
         avformat_close_input(&m_formatCtx);
         m_formatCtx = nullptr;
@@ -278,24 +270,143 @@ void DecodeThread::closeFile()
     m_duration = 0;
     m_videoWidth = 0;
     m_videoHeight = 0;
+    m_frameDuration = 1.0 / 25;
+    m_hasVideo = false;
+    m_hasAudio = false;
+    m_pendingRecovery = -1;
+    m_waitKeyframe = false;
+#endif
+}
+
+/**
+ * @brief 创建并打开视频解码器（允许时先尝试硬件解码）
+ */
+bool DecodeThread::openVideoDecoder()
+{
+#if FFMPEG_AVAILABLE
+    AVCodecParameters *codecpar = m_formatCtx->streams[m_videoStreamIndex]->codecpar;
+    const AVCodec *codec = avcodec_find_decoder(codecpar->codec_id);
+    if (!codec) return false;
+    
+    // 分配解码器上下文
+    m_videoCodecCtx = avcodec_alloc_context3(codec);
+    avcodec_parameters_to_context(m_videoCodecCtx, codecpar);
+    
+    // 【重要】在 avcodec_open2 之前尝试初始化硬件解码
+    if (m_hardwareAllowed) {
+        initHardwareDecoder(codec);
+    }
+    m_bufferPools.install(m_videoCodecCtx);
+    
+    // 打开解码器
+    const bool opened = avcodec_open2(m_videoCodecCtx, codec, nullptr) >= 0;
+    m_metrics.setHardwareDecoding(opened && m_useHwDecode);
+    return opened;
+#else
+    return false;
+#endif
+}
+
+void DecodeThread::closeVideoDecoder()
+{
+#if FFMPEG_AVAILABLE
+    m_converter.reset();
+    m_frameParams = FrameParams();
+    
+    if (m_videoCodecCtx) {
+        avcodec_free_context(&m_videoCodecCtx);
+        m_videoCodecCtx = nullptr;
+    }
+    
+    if (m_hwDeviceCtx) {
+        av_buffer_unref(&m_hwDeviceCtx);
+        m_hwDeviceCtx = nullptr;
+    }
+    
     m_useHwDecode = false;
     m_hwPixFmt = AV_PIX_FMT_NONE;
+    m_metrics.setHardwareDecoding(false);
+#endif
+}
+
+void DecodeThread::requestRecovery(RecoveryAction action)
+{
+    m_pendingRecovery = static_cast<int>(action);
+    // 解码线程可能正阻塞在满队列上
+    wakeProducer();
+}
+
+/**
+ * @brief 唤醒阻塞在满队列上的解码线程
+ *
+ * 满队列等待不带超时：先持有队列锁再唤醒，保证解码线程要么已在等待中被唤醒，
+ * 要么尚未检查条件、随后看到新的 m_running / m_pendingRecovery。
+ */
+void DecodeThread::wakeProducer()
+{
+    {
+        QMutexLocker locker(&m_videoMutex);
+        m_videoCondition.wakeAll();
+    }
+    {
+        QMutexLocker locker(&m_audioMutex);
+        m_audioCondition.wakeAll();
+    }
+}
+
+/**
+ * @brief 在解码线程执行恢复动作
+ *
+ * 队列中的帧来自停滞之前，一并丢弃；之后视频从下一个关键帧重新开始。
+ */
+void DecodeThread::performRecovery(RecoveryAction action)
+{
+#if FFMPEG_AVAILABLE
+    switch (action) {
+    case RecoveryAction::FlushResync:
+        if (m_videoCodecCtx) avcodec_flush_buffers(m_videoCodecCtx);
+        if (m_audioCodecCtx) avcodec_flush_buffers(m_audioCodecCtx);
+        break;
+    case RecoveryAction::SoftwareFallback:
+        m_hardwareAllowed = false;
+        [[fallthrough]];
+    case RecoveryAction::ReopenDecoder:
+        if (m_videoStreamIndex < 0) break;
+        closeVideoDecoder();
+        if (!openVideoDecoder()) {
+            // 保持无解码器状态，看门狗会继续升级到重新打开文件
+            qWarning() << "恢复：重建视频解码器失败";
+            avcodec_free_context(&m_videoCodecCtx);
+            m_videoCodecCtx = nullptr;
+        }
+        break;
+    default:
+        break;
+    }
+    
+    flushQueues();
+    m_waitKeyframe = true;
+#else
+    Q_UNUSED(action)
 #endif
 }
 
 void DecodeThread::startDecoding()
 {
-    if (!m_running) {
-        m_running = true;
-        start();
+    if (m_running && isRunning()) return;
+    
+    // 上一轮在文件结尾自然退出时线程可能尚未完全结束：等待结束后重新启动
+    if (isRunning()) {
+        wait();
     }
+    m_running = true;
+    start();
 }
 
 void DecodeThread::stopDecoding()
 {
     m_running = false;
-    m_videoCondition.wakeAll();
-    m_audioCondition.wakeAll();
+    wakeProducer();
     if (isRunning()) {
         wait(1000);
         if (isRunning()) {
@@ -315,6 +426,14 @@ void DecodeThread::seekTo(double seconds)
 #endif
 }
 
+void DecodeThread::setOutputSize(const QSize &size)
+{
+    // 宽高打包为一个原子量，解码线程不会读到新宽度配旧高度
+    const quint64 packed = size.isValid()
+        ? (quint64(quint32(size.width())) << 32) | quint32(size.height()) : 0;
+    m_outputSize.store(packed, std::memory_order_relaxed);
+}
+
 QAudioFormat DecodeThread::audioFormat() const
 {
     QAudioFormat format;
@@ -332,6 +451,7 @@ bool DecodeThread::getVideoFrame(VideoFrame &frame)
     }
     frame = m_videoQueue.dequeue();
     m_videoCondition.wakeOne();
+    m_metrics.setVideoQueueDepth(m_videoQueue.size());
     return true;
 }
 
@@ -343,6 +463,7 @@ bool DecodeThread::getAudioFrame(AudioFrame &frame)
     }
     frame = m_audioQueue.dequeue();
     m_audioCondition.wakeOne();
+    m_metrics.setAudioQueueDepth(m_audioQueue.size());
     return true;
 }
 
@@ -353,16 +474,6 @@ void DecodeThread::run()
     
     AVPacket *packet = av_packet_alloc();
     AVFrame *frame = av_frame_alloc();
-    AVFrame *rgbFrame = av_frame_alloc();
-    
-    // 为 RGB 帧分配缓冲区
-    int rgbBufferSize = av_image_get_buffer_size(AV_PIX_FMT_RGB32, m_videoWidth, m_videoHeight, 1);
-    uint8_t *rgbBuffer = static_cast<uint8_t*>(av_malloc(rgbBufferSize));
-    av_image_fill_arrays(rgbFrame->data, rgbFrame->linesize, rgbBuffer, 
-                         AV_PIX_FMT_RGB32, m_videoWidth, m_videoHeight, 1);
-    
-    // 用于记录上一帧的像素格式，以便在格式变化时重新创建 sws 上下文
-    AVPixelFormat lastPixFmt = AV_PIX_FMT_NONE;
     
     // 性能计时
     g_perfTimer.start();
@@ -382,15 +493,38 @@ void DecodeThread::run()
             m_seeking = false;
         }
         
+        // 看门狗请求的恢复动作
+        const int recovery = m_pendingRecovery.exchange(-1);
+        if (recovery >= 0) {
+            performRecovery(static_cast<RecoveryAction>(recovery));
+        }
+        
         // 读取数据包
         int ret = av_read_frame(m_formatCtx, packet);
         if (ret < 0) {
             if (ret == AVERROR_EOF) {
+                // 先清除运行标志，收到 decodingFinished 后可立即重新 startDecoding
+                m_running = false;
+                m_metrics.addLoop();
                 emit decodingFinished();
             }
             break;
         }
         
+        if (packet->pts != AV_NOPTS_VALUE) {
+            m_metrics.markProgress(PipelineStage::Demux,
+                                   packet->pts * av_q2d(m_formatCtx->streams[packet->stream_index]->time_base));
+        }
+        
+        // 恢复后从关键帧重新开始，之前的非关键帧缺少参考帧
+        if (m_waitKeyframe && packet->stream_index == m_videoStreamIndex) {
+            if (!(packet->flags & AV_PKT_FLAG_KEY)) {
+                av_packet_unref(packet);
+                continue;
+            }
+            m_waitKeyframe = false;
+        }
+        
         // ========================================
         // 视频解码
         // ========================================
@@ -405,18 +539,24 @@ void DecodeThread::run()
                 
                 qint64 t1 = g_perfTimer.nsecsElapsed();
                 g_decodeTime += (t1 - t0);
+                m_metrics.addDecodeTime((t1 - t0) / 1000.0);
                 
                 // 处理帧 - 可能是硬件帧或软件帧
                 AVFrame *srcFrame = frame;
                 AVFrame *swFrame = nullptr;
+                MemoryCharge transferCharge;
                 
                 // 如果是硬件帧，需要先传输到 CPU
                 if (m_useHwDecode && frame->format == m_hwPixFmt) {
                     swFrame = transferHwFrame(frame);
                     if (swFrame) {
                         srcFrame = swFrame;
+                        transferCharge = MemoryCharge(&m_metrics.memory(), MemoryCategory::ConversionBuffers,
+                            av_image_get_buffer_size(static_cast<AVPixelFormat>(swFrame->format),
+                                                     swFrame->width, swFrame->height, 1));
                     } else {
-                        // 传输失败，跳过这一帧
+                        // 传输失败，跳过这一帧（持续失败时由看门狗回退软件解码）
+                        m_metrics.addHwTransferFailure();
                         continue;
                     }
                 }
@@ -424,27 +564,43 @@ void DecodeThread::run()
                 qint64 t2 = g_perfTimer.nsecsElapsed();
                 g_transferTime += (t2 - t1);
                 
-                // 检查像素格式是否变化，需要重新创建 sws 上下文
+                // 流中途改变分辨率 / 格式：只重新选择转换函数，不重开解码器、不清空队列
+                if (m_frameParams.update(frame, "DecodeThread")) {
+                    m_metrics.addReconfiguration();
+                }
+                const QSize srcSize(srcFrame->width, srcFrame->height);
+                if (srcSize != QSize(m_videoWidth, m_videoHeight)) {
+                    m_videoWidth = srcSize.width();
+                    m_videoHeight = srcSize.height();
+                    emit videoSizeChanged(srcSize);
+                }
+                
+                // 输出尺寸：显示区域尺寸（由 GUI 线程设置），缩放在颜色转换中一次完成
+                const quint64 packedSize = m_outputSize.load(std::memory_order_relaxed);
+                QSize outputSize(int(packedSize >> 32), int(packedSize & 0xffffffffu));
+                if (outputSize.isEmpty()) {
+                    outputSize = srcSize;
+                }
+                const bool nv12 = (m_outputFormat == FrameFormat::NV12);
+                if (nv12) {
+                    // NV12 色度 2x2 采样，宽高必须为偶数
+                    outputSize = QSize(outputSize.width() & ~1, outputSize.height() & ~1);
+                }
+                
+                // 源格式或输出尺寸变化时才重新选择转换函数，每帧只是一次间接调用
+                // （取值范围取自解码帧：硬件帧传输到 CPU 时不复制帧属性）
                 AVPixelFormat pixFmt = static_cast<AVPixelFormat>(srcFrame->format);
-                if (pixFmt != lastPixFmt) {
-                    if (m_swsCtx) {
-                        sws_freeContext(m_swsCtx);
+                if (!m_converter.configure(pixFmt, srcSize,
+                                           nv12 ? FrameFormat::NV12 : FrameFormat::RGB32,
+                                           outputSize, frame->color_range)) {
+                    if (swFrame) {
+                        av_frame_free(&swFrame);
                     }
-                    // 使用 SWS_FAST_BILINEAR 提升性能
-                    m_swsCtx = sws_getContext(
-                        m_videoWidth, m_videoHeight, pixFmt,
-                        m_videoWidth, m_videoHeight, AV_PIX_FMT_RGB32,
-                        SWS_FAST_BILINEAR, nullptr, nullptr, nullptr
-                    );
-                    lastPixFmt = pixFmt;
-                    qDebug() << "创建 sws 上下文，源格式:" << av_get_pix_fmt_name(pixFmt);
+                    continue;
                 }
                 
-                // 转换为 RGB
-                if (m_swsCtx) {
-                    sws_scale(m_swsCtx, srcFrame->data, srcFrame->linesize, 0, m_videoHeight,
-                             rgbFrame->data, rgbFrame->linesize);
-                }
+                // 直接转换到新分配的 QImage，无需再深拷贝
+                QImage image = m_converter.convert(srcFrame);
                 
                 qint64 t3 = g_perfTimer.nsecsElapsed();
                 g_scaleTime += (t3 - t2);
@@ -456,12 +612,10 @@ void DecodeThread::run()
                     pts = srcFrame->pts * av_q2d(stream->time_base);
                 }
                 
-                // 创建 QImage - 使用浅拷贝 + 移动语义优化
-                QImage image(rgbFrame->data[0], m_videoWidth, m_videoHeight, 
-                            rgbFrame->linesize[0], QImage::Format_RGB32);
-                
                 VideoFrame vf;
-                vf.image = image.copy();  // 必须深拷贝，因为 rgbBuffer 会被复用
+                vf.charge = MemoryCharge::shared(m_metrics.memory(), MemoryCategory::FrameQueue,
+                                                 image.sizeInBytes());
+                vf.image = std::move(image);
                 vf.pts = pts;
                 
                 qint64 t4 = g_perfTimer.nsecsElapsed();
@@ -482,8 +636,8 @@ void DecodeThread::run()
                     qDebug() << "FPS:" << QString::number(fps, 'f', 1);
                     qDebug() << "解码:" << (g_decodeTime / 1000000) << "ms";
                     qDebug() << "GPU→CPU:" << (g_transferTime / 1000000) << "ms";
-                    qDebug() << "sws_scale:" << (g_scaleTime / 1000000) << "ms";
-                    qDebug() << "QImage拷贝:" << (g_copyTime / 1000000) << "ms";
+                    qDebug() << "颜色转换:" << (g_scaleTime / 1000000) << "ms";
+                    qDebug() << "入队:" << (g_copyTime / 1000000) << "ms";
                     qDebug() << "队列大小:" << m_videoQueue.size();
                     qDebug() << "=======================================";
                     // 重置计时
@@ -495,11 +649,14 @@ void DecodeThread::run()
                 // 加入队列（等待如果队列满）
                 {
                     QMutexLocker locker(&m_videoMutex);
-                    while (m_videoQueue.size() >= MAX_VIDEO_QUEUE_SIZE && m_running) {
-                        m_videoCondition.wait(&m_videoMutex, 10);
+                    while (m_videoQueue.size() >= MAX_VIDEO_QUEUE_SIZE && m_running
+                           && m_pendingRecovery < 0) {
+                        m_videoCondition.wait(&m_videoMutex);
                     }
-                    if (m_running) {
+                    if (m_running && m_pendingRecovery < 0) {
                         m_videoQueue.enqueue(vf);
+                        m_metrics.addVideoFrame(m_videoQueue.size());
+                        m_metrics.markProgress(PipelineStage::Decode, pts);
                     }
                 }
                 
@@ -542,14 +699,18 @@ void DecodeThread::run()
                     AudioFrame af;
                     af.data = audioData;
                     af.pts = pts;
+                    af.charge = MemoryCharge::shared(m_metrics.memory(), MemoryCategory::AudioBuffers,
+                                                     audioData.size());
                     
                     {
                         QMutexLocker locker(&m_audioMutex);
-                        while (m_audioQueue.size() >= MAX_AUDIO_QUEUE_SIZE && m_running) {
-                            m_audioCondition.wait(&m_audioMutex, 10);
+                        while (m_audioQueue.size() >= MAX_AUDIO_QUEUE_SIZE && m_running
+                               && m_pendingRecovery < 0) {
+                            m_audioCondition.wait(&m_audioMutex);
                         }
-                        if (m_running) {
+                        if (m_running && m_pendingRecovery < 0) {
                             m_audioQueue.enqueue(af);
+                            m_metrics.addAudioFrame(m_audioQueue.size());
                         }
                     }
                 }
@@ -559,8 +720,6 @@ void DecodeThread::run()
         av_packet_unref(packet);
     }
     
-    av_free(rgbBuffer);
-    av_frame_free(&rgbFrame);
     av_frame_free(&frame);
     av_packet_free(&packet);
 #endif
@@ -589,6 +748,7 @@ FFmpegPlayer::FFmpegPlayer(QObject *parent)
     connect(m_decodeThread, &DecodeThread::fileOpened, this, &FFmpegPlayer::onFileOpened);
     connect(m_decodeThread, &DecodeThread::decodingFinished, this, &FFmpegPlayer::onDecodingFinished);
     connect(m_decodeThread, &DecodeThread::errorOccurred, this, &FFmpegPlayer::onDecodeError);
+    connect(m_decodeThread, &DecodeThread::videoSizeChanged, this, &FFmpegPlayer::videoSizeChanged);
     
     // 视频定时器
     m_videoTimer = new QTimer(this);
@@ -599,6 +759,10 @@ FFmpegPlayer::FFmpegPlayer(QObject *parent)
     m_audioTimer = new QTimer(this);
     m_audioTimer->setTimerType(Qt::PreciseTimer);
     connect(m_audioTimer, &QTimer::timeout, this, &FFmpegPlayer::processAudio);
+    
+    // 停滞看门狗：动作在 GUI 线程下发，解码器相关的由解码线程执行
+    m_watchdog = new PipelineWatchdog(m_decodeThread->metrics(), this);
+    m_watchdog->setRecoveryHandler([this](RecoveryAction action) { return runRecovery(action); });
 }
 
 FFmpegPlayer::~FFmpegPlayer()
@@ -607,15 +771,16 @@ FFmpegPlayer::~FFmpegPlayer()
     cleanupAudio();
 }
 
-void FFmpegPlayer::loadFile(const QString &filename)
+bool FFmpegPlayer::loadFile(const QString &filename)
 {
     stop();
     m_currentFile = filename;
+    m_decodeThread->setHardwareDecodingAllowed(true);
     
-    if (m_decodeThread->openFile(filename)) {
-        m_duration = m_decodeThread->duration();
-        emit durationChanged(m_duration);
-    }
+    if (!m_decodeThread->openFile(filename)) return false;
+    m_duration = m_decodeThread->duration();
+    emit durationChanged(m_duration);
+    return true;
 }
 
 void FFmpegPlayer::play()
@@ -627,8 +792,12 @@ void FFmpegPlayer::play()
             // 重新打开文件
             m_decodeThread->openFile(m_currentFile);
         }
-        setupAudio();
+        // 先启动解码，音频设备打开与首批解码并行
         m_decodeThread->startDecoding();
+        if (m_decodeThread->hasAudio()) {
+            setupAudio();
+            StartupTimeline::mark("audio ready");
+        }
     }
     
     m_startTime = QDateTime::currentMSecsSinceEpoch() - static_cast<qint64>(m_currentPosition * 1000);
@@ -638,6 +807,7 @@ void FFmpegPlayer::play()
     m_audioTimer->start(5);   // 音频处理更频繁
     
     setState(PlayingState);
+    armWatchdog();
 }
 
 void FFmpegPlayer::pause()
@@ -646,6 +816,9 @@ void FFmpegPlayer::pause()
     
     m_videoTimer->stop();
     m_audioTimer->stop();
+    m_watchdog->disarm();
+    m_decodeThread->metrics().audio().reset();
+    m_decodeThread->metrics().resetPresentation();
     
     setState(PausedState);
 }
@@ -654,6 +827,7 @@ void FFmpegPlayer::stop()
 {
     m_videoTimer->stop();
     m_audioTimer->stop();
+    m_watchdog->disarm();
     
     m_decodeThread->stopDecoding();
     cleanupAudio();
@@ -682,6 +856,9 @@ void FFmpegPlayer::seek(double seconds)
     m_startTime = QDateTime::currentMSecsSinceEpoch() - static_cast<qint64>(seconds * 1000);
     
     m_decodeThread->seekTo(seconds);
+    m_watchdog->resetProgress();
+    m_decodeThread->metrics().audio().reset();
+    m_decodeThread->metrics().resetPresentation();
     emit positionChanged(seconds);
 }
 
@@ -703,6 +880,16 @@ int FFmpegPlayer::videoHeight() const
     return m_decodeThread->videoHeight();
 }
 
+void FFmpegPlayer::setOutputSize(const QSize &size)
+{
+    m_decodeThread->setOutputSize(size);
+}
+
+void FFmpegPlayer::setOutputFormat(FrameFormat format)
+{
+    m_decodeThread->setOutputFormat(format);
+}
+
 void FFmpegPlayer::onFileOpened()
 {
     m_duration = m_decodeThread->duration();
@@ -735,12 +922,30 @@ void FFmpegPlayer::processVideo()
     if (m_state != PlayingState) return;
     
     VideoFrame frame;
+    
+    // 恢复后的第一帧直接显示，并以它为新的时钟起点（跳到关键帧后 PTS 会向前跳）
+    if (m_resyncVideo && m_decodeThread->getVideoFrame(frame)) {
+        m_resyncVideo = false;
+        m_currentPosition = frame.pts;
+        m_startTime = QDateTime::currentMSecsSinceEpoch() - static_cast<qint64>(frame.pts * 1000);
+        PlaybackMetrics &metrics = m_decodeThread->metrics();
+        metrics.markProgress(PipelineStage::Present, frame.pts);
+        metrics.resetPresentation();
+        metrics.addPresentedFrame(frame.pts);
+        emit positionChanged(m_currentPosition);
+        emit frameReady(frame.image);
+        StartupTimeline::firstFrame();
+        return;
+    }
+    
+    PlaybackMetrics &metrics = m_decodeThread->metrics();
     while (m_decodeThread->getVideoFrame(frame)) {
         // 使用音频时钟进行同步
         double targetTime = (m_audioClock > 0) ? m_audioClock : m_currentPosition;
         
         // 如果帧太旧，跳过
         if (frame.pts < targetTime - 0.1) {
+            metrics.addDroppedFrames(1);
             continue;
         }
         
@@ -751,8 +956,14 @@ void FFmpegPlayer::processVideo()
         }
         
         m_currentPosition = frame.pts;
+        metrics.markProgress(PipelineStage::Present, frame.pts);
+        metrics.addPresentedFrame(frame.pts);
+        if (m_audioClock > 0) {
+            metrics.setAvOffset((frame.pts - m_audioClock) * 1000.0);
+        }
         emit positionChanged(m_currentPosition);
         emit frameReady(frame.image);
+        StartupTimeline::firstFrame();
         break;
     }
 }
@@ -761,8 +972,13 @@ void FFmpegPlayer::processAudio()
 {
     if (m_state != PlayingState || !m_audioDevice) return;
     
+    AudioTelemetry &telemetry = m_decodeThread->metrics().audio();
+    telemetry.beginWrite();
+    
     AudioFrame frame;
+    bool gotFrame = false;
     while (m_decodeThread->getAudioFrame(frame)) {
+        gotFrame = true;
         // 应用音量
         if (m_volume < 100) {
             int16_t *samples = reinterpret_cast<int16_t*>(frame.data.data());
@@ -778,6 +994,17 @@ void FFmpegPlayer::processAudio()
         // 更新音频时钟
         m_audioClock = frame.pts + static_cast<double>(frame.data.size()) / (44100 * 2 * 2);
     }
+    
+    // 设备消耗进度：已播放时长前进，或数据已播完处于空闲（欠载不算设备故障）
+    const qint64 processed = m_audioSink->processedUSecs();
+    if (processed != m_lastAudioProcessed || m_audioSink->state() == QAudio::IdleState) {
+        m_lastAudioProcessed = processed;
+        m_decodeThread->metrics().markProgress(PipelineStage::Audio, processed * (44100 * 2 * 2) / 1e6);
+    }
+    
+    // 解码帧全部直接写入设备：本次没有取到帧说明解码没跟上
+    const qint64 bufferedBytes = m_audioSink->bufferSize() - m_audioSink->bytesFree();
+    telemetry.endWrite(bufferedBytes * 1000.0 / (44100 * 2 * 2), !gotFrame, processed / 1e6);
 }
 
 void FFmpegPlayer::setupAudio()
@@ -793,6 +1020,14 @@ void FFmpegPlayer::setupAudio()
     m_audioSink = std::make_unique<QAudioSink>(format);
     m_audioSink->setVolume(m_volume / 100.0);
     m_audioDevice = m_audioSink->start();
+    m_lastAudioProcessed = -1;
+    
+    m_audioSinkCharge = MemoryCharge(&m_decodeThread->metrics().memory(), MemoryCategory::AudioBuffers,
+                                     m_audioSink->bufferSize());
+    
+    AudioTelemetry &telemetry = m_decodeThread->metrics().audio();
+    telemetry.setDeviceLatency(m_audioSink->bufferSize() * 1000.0 / (44100 * 2 * 2));
+    telemetry.reset();
 }
 
 void FFmpegPlayer::cleanupAudio()
@@ -802,6 +1037,57 @@ void FFmpegPlayer::cleanupAudio()
         m_audioSink.reset();
     }
     m_audioDevice = nullptr;
+    m_audioSinkCharge = MemoryCharge();
+}
+
+void FFmpegPlayer::armWatchdog()
+{
+    m_watchdog->arm(m_decodeThread->frameDuration(),
+                    m_decodeThread->hasVideo(),
+                    m_decodeThread->hasAudio() && m_audioDevice);
+}
+
+/**
+ * @brief 执行看门狗下发的恢复动作
+ * @return false 表示动作不适用，看门狗直接升级
+ */
+bool FFmpegPlayer::runRecovery(RecoveryAction action)
+{
+    switch (action) {
+    case RecoveryAction::SoftwareFallback:
+        if (!m_decodeThread->isHardwareDecoding()) {
+            return false;
+        }
+        [[fallthrough]];
+    case RecoveryAction::FlushResync:
+    case RecoveryAction::ReopenDecoder:
+        m_decodeThread->requestRecovery(action);
+        // 读包出错退出的解码线程在这里重新启动；运行中时为空操作
+        m_decodeThread->startDecoding();
+        break;
+    case RecoveryAction::ReopenFile: {
+        // 解码线程可能卡在解码器内部：停止（必要时强制结束）后从停滞位置重新打开
+        const double position = m_currentPosition;
+        if (!m_decodeThread->openFile(m_currentFile)) {
+            return false;
+        }
+        m_decodeThread->seekTo(position);
+        m_decodeThread->startDecoding();
+        break;
+    }
+    case RecoveryAction::ReopenAudio:
+        setupAudio();
+        if (!m_audioDevice) {
+            // 没有可用设备：放弃音频时钟，视频按自身时钟继续
+            m_audioClock = 0;
+            return false;
+        }
+        return true;
+    }
+    
+    m_audioClock = 0;
+    m_resyncVideo = true;
+    return true;
 }
 
 void FFmpegPlayer::setState(PlaybackState state)
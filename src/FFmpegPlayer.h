@@ -13,6 +13,11 @@
 #include <memory>
 #include <atomic>
 
+#include "FrameConverter.h"
+#include "PlaybackMetrics.h"
+
+class PipelineWatchdog;
+
 #if FFMPEG_AVAILABLE
 extern "C" {
 #include <libavcodec/avcodec.h>
@@ -31,6 +36,7 @@ extern "C" {
 struct VideoFrame {
     QImage image;
     double pts = 0;  // 显示时间戳（秒）
+    std::shared_ptr<MemoryCharge> charge;  // 帧内存记账，最后一个副本释放时归还
 };
 
 /**
@@ -39,6 +45,7 @@ struct VideoFrame {
 struct AudioFrame {
     QByteArray data;
     double pts = 0;
+    std::shared_ptr<MemoryCharge> charge;
 };
 
 /**
@@ -58,10 +65,42 @@ public:
     void stopDecoding();
     void seekTo(double seconds);
     
+    /**
+     * @brief 请求解码线程执行恢复动作（在下一次读包前执行）
+     *
+     * 只处理 FlushResync / ReopenDecoder / SoftwareFallback，之后丢弃视频包直到下一个关键帧。
+     */
+    void requestRecovery(RecoveryAction action);
+    
+    /**
+     * @brief 是否允许硬件解码（回退软件解码后对重新打开同样生效）
+     */
+    void setHardwareDecodingAllowed(bool allowed) { m_hardwareAllowed = allowed; }
+    bool isHardwareDecoding() const { return m_useHwDecode; }
+    
+    /**
+     * @brief 设置输出尺寸（sws_scale 直接缩放到显示尺寸）
+     * @param size 目标尺寸，无效尺寸表示保持原始分辨率
+     */
+    void setOutputSize(const QSize &size);
+    
+    /**
+     * @brief 设置输出像素格式（需在开始解码前设置）
+     */
+    void setOutputFormat(FrameFormat format) { m_outputFormat = format; }
+    
     double duration() const { return m_duration; }
+    double frameDuration() const { return m_frameDuration; }
+    bool hasVideo() const { return m_hasVideo; }
+    bool hasAudio() const { return m_hasAudio; }
     int videoWidth() const { return m_videoWidth; }
     int videoHeight() const { return m_videoHeight; }
     
+    /**
+     * @brief 运行指标（任意线程可读取快照）
+     */
+    PlaybackMetrics &metrics() { return m_metrics; }
+    
     // 获取解码后的帧
     bool getVideoFrame(VideoFrame &frame);
     bool getAudioFrame(AudioFrame &frame);
@@ -72,6 +111,7 @@ public:
 signals:
     void fileOpened();
     void decodingFinished();
+    void videoSizeChanged(const QSize &size);   ///< 流中途分辨率变化（解码线程发出）
     void errorOccurred(const QString &error);
 
 protected:
@@ -80,26 +120,39 @@ protected:
 private:
     void decodePacket();
     void flushQueues();
+    void wakeProducer();
     bool initHardwareDecoder(const AVCodec *codec);
     AVFrame* transferHwFrame(AVFrame *hwFrame);  // 从 GPU 转移帧到 CPU
+    bool openVideoDecoder();
+    void closeVideoDecoder();
+    void performRecovery(RecoveryAction action);
 
 #if FFMPEG_AVAILABLE
     AVFormatContext *m_formatCtx = nullptr;
     AVCodecContext *m_videoCodecCtx = nullptr;
     AVCodecContext *m_audioCodecCtx = nullptr;
-    SwsContext *m_swsCtx = nullptr;
+    FrameConverter m_converter;     // 按流选定的颜色转换/缩放
+    FrameParams m_frameParams;      // 最近解码帧的尺寸 / 格式（仅解码线程访问）
     SwrContext *m_swrCtx = nullptr;
     AVBufferRef *m_hwDeviceCtx = nullptr;  // 硬件设备上下文
     AVPixelFormat m_hwPixFmt = AV_PIX_FMT_NONE;  // 硬件像素格式
     
     int m_videoStreamIndex = -1;
     int m_audioStreamIndex = -1;
-    bool m_useHwDecode = false;  // 是否使用硬件解码
 #endif
+    std::atomic<bool> m_useHwDecode{false};     // 是否使用硬件解码
+    std::atomic<bool> m_hardwareAllowed{true};
+
+    // 看门狗恢复：GUI 线程请求，解码线程执行
+    std::atomic<int> m_pendingRecovery{-1};
+    bool m_waitKeyframe = false;                // 丢弃视频包直到关键帧（仅解码线程访问）
 
     double m_duration = 0;
-    int m_videoWidth = 0;
-    int m_videoHeight = 0;
+    double m_frameDuration = 1.0 / 25;
+    bool m_hasVideo = false;
+    bool m_hasAudio = false;
+    std::atomic<int> m_videoWidth{0};   // 流中途重配置时由解码线程更新
+    std::atomic<int> m_videoHeight{0};
     int m_audioSampleRate = 44100;
     int m_audioChannels = 2;
     
@@ -115,6 +168,15 @@ private:
     std::atomic<bool> m_seeking{false};
     double m_seekTarget = 0;
     
+    // 输出尺寸（宽 << 32 | 高，0 表示原始分辨率），GUI 线程写、解码线程读
+    std::atomic<quint64> m_outputSize{0};
+    std::atomic<FrameFormat> m_outputFormat{FrameFormat::RGB32};
+    
+    PlaybackMetrics m_metrics;
+#if FFMPEG_AVAILABLE
+    AccountedBufferPools m_bufferPools{m_metrics.memory()};  // 软件解码帧缓冲池（计入内存记账）
+#endif
+    
     static constexpr int MAX_VIDEO_QUEUE_SIZE = 30;
     static constexpr int MAX_AUDIO_QUEUE_SIZE = 100;
 };
@@ -145,8 +207,9 @@ public:
 
     /**
      * @brief 加载视频文件
+     * @return 打开失败时返回 false（同时发出 errorOccurred）
      */
-    void loadFile(const QString &filename);
+    bool loadFile(const QString &filename);
 
     /**
      * @brief 播放控制
@@ -193,11 +256,27 @@ public:
     int videoWidth() const;
     int videoHeight() const;
 
+    /**
+     * @brief 设置视频帧输出尺寸（通常为显示区域的设备像素尺寸）
+     */
+    void setOutputSize(const QSize &size);
+
+    /**
+     * @brief 设置视频帧输出格式（NV12 用于 KMS overlay 平面直接扫描输出）
+     */
+    void setOutputFormat(FrameFormat format);
+
+    /**
+     * @brief 运行指标（解码计数、停滞恢复、音频遥测）
+     */
+    PlaybackMetrics &metrics() { return m_decodeThread->metrics(); }
+
 signals:
     void positionChanged(double seconds);
     void durationChanged(double seconds);
     void stateChanged(PlaybackState state);
     void fileLoaded();
+    void videoSizeChanged(const QSize &size);
     void endOfFile();
     void errorOccurred(const QString &error);
     void frameReady(const QImage &frame);
@@ -213,6 +292,8 @@ private:
     void setupAudio();
     void cleanupAudio();
     void setState(PlaybackState state);
+    void armWatchdog();
+    bool runRecovery(RecoveryAction action);
 
     DecodeThread *m_decodeThread = nullptr;
     
@@ -233,6 +314,12 @@ private:
     
     QString m_currentFile;
     qint64 m_startTime = 0;  // 播放开始时间
+    MemoryCharge m_audioSinkCharge;     // 音频设备缓冲
+    
+    // 停滞看门狗
+    PipelineWatchdog *m_watchdog = nullptr;
+    bool m_resyncVideo = false;         // 恢复后下一帧直接显示并重设时钟
+    qint64 m_lastAudioProcessed = -1;   // 上次读到的设备已播放时长（微秒）
 };
 
 #endif // FFMPEGPLAYER_H
@@ -1,5 +1,7 @@
 #include "FloatingVideoPlayer.h"
-#include "D3D11Renderer.h"
+#include "ProxyCache.h"
+#include "SessionResume.h"
+#include "VideoRendererBase.h"
 
 #include <QVBoxLayout>
 #include <QHBoxLayout>
@@ -16,6 +18,9 @@
 #include <QMimeData>
 #include <QDragEnterEvent>
 #include <QDropEvent>
+#include <QCloseEvent>
+#include <QDebug>
+#include <QStyle>
 
 FloatingVideoPlayer::FloatingVideoPlayer(QWidget *parent)
     : QWidget(parent)
@@ -53,53 +58,23 @@ void FloatingVideoPlayer::setupUI()
     mainLayout->setContentsMargins(EDGE_MARGIN, EDGE_MARGIN, EDGE_MARGIN, EDGE_MARGIN);
     mainLayout->setSpacing(0);
 
-    // 硬件加速视频组件
-#ifdef _WIN32
-    renderer = new D3D11Renderer(this);
-#elif defined(__APPLE__)
-    renderer = new OpenGLRenderer(this);
-#else
-    renderer = new OpenGLRenderer(this);
-#endif
+    // 硬件加速视频组件（Windows: D3D11，macOS/Linux: Qt RHI）
+    renderer = createVideoRenderer(this);
     renderer->setMouseTracking(true);
     mainLayout->addWidget(renderer);
 
-#ifdef _WIN32
-    connect(renderer, &D3D11Renderer::positionChanged,
+    connect(renderer, &VideoRendererBase::positionChanged,
         this, &FloatingVideoPlayer::onPositionChanged);
-    connect(renderer, &D3D11Renderer::durationChanged,
+    connect(renderer, &VideoRendererBase::durationChanged,
         this, &FloatingVideoPlayer::onDurationChanged);
-    connect(renderer, &D3D11Renderer::playbackStateChanged,
+    connect(renderer, &VideoRendererBase::playbackStateChanged,
         this, &FloatingVideoPlayer::onPlaybackStateChanged);
-    connect(renderer, &D3D11Renderer::fileLoaded,
+    connect(renderer, &VideoRendererBase::fileLoaded,
         this, &FloatingVideoPlayer::onFileLoaded);
-    connect(renderer, &D3D11Renderer::errorOccurred,
+    connect(renderer, &VideoRendererBase::errorOccurred,
         this, &FloatingVideoPlayer::onErrorOccurred);
-#elif defined(__APPLE__)
-    connect(renderer, &MetalRenderer::positionChanged,
-        this, &FloatingVideoPlayer::onPositionChanged);
-    connect(renderer, &MetalRenderer::durationChanged,
-        this, &FloatingVideoPlayer::onDurationChanged);
-    connect(renderer, &MetalRenderer::playbackStateChanged,
-        this, &FloatingVideoPlayer::onPlaybackStateChanged);
-    connect(renderer, &MetalRenderer::fileLoaded,
-        this, &FloatingVideoPlayer::onFileLoaded);
-    connect(renderer, &MetalRenderer::errorOccurred,
-        this, &FloatingVideoPlayer::onErrorOccurred);
-#else
-    connect(renderer, &OpenGLRenderer::positionChanged,
-        this, &FloatingVideoPlayer::onPositionChanged);
-    connect(renderer, &OpenGLRenderer::durationChanged,
-        this, &FloatingVideoPlayer::onDurationChanged);
-    connect(renderer, &OpenGLRenderer::playbackStateChanged,
-        this, &FloatingVideoPlayer::onPlaybackStateChanged);
-    connect(renderer, &OpenGLRenderer::fileLoaded,
-        this, &FloatingVideoPlayer::onFileLoaded);
-    connect(renderer, &OpenGLRenderer::errorOccurred,
-        this, &FloatingVideoPlayer::onErrorOccurred);
-#endif
-
-   
+    connect(renderer, &VideoRendererBase::firstFrameShown,
+        this, &FloatingVideoPlayer::hideSnapshot);
 
     // 创建控制栏
     createControlBar();
@@ -158,9 +133,13 @@ void FloatingVideoPlayer::createControlBar()
     m_progressSlider->setRange(0, 1000);
     connect(m_progressSlider, &QSlider::sliderPressed, [this]() {
         m_isSliderDragging = true;
+        // 拖动期间暂停代理生成，预览解码与跳转优先
+        if (m_proxyBuilder) m_proxyBuilder->setPaused(true);
     });
     connect(m_progressSlider, &QSlider::sliderReleased, [this]() {
         m_isSliderDragging = false;
+        if (m_scrubPreview) m_scrubPreview->hide();
+        if (m_proxyBuilder) m_proxyBuilder->setPaused(false);
         if (m_duration > 0) {
             double seekPos = (m_progressSlider->value() / 1000.0) * m_duration;
             renderer->seek(seekPos);
@@ -173,6 +152,7 @@ void FloatingVideoPlayer::createControlBar()
                 .arg(formatTime(pos))
                 .arg(formatTime(m_duration)));
         }
+        showScrubPreview(value);
     });
     controlLayout->addWidget(m_progressSlider);
 
@@ -288,6 +268,23 @@ void FloatingVideoPlayer::createContextMenu()
         });
     }
 
+    // 呈现帧率上限：小窗口下 30 fps 已足够，解码与转换按比例减少（软件渲染器不支持，菜单禁用）
+    auto *rateMenu = m_contextMenu->addMenu("⏱ 帧率上限");
+    rateMenu->setEnabled(renderer->supportsMaxPresentRate());
+    m_presentRateGroup = new QActionGroup(this);
+    for (auto [name, fps] : {
+        std::pair{"不限制", 0.0}, {"30 fps", 30.0}, {"24 fps", 24.0}, {"15 fps", 15.0}
+    }) {
+        auto *action = rateMenu->addAction(name);
+        action->setCheckable(true);
+        action->setData(fps);
+        m_presentRateGroup->addAction(action);
+        if (fps == 0.0) action->setChecked(true);
+        connect(action, &QAction::triggered, [this, fps]() {
+            setMaxPresentRate(fps);
+        });
+    }
+
     // 窗口大小
     auto *sizeMenu = m_contextMenu->addMenu("📐 窗口大小");
     for (auto [name, size] : {
@@ -301,6 +298,32 @@ void FloatingVideoPlayer::createContextMenu()
         });
     }
 
+    // 画面几何（只改变顶点，不处理像素）
+    auto *geometryMenu = m_contextMenu->addMenu("🔄 画面");
+    auto updateGeometry = [this](auto &&change) {
+        VideoGeometry geometry = renderer->videoGeometry();
+        change(geometry);
+        renderer->setVideoGeometry(geometry);
+    };
+    connect(geometryMenu->addAction("顺时针旋转 90°"), &QAction::triggered, [updateGeometry]() {
+        updateGeometry([](VideoGeometry &g) { g.rotation = (g.rotation + 90) % 360; });
+    });
+    connect(geometryMenu->addAction("水平翻转"), &QAction::triggered, [updateGeometry]() {
+        updateGeometry([](VideoGeometry &g) { g.flipHorizontal = !g.flipHorizontal; });
+    });
+    connect(geometryMenu->addAction("垂直翻转"), &QAction::triggered, [updateGeometry]() {
+        updateGeometry([](VideoGeometry &g) { g.flipVertical = !g.flipVertical; });
+    });
+    geometryMenu->addSeparator();
+    for (auto [name, zoom] : { std::pair{"放大 1.5×", 1.5}, {"放大 2×", 2.0} }) {
+        connect(geometryMenu->addAction(name), &QAction::triggered, [updateGeometry, zoom]() {
+            updateGeometry([zoom](VideoGeometry &g) { g.zoom = zoom; g.pan = QPointF(); });
+        });
+    }
+    connect(geometryMenu->addAction("还原"), &QAction::triggered, [this]() {
+        renderer->setVideoGeometry(VideoGeometry());
+    });
+
     m_contextMenu->addSeparator();
 
     // 置顶
@@ -315,16 +338,28 @@ void FloatingVideoPlayer::createContextMenu()
         show();
     });
 
+    // 代理缓存
+    m_proxyAction = m_contextMenu->addAction("🎞 拖动预览（后台生成代理）");
+    m_proxyAction->setCheckable(true);
+    m_proxyAction->setChecked(m_proxyBuilder != nullptr);
+    connect(m_proxyAction, &QAction::triggered, this, &FloatingVideoPlayer::setProxyCacheEnabled);
+
     m_contextMenu->addSeparator();
 
     connect(m_contextMenu->addAction("❌ 退出"), &QAction::triggered, this, &QWidget::close);
 }
 
-void FloatingVideoPlayer::openVideo(const QString &filePath)
+void FloatingVideoPlayer::openVideo(const QString &filePath, double startPosition)
 {
     if (filePath.isEmpty()) return;
     
+    m_currentFile = filePath;
     renderer->loadFile(filePath);
+    if (startPosition > 0 && renderer->duration() > 0) {
+        // loadFile 返回时还没有帧上屏，跳转后第一帧即为恢复位置
+        renderer->seek(startPosition);
+    }
+    openScrubber();
     
     QFileInfo fileInfo(filePath);
     setWindowTitle(QString("Loop - %1").arg(fileInfo.fileName()));
@@ -400,8 +435,147 @@ void FloatingVideoPlayer::onFileLoaded()
     showControlBar();
 }
 
+PlaybackMetrics *FloatingVideoPlayer::metrics() const
+{
+    return renderer ? renderer->metrics() : nullptr;
+}
+
+void FloatingVideoPlayer::setProxyCacheEnabled(bool enabled)
+{
+    if (m_proxyAction) m_proxyAction->setChecked(enabled);
+    if (enabled == (m_proxyBuilder != nullptr)) return;
+
+    if (!enabled) {
+        // 析构时取消进行中的转码（未完成的 .part 会被删除）
+        delete m_proxyBuilder;
+        m_proxyBuilder = nullptr;
+        m_scrubber.reset();
+        if (m_scrubPreview) m_scrubPreview->hide();
+        return;
+    }
+
+    m_proxyBuilder = new ProxyBuilder(this);
+    // 代理按屏幕尺寸生成：全屏时的预览也不会比源文件模糊太多，更大则没有意义
+    if (auto *screen = QApplication::primaryScreen()) {
+        m_proxyBuilder->setMaxSize(screen->size() * screen->devicePixelRatio());
+    }
+    connect(m_proxyBuilder, &ProxyBuilder::proxyReady, this, [this](const QString &master, const QString &) {
+        if (master == m_currentFile) openScrubber();
+    });
+    openScrubber();
+}
+
+void FloatingVideoPlayer::setFrameCacheEnabled(bool enabled)
+{
+    renderer->setFrameCacheEnabled(enabled);
+}
+
+void FloatingVideoPlayer::setMaxPresentRate(double fps)
+{
+    if (!renderer->supportsMaxPresentRate()) {
+        qWarning() << "当前渲染器不支持呈现帧率上限，忽略:" << renderer->rendererName();
+        return;
+    }
+    renderer->setMaxPresentRate(fps);
+    for (QAction *action : m_presentRateGroup->actions()) {
+        action->setChecked(action->data().toDouble() == fps);
+    }
+}
+
+void FloatingVideoPlayer::openScrubber()
+{
+    if (!m_proxyBuilder || m_currentFile.isEmpty()) return;
+
+    const QString proxy = ProxyCache::lookup(m_currentFile);
+    if (proxy.isEmpty()) {
+        m_scrubber.reset();
+        m_proxyBuilder->enqueue(m_currentFile);
+        return;
+    }
+    if (m_scrubber && m_scrubber->path() == proxy) return;
+    if (!m_scrubber) m_scrubber = std::make_unique<ProxyScrubber>();
+    if (!m_scrubber->open(proxy)) {
+        qWarning() << "[代理] 无法打开:" << proxy;
+        m_scrubber.reset();
+    }
+}
+
+void FloatingVideoPlayer::showScrubPreview(int sliderValue)
+{
+    if (!m_scrubber || m_duration <= 0) return;
+
+    const qreal dpr = devicePixelRatioF();
+    const int previewWidth = qMin(SCRUB_PREVIEW_WIDTH, renderer->width() - 2 * EDGE_MARGIN);
+    const QImage image = m_scrubber->frameAt((sliderValue / 1000.0) * m_duration, qRound(previewWidth * dpr));
+    if (image.isNull()) return;
+
+    if (!m_scrubPreview) {
+        m_scrubPreview = new QLabel(this);
+        m_scrubPreview->setStyleSheet("background-color: black; border: 1px solid #3a3a5a;");
+        m_scrubPreview->setAttribute(Qt::WA_TransparentForMouseEvents);
+        if (renderer->testAttribute(Qt::WA_NativeWindow)) {
+            m_scrubPreview->setAttribute(Qt::WA_NativeWindow);
+        }
+    }
+    QPixmap pixmap = QPixmap::fromImage(image);
+    pixmap.setDevicePixelRatio(dpr);
+    m_scrubPreview->setPixmap(pixmap);
+    const QSize previewSize = pixmap.deviceIndependentSize().toSize();
+    m_scrubPreview->resize(previewSize);
+
+    // 预览居中对准滑块手柄，贴在控制栏上方
+    const int handleX = QStyle::sliderPositionFromValue(m_progressSlider->minimum(), m_progressSlider->maximum(),
+                                                        sliderValue, m_progressSlider->width());
+    const QPoint anchor = m_progressSlider->mapTo(this, QPoint(handleX, 0));
+    const int x = qBound(0, anchor.x() - previewSize.width() / 2, qMax(0, width() - previewSize.width()));
+    m_scrubPreview->move(x, qMax(0, m_controlBar->y() - previewSize.height() - 4));
+    m_scrubPreview->show();
+    m_scrubPreview->raise();
+}
+
+void FloatingVideoPlayer::showSnapshot(const QImage &snapshot)
+{
+    if (snapshot.isNull()) return;
+    
+    m_snapshot = QPixmap::fromImage(snapshot);
+    if (!m_snapshotOverlay) {
+        m_snapshotOverlay = new QLabel(this);
+        m_snapshotOverlay->setAlignment(Qt::AlignCenter);
+        m_snapshotOverlay->setStyleSheet("background-color: black;");
+        m_snapshotOverlay->setAttribute(Qt::WA_TransparentForMouseEvents);
+        // D3D11 渲染器是原生子窗口，覆盖层也需要原生窗口才能叠在其上
+        if (renderer->testAttribute(Qt::WA_NativeWindow)) {
+            m_snapshotOverlay->setAttribute(Qt::WA_NativeWindow);
+        }
+    }
+    layoutSnapshot();
+    m_snapshotOverlay->show();
+    m_snapshotOverlay->raise();
+    m_controlBar->raise();
+}
+
+void FloatingVideoPlayer::hideSnapshot()
+{
+    if (!m_snapshotOverlay) return;
+    m_snapshotOverlay->hide();
+    m_snapshotOverlay->deleteLater();
+    m_snapshotOverlay = nullptr;
+    m_snapshot = QPixmap();
+}
+
+void FloatingVideoPlayer::layoutSnapshot()
+{
+    if (!m_snapshotOverlay || !renderer) return;
+    m_snapshotOverlay->setGeometry(renderer->geometry());
+    const qreal dpr = devicePixelRatioF();
+    QPixmap scaled = m_snapshot.scaled(renderer->size() * dpr, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    scaled.setDevicePixelRatio(dpr);
+    m_snapshotOverlay->setPixmap(scaled);
+}
+
 void FloatingVideoPlayer::onErrorOccurred(const QString &error)
 {
+    hideSnapshot();
     QMessageBox::warning(this, "播放错误", error);
 }
 
@@ -550,6 +724,16 @@ void FloatingVideoPlayer::resizeEvent(QResizeEvent *event)
         m_controlBar->resize(renderer->width(), m_controlBar->height());
         m_controlBar->move(0, renderer->height() - m_controlBar->height());
     }
+    layoutSnapshot();
+}
+
+void FloatingVideoPlayer::closeEvent(QCloseEvent *event)
+{
+    // 记录本次会话：下次启动先显示这一帧，再从此位置继续
+    if (!m_currentFile.isEmpty()) {
+        SessionResume::save(m_currentFile, renderer->position(), renderer->grabFrame());
+    }
+    QWidget::closeEvent(event);
 }
 
 FloatingVideoPlayer::ResizeEdge FloatingVideoPlayer::detectEdge(const QPoint &pos)
@@ -8,8 +8,14 @@
 #include <QLabel>
 #include <QTimer>
 #include <QPushButton>
+#include <QPixmap>
+#include <memory>
 
-class D3D11Renderer;
+class VideoRendererBase;
+class PlaybackMetrics;
+class ProxyBuilder;
+class ProxyScrubber;
+class QActionGroup;
 
 /**
  * @brief 悬浮视频播放器窗口类
@@ -34,8 +40,34 @@ public:
     /**
      * @brief 打开并播放视频文件
      * @param filePath 视频文件路径
+     * @param startPosition 起始位置（秒），用于恢复上次会话
      */
-    void openVideo(const QString &filePath);
+    void openVideo(const QString &filePath, double startPosition = 0);
+
+    /**
+     * @brief 在第一帧上屏前显示上次退出时的画面快照
+     */
+    void showSnapshot(const QImage &snapshot);
+
+    /**
+     * @brief 渲染器的运行指标（供指标端点抓取），不支持时返回 nullptr
+     */
+    PlaybackMetrics *metrics() const;
+
+    /**
+     * @brief 启用后台代理生成：打开的文件在空闲时转码为全帧内代理，拖动进度条时显示预览帧
+     */
+    void setProxyCacheEnabled(bool enabled);
+
+    /**
+     * @brief 启用短循环磁盘帧缓存（只对之后打开的文件生效）
+     */
+    void setFrameCacheEnabled(bool enabled);
+
+    /**
+     * @brief 限制呈现帧率（0 表示不限制），音频不受影响
+     */
+    void setMaxPresentRate(double fps);
 
 public slots:
     void play();
@@ -58,6 +90,7 @@ protected:
     void resizeEvent(QResizeEvent *event) override;
     void dragEnterEvent(QDragEnterEvent *event) override;
     void dropEvent(QDropEvent *event) override;
+    void closeEvent(QCloseEvent *event) override;
 
 private slots:
     void onPositionChanged(double seconds);
@@ -65,6 +98,7 @@ private slots:
     void onPlaybackStateChanged(bool playing);
     void onFileLoaded();
     void onErrorOccurred(const QString &error);
+    void hideSnapshot();
     void hideControlBar();
     void showControlBar();
 
@@ -72,6 +106,9 @@ private:
     void setupUI();
     void createContextMenu();
     void createControlBar();
+    void layoutSnapshot();
+    void openScrubber();
+    void showScrubPreview(int sliderValue);
     QString formatTime(double seconds);
 
     // 边缘检测（用于调整窗口大小）
@@ -90,15 +127,8 @@ private:
     void updateCursor(ResizeEdge edge);
 
 private:
-    // 视频播放器 (硬件加速)
-#ifdef _WIN32
-    D3D11Renderer* renderer;
-#elif defined(__APPLE__)
-    // MetalRenderer *renderer = new MetalRenderer(this);  // TODO
-    OpenGLRenderer* renderer;
-#else
-    OpenGLRenderer* renderer;
-#endif
+    // 视频播放器 (硬件加速，由 createVideoRenderer 按平台创建)
+    VideoRendererBase* renderer;
 
     // 控制栏
     QWidget *m_controlBar;
@@ -111,6 +141,19 @@ private:
     // 右键菜单
     QMenu *m_contextMenu;
 
+    // 会话恢复：首帧前覆盖在渲染器上的快照
+    QLabel *m_snapshotOverlay = nullptr;
+    QPixmap m_snapshot;
+    QString m_currentFile;
+
+    // 代理缓存：拖动进度条时的预览帧
+    ProxyBuilder *m_proxyBuilder = nullptr;
+    std::unique_ptr<ProxyScrubber> m_scrubber;
+    QLabel *m_scrubPreview = nullptr;
+    QAction *m_proxyAction = nullptr;
+
+    QActionGroup *m_presentRateGroup = nullptr;
+
     // 拖动相关
     QPoint m_dragPosition;
     bool m_isDragging = false;
@@ -128,6 +171,7 @@ private:
     static constexpr int EDGE_MARGIN = 8;
     static constexpr int MIN_WIDTH = 200;
     static constexpr int MIN_HEIGHT = 150;
+    static constexpr int SCRUB_PREVIEW_WIDTH = 240;
 };
 
 #endif // FLOATINGVIDEOPLAYER_H
@@ -0,0 +1,197 @@
+/**
+ * @file FrameConverter.cpp
+ * @brief FrameConverter 分派表
+ */
+
+#include "FrameConverter.h"
+
+#include <QDebug>
+
+#if FFMPEG_AVAILABLE
+
+extern "C" {
+#include <libavutil/pixdesc.h>
+}
+
+namespace {
+
+using namespace FrameConversion;
+
+/**
+ * @brief 分派表项：(源格式, 目标格式, 缩小倍数, 取值范围) → 特化转换函数
+ */
+struct Entry {
+    AVPixelFormat src;
+    FrameFormat dst;
+    int downscale;
+    YuvConverter::ColorRange range;
+    ConvertFn convert;
+    const char *name;
+};
+
+#define CONVERTER_ENTRY(SRC, DST, SCALE, RANGE) \
+    { SRC, FrameFormat::DST, SCALE, YuvConverter::RANGE, \
+      &Converter<SRC, FrameFormat::DST, SCALE, YuvConverter::RANGE>::convert, \
+      "Converter<" #SRC ", " #DST ", " #SCALE ", " #RANGE ">" }
+
+const Entry DISPATCH_TABLE[] = {
+    CONVERTER_ENTRY(AV_PIX_FMT_YUV420P, RGB32, 1, LimitedRange),
+    CONVERTER_ENTRY(AV_PIX_FMT_YUV420P, RGB32, 2, LimitedRange),
+    CONVERTER_ENTRY(AV_PIX_FMT_YUV420P, RGB32, 4, LimitedRange),
+    CONVERTER_ENTRY(AV_PIX_FMT_YUV420P, RGB32, 1, FullRange),
+    CONVERTER_ENTRY(AV_PIX_FMT_YUV420P, RGB32, 2, FullRange),
+    CONVERTER_ENTRY(AV_PIX_FMT_YUV420P, RGB32, 4, FullRange),
+    // YUVJ420P 只有全范围特化（有限范围的组合在编译期被拒绝）
+    CONVERTER_ENTRY(AV_PIX_FMT_YUVJ420P, RGB32, 1, FullRange),
+    CONVERTER_ENTRY(AV_PIX_FMT_YUVJ420P, RGB32, 2, FullRange),
+    CONVERTER_ENTRY(AV_PIX_FMT_YUVJ420P, RGB32, 4, FullRange),
+    CONVERTER_ENTRY(AV_PIX_FMT_NV12, RGB32, 1, LimitedRange),
+    CONVERTER_ENTRY(AV_PIX_FMT_NV12, RGB32, 2, LimitedRange),
+    CONVERTER_ENTRY(AV_PIX_FMT_NV12, RGB32, 4, LimitedRange),
+    CONVERTER_ENTRY(AV_PIX_FMT_NV12, RGB32, 1, FullRange),
+    CONVERTER_ENTRY(AV_PIX_FMT_NV12, RGB32, 2, FullRange),
+    CONVERTER_ENTRY(AV_PIX_FMT_NV12, RGB32, 4, FullRange),
+    CONVERTER_ENTRY(AV_PIX_FMT_NV12, NV12, 1, LimitedRange),
+};
+
+#undef CONVERTER_ENTRY
+
+/**
+ * @brief 输出尺寸是否正好为源尺寸的 1/factor
+ */
+int exactDownscale(const QSize &srcSize, const QSize &outputSize)
+{
+    for (int factor : {1, 2, 4}) {
+        if (outputSize == QSize(srcSize.width() / factor, srcSize.height() / factor)) {
+            return factor;
+        }
+    }
+    return 0;
+}
+
+} // namespace
+
+QList<FrameConverter::Specialization> FrameConverter::specializations()
+{
+    QList<Specialization> list;
+    for (const Entry &entry : DISPATCH_TABLE) {
+        list.append({ entry.src, entry.dst, entry.downscale, entry.range, entry.name });
+    }
+    return list;
+}
+
+bool FrameConverter::select(AVPixelFormat srcFormat, const QSize &srcSize,
+                            FrameFormat dstFormat, const QSize &outputSize, AVColorRange srcRange)
+{
+    m_convert = nullptr;
+    m_srcFormat = srcFormat;
+    m_srcSize = srcSize;
+    m_srcRange = srcRange;
+    m_dstFormat = dstFormat;
+    m_params.srcWidth = srcSize.width();
+    m_params.srcHeight = srcSize.height();
+    m_params.outputSize = outputSize;
+
+    const YuvConverter::ColorRange range = YuvConverter::colorRangeFor(srcFormat, srcRange);
+    const int downscale = exactDownscale(srcSize, outputSize);
+    for (const Entry &entry : DISPATCH_TABLE) {
+        if (entry.src == srcFormat && entry.dst == dstFormat && entry.downscale == downscale
+            && entry.range == range) {
+            m_convert = entry.convert;
+            m_name = entry.name;
+            break;
+        }
+    }
+
+    if (!m_convert) {
+        const AVPixelFormat swsFormat = dstFormat == FrameFormat::NV12
+            ? TargetTraits<FrameFormat::NV12>::SWS_FORMAT
+            : TargetTraits<FrameFormat::RGB32>::SWS_FORMAT;
+        m_params.sws = cachedSws(srcFormat, srcSize, swsFormat, outputSize,
+                                 range == YuvConverter::FullRange);
+        if (!m_params.sws) {
+            qWarning() << "无法创建颜色转换，源格式:" << av_get_pix_fmt_name(srcFormat);
+            return false;
+        }
+        m_convert = dstFormat == FrameFormat::NV12
+            ? &SwsConverter<FrameFormat::NV12>::convert
+            : &SwsConverter<FrameFormat::RGB32>::convert;
+        m_name = "SwsConverter";
+    }
+
+    qDebug() << "帧转换:" << m_name << "源格式:" << av_get_pix_fmt_name(srcFormat)
+             << (range == YuvConverter::FullRange ? "全范围" : "有限范围")
+             << srcSize << "→" << outputSize;
+    return true;
+}
+
+SwsContext *FrameConverter::cachedSws(AVPixelFormat srcFormat, const QSize &srcSize,
+                                      AVPixelFormat dstFormat, const QSize &outputSize, bool fullRange)
+{
+    SwsSlot *victim = &m_swsCache[0];
+    for (SwsSlot &slot : m_swsCache) {
+        if (slot.sws && slot.srcFormat == srcFormat && slot.srcSize == srcSize
+            && slot.dstFormat == dstFormat && slot.outputSize == outputSize
+            && slot.fullRange == fullRange) {
+            slot.lastUsed = ++m_swsUse;
+            return slot.sws;
+        }
+        if (!slot.sws || (victim->sws && slot.lastUsed < victim->lastUsed)) {
+            victim = &slot;
+        }
+    }
+
+    sws_freeContext(victim->sws);
+    victim->sws = sws_getContext(srcSize.width(), srcSize.height(), srcFormat,
+                                 outputSize.width(), outputSize.height(), dstFormat,
+                                 SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+    if (victim->sws && fullRange) {
+        // sws 只从 YUVJ 格式推断全范围；只由 color_range 标记的全范围需要显式指定源范围
+        int *invTable = nullptr;
+        int *table = nullptr;
+        int srcRange = 0, dstRange = 0, brightness = 0, contrast = 0, saturation = 0;
+        sws_getColorspaceDetails(victim->sws, &invTable, &srcRange, &table, &dstRange,
+                                 &brightness, &contrast, &saturation);
+        sws_setColorspaceDetails(victim->sws, invTable, 1, table, dstRange,
+                                 brightness, contrast, saturation);
+    }
+    victim->srcFormat = srcFormat;
+    victim->srcSize = srcSize;
+    victim->dstFormat = dstFormat;
+    victim->outputSize = outputSize;
+    victim->fullRange = fullRange;
+    victim->lastUsed = ++m_swsUse;
+    return victim->sws;
+}
+
+void FrameConverter::reset()
+{
+    for (SwsSlot &slot : m_swsCache) {
+        sws_freeContext(slot.sws);
+        slot = SwsSlot();
+    }
+    m_params.sws = nullptr;
+    m_convert = nullptr;
+    m_srcFormat = AV_PIX_FMT_NONE;
+    m_srcSize = QSize();
+    m_srcRange = AVCOL_RANGE_UNSPECIFIED;
+    m_params.outputSize = QSize();
+    m_name = "";
+}
+
+bool FrameParams::update(const AVFrame *frame, const char *tag)
+{
+    const FrameParams current = of(frame);
+    if (current == *this) return false;
+
+    const bool midStream = width > 0;
+    if (midStream) {
+        qDebug().nospace() << "[重配置] " << tag << ": " << width << "x" << height << " "
+                           << av_get_pix_fmt_name(format) << " → " << current.width << "x" << current.height
+                           << " " << av_get_pix_fmt_name(current.format);
+    }
+    *this = current;
+    return midStream;
+}
+
+#endif // FFMPEG_AVAILABLE
@@ -0,0 +1,318 @@
+/**
+ * @file FrameConverter.h
+ * @brief 解码帧 → 输出图像的转换管线（按流编译期特化）
+ *
+ * 源格式、目标格式与缩小倍数在流打开 / 输出尺寸变化时确定一次，
+ * 从分派表中选出一个特化的 Converter<Src, Dst, Downscale, Range>::convert，
+ * 每帧只调用这个函数指针，热路径上没有格式分支与虚函数调用。
+ *
+ * 取值范围（有限 / 全范围）同样是特化参数：YUVJ420P 总是全范围，
+ * 其他格式按帧的 color_range 选择，与 YuvConverter::colorRangeFor 一致。
+ *
+ * 没有专用内核的组合（10bit、缩放到任意尺寸等）回退到 SwsConverter<Dst>。
+ *
+ * 流中途改变分辨率或像素格式（自适应 HLS 切换码率、拼接的 TS）时只重新选择转换函数；
+ * sws 上下文按参数缓存几份，来回切换时不重复创建。
+ */
+
+#ifndef FRAMECONVERTER_H
+#define FRAMECONVERTER_H
+
+#include <QImage>
+#include <QList>
+#include <QSize>
+#include <cstring>
+
+#include "YuvConverter.h"
+
+#if FFMPEG_AVAILABLE
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixfmt.h>
+#include <libswscale/swscale.h>
+}
+#endif
+
+/**
+ * @brief 视频帧输出格式
+ */
+enum class FrameFormat {
+    RGB32,  ///< QImage::Format_RGB32（默认）
+    NV12    ///< QImage::Format_Grayscale8，高度为 h*3/2：Y 平面后接交织 UV 平面
+};
+
+#if FFMPEG_AVAILABLE
+
+namespace FrameConversion {
+
+/**
+ * @brief 每条流确定一次的转换参数
+ */
+struct Params {
+    int srcWidth = 0;
+    int srcHeight = 0;
+    QSize outputSize;
+    SwsContext *sws = nullptr;      ///< 仅 SwsConverter 使用
+};
+
+using ConvertFn = QImage (*)(const Params &params, const AVFrame *frame);
+
+// ==================== 目标格式特征 ====================
+
+template <FrameFormat Dst>
+struct TargetTraits;
+
+template <>
+struct TargetTraits<FrameFormat::RGB32> {
+    static constexpr AVPixelFormat SWS_FORMAT = AV_PIX_FMT_RGB32;
+
+    static QImage allocate(const QSize &size) { return QImage(size, QImage::Format_RGB32); }
+
+    static void planes(QImage &image, const QSize &, uint8_t *data[4], int linesize[4])
+    {
+        data[0] = image.bits();
+        linesize[0] = static_cast<int>(image.bytesPerLine());
+    }
+};
+
+template <>
+struct TargetTraits<FrameFormat::NV12> {
+    static constexpr AVPixelFormat SWS_FORMAT = AV_PIX_FMT_NV12;
+
+    static QImage allocate(const QSize &size)
+    {
+        return QImage(size.width(), size.height() * 3 / 2, QImage::Format_Grayscale8);
+    }
+
+    // Y 平面与 UV 平面连续存放在同一个 Grayscale8 图像中
+    static void planes(QImage &image, const QSize &size, uint8_t *data[4], int linesize[4])
+    {
+        const int stride = static_cast<int>(image.bytesPerLine());
+        data[0] = image.bits();
+        data[1] = image.bits() + stride * size.height();
+        linesize[0] = linesize[1] = stride;
+    }
+};
+
+// ==================== 源格式特征 ====================
+
+template <AVPixelFormat Src>
+struct SourceTraits;
+
+template <>
+struct SourceTraits<AV_PIX_FMT_YUV420P> {
+    static constexpr YuvConverter::SourceFormat LAYOUT = YuvConverter::YUV420P;
+    static constexpr bool FULL_RANGE_ONLY = false;
+};
+
+// YUVJ420P 只有全范围特化（见 Converter 中的 static_assert）
+template <>
+struct SourceTraits<AV_PIX_FMT_YUVJ420P> {
+    static constexpr YuvConverter::SourceFormat LAYOUT = YuvConverter::YUV420P;
+    static constexpr bool FULL_RANGE_ONLY = true;
+};
+
+template <>
+struct SourceTraits<AV_PIX_FMT_NV12> {
+    static constexpr YuvConverter::SourceFormat LAYOUT = YuvConverter::NV12;
+    static constexpr bool FULL_RANGE_ONLY = false;
+};
+
+// ==================== 转换器 ====================
+
+/**
+ * @brief 专用内核转换器（只为有内核的组合定义）
+ */
+template <AVPixelFormat Src, FrameFormat Dst, int Downscale = 1,
+          YuvConverter::ColorRange Range = YuvConverter::LimitedRange>
+struct Converter;
+
+template <AVPixelFormat Src, int Downscale, YuvConverter::ColorRange Range>
+struct Converter<Src, FrameFormat::RGB32, Downscale, Range> {
+    static_assert(!SourceTraits<Src>::FULL_RANGE_ONLY || Range == YuvConverter::FullRange,
+                  "YUVJ 格式只能使用全范围颜色矩阵");
+
+    static QImage convert(const Params &params, const AVFrame *frame)
+    {
+        QImage image = TargetTraits<FrameFormat::RGB32>::allocate(params.outputSize);
+        if (!image.isNull()) {
+            YuvConverter::convert<SourceTraits<Src>::LAYOUT, Downscale, Range>(
+                frame->data, frame->linesize, params.srcWidth, params.srcHeight,
+                image.bits(), static_cast<int>(image.bytesPerLine()));
+        }
+        return image;
+    }
+};
+
+/**
+ * @brief NV12 → NV12 原尺寸：逐平面复制（KMS overlay 平面 + 硬件解码的常见组合）
+ *
+ * 输出不携带取值范围，只有有限范围的源可以直接复制；全范围 NV12 走 sws 压缩到有限范围。
+ */
+template <>
+struct Converter<AV_PIX_FMT_NV12, FrameFormat::NV12, 1, YuvConverter::LimitedRange> {
+    static QImage convert(const Params &params, const AVFrame *frame)
+    {
+        QImage image = TargetTraits<FrameFormat::NV12>::allocate(params.outputSize);
+        if (image.isNull()) {
+            return image;
+        }
+        uint8_t *data[4] = {};
+        int linesize[4] = {};
+        TargetTraits<FrameFormat::NV12>::planes(image, params.outputSize, data, linesize);
+
+        const int width = params.outputSize.width();
+        const int heights[2] = { params.outputSize.height(), params.outputSize.height() / 2 };
+        for (int plane = 0; plane < 2; plane++) {
+            for (int row = 0; row < heights[plane]; row++) {
+                memcpy(data[plane] + row * linesize[plane],
+                       frame->data[plane] + row * frame->linesize[plane], width);
+            }
+        }
+        return image;
+    }
+};
+
+/**
+ * @brief 通用回退：sws_scale
+ */
+template <FrameFormat Dst>
+struct SwsConverter {
+    static QImage convert(const Params &params, const AVFrame *frame)
+    {
+        QImage image = TargetTraits<Dst>::allocate(params.outputSize);
+        if (!image.isNull()) {
+            uint8_t *data[4] = {};
+            int linesize[4] = {};
+            TargetTraits<Dst>::planes(image, params.outputSize, data, linesize);
+            sws_scale(params.sws, frame->data, frame->linesize, 0, params.srcHeight,
+                      data, linesize);
+        }
+        return image;
+    }
+};
+
+} // namespace FrameConversion
+
+/**
+ * @brief 解码帧参数（尺寸 / 像素格式），用于检测流中途的重配置
+ */
+struct FrameParams {
+    int width = 0;
+    int height = 0;
+    AVPixelFormat format = AV_PIX_FMT_NONE;
+
+    static FrameParams of(const AVFrame *frame)
+    {
+        return FrameParams{ frame->width, frame->height, static_cast<AVPixelFormat>(frame->format) };
+    }
+
+    bool operator==(const FrameParams &other) const = default;
+
+    /**
+     * @brief 与上一帧比较并记录
+     * @param tag 日志前缀
+     * @return 参数在流中途变化时返回 true（首帧不算），同时输出日志
+     */
+    bool update(const AVFrame *frame, const char *tag);
+};
+
+/**
+ * @brief 按流选定的帧转换器
+ *
+ * 用法：每帧先调用 configure()（参数不变时只是一次比较），再调用 convert()。
+ * 只在一个线程（解码线程）中使用。
+ */
+class FrameConverter
+{
+public:
+    FrameConverter() = default;
+    ~FrameConverter() { reset(); }
+
+    FrameConverter(const FrameConverter &) = delete;
+    FrameConverter &operator=(const FrameConverter &) = delete;
+
+    /**
+     * @brief 分派表中的一个特化（微基准按表逐项测量）
+     */
+    struct Specialization {
+        AVPixelFormat src;
+        FrameFormat dst;
+        int downscale;
+        YuvConverter::ColorRange range;
+        const char *name;
+    };
+
+    /**
+     * @brief 分派表全部特化
+     */
+    static QList<Specialization> specializations();
+
+    /**
+     * @brief 选择转换函数
+     * @param srcFormat 解码帧像素格式
+     * @param srcSize 解码帧尺寸
+     * @param dstFormat 输出格式
+     * @param outputSize 输出尺寸（NV12 需为偶数）
+     * @param srcRange 解码帧的 color_range（YUVJ 格式总按全范围）
+     * @return 无法转换（sws 不支持该格式）时返回 false
+     */
+    bool configure(AVPixelFormat srcFormat, const QSize &srcSize,
+                   FrameFormat dstFormat, const QSize &outputSize,
+                   AVColorRange srcRange = AVCOL_RANGE_UNSPECIFIED)
+    {
+        if (m_convert && srcFormat == m_srcFormat && srcSize == m_srcSize
+            && dstFormat == m_dstFormat && outputSize == m_params.outputSize
+            && srcRange == m_srcRange) {
+            return true;
+        }
+        return select(srcFormat, srcSize, dstFormat, outputSize, srcRange);
+    }
+
+    /**
+     * @brief 转换一帧（需先 configure 成功）
+     */
+    QImage convert(const AVFrame *frame) const { return m_convert(m_params, frame); }
+
+    /**
+     * @brief 当前选中的转换器名称（日志用）
+     */
+    const char *name() const { return m_name; }
+
+    /**
+     * @brief 释放缓存的 sws 上下文并清除选择（关闭文件时调用）
+     */
+    void reset();
+
+private:
+    bool select(AVPixelFormat srcFormat, const QSize &srcSize,
+                FrameFormat dstFormat, const QSize &outputSize, AVColorRange srcRange);
+    SwsContext *cachedSws(AVPixelFormat srcFormat, const QSize &srcSize,
+                          AVPixelFormat dstFormat, const QSize &outputSize, bool fullRange);
+
+    // sws 上下文缓存（按最近使用淘汰）
+    struct SwsSlot {
+        SwsContext *sws = nullptr;
+        AVPixelFormat srcFormat = AV_PIX_FMT_NONE;
+        QSize srcSize;
+        AVPixelFormat dstFormat = AV_PIX_FMT_NONE;
+        QSize outputSize;
+        bool fullRange = false;
+        quint64 lastUsed = 0;
+    };
+    static constexpr int SWS_CACHE_SIZE = 3;
+    SwsSlot m_swsCache[SWS_CACHE_SIZE];
+    quint64 m_swsUse = 0;
+
+    FrameConversion::ConvertFn m_convert = nullptr;
+    FrameConversion::Params m_params;
+    AVPixelFormat m_srcFormat = AV_PIX_FMT_NONE;
+    QSize m_srcSize;
+    AVColorRange m_srcRange = AVCOL_RANGE_UNSPECIFIED;
+    FrameFormat m_dstFormat = FrameFormat::RGB32;
+    const char *m_name = "";
+};
+
+#endif // FFMPEG_AVAILABLE
+
+#endif // FRAMECONVERTER_H
@@ -0,0 +1,425 @@
+/**
+ * @file KmsOutput.cpp
+ * @brief DRM/KMS 直接输出实现
+ */
+
+#include "KmsOutput.h"
+#include <QSocketNotifier>
+#include <QDebug>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <drm_fourcc.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+KmsOutput::KmsOutput(QObject *parent)
+    : QObject(parent)
+{
+}
+
+KmsOutput::~KmsOutput()
+{
+    if (m_fd < 0) return;
+
+    for (auto &buffer : m_buffers) {
+        destroyBuffer(buffer);
+    }
+    destroyBuffer(m_background);
+    if (m_modeBlobId) {
+        drmModeDestroyPropertyBlob(m_fd, m_modeBlobId);
+    }
+    ::close(m_fd);
+}
+
+bool KmsOutput::open(const QString &device, bool useOverlay)
+{
+    m_fd = ::open(device.toLocal8Bit().constData(), O_RDWR | O_CLOEXEC);
+    if (m_fd < 0) {
+        qCritical() << "无法打开 DRM 设备:" << device << std::strerror(errno);
+        return false;
+    }
+
+    // 原子提交需要通用平面（主平面/光标平面也作为 plane 暴露）
+    drmSetClientCap(m_fd, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1);
+    if (drmSetClientCap(m_fd, DRM_CLIENT_CAP_ATOMIC, 1) != 0) {
+        qCritical() << "DRM 驱动不支持原子提交:" << device;
+        return false;
+    }
+
+    uint64_t hasDumb = 0;
+    if (drmGetCap(m_fd, DRM_CAP_DUMB_BUFFER, &hasDumb) != 0 || !hasDumb) {
+        qCritical() << "DRM 驱动不支持 dumb buffer:" << device;
+        return false;
+    }
+
+    if (!findOutput() || !findPlanes(useOverlay)) {
+        return false;
+    }
+
+    // 主平面缓冲区：overlay 模式下只需要一个黑色背景
+    if (isNv12()) {
+        if (!createBuffer(m_background, modeSize(), DRM_FORMAT_XRGB8888)) return false;
+    } else {
+        for (auto &buffer : m_buffers) {
+            if (!createBuffer(buffer, modeSize(), DRM_FORMAT_XRGB8888)) return false;
+        }
+    }
+
+    if (!modeset()) {
+        return false;
+    }
+
+    m_notifier = new QSocketNotifier(m_fd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &KmsOutput::onDrmEvent);
+
+    qDebug() << "========================================";
+    qDebug() << "KMS 输出已就绪:" << device;
+    qDebug() << "模式:" << m_mode.name << "@" << m_mode.vrefresh << "Hz";
+    qDebug() << "CRTC:" << m_crtcId << "主平面:" << m_primaryPlaneId
+             << "overlay (NV12):" << (m_overlayPlaneId ? QString::number(m_overlayPlaneId) : QString("无"));
+    qDebug() << "========================================";
+    return true;
+}
+
+bool KmsOutput::findOutput()
+{
+    drmModeRes *res = drmModeGetResources(m_fd);
+    if (!res) {
+        qCritical() << "drmModeGetResources 失败";
+        return false;
+    }
+
+    for (int i = 0; i < res->count_connectors && !m_connectorId; i++) {
+        drmModeConnector *conn = drmModeGetConnector(m_fd, res->connectors[i]);
+        if (!conn) continue;
+
+        if (conn->connection == DRM_MODE_CONNECTED && conn->count_modes > 0) {
+            // 优先使用首选模式
+            m_mode = conn->modes[0];
+            for (int m = 0; m < conn->count_modes; m++) {
+                if (conn->modes[m].type & DRM_MODE_TYPE_PREFERRED) {
+                    m_mode = conn->modes[m];
+                    break;
+                }
+            }
+
+            // 优先沿用当前编码器绑定的 CRTC，否则选第一个可用的
+            uint32_t crtcId = 0;
+            if (conn->encoder_id) {
+                if (drmModeEncoder *enc = drmModeGetEncoder(m_fd, conn->encoder_id)) {
+                    crtcId = enc->crtc_id;
+                    drmModeFreeEncoder(enc);
+                }
+            }
+            for (int e = 0; e < conn->count_encoders && !crtcId; e++) {
+                drmModeEncoder *enc = drmModeGetEncoder(m_fd, conn->encoders[e]);
+                if (!enc) continue;
+                for (int c = 0; c < res->count_crtcs; c++) {
+                    if (enc->possible_crtcs & (1u << c)) {
+                        crtcId = res->crtcs[c];
+                        break;
+                    }
+                }
+                drmModeFreeEncoder(enc);
+            }
+
+            if (crtcId) {
+                m_connectorId = conn->connector_id;
+                m_crtcId = crtcId;
+                for (int c = 0; c < res->count_crtcs; c++) {
+                    if (res->crtcs[c] == crtcId) m_crtcIndex = c;
+                }
+            }
+        }
+        drmModeFreeConnector(conn);
+    }
+    drmModeFreeResources(res);
+
+    if (!m_connectorId || m_crtcIndex < 0) {
+        qCritical() << "未找到已连接的显示器";
+        return false;
+    }
+    return true;
+}
+
+bool KmsOutput::findPlanes(bool useOverlay)
+{
+    drmModePlaneRes *planes = drmModeGetPlaneResources(m_fd);
+    if (!planes) return false;
+
+    for (uint32_t i = 0; i < planes->count_planes; i++) {
+        drmModePlane *plane = drmModeGetPlane(m_fd, planes->planes[i]);
+        if (!plane) continue;
+
+        if (plane->possible_crtcs & (1u << m_crtcIndex)) {
+            // 平面类型是 "type" 枚举属性
+            uint64_t type = DRM_PLANE_TYPE_OVERLAY;
+            if (drmModeObjectProperties *props =
+                    drmModeObjectGetProperties(m_fd, plane->plane_id, DRM_MODE_OBJECT_PLANE)) {
+                for (uint32_t p = 0; p < props->count_props; p++) {
+                    drmModePropertyRes *prop = drmModeGetProperty(m_fd, props->props[p]);
+                    if (prop && std::strcmp(prop->name, "type") == 0) {
+                        type = props->prop_values[p];
+                    }
+                    drmModeFreeProperty(prop);
+                }
+                drmModeFreeObjectProperties(props);
+            }
+
+            const bool supportsNv12 = std::find(plane->formats, plane->formats + plane->count_formats,
+                                                DRM_FORMAT_NV12) != plane->formats + plane->count_formats;
+
+            if (type == DRM_PLANE_TYPE_PRIMARY && !m_primaryPlaneId) {
+                m_primaryPlaneId = plane->plane_id;
+            } else if (type == DRM_PLANE_TYPE_OVERLAY && useOverlay && supportsNv12 && !m_overlayPlaneId) {
+                m_overlayPlaneId = plane->plane_id;
+            }
+        }
+        drmModeFreePlane(plane);
+    }
+    drmModeFreePlaneResources(planes);
+
+    if (!m_primaryPlaneId) {
+        qCritical() << "未找到 CRTC 的主平面";
+        return false;
+    }
+    if (useOverlay && !m_overlayPlaneId) {
+        qWarning() << "没有支持 NV12 的 overlay 平面，回退到主平面 XRGB8888";
+    }
+    return true;
+}
+
+bool KmsOutput::createBuffer(DumbBuffer &buffer, const QSize &size, uint32_t fourcc)
+{
+    const bool nv12 = (fourcc == DRM_FORMAT_NV12);
+
+    // NV12：Y 与 UV 平面放在同一个 dumb buffer 中，共用 pitch
+    drm_mode_create_dumb create = {};
+    create.width = size.width();
+    create.height = nv12 ? size.height() * 3 / 2 : size.height();
+    create.bpp = nv12 ? 8 : 32;
+    if (drmIoctl(m_fd, DRM_IOCTL_MODE_CREATE_DUMB, &create) != 0) {
+        qCritical() << "创建 dumb buffer 失败:" << size << std::strerror(errno);
+        return false;
+    }
+
+    uint32_t handles[4] = { create.handle };
+    uint32_t pitches[4] = { create.pitch };
+    uint32_t offsets[4] = { 0 };
+    if (nv12) {
+        handles[1] = create.handle;
+        pitches[1] = create.pitch;
+        offsets[1] = create.pitch * size.height();
+    }
+
+    buffer.handle = create.handle;
+    buffer.pitch = create.pitch;
+    buffer.size = size;
+    buffer.lastVideoRect = QRect();
+
+    if (drmModeAddFB2(m_fd, size.width(), size.height(), fourcc,
+                      handles, pitches, offsets, &buffer.fbId, 0) != 0) {
+        qCritical() << "drmModeAddFB2 失败:" << std::strerror(errno);
+        destroyBuffer(buffer);
+        return false;
+    }
+
+    drm_mode_map_dumb map = {};
+    map.handle = create.handle;
+    if (drmIoctl(m_fd, DRM_IOCTL_MODE_MAP_DUMB, &map) != 0) {
+        destroyBuffer(buffer);
+        return false;
+    }
+
+    void *addr = mmap(nullptr, create.size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, map.offset);
+    if (addr == MAP_FAILED) {
+        destroyBuffer(buffer);
+        return false;
+    }
+    buffer.map = static_cast<uint8_t*>(addr);
+    buffer.mapSize = create.size;
+
+    // 初始为黑色（NV12 有限范围黑：Y=16, UV=128）
+    if (nv12) {
+        std::memset(buffer.map, 16, create.pitch * size.height());
+        std::memset(buffer.map + create.pitch * size.height(), 128, create.pitch * size.height() / 2);
+    } else {
+        std::memset(buffer.map, 0, buffer.mapSize);
+    }
+    return true;
+}
+
+void KmsOutput::destroyBuffer(DumbBuffer &buffer)
+{
+    if (buffer.map) {
+        munmap(buffer.map, buffer.mapSize);
+        buffer.map = nullptr;
+    }
+    if (buffer.fbId) {
+        drmModeRmFB(m_fd, buffer.fbId);
+        buffer.fbId = 0;
+    }
+    if (buffer.handle) {
+        drm_mode_destroy_dumb destroy = {};
+        destroy.handle = buffer.handle;
+        drmIoctl(m_fd, DRM_IOCTL_MODE_DESTROY_DUMB, &destroy);
+        buffer.handle = 0;
+    }
+    buffer.mapSize = 0;
+    buffer.size = QSize();
+}
+
+uint32_t KmsOutput::propertyId(uint32_t objectId, uint32_t objectType, const char *name)
+{
+    const auto key = qMakePair(objectId, QByteArray(name));
+    auto it = m_propertyCache.constFind(key);
+    if (it != m_propertyCache.constEnd()) return it.value();
+
+    uint32_t id = 0;
+    if (drmModeObjectProperties *props = drmModeObjectGetProperties(m_fd, objectId, objectType)) {
+        for (uint32_t i = 0; i < props->count_props && !id; i++) {
+            drmModePropertyRes *prop = drmModeGetProperty(m_fd, props->props[i]);
+            if (prop && std::strcmp(prop->name, name) == 0) {
+                id = prop->prop_id;
+            }
+            drmModeFreeProperty(prop);
+        }
+        drmModeFreeObjectProperties(props);
+    }
+
+    m_propertyCache.insert(key, id);
+    return id;
+}
+
+bool KmsOutput::addProperty(drmModeAtomicReq *req, uint32_t objectId, uint32_t objectType,
+                            const char *name, uint64_t value)
+{
+    const uint32_t id = propertyId(objectId, objectType, name);
+    if (!id) {
+        qWarning() << "KMS 属性不存在:" << name;
+        return false;
+    }
+    return drmModeAtomicAddProperty(req, objectId, id, value) >= 0;
+}
+
+void KmsOutput::addPlaneState(drmModeAtomicReq *req, uint32_t planeId, const DumbBuffer &buffer,
+                              const QRect &crtcRect)
+{
+    const uint32_t type = DRM_MODE_OBJECT_PLANE;
+    addProperty(req, planeId, type, "FB_ID", buffer.fbId);
+    addProperty(req, planeId, type, "CRTC_ID", m_crtcId);
+    // 源矩形为 16.16 定点数
+    addProperty(req, planeId, type, "SRC_X", 0);
+    addProperty(req, planeId, type, "SRC_Y", 0);
+    addProperty(req, planeId, type, "SRC_W", static_cast<uint64_t>(buffer.size.width()) << 16);
+    addProperty(req, planeId, type, "SRC_H", static_cast<uint64_t>(buffer.size.height()) << 16);
+    addProperty(req, planeId, type, "CRTC_X", crtcRect.x());
+    addProperty(req, planeId, type, "CRTC_Y", crtcRect.y());
+    addProperty(req, planeId, type, "CRTC_W", crtcRect.width());
+    addProperty(req, planeId, type, "CRTC_H", crtcRect.height());
+}
+
+bool KmsOutput::modeset()
+{
+    if (drmModeCreatePropertyBlob(m_fd, &m_mode, sizeof(m_mode), &m_modeBlobId) != 0) {
+        qCritical() << "创建模式属性失败";
+        return false;
+    }
+
+    drmModeAtomicReq *req = drmModeAtomicAlloc();
+    addProperty(req, m_connectorId, DRM_MODE_OBJECT_CONNECTOR, "CRTC_ID", m_crtcId);
+    addProperty(req, m_crtcId, DRM_MODE_OBJECT_CRTC, "MODE_ID", m_modeBlobId);
+    addProperty(req, m_crtcId, DRM_MODE_OBJECT_CRTC, "ACTIVE", 1);
+
+    const QRect screen(QPoint(0, 0), modeSize());
+    addPlaneState(req, m_primaryPlaneId, isNv12() ? m_background : m_buffers[0], screen);
+
+    const int ret = drmModeAtomicCommit(m_fd, req, DRM_MODE_ATOMIC_ALLOW_MODESET, nullptr);
+    drmModeAtomicFree(req);
+    if (ret != 0) {
+        qCritical() << "KMS 模式设置失败:" << std::strerror(errno);
+        return false;
+    }
+
+    m_front = isNv12() ? -1 : 0;
+    return true;
+}
+
+bool KmsOutput::present(const QImage &frame, const QRect &videoRect)
+{
+    if (m_flipPending || frame.isNull()) return false;
+
+    const int back = (m_front + 1) % BUFFER_COUNT;
+    DumbBuffer &buffer = m_buffers[back];
+    QRect crtcRect;
+
+    if (isNv12()) {
+        // overlay 平面：缓冲区即视频尺寸，平面定位到视频区域，黑边由主平面背景提供
+        const QSize size(frame.width(), frame.height() * 2 / 3);
+        if (buffer.size != size) {
+            destroyBuffer(buffer);
+            if (!createBuffer(buffer, size, DRM_FORMAT_NV12)) return false;
+        }
+        const size_t rowBytes = std::min<size_t>(frame.width(), buffer.pitch);
+        for (int y = 0; y < frame.height(); y++) {
+            std::memcpy(buffer.map + y * buffer.pitch, frame.constScanLine(y), rowBytes);
+        }
+        crtcRect = QRect(videoRect.topLeft(), size).intersected(QRect(QPoint(0, 0), modeSize()));
+    } else {
+        // 主平面：全屏 XRGB8888，黑边只在视频区域变化后重填
+        const QRect dst = QRect(videoRect.topLeft(), frame.size())
+                              .intersected(QRect(QPoint(0, 0), buffer.size));
+        if (buffer.lastVideoRect != dst) {
+            std::memset(buffer.map, 0, buffer.mapSize);
+            buffer.lastVideoRect = dst;
+        }
+        for (int y = 0; y < dst.height(); y++) {
+            std::memcpy(buffer.map + (dst.y() + y) * buffer.pitch + dst.x() * 4,
+                        frame.constScanLine(y), dst.width() * 4);
+        }
+        crtcRect = QRect(QPoint(0, 0), buffer.size);
+    }
+
+    drmModeAtomicReq *req = drmModeAtomicAlloc();
+    addPlaneState(req, isNv12() ? m_overlayPlaneId : m_primaryPlaneId, buffer, crtcRect);
+
+    // 非阻塞提交，翻页在下一个 vblank 生效并通过事件通知
+    const int ret = drmModeAtomicCommit(m_fd, req,
+                                        DRM_MODE_ATOMIC_NONBLOCK | DRM_MODE_PAGE_FLIP_EVENT, this);
+    drmModeAtomicFree(req);
+    if (ret != 0) {
+        qWarning() << "KMS 翻页提交失败:" << std::strerror(errno);
+        return false;
+    }
+
+    m_queued = back;
+    m_flipPending = true;
+    return true;
+}
+
+void KmsOutput::onDrmEvent()
+{
+    drmEventContext ctx = {};
+    ctx.version = 3;
+    ctx.page_flip_handler2 = &KmsOutput::pageFlipHandler;
+    drmHandleEvent(m_fd, &ctx);
+}
+
+void KmsOutput::pageFlipHandler(int fd, unsigned int sequence, unsigned int sec,
+                                unsigned int usec, unsigned int crtcId, void *data)
+{
+    Q_UNUSED(fd)
+    Q_UNUSED(sequence)
+    Q_UNUSED(sec)
+    Q_UNUSED(usec)
+    Q_UNUSED(crtcId)
+
+    auto *self = static_cast<KmsOutput*>(data);
+    self->m_front = self->m_queued;
+    self->m_queued = -1;
+    self->m_flipPending = false;
+    emit self->flipCompleted();
+}
@@ -0,0 +1,122 @@
+/**
+ * @file KmsOutput.h
+ * @brief DRM/KMS 直接输出（无桌面的信息屏/kiosk 部署）
+ *
+ * 不经过窗口系统与合成器，直接驱动 KMS 平面：
+ * - 主平面：XRGB8888 dumb buffer，软件合成黑边
+ * - 可选 overlay 平面：NV12 dumb buffer，由扫描输出硬件完成 YUV→RGB
+ * - 原子提交 + PAGE_FLIP_EVENT，翻页在 vblank 完成，节奏锁定刷新率
+ *
+ * 可在 vkms 虚拟 KMS 驱动上运行（modprobe vkms），便于 CI 冒烟测试。
+ */
+
+#ifndef KMSOUTPUT_H
+#define KMSOUTPUT_H
+
+#include <QObject>
+#include <QImage>
+#include <QRect>
+#include <QHash>
+
+#include <xf86drm.h>
+#include <xf86drmMode.h>
+
+class QSocketNotifier;
+
+/**
+ * @brief KMS 输出设备
+ *
+ * 双缓冲：一个缓冲区正在扫描输出，另一个用于写入下一帧。
+ * 翻页未完成时 present() 返回 false，调用方在 flipCompleted 后重试。
+ */
+class KmsOutput : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit KmsOutput(QObject *parent = nullptr);
+    ~KmsOutput() override;
+
+    /**
+     * @brief 打开 DRM 设备并完成模式设置
+     * @param device 设备路径，如 /dev/dri/card0
+     * @param useOverlay 使用 NV12 overlay 平面（不支持时回退到主平面）
+     */
+    bool open(const QString &device, bool useOverlay);
+
+    /**
+     * @brief 当前显示模式尺寸
+     */
+    QSize modeSize() const { return QSize(m_mode.hdisplay, m_mode.vdisplay); }
+
+    /**
+     * @brief 是否使用 NV12 overlay 平面（帧需为 FrameFormat::NV12）
+     */
+    bool isNv12() const { return m_overlayPlaneId != 0; }
+
+    /**
+     * @brief 提交一帧，在下一个 vblank 翻页
+     * @param frame 显示尺寸的帧（RGB32，或 NV12 模式下 h*3/2 的 Grayscale8）
+     * @param videoRect 视频在屏幕上的区域
+     * @return 上一次翻页尚未完成时返回 false
+     */
+    bool present(const QImage &frame, const QRect &videoRect);
+
+    bool isFlipPending() const { return m_flipPending; }
+
+signals:
+    /**
+     * @brief 翻页完成（vblank）
+     */
+    void flipCompleted();
+
+private slots:
+    void onDrmEvent();
+
+private:
+    struct DumbBuffer {
+        uint32_t handle = 0;
+        uint32_t fbId = 0;
+        uint32_t pitch = 0;
+        uint8_t *map = nullptr;
+        size_t mapSize = 0;
+        QSize size;
+        QRect lastVideoRect;    ///< 主平面：上次写入视频的区域（黑边只在变化时重填）
+    };
+
+    bool findOutput();
+    bool findPlanes(bool useOverlay);
+    bool createBuffer(DumbBuffer &buffer, const QSize &size, uint32_t fourcc);
+    void destroyBuffer(DumbBuffer &buffer);
+    bool modeset();
+
+    uint32_t propertyId(uint32_t objectId, uint32_t objectType, const char *name);
+    bool addProperty(drmModeAtomicReq *req, uint32_t objectId, uint32_t objectType,
+                     const char *name, uint64_t value);
+    void addPlaneState(drmModeAtomicReq *req, uint32_t planeId, const DumbBuffer &buffer,
+                       const QRect &crtcRect);
+
+    static void pageFlipHandler(int fd, unsigned int sequence, unsigned int sec,
+                                unsigned int usec, unsigned int crtcId, void *data);
+
+    int m_fd = -1;
+    uint32_t m_connectorId = 0;
+    uint32_t m_crtcId = 0;
+    int m_crtcIndex = -1;
+    uint32_t m_primaryPlaneId = 0;
+    uint32_t m_overlayPlaneId = 0;
+    drmModeModeInfo m_mode = {};
+    uint32_t m_modeBlobId = 0;
+
+    static constexpr int BUFFER_COUNT = 2;
+    DumbBuffer m_buffers[BUFFER_COUNT];
+    DumbBuffer m_background;    ///< overlay 模式下主平面的黑色背景
+    int m_front = -1;           ///< 正在扫描输出的缓冲区
+    int m_queued = -1;          ///< 已提交、等待翻页的缓冲区
+    bool m_flipPending = false;
+
+    QSocketNotifier *m_notifier = nullptr;
+    QHash<QPair<uint32_t, QByteArray>, uint32_t> m_propertyCache;
+};
+
+#endif // KMSOUTPUT_H
@@ -0,0 +1,99 @@
+/**
+ * @file KmsPlayer.cpp
+ * @brief KMS 全屏播放实现
+ */
+
+#include "KmsPlayer.h"
+#include "KmsOutput.h"
+#include "FFmpegPlayer.h"
+#include <QDebug>
+
+KmsPlayer::KmsPlayer(QObject *parent)
+    : QObject(parent)
+    , m_player(new FFmpegPlayer(this))
+    , m_output(new KmsOutput(this))
+{
+    m_player->setLoop(true);
+
+    connect(m_player, &FFmpegPlayer::fileLoaded, this, &KmsPlayer::onFileLoaded);
+    connect(m_player, &FFmpegPlayer::videoSizeChanged, this, &KmsPlayer::onFileLoaded);   // 宽高比可能改变
+    connect(m_player, &FFmpegPlayer::frameReady, this, &KmsPlayer::onFrameReady);
+    connect(m_player, &FFmpegPlayer::errorOccurred, this, &KmsPlayer::onErrorOccurred);
+    connect(m_output, &KmsOutput::flipCompleted, this, &KmsPlayer::onFlipCompleted);
+}
+
+bool KmsPlayer::open(const QString &device, bool useOverlay)
+{
+    if (!m_output->open(device, useOverlay)) {
+        return false;
+    }
+    // overlay 平面直接扫描 NV12，省去 RGB 转换
+    m_player->setOutputFormat(m_output->isNv12() ? FrameFormat::NV12 : FrameFormat::RGB32);
+    return true;
+}
+
+void KmsPlayer::play(const QString &filename)
+{
+    m_player->loadFile(filename);
+    m_player->play();
+}
+
+PlaybackMetrics *KmsPlayer::metrics()
+{
+    return &m_player->metrics();
+}
+
+void KmsPlayer::onFileLoaded()
+{
+    // 保持宽高比铺满屏幕，解码线程直接输出该尺寸
+    const QSize screen = m_output->modeSize();
+    QSize videoSize(m_player->videoWidth(), m_player->videoHeight());
+    if (videoSize.isEmpty()) {
+        videoSize = screen;
+    }
+    videoSize.scale(screen, Qt::KeepAspectRatio);
+    if (m_output->isNv12()) {
+        videoSize = QSize(videoSize.width() & ~1, videoSize.height() & ~1);
+    }
+
+    m_videoRect = QRect((screen.width() - videoSize.width()) / 2,
+                        (screen.height() - videoSize.height()) / 2,
+                        videoSize.width(), videoSize.height());
+    m_player->setOutputSize(videoSize);
+
+    qDebug() << "KMS 视频区域:" << m_videoRect;
+}
+
+void KmsPlayer::onFrameReady(const QImage &frame)
+{
+    if (!m_output->present(frame, m_videoRect)) {
+        // 翻页未完成：只保留最新一帧，vblank 后提交
+        if (!m_pendingFrame.isNull()) {
+            m_player->metrics().addDroppedFrames(1);
+        }
+        m_pendingFrame = frame;
+    }
+}
+
+void KmsPlayer::onFlipCompleted()
+{
+    m_flipCount++;
+    if (m_maxFlips > 0 && m_flipCount >= m_maxFlips) {
+        qDebug() << "KMS 已完成" << m_flipCount << "次翻页，退出";
+        m_player->stop();
+        emit finished(0);
+        return;
+    }
+
+    if (!m_pendingFrame.isNull()) {
+        if (m_output->present(m_pendingFrame, m_videoRect)) {
+            m_pendingFrame = QImage();
+        }
+    }
+}
+
+void KmsPlayer::onErrorOccurred(const QString &error)
+{
+    qCritical() << "KMS 播放错误:" << error;
+    emit finished(1);
+}
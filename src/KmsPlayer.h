@@ -0,0 +1,75 @@
+/**
+ * @file KmsPlayer.h
+ * @brief KMS 全屏播放（kiosk 模式，无窗口系统）
+ */
+
+#ifndef KMSPLAYER_H
+#define KMSPLAYER_H
+
+#include <QObject>
+#include <QImage>
+#include <QRect>
+
+class FFmpegPlayer;
+class KmsOutput;
+class PlaybackMetrics;
+
+/**
+ * @brief KMS 全屏循环播放器
+ *
+ * FFmpegPlayer 负责解码与音视频同步，KmsOutput 负责扫描输出。
+ * 帧到达时若上一次翻页未完成，只保留最新一帧，翻页完成（vblank）后立即提交，
+ * 因此呈现节奏与刷新率锁定。
+ */
+class KmsPlayer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit KmsPlayer(QObject *parent = nullptr);
+
+    /**
+     * @brief 打开 KMS 设备
+     * @param device DRM 设备，如 /dev/dri/card0
+     * @param useOverlay 使用 NV12 overlay 平面
+     */
+    bool open(const QString &device, bool useOverlay);
+
+    /**
+     * @brief 循环播放文件
+     */
+    void play(const QString &filename);
+
+    /**
+     * @brief 翻页指定次数后退出（CI 冒烟测试，0 表示不限）
+     */
+    void setMaxFlips(int count) { m_maxFlips = count; }
+
+    /**
+     * @brief 运行指标（解码与同步来自 FFmpegPlayer；等待翻页时被新帧替换的帧计为丢帧）
+     */
+    PlaybackMetrics *metrics();
+
+signals:
+    /**
+     * @brief 播放结束（出错或达到翻页次数）
+     * @param exitCode 进程退出码
+     */
+    void finished(int exitCode);
+
+private slots:
+    void onFileLoaded();
+    void onFrameReady(const QImage &frame);
+    void onFlipCompleted();
+    void onErrorOccurred(const QString &error);
+
+private:
+    FFmpegPlayer *m_player = nullptr;
+    KmsOutput *m_output = nullptr;
+    QImage m_pendingFrame;
+    QRect m_videoRect;
+    int m_maxFlips = 0;
+    int m_flipCount = 0;
+};
+
+#endif // KMSPLAYER_H
@@ -0,0 +1,354 @@
+/**
+ * @file LoopFrameCache.cpp
+ * @brief 短循环磁盘帧缓存实现
+ */
+
+#include "LoopFrameCache.h"
+#include "RhiRenderer.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+
+#if FFMPEG_AVAILABLE
+
+namespace {
+
+static constexpr qint64 MAX_CACHE_BYTES = 4LL * 1024 * 1024 * 1024;
+static constexpr qint64 MAX_ENTRY_BYTES = 512LL * 1024 * 1024;
+static constexpr double MAX_LOOP_SECONDS = 60.0;
+static constexpr qint64 HASH_BYTES = 1024 * 1024;    // 内容哈希读取首尾各 1 MiB
+static constexpr qint64 PAGE_BYTES = 4096;
+static constexpr int ROW_ALIGN = 64;
+static constexpr quint32 FORMAT_VERSION = 1;
+static constexpr char MAGIC[8] = { 'L', 'O', 'O', 'P', 'F', 'R', 'M', '1' };
+
+/**
+ * @brief 文件头（位于文件开头，录制完成时最后写入）
+ */
+struct FileHeader {
+    char magic[8];
+    quint32 version;
+    qint32 width;
+    qint32 height;
+    qint32 frameCount;
+    qint32 linesize[3];
+    qint32 transfer;
+    quint8 bt2020;
+    quint8 fullRange;
+    quint8 reserved[2];
+    float peakNits;
+    double loopDuration;
+    qint64 frameBytes;
+};
+static_assert(std::is_trivially_copyable_v<FileHeader> && sizeof(FileHeader) <= PAGE_BYTES);
+
+QString cacheDir()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/frames");
+}
+
+QString cachePath(const QString &key)
+{
+    return cacheDir() + QLatin1Char('/') + key + QStringLiteral(".yuv");
+}
+
+qint64 alignUp(qint64 value, qint64 alignment)
+{
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+/**
+ * @brief 按输出尺寸计算各平面行宽，返回整帧（页对齐）字节数
+ */
+qint64 frameLayout(const QSize &size, int (&linesize)[3])
+{
+    const int chromaHeight = (size.height() + 1) / 2;
+    linesize[0] = static_cast<int>(alignUp(size.width(), ROW_ALIGN));
+    linesize[1] = linesize[2] = static_cast<int>(alignUp((size.width() + 1) / 2, ROW_ALIGN));
+    return alignUp(qint64(linesize[0]) * size.height() + 2LL * linesize[1] * chromaHeight, PAGE_BYTES);
+}
+
+/**
+ * @brief 目录总量超过上限时按修改时间（即最近使用时间）从旧到新删除
+ */
+void prune()
+{
+    QFileInfoList entries = QDir(cacheDir()).entryInfoList({ QStringLiteral("*.yuv") }, QDir::Files, QDir::Time);
+    qint64 total = 0;
+    for (const QFileInfo &entry : entries) {
+        total += entry.size();
+    }
+    while (total > MAX_CACHE_BYTES && !entries.isEmpty()) {
+        const QFileInfo oldest = entries.takeLast();
+        if (QFile::remove(oldest.absoluteFilePath())) {
+            total -= oldest.size();
+            qDebug() << "[帧缓存] 淘汰:" << oldest.fileName();
+        }
+    }
+}
+
+} // namespace
+
+// ============================================================================
+// 键与条件
+// ============================================================================
+
+QString LoopFrameCache::key(const QString &file, const QSize &outputSize)
+{
+    // 只读首尾：容器头、索引与首尾数据足以区分不同内容，不必读完整个文件
+    QFile input(file);
+    if (!input.open(QIODevice::ReadOnly)) return QString();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray::number(input.size()));
+    hash.addData(input.read(HASH_BYTES));
+    if (input.size() > HASH_BYTES && input.seek(qMax(HASH_BYTES, input.size() - HASH_BYTES))) {
+        hash.addData(input.read(HASH_BYTES));
+    }
+    hash.addData(QByteArray::number(outputSize.width()) + 'x' + QByteArray::number(outputSize.height()));
+    hash.addData(QByteArray::number(FORMAT_VERSION));
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+QSize LoopFrameCache::outputSize(const QSize &source, const QSize &display)
+{
+    if (source.isEmpty()) return QSize();
+    double scale = 1.0;
+    if (!display.isEmpty()) {
+        scale = qMin(1.0, qMin(double(display.width()) / source.width(), double(display.height()) / source.height()));
+    }
+    return QSize(qMax(2, qRound(source.width() * scale) & ~1), qMax(2, qRound(source.height() * scale) & ~1));
+}
+
+bool LoopFrameCache::eligible(double duration, double fps, const QSize &outputSize)
+{
+    if (duration <= 0 || duration > MAX_LOOP_SECONDS || fps <= 0 || outputSize.isEmpty()) return false;
+    int linesize[3];
+    const qint64 frames = static_cast<qint64>(std::ceil(duration * fps));
+    return frames * frameLayout(outputSize, linesize) <= MAX_ENTRY_BYTES;
+}
+
+// ============================================================================
+// 读取（映射）
+// ============================================================================
+
+std::shared_ptr<const LoopFrameCache> LoopFrameCache::open(const QString &key)
+{
+    if (key.isEmpty()) return nullptr;
+    std::shared_ptr<LoopFrameCache> cache(new LoopFrameCache);
+    cache->m_file.setFileName(cachePath(key));
+    if (!cache->m_file.open(QIODevice::ReadOnly)) return nullptr;
+
+    FileHeader header;
+    if (cache->m_file.read(reinterpret_cast<char *>(&header), sizeof(header)) != sizeof(header)
+        || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != FORMAT_VERSION
+        || header.frameCount <= 0 || header.width <= 0 || header.height <= 0) {
+        qWarning() << "[帧缓存] 文件无效，删除:" << cache->m_file.fileName();
+        cache->m_file.remove();
+        return nullptr;
+    }
+    const QSize size(header.width, header.height);
+    int linesize[3];
+    const qint64 frameBytes = frameLayout(size, linesize);
+    const qint64 indexOffset = PAGE_BYTES + frameBytes * header.frameCount;
+    if (frameBytes != header.frameBytes
+        || cache->m_file.size() < indexOffset + qint64(sizeof(double)) * header.frameCount) {
+        qWarning() << "[帧缓存] 文件不完整，删除:" << cache->m_file.fileName();
+        cache->m_file.remove();
+        return nullptr;
+    }
+
+    // 只读映射：帧数据由页缓存提供，多个进程（或重复打开）共享同一份物理页
+    cache->m_data = cache->m_file.map(0, cache->m_file.size());
+    if (!cache->m_data) return nullptr;
+    cache->m_file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+
+    cache->m_positions = reinterpret_cast<const double *>(cache->m_data + indexOffset);
+    cache->m_frameCount = header.frameCount;
+    cache->m_loopDuration = header.loopDuration;
+    cache->m_width = header.width;
+    cache->m_height = header.height;
+    cache->m_frameBytes = frameBytes;
+    const qint64 chromaBytes = qint64(linesize[1]) * ((header.height + 1) / 2);
+    for (int i = 0; i < 3; i++) {
+        cache->m_linesize[i] = linesize[i];
+    }
+    cache->m_planeOffset[0] = 0;
+    cache->m_planeOffset[1] = qint64(linesize[0]) * header.height;
+    cache->m_planeOffset[2] = cache->m_planeOffset[1] + chromaBytes;
+    cache->m_transfer = header.transfer;
+    cache->m_bt2020 = header.bt2020;
+    cache->m_fullRange = header.fullRange;
+    cache->m_peakNits = header.peakNits;
+
+    qDebug() << "[帧缓存] 命中:" << header.width << "x" << header.height << header.frameCount << "帧，"
+             << cache->m_file.size() / (1024 * 1024) << "MB";
+    return cache;
+}
+
+LoopFrameCache::~LoopFrameCache()
+{
+    if (m_data) {
+        m_file.unmap(const_cast<uchar *>(m_data));
+    }
+}
+
+int LoopFrameCache::frameAt(double position) const
+{
+    const double *end = m_positions + m_frameCount;
+    return static_cast<int>(std::lower_bound(m_positions, end, position - 0.0005) - m_positions);
+}
+
+void LoopFrameCache::frame(int index, RhiVideoFrame &out) const
+{
+    const uchar *base = m_data + PAGE_BYTES + m_frameBytes * index;
+    const int planeHeights[3] = { m_height, (m_height + 1) / 2, (m_height + 1) / 2 };
+    for (int i = 0; i < 3; i++) {
+        // 不复制：QByteArray 只引用映射，backing 保证帧存活期间映射不被解除
+        out.planes[i] = QByteArray::fromRawData(reinterpret_cast<const char *>(base + m_planeOffset[i]),
+                                                m_linesize[i] * planeHeights[i]);
+        out.linesize[i] = m_linesize[i];
+    }
+    out.width = m_width;
+    out.height = m_height;
+    out.position = m_positions[index];
+    out.bitDepth = 8;
+    out.transfer = static_cast<VideoTransfer>(m_transfer);
+    out.bt2020 = m_bt2020;
+    out.fullRange = m_fullRange;
+    out.peakNits = m_peakNits;
+    out.backing = shared_from_this();
+}
+
+// ============================================================================
+// 录制
+// ============================================================================
+
+LoopFrameCacheWriter::LoopFrameCacheWriter(const QString &key, const QSize &outputSize)
+    : m_key(key)
+    , m_size(outputSize)
+{
+    m_frameBytes = frameLayout(m_size, m_linesize);
+    m_file.setFileName(cachePath(key) + QStringLiteral(".part"));
+    if (!QDir().mkpath(cacheDir()) || !m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+        || !m_file.seek(PAGE_BYTES)) {
+        qWarning() << "[帧缓存] 无法写入:" << m_file.fileName();
+        abandon();
+        return;
+    }
+    m_staging.fill('\0', m_frameBytes);
+}
+
+LoopFrameCacheWriter::~LoopFrameCacheWriter()
+{
+    abandon();
+}
+
+bool LoopFrameCacheWriter::add(const RhiVideoFrame &frame)
+{
+    if (!m_active) return false;
+    if (frame.bitDepth != 8 || frame.deinterlace != DeinterlaceMode::Off
+        || PAGE_BYTES + m_frameBytes * (m_positions.size() + 1) > MAX_ENTRY_BYTES) {
+        abandon();
+        return false;
+    }
+    if (m_positions.isEmpty()) {
+        m_transfer = static_cast<int>(frame.transfer);
+        m_bt2020 = frame.bt2020;
+        m_fullRange = frame.fullRange;
+        m_peakNits = frame.peakNits;
+    }
+
+    // 流中途改变尺寸时按新尺寸缩放到同一输出尺寸，缓存帧尺寸始终一致
+    m_swsCtx = sws_getCachedContext(m_swsCtx, frame.width, frame.height, AV_PIX_FMT_YUV420P,
+                                    m_size.width(), m_size.height(), AV_PIX_FMT_YUV420P,
+                                    SWS_BILINEAR, nullptr, nullptr, nullptr);
+    if (!m_swsCtx) {
+        abandon();
+        return false;
+    }
+    const int chromaHeight = (m_size.height() + 1) / 2;
+    uint8_t *base = reinterpret_cast<uint8_t *>(m_staging.data());
+    uint8_t *dst[4] = { base, base + qint64(m_linesize[0]) * m_size.height(), nullptr, nullptr };
+    dst[2] = dst[1] + qint64(m_linesize[1]) * chromaHeight;
+    const int dstStride[4] = { m_linesize[0], m_linesize[1], m_linesize[2], 0 };
+    const uint8_t *src[4] = {
+        reinterpret_cast<const uint8_t *>(frame.planes[0].constData()),
+        reinterpret_cast<const uint8_t *>(frame.planes[1].constData()),
+        reinterpret_cast<const uint8_t *>(frame.planes[2].constData()),
+        nullptr,
+    };
+    const int srcStride[4] = { frame.linesize[0], frame.linesize[1], frame.linesize[2], 0 };
+    sws_scale(m_swsCtx, src, srcStride, 0, frame.height, dst, dstStride);
+
+    if (m_file.write(m_staging) != m_staging.size()) {
+        qWarning() << "[帧缓存] 写入失败:" << m_file.errorString();
+        abandon();
+        return false;
+    }
+    m_positions.append(frame.position);
+    return true;
+}
+
+bool LoopFrameCacheWriter::finish(double loopDuration)
+{
+    if (!m_active || m_positions.isEmpty() || loopDuration <= 0) {
+        abandon();
+        return false;
+    }
+
+    FileHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = FORMAT_VERSION;
+    header.width = m_size.width();
+    header.height = m_size.height();
+    header.frameCount = static_cast<qint32>(m_positions.size());
+    for (int i = 0; i < 3; i++) {
+        header.linesize[i] = m_linesize[i];
+    }
+    header.transfer = m_transfer;
+    header.bt2020 = m_bt2020;
+    header.fullRange = m_fullRange;
+    header.peakNits = m_peakNits;
+    header.loopDuration = loopDuration;
+    header.frameBytes = m_frameBytes;
+
+    const qint64 indexBytes = qint64(sizeof(double)) * m_positions.size();
+    const bool ok = m_file.write(reinterpret_cast<const char *>(m_positions.constData()), indexBytes) == indexBytes
+                 && m_file.seek(0)
+                 && m_file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header)
+                 && m_file.flush();
+    m_file.close();
+    const QString finalPath = cachePath(m_key);
+    QFile::remove(finalPath);
+    if (!ok || !QFile::rename(m_file.fileName(), finalPath)) {
+        abandon();
+        return false;
+    }
+    m_active = false;
+    qDebug() << "[帧缓存] 已写入:" << m_size.width() << "x" << m_size.height() << m_positions.size() << "帧，"
+             << QFileInfo(finalPath).size() / (1024 * 1024) << "MB";
+    prune();
+    return true;
+}
+
+void LoopFrameCacheWriter::abandon()
+{
+    sws_freeContext(m_swsCtx);
+    m_swsCtx = nullptr;
+    m_staging = QByteArray();
+    if (m_active) {
+        m_active = false;
+        m_file.close();
+        m_file.remove();
+    }
+}
+
+#endif // FFMPEG_AVAILABLE
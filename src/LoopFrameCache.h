@@ -0,0 +1,142 @@
+/**
+ * @file LoopFrameCache.h
+ * @brief 短循环的磁盘帧缓存：解码后的显示尺寸 YUV420P 帧写入可映射文件，之后直接从映射播放
+ *
+ * 短叠加循环每次进程启动都要重新解码。第一次播放时转换阶段把第一轮循环的每一帧
+ * （缩到显示尺寸以内）顺序写入 <CacheLocation>/frames/<键>.yuv，循环结束后写入文件头与索引并改名。
+ * 之后打开同一文件、同一输出尺寸时映射该文件：
+ * - 不再启动视频解码与转换阶段，帧平面以 QByteArray::fromRawData 指向映射，上传直接读页缓存，不复制
+ * - demux 照常运行（音频与循环时间轴），视频包只用于推算循环长度后丢弃
+ *
+ * 键为内容哈希（文件大小 + 首尾各 HASH_BYTES 字节）与输出尺寸；文件替换后自动失效。
+ * 只缓存时长不超过 MAX_LOOP_SECONDS、预计大小不超过 MAX_ENTRY_BYTES 的本地 8 位逐行片源；
+ * 目录总量超过 MAX_CACHE_BYTES 时按最近使用时间淘汰。
+ *
+ * 文件布局（小端）：
+ *   [文件头，PAGE_BYTES 字节] [帧 0] [帧 1] ... [位置索引 double × 帧数]
+ * 每帧依次为 Y / U / V 平面（行宽按 64 字节对齐），整帧按 PAGE_BYTES 对齐。
+ */
+
+#ifndef LOOPFRAMECACHE_H
+#define LOOPFRAMECACHE_H
+
+#include <QFile>
+#include <QList>
+#include <QSize>
+#include <QString>
+#include <QtGlobal>
+#include <memory>
+
+struct RhiVideoFrame;
+struct SwsContext;
+
+class LoopFrameCache : public std::enable_shared_from_this<LoopFrameCache>
+{
+public:
+    /**
+     * @brief 缓存键：内容哈希 + 输出尺寸
+     */
+    static QString key(const QString &file, const QSize &outputSize);
+
+    /**
+     * @brief 输出尺寸：源尺寸缩到显示尺寸以内（保持宽高比，不放大，取偶数）
+     */
+    static QSize outputSize(const QSize &source, const QSize &display);
+
+    /**
+     * @brief 片段是否值得缓存（短循环、总大小在上限内）
+     */
+    static bool eligible(double duration, double fps, const QSize &outputSize);
+
+    /**
+     * @brief 映射已完成的缓存文件，并刷新最近使用时间
+     * @return 未命中或文件无效时返回 nullptr
+     */
+    static std::shared_ptr<const LoopFrameCache> open(const QString &key);
+
+    ~LoopFrameCache();
+    LoopFrameCache(const LoopFrameCache&) = delete;
+    LoopFrameCache &operator=(const LoopFrameCache&) = delete;
+
+    int frameCount() const { return m_frameCount; }
+    double loopDuration() const { return m_loopDuration; }
+    qint64 mappedBytes() const { return m_file.size(); }
+
+    /**
+     * @brief 文件内位置不早于 position 的第一帧，超过最后一帧时返回 frameCount()
+     */
+    int frameAt(double position) const;
+
+    /**
+     * @brief 填充第 index 帧：平面指向映射（不复制），position 为文件内位置，pts / serial 由调用方设置
+     */
+    void frame(int index, RhiVideoFrame &out) const;
+
+private:
+    LoopFrameCache() = default;
+
+    QFile m_file;
+    const uchar *m_data = nullptr;
+    const double *m_positions = nullptr;
+    int m_frameCount = 0;
+    double m_loopDuration = 0;
+    int m_width = 0;
+    int m_height = 0;
+    int m_linesize[3] = {0, 0, 0};
+    qint64 m_planeOffset[3] = {0, 0, 0};
+    qint64 m_frameBytes = 0;
+    int m_transfer = 0;
+    bool m_bt2020 = false;
+    bool m_fullRange = false;
+    float m_peakNits = 0;
+};
+
+/**
+ * @brief 第一轮循环的录制：只在转换阶段调用
+ *
+ * 跳转、尺寸变化、隔行 / 高位深帧或超过单条上限时放弃，删除未完成的文件。
+ */
+class LoopFrameCacheWriter
+{
+public:
+    LoopFrameCacheWriter(const QString &key, const QSize &outputSize);
+    ~LoopFrameCacheWriter();
+    LoopFrameCacheWriter(const LoopFrameCacheWriter&) = delete;
+    LoopFrameCacheWriter &operator=(const LoopFrameCacheWriter&) = delete;
+
+    /**
+     * @brief 追加一帧（必要时缩放到输出尺寸）
+     * @return false 表示已放弃，之后不必再调用
+     */
+    bool add(const RhiVideoFrame &frame);
+
+    /**
+     * @brief 第一轮结束：写入索引与文件头并改名为正式文件
+     * @param loopDuration 一轮循环在连续时间轴上的长度（demux 推算的下一轮起点）
+     */
+    bool finish(double loopDuration);
+
+    /**
+     * @brief 放弃录制，删除未完成的文件
+     */
+    void abandon();
+
+private:
+    QString m_key;
+    QFile m_file;       // <键>.yuv.part
+    QSize m_size;
+    int m_linesize[3] = {0, 0, 0};
+    qint64 m_frameBytes = 0;
+    QList<double> m_positions;
+    QByteArray m_staging;           // 一帧（含页对齐填充）
+    SwsContext *m_swsCtx = nullptr;
+    bool m_active = true;
+
+    // 色彩属性取自第一帧
+    int m_transfer = 0;
+    bool m_bt2020 = false;
+    bool m_fullRange = false;
+    float m_peakNits = 0;
+};
+
+#endif // LOOPFRAMECACHE_H
@@ -0,0 +1,104 @@
+/**
+ * @file MediaProbe.cpp
+ * @brief 后台预探测媒体文件实现
+ */
+
+#include "MediaProbe.h"
+#include "StartupTimeline.h"
+
+#include <QDebug>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <memory>
+
+#if FFMPEG_AVAILABLE
+
+namespace {
+
+struct ProbeState {
+    QMutex mutex;
+    QString filename;
+    std::unique_ptr<QThread> thread;
+    AVFormatContext *formatCtx = nullptr;   // 探测线程写入，join 后由 take/discard 读取
+};
+
+ProbeState &state()
+{
+    static ProbeState instance;
+    return instance;
+}
+
+/**
+ * @brief 等待探测线程结束并释放结果（调用方持有 mutex）
+ */
+void discardLocked(ProbeState &s)
+{
+    if (s.thread) {
+        s.thread->wait();
+        s.thread.reset();
+    }
+    if (s.formatCtx) {
+        avformat_close_input(&s.formatCtx);
+    }
+    s.filename.clear();
+}
+
+} // namespace
+
+void MediaProbe::start(const QString &filename)
+{
+    ProbeState &s = state();
+    QMutexLocker locker(&s.mutex);
+    discardLocked(s);
+
+    s.filename = filename;
+    const QByteArray path = filename.toUtf8();
+    s.thread.reset(QThread::create([&s, path]() {
+        StartupTimeline::mark("probe start");
+        AVFormatContext *ctx = avformat_alloc_context();
+        if (avformat_open_input(&ctx, path.constData(), nullptr, nullptr) != 0) {
+            // 失败时 ctx 已被释放；交给 openFile 重新打开并报告错误
+            return;
+        }
+        if (avformat_find_stream_info(ctx, nullptr) < 0) {
+            avformat_close_input(&ctx);
+            return;
+        }
+        s.formatCtx = ctx;
+        StartupTimeline::mark("probe done");
+    }));
+    s.thread->start();
+}
+
+AVFormatContext *MediaProbe::take(const QString &filename)
+{
+    ProbeState &s = state();
+    QMutexLocker locker(&s.mutex);
+    if (!s.thread || s.filename != filename) {
+        return nullptr;
+    }
+    s.thread->wait();
+    s.thread.reset();
+    AVFormatContext *ctx = s.formatCtx;
+    s.formatCtx = nullptr;
+    s.filename.clear();
+    if (ctx) {
+        qDebug() << "使用预探测结果:" << filename;
+    }
+    return ctx;
+}
+
+void MediaProbe::discard()
+{
+    ProbeState &s = state();
+    QMutexLocker locker(&s.mutex);
+    discardLocked(s);
+}
+
+#else
+
+void MediaProbe::start(const QString &) {}
+void MediaProbe::discard() {}
+
+#endif
@@ -0,0 +1,43 @@
+/**
+ * @file MediaProbe.h
+ * @brief 后台预探测媒体文件（与窗口、GPU 初始化并行）
+ *
+ * main 在解析完命令行后立即 start()，在后台线程执行 avformat_open_input +
+ * avformat_find_stream_info；渲染器 openFile 时 take() 取走已探测好的上下文，
+ * 文件名不匹配或未启动预探测时返回 nullptr，调用方照常自行打开。
+ */
+
+#ifndef MEDIAPROBE_H
+#define MEDIAPROBE_H
+
+#include <QString>
+
+#if FFMPEG_AVAILABLE
+extern "C" {
+#include <libavformat/avformat.h>
+}
+#endif
+
+class MediaProbe
+{
+public:
+    /**
+     * @brief 启动后台探测（重复调用会丢弃上一次未取走的结果）
+     */
+    static void start(const QString &filename);
+
+#if FFMPEG_AVAILABLE
+    /**
+     * @brief 等待探测完成并取走上下文（所有权转移给调用方）
+     * @return 文件名匹配且探测成功时返回上下文，否则 nullptr
+     */
+    static AVFormatContext *take(const QString &filename);
+#endif
+
+    /**
+     * @brief 丢弃未取走的结果（程序退出前调用）
+     */
+    static void discard();
+};
+
+#endif // MEDIAPROBE_H
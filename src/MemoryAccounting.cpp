@@ -0,0 +1,302 @@
+/**
+ * @file MemoryAccounting.cpp
+ * @brief 内存记账实现
+ */
+
+#include "MemoryAccounting.h"
+
+#include <mutex>
+
+#if FFMPEG_AVAILABLE
+extern "C" {
+#include <libavutil/buffer.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/pixdesc.h>
+}
+#endif
+
+static void updateMax(std::atomic<qint64> &target, qint64 value)
+{
+    qint64 current = target.load(std::memory_order_relaxed);
+    while (value > current
+           && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+// ============================================
+// MemoryAccounting
+// ============================================
+
+MemoryAccounting::MemoryAccounting(MemoryAccounting *parent)
+    : m_parent(parent)
+{
+}
+
+MemoryAccounting &MemoryAccounting::process()
+{
+    static MemoryAccounting instance{RootTag{}};
+    return instance;
+}
+
+const char *MemoryAccounting::categoryName(MemoryCategory category)
+{
+    switch (category) {
+    case MemoryCategory::PacketQueue:       return "packet_queue";
+    case MemoryCategory::FrameQueue:        return "frame_queue";
+    case MemoryCategory::ConversionBuffers: return "conversion_buffers";
+    case MemoryCategory::GpuTextures:       return "gpu_textures";
+    case MemoryCategory::AudioBuffers:      return "audio_buffers";
+    case MemoryCategory::Caches:            return "caches";
+    case MemoryCategory::FFmpegPools:       return "ffmpeg_pools";
+    }
+    return "unknown";
+}
+
+void MemoryAccounting::add(MemoryCategory category, qint64 bytes)
+{
+    if (bytes == 0) return;
+
+    const int index = static_cast<int>(category);
+    const qint64 current = m_current[index].fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    const qint64 total = m_total.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    if (bytes > 0) {
+        updateMax(m_highWater[index], current);
+        updateMax(m_totalHighWater, total);
+    }
+
+    if (m_parent) {
+        m_parent->add(category, bytes);
+    }
+}
+
+MemoryUsageSnapshot MemoryAccounting::snapshot() const
+{
+    MemoryUsageSnapshot snapshot;
+    for (int i = 0; i < MEMORY_CATEGORY_COUNT; i++) {
+        snapshot.current[i] = m_current[i].load(std::memory_order_relaxed);
+        snapshot.highWater[i] = m_highWater[i].load(std::memory_order_relaxed);
+    }
+    snapshot.total = m_total.load(std::memory_order_relaxed);
+    snapshot.totalHighWater = m_totalHighWater.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+void MemoryAccounting::resetHighWater()
+{
+    for (int i = 0; i < MEMORY_CATEGORY_COUNT; i++) {
+        m_highWater[i].store(m_current[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+    m_totalHighWater.store(m_total.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+// ============================================
+// MemoryCharge
+// ============================================
+
+MemoryCharge::MemoryCharge(MemoryAccounting *accounting, MemoryCategory category, qint64 bytes)
+    : m_accounting(accounting)
+    , m_category(category)
+{
+    resize(bytes);
+}
+
+MemoryCharge::MemoryCharge(MemoryCharge &&other) noexcept
+    : m_accounting(other.m_accounting)
+    , m_category(other.m_category)
+    , m_bytes(other.m_bytes)
+{
+    other.m_bytes = 0;
+}
+
+MemoryCharge &MemoryCharge::operator=(MemoryCharge &&other) noexcept
+{
+    if (this != &other) {
+        resize(0);
+        m_accounting = other.m_accounting;
+        m_category = other.m_category;
+        m_bytes = other.m_bytes;
+        other.m_bytes = 0;
+    }
+    return *this;
+}
+
+void MemoryCharge::resize(qint64 bytes)
+{
+    if (!m_accounting || bytes == m_bytes) return;
+    m_accounting->add(m_category, bytes - m_bytes);
+    m_bytes = bytes;
+}
+
+// ============================================
+// AccountedBufferPools
+// ============================================
+
+#if FFMPEG_AVAILABLE
+
+namespace {
+
+static constexpr int MAX_PLANES = 4;
+// 按缓冲大小分池：各平面同尺寸时共用一个池；流在两种分辨率间来回切换时两套池都保留
+static constexpr int MAX_SIZE_CLASSES = 2 * MAX_PLANES;
+// 与 libavcodec 默认分配一致：每块额外预留 16 字节与一次 SIMD 对齐
+static constexpr size_t POOL_PADDING = 16 + 64 - 1;
+
+/**
+ * @brief 单个池的信息：池内缓冲的释放回调需要知道大小与记账目标
+ *
+ * 池销毁（所有缓冲归还之后）时由 freePool 删除。
+ */
+struct PoolInfo {
+    MemoryAccounting *accounting = nullptr;
+    size_t size = 0;
+};
+
+void freeBlock(void *opaque, uint8_t *data)
+{
+    auto *info = static_cast<PoolInfo*>(opaque);
+    info->accounting->release(MemoryCategory::FFmpegPools, static_cast<qint64>(info->size));
+    av_free(data);
+}
+
+AVBufferRef *allocBlock(void *opaque, size_t size)
+{
+    auto *info = static_cast<PoolInfo*>(opaque);
+    auto *data = static_cast<uint8_t*>(av_malloc(size));
+    if (!data) return nullptr;
+
+    AVBufferRef *buffer = av_buffer_create(data, size, freeBlock, info, 0);
+    if (!buffer) {
+        av_free(data);
+        return nullptr;
+    }
+    info->accounting->add(MemoryCategory::FFmpegPools, static_cast<qint64>(size));
+    return buffer;
+}
+
+void freePool(void *opaque)
+{
+    delete static_cast<PoolInfo*>(opaque);
+}
+
+} // namespace
+
+struct AccountedBufferPools::State {
+    struct SizeClass {
+        AVBufferPool *pool = nullptr;
+        size_t size = 0;
+        quint64 lastUse = 0;
+    };
+
+    MemoryAccounting *accounting = nullptr;
+    std::mutex mutex;                       // 帧线程并发调用 get_buffer2
+    SizeClass classes[MAX_SIZE_CLASSES];
+    quint64 useCounter = 0;
+
+    ~State()
+    {
+        for (SizeClass &sizeClass : classes) {
+            av_buffer_pool_uninit(&sizeClass.pool);
+        }
+    }
+
+    /**
+     * @brief 取指定大小的池，没有则淘汰最久未用的一类后新建（调用方持锁）
+     *
+     * 被淘汰的池在已借出的缓冲全部归还后自行释放。
+     */
+    AVBufferPool *poolFor(size_t size)
+    {
+        SizeClass *victim = &classes[0];
+        for (SizeClass &sizeClass : classes) {
+            if (sizeClass.pool && sizeClass.size == size) {
+                sizeClass.lastUse = ++useCounter;
+                return sizeClass.pool;
+            }
+            if (!victim->pool) continue;
+            if (!sizeClass.pool || sizeClass.lastUse < victim->lastUse) victim = &sizeClass;
+        }
+
+        av_buffer_pool_uninit(&victim->pool);
+        auto *info = new PoolInfo{accounting, size};
+        victim->pool = av_buffer_pool_init2(size, info, allocBlock, freePool);
+        if (!victim->pool) {
+            delete info;
+            victim->size = 0;
+            return nullptr;
+        }
+        victim->size = size;
+        victim->lastUse = ++useCounter;
+        return victim->pool;
+    }
+};
+
+AccountedBufferPools::AccountedBufferPools(MemoryAccounting &accounting)
+    : m_state(std::make_shared<State>())
+{
+    m_state->accounting = &accounting;
+}
+
+AccountedBufferPools::~AccountedBufferPools() = default;
+
+void AccountedBufferPools::install(AVCodecContext *codecCtx)
+{
+    codecCtx->opaque = m_state.get();
+    codecCtx->get_buffer2 = &AccountedBufferPools::getBuffer2;
+}
+
+int AccountedBufferPools::getBuffer2(AVCodecContext *codecCtx, AVFrame *frame, int flags)
+{
+    auto *state = static_cast<State*>(codecCtx->opaque);
+    const auto format = static_cast<AVPixelFormat>(frame->format);
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+    if (!state || codecCtx->codec_type != AVMEDIA_TYPE_VIDEO || !desc
+        || (desc->flags & (AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_PAL))
+        || !(codecCtx->codec->capabilities & AV_CODEC_CAP_DR1)) {
+        return avcodec_default_get_buffer2(codecCtx, frame, flags);
+    }
+
+    // 与默认分配相同的尺寸与行宽对齐要求
+    int width = frame->width;
+    int height = frame->height;
+    int linesizeAlign[AV_NUM_DATA_POINTERS];
+    avcodec_align_dimensions2(codecCtx, &width, &height, linesizeAlign);
+
+    int linesize[MAX_PLANES] = {};
+    if (av_image_fill_linesizes(linesize, format, width) < 0) {
+        return avcodec_default_get_buffer2(codecCtx, frame, flags);
+    }
+    ptrdiff_t strides[MAX_PLANES] = {};
+    for (int i = 0; i < MAX_PLANES; i++) {
+        const int align = qMax(1, linesizeAlign[i]);
+        linesize[i] = (linesize[i] + align - 1) / align * align;
+        strides[i] = linesize[i];
+    }
+    size_t planeSizes[MAX_PLANES] = {};
+    if (av_image_fill_plane_sizes(planeSizes, format, height, strides) < 0) {
+        return avcodec_default_get_buffer2(codecCtx, frame, flags);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        for (int i = 0; i < MAX_PLANES; i++) {
+            if (!planeSizes[i]) break;
+            AVBufferPool *pool = state->poolFor(planeSizes[i] + POOL_PADDING);
+            if (!pool) {
+                av_frame_unref(frame);
+                return AVERROR(ENOMEM);
+            }
+            frame->buf[i] = av_buffer_pool_get(pool);
+            if (!frame->buf[i]) {
+                av_frame_unref(frame);
+                return AVERROR(ENOMEM);
+            }
+            frame->data[i] = frame->buf[i]->data;
+            frame->linesize[i] = linesize[i];
+        }
+    }
+
+    frame->extended_data = frame->data;
+    return 0;
+}
+
+#endif // FFMPEG_AVAILABLE
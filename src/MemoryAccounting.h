@@ -0,0 +1,164 @@
+/**
+ * @file MemoryAccounting.h
+ * @brief 按播放器、按子系统的内存记账
+ *
+ * 每个播放器持有一个 MemoryAccounting（在 PlaybackMetrics 中），变化同时汇总到进程级实例，
+ * 用于估算每种 kiosk 硬件能同时跑多少路循环播放。
+ *
+ * 记账方式：
+ * - MemoryCharge：与对象生命周期绑定，析构时自动释放（队列清空、帧丢弃都不需要额外处理）
+ * - add/release：无法挂载 RAII 对象的地方（如 AVPacket* 队列）手动成对调用
+ * - AccountedBufferPools：替换解码器 get_buffer2，FFmpeg 帧缓冲池走 av_buffer_pool 并计入
+ *
+ * 计数都是 relaxed 原子量，任何线程可更新、可读取快照。
+ */
+
+#ifndef MEMORYACCOUNTING_H
+#define MEMORYACCOUNTING_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <memory>
+
+/**
+ * @brief 内存子系统
+ */
+enum class MemoryCategory {
+    PacketQueue,        ///< 待解码的压缩包
+    FrameQueue,         ///< 已解码、待呈现的 CPU 帧
+    ConversionBuffers,  ///< 颜色转换 / GPU→CPU 传输的中间缓冲
+    GpuTextures,        ///< GPU 纹理与上传缓冲
+    AudioBuffers,       ///< 解码后的音频块与设备缓冲
+    Caches,             ///< 各类缓存
+    FFmpegPools,        ///< 解码器帧缓冲池（av_buffer_pool）
+};
+static constexpr int MEMORY_CATEGORY_COUNT = 7;
+
+/**
+ * @brief 内存快照（字节）
+ */
+struct MemoryUsageSnapshot {
+    qint64 current[MEMORY_CATEGORY_COUNT] = {};
+    qint64 highWater[MEMORY_CATEGORY_COUNT] = {};
+    qint64 total = 0;
+    qint64 totalHighWater = 0;
+};
+
+/**
+ * @brief 内存记账
+ */
+class MemoryAccounting
+{
+public:
+    /**
+     * @param parent 汇总目标，默认为进程级实例；进程级实例自身没有上级
+     */
+    explicit MemoryAccounting(MemoryAccounting *parent = &process());
+
+    MemoryAccounting(const MemoryAccounting &) = delete;
+    MemoryAccounting &operator=(const MemoryAccounting &) = delete;
+
+    /**
+     * @brief 增减记账（负数表示释放）
+     */
+    void add(MemoryCategory category, qint64 bytes);
+    void release(MemoryCategory category, qint64 bytes) { add(category, -bytes); }
+
+    MemoryUsageSnapshot snapshot() const;
+
+    /**
+     * @brief 把各项高水位重置为当前值（按采样周期统计）
+     */
+    void resetHighWater();
+
+    /**
+     * @brief 进程级汇总（所有播放器）
+     */
+    static MemoryAccounting &process();
+
+    static const char *categoryName(MemoryCategory category);
+
+private:
+    struct RootTag {};
+    explicit MemoryAccounting(RootTag) {}
+
+    MemoryAccounting *m_parent = nullptr;
+    std::atomic<qint64> m_current[MEMORY_CATEGORY_COUNT] = {};
+    std::atomic<qint64> m_highWater[MEMORY_CATEGORY_COUNT] = {};
+    std::atomic<qint64> m_total{0};
+    std::atomic<qint64> m_totalHighWater{0};
+};
+
+/**
+ * @brief 与对象生命周期绑定的记账（只可移动）
+ *
+ * 可复制的帧结构通过 std::shared_ptr<MemoryCharge> 持有，最后一个副本析构时释放。
+ */
+class MemoryCharge
+{
+public:
+    MemoryCharge() = default;
+    MemoryCharge(MemoryAccounting *accounting, MemoryCategory category, qint64 bytes);
+    ~MemoryCharge() { resize(0); }
+
+    MemoryCharge(MemoryCharge &&other) noexcept;
+    MemoryCharge &operator=(MemoryCharge &&other) noexcept;
+    MemoryCharge(const MemoryCharge &) = delete;
+    MemoryCharge &operator=(const MemoryCharge &) = delete;
+
+    /**
+     * @brief 调整记账大小（如纹理重建）
+     */
+    void resize(qint64 bytes);
+    qint64 bytes() const { return m_bytes; }
+
+    /**
+     * @brief 创建可在帧副本间共享的记账
+     */
+    static std::shared_ptr<MemoryCharge> shared(MemoryAccounting &accounting, MemoryCategory category, qint64 bytes)
+    {
+        return std::make_shared<MemoryCharge>(&accounting, category, bytes);
+    }
+
+private:
+    MemoryAccounting *m_accounting = nullptr;
+    MemoryCategory m_category = MemoryCategory::Caches;
+    qint64 m_bytes = 0;
+};
+
+#if FFMPEG_AVAILABLE
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+/**
+ * @brief 记账的解码器帧缓冲池
+ *
+ * install() 把解码器的 get_buffer2 替换为按平面大小从 av_buffer_pool 取缓冲，
+ * 池中每块缓冲从分配到池销毁都计入 FFmpegPools。硬件帧、调色板格式和音频仍走默认分配。
+ * 池按缓冲大小分类保留，流中途改变分辨率时只新建缺少的大小，切回原分辨率时直接复用。
+ * 必须比解码器上下文活得久（池在所有帧释放后才真正销毁）。
+ */
+class AccountedBufferPools
+{
+public:
+    explicit AccountedBufferPools(MemoryAccounting &accounting);
+    ~AccountedBufferPools();
+
+    AccountedBufferPools(const AccountedBufferPools &) = delete;
+    AccountedBufferPools &operator=(const AccountedBufferPools &) = delete;
+
+    /**
+     * @brief 安装到解码器（avcodec_open2 之前调用）
+     */
+    void install(AVCodecContext *codecCtx);
+
+private:
+    struct State;
+    static int getBuffer2(AVCodecContext *codecCtx, AVFrame *frame, int flags);
+
+    std::shared_ptr<State> m_state;
+};
+#endif
+
+#endif // MEMORYACCOUNTING_H
@@ -0,0 +1,395 @@
+/**
+ * @file MetricsExporter.cpp
+ * @brief 本地指标端点实现
+ */
+
+#include "MetricsExporter.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QMutexLocker>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <type_traits>
+#include <utility>
+
+namespace {
+
+constexpr int MAX_REQUEST_BYTES = 8192;
+constexpr int CONNECTION_TIMEOUT_MS = 5000;
+constexpr int RATE_SAMPLE_INTERVAL_MS = 1000;
+
+// 标签值只用 ASCII，便于查询
+const char *const STAGE_LABELS[PIPELINE_STAGE_COUNT] = { "demux", "decode", "present", "audio" };
+const char *const ACTION_LABELS[RECOVERY_ACTION_COUNT] = {
+    "flush_resync", "reopen_decoder", "software_fallback", "reopen_file", "reopen_audio",
+};
+
+QByteArray escapeLabel(const QString &value)
+{
+    QByteArray escaped = value.toUtf8();
+    escaped.replace('\\', "\\\\").replace('"', "\\\"").replace('\n', "\\n");
+    return escaped;
+}
+
+/**
+ * @brief 按行拼接 Prometheus 文本：每个指标族先输出 HELP / TYPE，再输出各来源的序列
+ */
+class PrometheusWriter
+{
+public:
+    void family(const char *name, const char *type, const char *help)
+    {
+        m_out += "# HELP ";
+        m_out += name;
+        m_out += ' ';
+        m_out += help;
+        m_out += "\n# TYPE ";
+        m_out += name;
+        m_out += ' ';
+        m_out += type;
+        m_out += '\n';
+    }
+
+    void value(const char *name, const QByteArray &labels, double value)
+    {
+        m_out += name;
+        if (!labels.isEmpty()) {
+            m_out += '{';
+            m_out += labels;
+            m_out += '}';
+        }
+        m_out += ' ';
+        m_out += QByteArray::number(value, 'g', 12);
+        m_out += '\n';
+    }
+
+    QByteArray take() { return std::move(m_out); }
+
+private:
+    QByteArray m_out;
+};
+
+} // namespace
+
+// ========================================
+// 服务端（运行在导出线程）
+// ========================================
+
+class MetricsServer : public QObject
+{
+public:
+    explicit MetricsServer(MetricsExporter *exporter) : m_exporter(exporter) {}
+
+    bool listen(const QString &address)
+    {
+        if (address.startsWith(QStringLiteral("unix:"))) {
+            const QString path = address.mid(5);
+            auto *server = new QLocalServer(this);
+            QLocalServer::removeServer(path);   // 上次异常退出残留的套接字文件
+            if (!server->listen(path)) {
+                qWarning() << "[指标] 无法监听" << path << server->errorString();
+                delete server;
+                return false;
+            }
+            connect(server, &QLocalServer::newConnection, this, [this, server]() {
+                while (QLocalSocket *socket = server->nextPendingConnection()) {
+                    serve(socket);
+                }
+            });
+            qDebug() << "[指标] 监听 Unix 套接字" << path;
+        } else {
+            bool ok = false;
+            const quint16 port = address.toUShort(&ok);
+            if (!ok) {
+                qWarning() << "[指标] 无效的监听地址:" << address;
+                return false;
+            }
+            auto *server = new QTcpServer(this);
+            if (!server->listen(QHostAddress::LocalHost, port)) {
+                qWarning() << "[指标] 无法监听 127.0.0.1:" << port << server->errorString();
+                delete server;
+                return false;
+            }
+            connect(server, &QTcpServer::newConnection, this, [this, server]() {
+                while (QTcpSocket *socket = server->nextPendingConnection()) {
+                    serve(socket);
+                }
+            });
+            qDebug().noquote() << "[指标] 监听" << QStringLiteral("http://127.0.0.1:%1/metrics").arg(server->serverPort());
+        }
+
+        if (!m_rateTimer) {
+            m_clock.start();
+            m_rateTimer = new QTimer(this);
+            connect(m_rateTimer, &QTimer::timeout, this, [this]() {
+                m_exporter->sampleRates(m_clock.nsecsElapsed());
+            });
+            m_rateTimer->start(RATE_SAMPLE_INTERVAL_MS);
+        }
+        return true;
+    }
+
+private:
+    /**
+     * @brief 最小 HTTP/1.0 应答：读到请求头结束后回复一次并关闭连接
+     */
+    template <typename Socket>
+    void serve(Socket *socket)
+    {
+        connect(socket, &Socket::disconnected, socket, &QObject::deleteLater);
+        QTimer::singleShot(CONNECTION_TIMEOUT_MS, socket, [socket]() { socket->abort(); });
+
+        connect(socket, &QIODevice::readyRead, socket, [this, socket]() {
+            QByteArray request = socket->property("request").toByteArray() + socket->readAll();
+            if (!request.contains("\r\n\r\n") && !request.contains("\n\n")) {
+                if (request.size() > MAX_REQUEST_BYTES) {
+                    socket->abort();
+                } else {
+                    socket->setProperty("request", request);
+                }
+                return;
+            }
+
+            const QList<QByteArray> requestLine = request.left(request.indexOf('\n')).trimmed().split(' ');
+            const QByteArray method = requestLine.value(0);
+            const QByteArray path = requestLine.value(1);
+
+            QByteArray status = "200 OK";
+            QByteArray contentType = "text/plain; version=0.0.4; charset=utf-8";
+            QByteArray body;
+            if (method != "GET") {
+                status = "405 Method Not Allowed";
+                body = "only GET is supported\n";
+            } else if (path == "/metrics" || path.startsWith("/metrics?")) {
+                body = m_exporter->scrape();
+            } else {
+                status = "404 Not Found";
+                body = "see /metrics\n";
+            }
+
+            QByteArray response = "HTTP/1.0 " + status + "\r\n"
+                + "Content-Type: " + contentType + "\r\n"
+                + "Content-Length: " + QByteArray::number(body.size()) + "\r\n"
+                + "Connection: close\r\n\r\n";
+            response += body;
+            socket->write(response);
+            if constexpr (std::is_same_v<Socket, QTcpSocket>) {
+                socket->disconnectFromHost();   // 写完后关闭
+            } else {
+                socket->disconnectFromServer();
+            }
+        });
+    }
+
+    MetricsExporter *m_exporter;
+    QTimer *m_rateTimer = nullptr;
+    QElapsedTimer m_clock;
+};
+
+// ========================================
+// MetricsExporter
+// ========================================
+
+MetricsExporter::MetricsExporter(QObject *parent)
+    : QObject(parent)
+{
+    m_thread.setObjectName(QStringLiteral("MetricsExporter"));
+    m_server = new MetricsServer(this);
+    m_server->moveToThread(&m_thread);
+    m_thread.start(QThread::LowPriority);
+}
+
+MetricsExporter::~MetricsExporter()
+{
+    MetricsServer *server = m_server;
+    QMetaObject::invokeMethod(server, [server]() { delete server; }, Qt::BlockingQueuedConnection);
+    m_thread.quit();
+    m_thread.wait();
+}
+
+bool MetricsExporter::listen(const QString &address)
+{
+    bool ok = false;
+    MetricsServer *server = m_server;
+    QMetaObject::invokeMethod(server, [server, address, &ok]() {
+        ok = server->listen(address);
+    }, Qt::BlockingQueuedConnection);
+    return ok;
+}
+
+void MetricsExporter::addSource(const QString &name, PlaybackMetrics *metrics)
+{
+    if (!metrics) return;
+    QMutexLocker locker(&m_mutex);
+    Source source;
+    source.name = name;
+    source.metrics = metrics;
+    source.lastPresented = metrics->snapshot().presentedFrames;
+    source.lastSampleNs = -1;
+    m_sources.append(source);
+}
+
+void MetricsExporter::removeSource(PlaybackMetrics *metrics)
+{
+    QMutexLocker locker(&m_mutex);
+    m_sources.removeIf([metrics](const Source &source) { return source.metrics == metrics; });
+}
+
+void MetricsExporter::sampleRates(qint64 nowNs)
+{
+    QMutexLocker locker(&m_mutex);
+    for (Source &source : m_sources) {
+        const quint64 presented = source.metrics->snapshot().presentedFrames;
+        if (source.lastSampleNs >= 0 && nowNs > source.lastSampleNs) {
+            source.fps = (presented - source.lastPresented) * 1e9 / (nowNs - source.lastSampleNs);
+        }
+        source.lastPresented = presented;
+        source.lastSampleNs = nowNs;
+    }
+}
+
+QByteArray MetricsExporter::scrape()
+{
+    QList<Sample> samples;
+    {
+        // 快照只读 relaxed 原子量，持锁仅为保证来源在读取期间不被移除
+        QMutexLocker locker(&m_mutex);
+        samples.reserve(m_sources.size());
+        for (const Source &source : m_sources) {
+            samples.append({source.name, source.metrics->snapshot(), source.fps});
+        }
+    }
+    return format(samples, MemoryAccounting::process().snapshot());
+}
+
+QByteArray MetricsExporter::format(const QList<Sample> &samples, const MemoryUsageSnapshot &process)
+{
+    PrometheusWriter out;
+    auto player = [](const Sample &sample) {
+        return "player=\"" + escapeLabel(sample.name) + '"';
+    };
+    auto with = [&](const Sample &sample, const char *key, const QByteArray &value) {
+        return player(sample) + ',' + key + "=\"" + value + '"';
+    };
+
+    out.family("loop_player_fps", "gauge", "Frames presented per second over the last sample interval.");
+    for (const Sample &s : samples) out.value("loop_player_fps", player(s), s.fps);
+
+    out.family("loop_player_frames_presented_total", "counter", "Frames (or fields) presented.");
+    for (const Sample &s : samples) out.value("loop_player_frames_presented_total", player(s), s.snapshot.presentedFrames);
+
+    out.family("loop_player_frames_dropped_total", "counter", "Frames dropped by the presenter to catch up with the clock.");
+    for (const Sample &s : samples) out.value("loop_player_frames_dropped_total", player(s), s.snapshot.droppedFrames);
+
+    out.family("loop_player_frames_skipped_total", "counter", "Decoded frames skipped by the presentation rate cap.");
+    for (const Sample &s : samples) out.value("loop_player_frames_skipped_total", player(s), s.snapshot.skippedFrames);
+
+    out.family("loop_player_frames_decoded_total", "counter", "Video frames decoded and queued.");
+    for (const Sample &s : samples) out.value("loop_player_frames_decoded_total", player(s), s.snapshot.videoFrames);
+
+    out.family("loop_player_reconfigurations_total", "counter", "Mid-stream resolution or pixel format changes.");
+    for (const Sample &s : samples) out.value("loop_player_reconfigurations_total", player(s), s.snapshot.reconfigurations);
+
+    out.family("loop_player_loops_total", "counter", "Times the demuxer reached the end of the file.");
+    for (const Sample &s : samples) out.value("loop_player_loops_total", player(s), s.snapshot.loops);
+
+    out.family("loop_player_seam_gaps_total", "counter", "Loop seams presented.");
+    for (const Sample &s : samples) out.value("loop_player_seam_gaps_total", player(s), s.snapshot.seamGaps);
+
+    out.family("loop_player_seam_gap_seconds", "gauge", "Extra presentation interval at loop seams.");
+    for (const Sample &s : samples) {
+        out.value("loop_player_seam_gap_seconds", with(s, "kind", "last"), s.snapshot.lastSeamGapMs / 1000.0);
+        out.value("loop_player_seam_gap_seconds", with(s, "kind", "max"), s.snapshot.maxSeamGapMs / 1000.0);
+    }
+
+    out.family("loop_player_av_offset_seconds", "gauge", "Last presented frame PTS minus master clock (positive: video ahead).");
+    for (const Sample &s : samples) out.value("loop_player_av_offset_seconds", player(s), s.snapshot.avOffsetMs / 1000.0);
+
+    out.family("loop_player_queue_depth", "gauge", "Decoded items waiting in the output queues.");
+    for (const Sample &s : samples) {
+        out.value("loop_player_queue_depth", with(s, "queue", "video"), s.snapshot.videoQueueDepth);
+        out.value("loop_player_queue_depth", with(s, "queue", "audio"), s.snapshot.audioQueueDepth);
+    }
+
+    out.family("loop_player_decode_time_seconds", "histogram", "Video decode time per frame.");
+    for (const Sample &s : samples) {
+        quint64 cumulative = 0;
+        for (int i = 0; i < DECODE_TIME_BUCKET_COUNT; i++) {
+            cumulative += s.snapshot.decodeTimeHistogram[i];
+            const QByteArray le = i < DECODE_TIME_BUCKET_COUNT - 1
+                ? QByteArray::number(DECODE_TIME_BUCKETS_US[i] / 1e6, 'g', 6) : QByteArray("+Inf");
+            out.value("loop_player_decode_time_seconds_bucket", with(s, "le", le), cumulative);
+        }
+        out.value("loop_player_decode_time_seconds_sum", player(s), s.snapshot.decodeTimeTotalUs / 1e6);
+        out.value("loop_player_decode_time_seconds_count", player(s), cumulative);
+    }
+
+    out.family("loop_player_decode_time_percentile_seconds", "gauge", "Decode time percentiles estimated from the histogram.");
+    for (const Sample &s : samples) {
+        for (const char *quantile : {"0.5", "0.95", "0.99"}) {
+            out.value("loop_player_decode_time_percentile_seconds", with(s, "quantile", quantile),
+                      s.snapshot.decodeTimePercentileUs(QByteArray(quantile).toDouble()) / 1e6);
+        }
+    }
+
+    out.family("loop_player_hardware_decoding", "gauge", "1 when the current file uses hardware decoding.");
+    for (const Sample &s : samples) out.value("loop_player_hardware_decoding", player(s), s.snapshot.hardwareDecoding ? 1 : 0);
+
+    out.family("loop_player_abr_variant", "gauge", "Current adaptive bitrate variant (ascending bandwidth), -1 when inactive.");
+    for (const Sample &s : samples) out.value("loop_player_abr_variant", player(s), s.snapshot.abrVariant);
+
+    out.family("loop_player_abr_variant_bandwidth_bits", "gauge", "Declared bandwidth of the current variant in bits per second.");
+    for (const Sample &s : samples) out.value("loop_player_abr_variant_bandwidth_bits", player(s), s.snapshot.abrBandwidth);
+
+    out.family("loop_player_abr_throughput_bits", "gauge", "Estimated download throughput in bits per second.");
+    for (const Sample &s : samples) out.value("loop_player_abr_throughput_bits", player(s), s.snapshot.abrThroughputBps);
+
+    out.family("loop_player_abr_switches_total", "counter", "Adaptive bitrate variant switches.");
+    for (const Sample &s : samples) out.value("loop_player_abr_switches_total", player(s), s.snapshot.abrSwitches);
+
+    out.family("loop_player_memory_bytes", "gauge", "Accounted memory by subsystem.");
+    for (const Sample &s : samples) {
+        for (int i = 0; i < MEMORY_CATEGORY_COUNT; i++) {
+            out.value("loop_player_memory_bytes",
+                      with(s, "subsystem", MemoryAccounting::categoryName(static_cast<MemoryCategory>(i))),
+                      s.snapshot.memory.current[i]);
+        }
+    }
+
+    out.family("loop_process_memory_bytes", "gauge", "Accounted memory by subsystem, all players.");
+    for (int i = 0; i < MEMORY_CATEGORY_COUNT; i++) {
+        out.value("loop_process_memory_bytes",
+                  "subsystem=\"" + QByteArray(MemoryAccounting::categoryName(static_cast<MemoryCategory>(i))) + '"',
+                  process.current[i]);
+    }
+
+    out.family("loop_player_audio_underruns_total", "counter", "Audio device underruns by cause.");
+    for (const Sample &s : samples) {
+        out.value("loop_player_audio_underruns_total", with(s, "cause", "decoder"), s.snapshot.audio.decoderStarvedUnderruns);
+        out.value("loop_player_audio_underruns_total", with(s, "cause", "device"), s.snapshot.audio.deviceStarvedUnderruns);
+    }
+
+    out.family("loop_player_audio_drift_ppm", "gauge", "Audio clock drift against the monotonic clock.");
+    for (const Sample &s : samples) out.value("loop_player_audio_drift_ppm", player(s), s.snapshot.audio.driftPpm);
+
+    out.family("loop_player_stalls_total", "counter", "Pipeline stalls by causing stage.");
+    for (const Sample &s : samples) {
+        for (int i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+            out.value("loop_player_stalls_total", with(s, "stage", STAGE_LABELS[i]), s.snapshot.stalls[i]);
+        }
+    }
+
+    out.family("loop_player_recoveries_total", "counter", "Successful stall recoveries by action.");
+    for (const Sample &s : samples) {
+        for (int i = 0; i < RECOVERY_ACTION_COUNT; i++) {
+            out.value("loop_player_recoveries_total", with(s, "action", ACTION_LABELS[i]), s.snapshot.recoveries[i]);
+        }
+    }
+
+    return out.take();
+}
@@ -0,0 +1,84 @@
+/**
+ * @file MetricsExporter.h
+ * @brief 本地指标端点（Prometheus 文本格式）
+ *
+ * 供集群监控抓取每台信息屏的运行状态：帧率、丢帧、循环接缝、音画偏移、队列深度、
+ * 解码耗时分布、按子系统的内存与硬件解码状态。
+ *
+ * - 监听 127.0.0.1:<端口>（HTTP）或 Unix 域套接字（同样按 HTTP 应答，
+ *   可用 curl --unix-socket 抓取），路径为 /metrics
+ * - 服务运行在独立线程：读取 PlaybackMetrics 的原子量快照后再序列化，
+ *   不在解码 / 呈现 / 音频路径上加锁或分配
+ * - 帧率由后台每秒采样呈现计数得到
+ */
+
+#ifndef METRICSEXPORTER_H
+#define METRICSEXPORTER_H
+
+#include "PlaybackMetrics.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QThread>
+
+class MetricsServer;
+
+class MetricsExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit MetricsExporter(QObject *parent = nullptr);
+    ~MetricsExporter() override;
+
+    /**
+     * @brief 开始监听
+     * @param address 端口号（"9464"，只绑定 127.0.0.1）或 "unix:<路径>"
+     * @return 监听失败返回 false（已输出警告）
+     */
+    bool listen(const QString &address);
+
+    /**
+     * @brief 登记指标来源，name 作为 player 标签；来源必须在 removeSource 或本对象析构之前有效
+     */
+    void addSource(const QString &name, PlaybackMetrics *metrics);
+    void removeSource(PlaybackMetrics *metrics);
+
+    /**
+     * @brief 当前所有来源的 Prometheus 文本（任意线程）
+     */
+    QByteArray scrape();
+
+    /**
+     * @brief 把一组快照序列化为 Prometheus 文本格式
+     */
+    struct Sample {
+        QString name;
+        PlaybackMetricsSnapshot snapshot;
+        double fps = 0;
+    };
+    static QByteArray format(const QList<Sample> &samples, const MemoryUsageSnapshot &process);
+
+private:
+    friend class MetricsServer;
+
+    struct Source {
+        QString name;
+        PlaybackMetrics *metrics = nullptr;
+        quint64 lastPresented = 0;  // 帧率采样
+        qint64 lastSampleNs = 0;
+        double fps = 0;
+    };
+
+    void sampleRates(qint64 nowNs);
+
+    QMutex m_mutex;                 // 保护来源列表（只在登记、采样、抓取时持有）
+    QList<Source> m_sources;
+    QThread m_thread;
+    MetricsServer *m_server = nullptr;
+};
+
+#endif // METRICSEXPORTER_H
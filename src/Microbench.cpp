@@ -0,0 +1,612 @@
+/**
+ * @file Microbench.cpp
+ * @brief 微基准实现（自带计时器，输出 Google Benchmark 格式 JSON）
+ */
+
+#include "Microbench.h"
+#include "FFmpegPlayer.h"
+#include "TaskGraph.h"
+#include "YuvConverter.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QQueue>
+#include <QRegularExpression>
+#include <QSysInfo>
+#include <QThread>
+#include <QWaitCondition>
+#include <ctime>
+#include <functional>
+#include <vector>
+
+#if FFMPEG_AVAILABLE
+extern "C" {
+#include <libavutil/pixdesc.h>
+}
+#endif
+
+#if FFMPEG_AVAILABLE
+
+namespace {
+
+// ==================== 计时框架 ====================
+
+/**
+ * @brief 单次运行状态
+ *
+ * 基准函数先完成准备工作，再在 start() / stop() 之间执行 iterations() 次被测操作。
+ */
+class State
+{
+public:
+    explicit State(qint64 iterations) : m_iterations(iterations) {}
+
+    qint64 iterations() const { return m_iterations; }
+
+    void start()
+    {
+        m_cpuStart = std::clock();
+        m_timer.start();
+    }
+
+    void stop()
+    {
+        m_realNs = m_timer.nsecsElapsed();
+        m_cpuNs = qint64(double(std::clock() - m_cpuStart) * 1e9 / CLOCKS_PER_SEC);
+    }
+
+    void setBytesProcessed(qint64 bytes) { m_bytes = bytes; }
+    void setItemsProcessed(qint64 items) { m_items = items; }
+    void skip(const QString &reason) { m_skipReason = reason; }
+
+    qint64 realNs() const { return m_realNs; }
+    qint64 cpuNs() const { return m_cpuNs; }
+    qint64 bytes() const { return m_bytes; }
+    qint64 items() const { return m_items; }
+    const QString &skipReason() const { return m_skipReason; }
+
+private:
+    qint64 m_iterations;
+    QElapsedTimer m_timer;
+    std::clock_t m_cpuStart = 0;
+    qint64 m_realNs = 0;
+    qint64 m_cpuNs = 0;
+    qint64 m_bytes = 0;
+    qint64 m_items = 0;
+    QString m_skipReason;
+};
+
+struct Benchmark {
+    QString name;
+    std::function<void(State &)> body;
+};
+
+static constexpr qint64 MIN_TIME_NS = 200000000;     // 每个基准至少运行 0.2 秒
+static constexpr qint64 MAX_ITERATIONS = 1000000000;
+
+/**
+ * @brief 运行一个基准：迭代次数逐步放大，直到总时间超过 MIN_TIME_NS（与 Google Benchmark 相同策略）
+ */
+QJsonObject runBenchmark(const Benchmark &benchmark)
+{
+    qint64 iterations = 1;
+    while (true) {
+        State state(iterations);
+        benchmark.body(state);
+
+        if (!state.skipReason().isEmpty()) {
+            QJsonObject result;
+            result["name"] = benchmark.name;
+            result["error_occurred"] = true;
+            result["error_message"] = state.skipReason();
+            return result;
+        }
+
+        if (state.realNs() >= MIN_TIME_NS || iterations >= MAX_ITERATIONS) {
+            const double realPerIter = double(state.realNs()) / iterations;
+            const double seconds = state.realNs() / 1e9;
+            QJsonObject result;
+            result["name"] = benchmark.name;
+            result["run_name"] = benchmark.name;
+            result["run_type"] = "iteration";
+            result["repetitions"] = 1;
+            result["iterations"] = iterations;
+            result["real_time"] = realPerIter;
+            result["cpu_time"] = double(state.cpuNs()) / iterations;
+            result["time_unit"] = "ns";
+            if (state.bytes() > 0 && seconds > 0) {
+                result["bytes_per_second"] = state.bytes() / seconds;
+            }
+            if (state.items() > 0 && seconds > 0) {
+                result["items_per_second"] = state.items() / seconds;
+            }
+            qDebug().noquote() << benchmark.name << QString::number(realPerIter, 'f', 1) << "ns" << iterations;
+            return result;
+        }
+
+        // 按已用时间估算下一轮迭代次数，最多放大 10 倍
+        const double multiplier = state.realNs() > 0
+            ? qMin(10.0, qMax(1.4 * MIN_TIME_NS / state.realNs(), 2.0)) : 10.0;
+        iterations = qMin(MAX_ITERATIONS, qint64(iterations * multiplier));
+    }
+}
+
+/**
+ * @brief 防止被测结果被编译器优化掉
+ */
+template <typename T>
+inline void doNotOptimize(const T &value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+#endif
+}
+
+// ==================== 帧队列交接 ====================
+
+/**
+ * @brief 与 DecodeThread 相同的有界队列：生产者满时等待，消费者取走后唤醒
+ */
+void benchQueueHandoff(State &state)
+{
+    QQueue<VideoFrame> queue;
+    QMutex mutex;
+    QWaitCondition notFull;
+    QWaitCondition notEmpty;
+    static constexpr int CAPACITY = 30;
+    const qint64 count = state.iterations();
+
+    const QImage image(64, 64, QImage::Format_RGB32);
+
+    state.start();
+    std::unique_ptr<QThread> producer(QThread::create([&]() {
+        for (qint64 i = 0; i < count; i++) {
+            VideoFrame frame;
+            frame.image = image;
+            frame.pts = double(i);
+            QMutexLocker locker(&mutex);
+            while (queue.size() >= CAPACITY) {
+                notFull.wait(&mutex);
+            }
+            queue.enqueue(std::move(frame));
+            notEmpty.wakeOne();
+        }
+    }));
+    producer->start();
+
+    for (qint64 i = 0; i < count; i++) {
+        QMutexLocker locker(&mutex);
+        while (queue.isEmpty()) {
+            notEmpty.wait(&mutex);
+        }
+        VideoFrame frame = queue.dequeue();
+        notFull.wakeOne();
+        doNotOptimize(frame.pts);
+    }
+    producer->wait();
+    state.stop();
+    state.setItemsProcessed(count);
+}
+
+Task handoffProducer(AsyncQueue<VideoFrame> &queue, QImage image, qint64 count)
+{
+    for (qint64 i = 0; i < count; i++) {
+        VideoFrame frame;
+        frame.image = image;
+        frame.pts = double(i);
+        if (!co_await queue.push(std::move(frame))) break;
+    }
+    queue.close();
+}
+
+Task handoffConsumer(AsyncQueue<VideoFrame> &queue)
+{
+    while (std::optional<VideoFrame> frame = co_await queue.pop()) {
+        doNotOptimize(frame->pts);
+    }
+}
+
+/**
+ * @brief 与 RHI 管线相同的协程交接：生产者挂起在满队列、消费者挂起在空队列，由两线程执行器调度
+ */
+void benchAsyncQueueHandoff(State &state)
+{
+    static constexpr int CAPACITY = 30;
+    const qint64 count = state.iterations();
+    const QImage image(64, 64, QImage::Format_RGB32);
+
+    Executor executor(2);
+    AsyncQueue<VideoFrame> queue(executor, CAPACITY);
+    TaskGroup group(executor);
+
+    state.start();
+    group.spawn(handoffProducer(queue, image, count));
+    group.spawn(handoffConsumer(queue));
+    group.wait();
+    state.stop();
+    state.setItemsProcessed(count);
+}
+
+// ==================== 颜色转换 / 缩放 ====================
+
+struct ScaleCase {
+    AVPixelFormat src;
+    FrameFormat dst;
+    QSize srcSize;
+    QSize dstSize;
+};
+
+const ScaleCase SCALE_CASES[] = {
+    { AV_PIX_FMT_YUV420P, FrameFormat::RGB32, {1280, 720},  {1280, 720} },
+    { AV_PIX_FMT_YUV420P, FrameFormat::RGB32, {1920, 1080}, {1920, 1080} },
+    { AV_PIX_FMT_YUV420P, FrameFormat::RGB32, {1920, 1080}, {960, 540} },
+    { AV_PIX_FMT_YUV420P, FrameFormat::RGB32, {1920, 1080}, {480, 270} },
+    { AV_PIX_FMT_YUV420P, FrameFormat::RGB32, {1920, 1080}, {1280, 720} },
+    { AV_PIX_FMT_YUV420P, FrameFormat::NV12,  {1920, 1080}, {1920, 1080} },
+    { AV_PIX_FMT_NV12,    FrameFormat::RGB32, {1920, 1080}, {1920, 1080} },
+    { AV_PIX_FMT_NV12,    FrameFormat::RGB32, {1920, 1080}, {960, 540} },
+    { AV_PIX_FMT_NV12,    FrameFormat::NV12,  {1920, 1080}, {1920, 1080} },
+    { AV_PIX_FMT_NV12,    FrameFormat::NV12,  {3840, 2160}, {1920, 1080} },
+};
+
+QString sizeName(const QSize &size)
+{
+    return QString("%1x%2").arg(size.width()).arg(size.height());
+}
+
+QString caseName(const ScaleCase &c)
+{
+    return QString("%1->%2/%3->%4")
+        .arg(QString::fromLatin1(av_get_pix_fmt_name(c.src)),
+             c.dst == FrameFormat::NV12 ? "nv12" : "rgb32",
+             sizeName(c.srcSize), sizeName(c.dstSize));
+}
+
+/**
+ * @brief 分配并填充源帧（内容不影响耗时，只需确定）
+ */
+AVFrame *makeSourceFrame(AVPixelFormat format, const QSize &size)
+{
+    AVFrame *frame = av_frame_alloc();
+    frame->format = format;
+    frame->width = size.width();
+    frame->height = size.height();
+    if (av_frame_get_buffer(frame, 0) < 0) {
+        av_frame_free(&frame);
+        return nullptr;
+    }
+    for (int plane = 0; plane < 3 && frame->data[plane]; plane++) {
+        const int rows = plane == 0 ? size.height() : (size.height() + 1) / 2;
+        for (int y = 0; y < rows; y++) {
+            uint8_t *row = frame->data[plane] + y * frame->linesize[plane];
+            for (int x = 0; x < frame->linesize[plane]; x++) {
+                row[x] = static_cast<uint8_t>(x * 7 + y * 3 + plane * 64);
+            }
+        }
+    }
+    return frame;
+}
+
+void benchSwsScale(State &state, const ScaleCase &c)
+{
+    AVFrame *src = makeSourceFrame(c.src, c.srcSize);
+    const AVPixelFormat dstFormat = c.dst == FrameFormat::NV12 ? AV_PIX_FMT_NV12 : AV_PIX_FMT_RGB32;
+    SwsContext *sws = sws_getContext(c.srcSize.width(), c.srcSize.height(), c.src,
+                                     c.dstSize.width(), c.dstSize.height(), dstFormat,
+                                     SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+    AVFrame *dst = av_frame_alloc();
+    dst->format = dstFormat;
+    dst->width = c.dstSize.width();
+    dst->height = c.dstSize.height();
+    if (!src || !sws || av_frame_get_buffer(dst, 0) < 0) {
+        state.skip("无法创建 sws 上下文");
+    } else {
+        state.start();
+        for (qint64 i = 0; i < state.iterations(); i++) {
+            sws_scale(sws, src->data, src->linesize, 0, c.srcSize.height(), dst->data, dst->linesize);
+        }
+        state.stop();
+        state.setBytesProcessed(state.iterations() * av_image_get_buffer_size(c.src, c.srcSize.width(), c.srcSize.height(), 1));
+        state.setItemsProcessed(state.iterations());
+    }
+    av_frame_free(&dst);
+    sws_freeContext(sws);
+    av_frame_free(&src);
+}
+
+/**
+ * @brief FrameConverter：按流选定的特化（无专用内核时即 SwsConverter）
+ */
+void benchFrameConverter(State &state, const ScaleCase &c)
+{
+    AVFrame *src = makeSourceFrame(c.src, c.srcSize);
+    FrameConverter converter;
+    if (!src || !converter.configure(c.src, c.srcSize, c.dst, c.dstSize)) {
+        state.skip("无法选择转换函数");
+    } else {
+        state.start();
+        for (qint64 i = 0; i < state.iterations(); i++) {
+            QImage image = converter.convert(src);
+            doNotOptimize(image);
+        }
+        state.stop();
+        state.setBytesProcessed(state.iterations() * av_image_get_buffer_size(c.src, c.srcSize.width(), c.srcSize.height(), 1));
+        state.setItemsProcessed(state.iterations());
+    }
+    av_frame_free(&src);
+}
+
+/**
+ * @brief 分派表中的每个特化：按表项构造能命中它的参数，确认选中的正是该特化后计时
+ */
+void benchSpecialization(State &state, const FrameConverter::Specialization &spec)
+{
+    static const QSize SOURCE_SIZE(1920, 1080);
+    const QSize outputSize(SOURCE_SIZE.width() / spec.downscale, SOURCE_SIZE.height() / spec.downscale);
+    const AVColorRange range = spec.range == YuvConverter::FullRange ? AVCOL_RANGE_JPEG : AVCOL_RANGE_MPEG;
+
+    AVFrame *src = makeSourceFrame(spec.src, SOURCE_SIZE);
+    FrameConverter converter;
+    if (!src || !converter.configure(spec.src, SOURCE_SIZE, spec.dst, outputSize, range)) {
+        state.skip("无法选择转换函数");
+    } else if (qstrcmp(converter.name(), spec.name) != 0) {
+        state.skip(QString("选中了 %1").arg(QString::fromLatin1(converter.name())));
+    } else {
+        state.start();
+        for (qint64 i = 0; i < state.iterations(); i++) {
+            QImage image = converter.convert(src);
+            doNotOptimize(image);
+        }
+        state.stop();
+        state.setBytesProcessed(state.iterations() * av_image_get_buffer_size(spec.src, SOURCE_SIZE.width(), SOURCE_SIZE.height(), 1));
+        state.setItemsProcessed(state.iterations());
+    }
+    av_frame_free(&src);
+}
+
+// ==================== 帧缓冲区 ====================
+
+void benchImageCopy(State &state, const QSize &size)
+{
+    const QImage source(size, QImage::Format_RGB32);
+    state.start();
+    for (qint64 i = 0; i < state.iterations(); i++) {
+        QImage copy = source.copy();
+        doNotOptimize(copy);
+    }
+    state.stop();
+    state.setBytesProcessed(state.iterations() * source.sizeInBytes());
+}
+
+/**
+ * @brief 对照：复用预先分配的缓冲区，只做内存复制
+ */
+void benchImageReuse(State &state, const QSize &size)
+{
+    const QImage source(size, QImage::Format_RGB32);
+    QImage target(size, QImage::Format_RGB32);
+    state.start();
+    for (qint64 i = 0; i < state.iterations(); i++) {
+        memcpy(target.bits(), source.constBits(), source.sizeInBytes());
+        doNotOptimize(target);
+    }
+    state.stop();
+    state.setBytesProcessed(state.iterations() * source.sizeInBytes());
+}
+
+// ==================== 音频 ====================
+
+// 44100Hz 立体声 16 位，1024 个采样帧
+static constexpr int AUDIO_CHUNK_BYTES = 1024 * 2 * 2;
+
+/**
+ * @brief 与 DecodeThread 相同：按上界分配、写入后截短
+ */
+void benchAudioChunkAlloc(State &state)
+{
+    state.start();
+    for (qint64 i = 0; i < state.iterations(); i++) {
+        QByteArray chunk(AUDIO_CHUNK_BYTES + 64, 0);
+        chunk.resize(AUDIO_CHUNK_BYTES);
+        doNotOptimize(chunk);
+    }
+    state.stop();
+    state.setItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief FFmpegPlayer 的整数音量循环
+ */
+void benchVolumeInt(State &state)
+{
+    std::vector<int16_t> samples(AUDIO_CHUNK_BYTES / 2, 12345);
+    const int volume = 50;
+    state.start();
+    for (qint64 i = 0; i < state.iterations(); i++) {
+        for (int16_t &sample : samples) {
+            sample = static_cast<int16_t>(sample * volume / 100);
+        }
+        doNotOptimize(samples[0]);
+    }
+    state.stop();
+    state.setBytesProcessed(state.iterations() * AUDIO_CHUNK_BYTES);
+}
+
+/**
+ * @brief D3D11Renderer 的浮点音量循环
+ */
+void benchVolumeFloat(State &state)
+{
+    std::vector<int16_t> samples(AUDIO_CHUNK_BYTES / 2, 12345);
+    const float volumeScale = 0.5f;
+    state.start();
+    for (qint64 i = 0; i < state.iterations(); i++) {
+        for (int16_t &sample : samples) {
+            sample = static_cast<int16_t>(sample * volumeScale);
+        }
+        doNotOptimize(samples[0]);
+    }
+    state.stop();
+    state.setBytesProcessed(state.iterations() * AUDIO_CHUNK_BYTES);
+}
+
+// ==================== 数据包 ====================
+
+void benchPacketAllocFree(State &state)
+{
+    state.start();
+    for (qint64 i = 0; i < state.iterations(); i++) {
+        AVPacket *packet = av_packet_alloc();
+        doNotOptimize(packet);
+        av_packet_free(&packet);
+    }
+    state.stop();
+    state.setItemsProcessed(state.iterations());
+}
+
+/**
+ * @brief 对照：复用同一个 AVPacket，每次只 unref（解码循环的做法）
+ */
+void benchPacketReuse(State &state)
+{
+    AVPacket *packet = av_packet_alloc();
+    state.start();
+    for (qint64 i = 0; i < state.iterations(); i++) {
+        av_new_packet(packet, 4096);
+        doNotOptimize(packet->data);
+        av_packet_unref(packet);
+    }
+    state.stop();
+    state.setItemsProcessed(state.iterations());
+    av_packet_free(&packet);
+}
+
+void benchPacketAllocPayload(State &state)
+{
+    state.start();
+    for (qint64 i = 0; i < state.iterations(); i++) {
+        AVPacket *packet = av_packet_alloc();
+        av_new_packet(packet, 4096);
+        doNotOptimize(packet->data);
+        av_packet_free(&packet);
+    }
+    state.stop();
+    state.setItemsProcessed(state.iterations());
+}
+
+QList<Benchmark> allBenchmarks()
+{
+    QList<Benchmark> benchmarks;
+    benchmarks.append({ "queue_handoff/VideoFrame", benchQueueHandoff });
+    benchmarks.append({ "queue_handoff/AsyncQueue", benchAsyncQueueHandoff });
+
+    for (const ScaleCase &c : SCALE_CASES) {
+        benchmarks.append({ "sws_scale/" + caseName(c), [c](State &s) { benchSwsScale(s, c); } });
+        benchmarks.append({ "FrameConverter/" + caseName(c), [c](State &s) { benchFrameConverter(s, c); } });
+    }
+
+    for (const FrameConverter::Specialization &spec : FrameConverter::specializations()) {
+        benchmarks.append({ "Converter/" + QString::fromLatin1(spec.name),
+                            [spec](State &s) { benchSpecialization(s, spec); } });
+    }
+
+    for (const QSize size : { QSize(1280, 720), QSize(1920, 1080) }) {
+        benchmarks.append({ "QImage_copy/" + sizeName(size), [size](State &s) { benchImageCopy(s, size); } });
+        benchmarks.append({ "image_reuse_memcpy/" + sizeName(size), [size](State &s) { benchImageReuse(s, size); } });
+    }
+
+    benchmarks.append({ "audio_chunk_alloc/QByteArray", benchAudioChunkAlloc });
+    benchmarks.append({ "volume/int", benchVolumeInt });
+    benchmarks.append({ "volume/float", benchVolumeFloat });
+    benchmarks.append({ "av_packet/alloc_free", benchPacketAllocFree });
+    benchmarks.append({ "av_packet/alloc_payload_free", benchPacketAllocPayload });
+    benchmarks.append({ "av_packet/reuse_unref", benchPacketReuse });
+    return benchmarks;
+}
+
+} // namespace
+
+// ==================== 入口 ====================
+
+int Microbench::run(const QString &outputPath, const QString &filter)
+{
+    const QRegularExpression pattern(filter);
+    if (!pattern.isValid()) {
+        qCritical() << "无效的过滤表达式:" << filter;
+        return 1;
+    }
+
+    QJsonArray results;
+    for (const Benchmark &benchmark : allBenchmarks()) {
+        if (!filter.isEmpty() && !pattern.match(benchmark.name).hasMatch()) continue;
+        results.append(runBenchmark(benchmark));
+    }
+
+    QJsonObject context;
+    context["date"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    context["host_name"] = QSysInfo::machineHostName();
+    context["executable"] = QCoreApplication::applicationFilePath();
+    context["num_cpus"] = QThread::idealThreadCount();
+#ifdef NDEBUG
+    context["library_build_type"] = "release";
+#else
+    context["library_build_type"] = "debug";
+#endif
+    context["yuv_kernel"] = QString::fromUtf8(YuvConverter::kernelName());
+    context["ffmpeg_version"] = QString::fromLatin1(av_version_info());
+
+    // 运行期间各子系统的内存记账（进程级汇总）
+    const MemoryUsageSnapshot usage = MemoryAccounting::process().snapshot();
+    QJsonObject memory;
+    for (int i = 0; i < MEMORY_CATEGORY_COUNT; i++) {
+        QJsonObject category;
+        category["current_bytes"] = usage.current[i];
+        category["high_water_bytes"] = usage.highWater[i];
+        memory[MemoryAccounting::categoryName(static_cast<MemoryCategory>(i))] = category;
+    }
+    memory["total_high_water_bytes"] = usage.totalHighWater;
+
+    QJsonObject root;
+    root["context"] = context;
+    root["benchmarks"] = results;
+    root["memory"] = memory;
+    const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+
+    if (outputPath == "-") {
+        QFile out;
+        out.open(stdout, QIODevice::WriteOnly);
+        out.write(json);
+        return 0;
+    }
+
+    QFile file(outputPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCritical() << "无法写入基准结果:" << outputPath;
+        return 1;
+    }
+    file.write(json);
+    qDebug() << "基准结果已写入:" << outputPath;
+    return 0;
+}
+
+#else
+
+int Microbench::run(const QString &outputPath, const QString &filter)
+{
+    Q_UNUSED(outputPath)
+    Q_UNUSED(filter)
+    qCritical("此版本未启用 FFmpeg，无法运行微基准");
+    return 1;
+}
+
+#endif
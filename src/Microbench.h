@@ -0,0 +1,37 @@
+/**
+ * @file Microbench.h
+ * @brief 管线基础操作的微基准
+ *
+ * 覆盖各条播放管线依赖的基础操作：
+ * - 帧队列交接（QQueue + QMutex + QWaitCondition，以及协程 AsyncQueue）
+ * - sws_scale 与 FrameConverter 各特化（按源/目标格式与尺寸）
+ * - QImage::copy 与复用缓冲区
+ * - QByteArray 音频块分配、标量音量循环
+ * - av_packet_alloc / av_packet_free 反复分配
+ *
+ * 输出与 Google Benchmark --benchmark_format=json 相同结构的 JSON，便于趋势跟踪。
+ *
+ * 独立构建为 loop_microbench（见 MicrobenchMain.cpp），不链接播放器与 GUI。
+ *
+ * 用法：
+ *   loop_microbench result.json [--filter sws_scale]
+ */
+
+#ifndef MICROBENCH_H
+#define MICROBENCH_H
+
+#include <QString>
+
+namespace Microbench {
+
+/**
+ * @brief 运行微基准
+ * @param outputPath JSON 输出路径，"-" 表示标准输出
+ * @param filter 基准名称过滤（正则），为空时运行全部
+ * @return 进程退出码
+ */
+int run(const QString &outputPath, const QString &filter);
+
+} // namespace Microbench
+
+#endif // MICROBENCH_H
@@ -0,0 +1,34 @@
+/**
+ * @file MicrobenchMain.cpp
+ * @brief loop_microbench 入口（独立可执行文件，不含播放器与 GUI）
+ *
+ * 使用方式：
+ * - loop_microbench                         全部基准，JSON 写到标准输出
+ * - loop_microbench result.json             写入文件
+ * - loop_microbench result.json --filter "FrameConverter/.*1920x1080"
+ */
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include "Microbench.h"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("loop_microbench");
+    app.setApplicationVersion("2.0.0");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Loop Video Player 管线基础操作微基准（Google Benchmark 格式 JSON）");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("output", "JSON 输出路径（默认 - 表示标准输出）", "[output]");
+
+    QCommandLineOption filterOption("filter", "只运行名称匹配的基准（正则）", "regex");
+    parser.addOption(filterOption);
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    const QString output = args.isEmpty() ? QStringLiteral("-") : args.first();
+    return Microbench::run(output, parser.value(filterOption));
+}
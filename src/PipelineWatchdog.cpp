@@ -0,0 +1,218 @@
+/**
+ * @file PipelineWatchdog.cpp
+ * @brief 播放管线停滞看门狗实现
+ */
+
+#include "PipelineWatchdog.h"
+
+#include <QDebug>
+#include <QTimer>
+#include <cmath>
+
+PipelineWatchdog::PipelineWatchdog(PlaybackMetrics &metrics, QObject *parent)
+    : QObject(parent)
+    , m_metrics(metrics)
+{
+    m_timer = new QTimer(this);
+    m_timer->setInterval(CHECK_INTERVAL_MS);
+    connect(m_timer, &QTimer::timeout, this, &PipelineWatchdog::check);
+    m_clock.start();
+}
+
+void PipelineWatchdog::arm(double frameDuration, bool watchVideo, bool watchAudio)
+{
+    m_watchVideo = watchVideo;
+    m_watchAudio = watchAudio;
+    m_stallThresholdMs = qMax(STALL_THRESHOLD_MS,
+                              static_cast<int>(std::ceil(frameDuration * 1000 * STALL_FRAME_MULTIPLE)));
+    m_recoveryTimeoutMs = qMax(RECOVERY_TIMEOUT_MS,
+                               static_cast<int>(std::ceil(frameDuration * 1000 * RECOVERY_FRAME_MULTIPLE)));
+    m_videoRecovering = false;
+    m_audioRecovering = false;
+    resetProgress();
+    m_armed = true;
+    m_timer->start();
+}
+
+void PipelineWatchdog::disarm()
+{
+    m_armed = false;
+    m_timer->stop();
+}
+
+void PipelineWatchdog::resetProgress()
+{
+    const qint64 now = m_clock.elapsed();
+    for (int i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+        m_lastCount[i] = m_metrics.progressCount(static_cast<PipelineStage>(i));
+        m_lastProgressMs[i] = now;
+    }
+}
+
+void PipelineWatchdog::setWatchAudio(bool watch)
+{
+    const int audio = static_cast<int>(PipelineStage::Audio);
+    m_watchAudio = watch;
+    m_audioRecovering = false;
+    m_lastCount[audio] = m_metrics.progressCount(PipelineStage::Audio);
+    m_lastProgressMs[audio] = m_clock.elapsed();
+}
+
+const char *PipelineWatchdog::stageName(PipelineStage stage)
+{
+    switch (stage) {
+    case PipelineStage::Demux:   return "读包";
+    case PipelineStage::Decode:  return "解码";
+    case PipelineStage::Present: return "呈现";
+    case PipelineStage::Audio:   return "音频设备";
+    }
+    return "?";
+}
+
+const char *PipelineWatchdog::actionName(RecoveryAction action)
+{
+    switch (action) {
+    case RecoveryAction::FlushResync:      return "清空解码器并跳到关键帧";
+    case RecoveryAction::ReopenDecoder:    return "重建解码器";
+    case RecoveryAction::SoftwareFallback: return "回退软件解码";
+    case RecoveryAction::ReopenFile:       return "重新打开文件";
+    case RecoveryAction::ReopenAudio:      return "重新打开音频设备";
+    }
+    return "?";
+}
+
+void PipelineWatchdog::check()
+{
+    if (!m_armed) return;
+
+    const qint64 now = m_clock.elapsed();
+    for (int i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+        const quint64 count = m_metrics.progressCount(static_cast<PipelineStage>(i));
+        if (count != m_lastCount[i]) {
+            m_lastCount[i] = count;
+            m_lastProgressMs[i] = now;
+        }
+    }
+
+    if (m_watchVideo) checkVideo(now);
+    if (m_watchAudio) checkAudio(now);
+}
+
+/**
+ * @brief 停滞起因：最早停止前进的阶段
+ *
+ * 下游停住后上游会因队列满而相继停住，最早停下的那一级才是起因。
+ */
+PipelineStage PipelineWatchdog::stalledStage() const
+{
+    PipelineStage oldest = PipelineStage::Present;
+    for (PipelineStage stage : {PipelineStage::Demux, PipelineStage::Decode, PipelineStage::Present}) {
+        if (m_lastProgressMs[static_cast<int>(stage)] < m_lastProgressMs[static_cast<int>(oldest)]) {
+            oldest = stage;
+        }
+    }
+    return oldest;
+}
+
+void PipelineWatchdog::checkVideo(qint64 now)
+{
+    const qint64 lastPresent = m_lastProgressMs[static_cast<int>(PipelineStage::Present)];
+
+    if (m_videoRecovering) {
+        if (lastPresent > m_videoActionMs) {
+            // 恢复出帧：耗时从最后一帧呈现（停滞开始）算起
+            const int elapsed = static_cast<int>(lastPresent - m_videoStallMs);
+            m_metrics.addRecovery(m_videoAction, elapsed);
+            m_videoRecovering = false;
+            if (elapsed > RECOVERY_BUDGET_MS) {
+                qWarning() << "[看门狗] 已恢复（" << actionName(m_videoAction) << "），但耗时" << elapsed << "ms";
+            } else {
+                qDebug() << "[看门狗] 已恢复（" << actionName(m_videoAction) << "），耗时" << elapsed << "ms";
+            }
+            return;
+        }
+        if (now - m_videoActionMs < m_recoveryTimeoutMs) return;
+
+        // 本级未奏效，升级
+        if (m_videoAction == RecoveryAction::ReopenFile
+            || !startAction(static_cast<RecoveryAction>(static_cast<int>(m_videoAction) + 1))) {
+            m_metrics.addFailedRecovery();
+            qCritical() << "[看门狗] 所有恢复动作均未奏效，等待下一次停滞后重试";
+            m_videoRecovering = false;
+            resetProgress();
+        }
+        return;
+    }
+
+    if (now - lastPresent < m_stallThresholdMs) return;
+
+    const PipelineStage stage = stalledStage();
+    m_metrics.addStall(stage);
+    qWarning() << "[看门狗] 画面停滞" << (now - lastPresent) << "ms，起因阶段:" << stageName(stage);
+
+    m_videoStallMs = lastPresent;
+    if (!startAction(RecoveryAction::FlushResync)) {
+        m_metrics.addFailedRecovery();
+        resetProgress();
+    }
+}
+
+/**
+ * @brief 从指定级别开始执行恢复动作，不适用的级别直接跳过
+ * @return 是否有动作被执行
+ */
+bool PipelineWatchdog::startAction(RecoveryAction first)
+{
+    if (!m_handler) return false;
+
+    for (int level = static_cast<int>(first); level <= static_cast<int>(RecoveryAction::ReopenFile); level++) {
+        const RecoveryAction action = static_cast<RecoveryAction>(level);
+        if (m_handler(action)) {
+            qWarning() << "[看门狗] 恢复动作:" << actionName(action);
+            // 动作可能同步执行较久（重新打开文件），且期间可能重置进度：从动作执行完算起
+            m_videoAction = action;
+            m_videoActionMs = m_clock.elapsed();
+            m_videoRecovering = true;
+            return true;
+        }
+    }
+    m_videoRecovering = false;
+    return false;
+}
+
+void PipelineWatchdog::checkAudio(qint64 now)
+{
+    const qint64 lastAudio = m_lastProgressMs[static_cast<int>(PipelineStage::Audio)];
+
+    if (m_audioRecovering) {
+        if (lastAudio > m_audioActionMs) {
+            const int elapsed = static_cast<int>(lastAudio - m_audioStallMs);
+            m_metrics.addRecovery(RecoveryAction::ReopenAudio, elapsed);
+            m_audioRecovering = false;
+            qDebug() << "[看门狗] 音频已恢复，耗时" << elapsed << "ms";
+        } else if (now - m_audioActionMs >= m_recoveryTimeoutMs) {
+            // 设备仍不可用：停止监视音频，视频继续播放
+            m_metrics.addFailedRecovery();
+            m_audioRecovering = false;
+            m_watchAudio = false;
+            qCritical() << "[看门狗] 音频设备无法恢复，继续无声播放";
+        }
+        return;
+    }
+
+    if (now - lastAudio < m_stallThresholdMs) return;
+
+    m_metrics.addStall(PipelineStage::Audio);
+    qWarning() << "[看门狗] 音频设备停止消耗数据" << (now - lastAudio) << "ms";
+
+    m_audioStallMs = lastAudio;
+    if (m_handler && m_handler(RecoveryAction::ReopenAudio)) {
+        m_audioActionMs = m_clock.elapsed();
+        qWarning() << "[看门狗] 恢复动作:" << actionName(RecoveryAction::ReopenAudio);
+        m_audioRecovering = true;
+    } else {
+        m_metrics.addFailedRecovery();
+        m_watchAudio = false;
+        qCritical() << "[看门狗] 音频设备无法恢复，继续无声播放";
+    }
+}
@@ -0,0 +1,116 @@
+/**
+ * @file PipelineWatchdog.h
+ * @brief 播放管线停滞看门狗
+ *
+ * 定时读取 PlaybackMetrics 中各阶段的进度计数（读包 / 解码 / 呈现 / 音频消耗），
+ * 呈现超过阈值没有前进时判定停滞，按起因阶段记录后逐级升级恢复动作：
+ *   清空解码器并跳到下一关键帧 → 重建解码器 → 硬件回退软件 → 重新打开文件
+ * 每一级在 RECOVERY_TIMEOUT_MS 内恢复出帧则停止升级；音频设备停滞单独重新打开。
+ *
+ * 恢复耗时从最后一帧呈现（停滞开始）算到恢复后的第一帧呈现，预算 RECOVERY_BUDGET_MS：
+ *   检测 ≤ 阈值 250 + 检查间隔 50 = 300 ms
+ *   前三级各 ≤ 超时 120 向上取整到检查间隔 = 150 ms（另加动作本身的同步耗时，超时从动作执行完算起），
+ *   重新打开文件最迟在 750 ms 左右开始
+ *   重新打开文件剩余约 250 ms，本地文件够用；网络源的重连与探测通常超过此值，无法保证在预算内
+ * 低帧率片段（阈值与单级超时按帧间隔放宽）和长 GOP（跳到关键帧后需多解若干帧）同样可能超出预算，
+ * 超出时计入 recoveries 的耗时并告警。
+ *
+ * 看门狗只负责判定与计时，动作由播放器通过 RecoveryHandler 执行。
+ * 所有方法在 GUI 线程调用。
+ */
+
+#ifndef PIPELINEWATCHDOG_H
+#define PIPELINEWATCHDOG_H
+
+#include "PlaybackMetrics.h"
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <functional>
+
+class QTimer;
+
+class PipelineWatchdog : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * @brief 执行恢复动作
+     * @return false 表示该动作不适用（如已是软件解码），看门狗直接升级到下一级
+     */
+    using RecoveryHandler = std::function<bool(RecoveryAction)>;
+
+    explicit PipelineWatchdog(PlaybackMetrics &metrics, QObject *parent = nullptr);
+
+    void setRecoveryHandler(RecoveryHandler handler) { m_handler = std::move(handler); }
+
+    /**
+     * @brief 开始监视（播放开始 / 恢复播放）
+     * @param frameDuration 视频帧间隔（秒），低帧率片段相应放宽停滞阈值
+     * @param watchVideo 是否有视频输出
+     * @param watchAudio 是否有音频输出
+     */
+    void arm(double frameDuration, bool watchVideo, bool watchAudio);
+
+    /**
+     * @brief 停止监视（暂停 / 停止）
+     */
+    void disarm();
+
+    /**
+     * @brief 以当前时刻为各阶段的最近进度（seek、循环重启后调用，避免误判）
+     */
+    void resetProgress();
+
+    /**
+     * @brief 运行中开始 / 停止监视音频（音频设备延迟创建时调用），以当前时刻为音频的最近进度
+     */
+    void setWatchAudio(bool watch);
+
+    bool isArmed() const { return m_armed; }
+
+    static const char *stageName(PipelineStage stage);
+    static const char *actionName(RecoveryAction action);
+
+private:
+    void check();
+    void checkVideo(qint64 now);
+    void checkAudio(qint64 now);
+    bool startAction(RecoveryAction first);
+    PipelineStage stalledStage() const;
+
+    static constexpr int CHECK_INTERVAL_MS = 50;
+    static constexpr int STALL_THRESHOLD_MS = 250;      ///< 呈现停滞多久判定为卡住
+    static constexpr int STALL_FRAME_MULTIPLE = 3;      ///< 低帧率时阈值至少为 3 个帧间隔
+    static constexpr int RECOVERY_TIMEOUT_MS = 120;     ///< 单级恢复等待出帧的时间
+    static constexpr int RECOVERY_FRAME_MULTIPLE = 2;   ///< 低帧率时单级超时至少为 2 个帧间隔
+    static constexpr int RECOVERY_BUDGET_MS = 1000;     ///< 恢复耗时（从停滞开始）超过此值时告警
+
+    PlaybackMetrics &m_metrics;
+    RecoveryHandler m_handler;
+    QTimer *m_timer = nullptr;
+    QElapsedTimer m_clock;
+
+    bool m_armed = false;
+    bool m_watchVideo = false;
+    bool m_watchAudio = false;
+    int m_stallThresholdMs = STALL_THRESHOLD_MS;
+    int m_recoveryTimeoutMs = RECOVERY_TIMEOUT_MS;
+
+    quint64 m_lastCount[PIPELINE_STAGE_COUNT] = {};
+    qint64 m_lastProgressMs[PIPELINE_STAGE_COUNT] = {};
+
+    // 视频升级链状态
+    bool m_videoRecovering = false;
+    RecoveryAction m_videoAction = RecoveryAction::FlushResync;
+    qint64 m_videoStallMs = 0;          ///< 停滞开始的时刻（最后一帧呈现）
+    qint64 m_videoActionMs = 0;         ///< 当前级动作开始的时刻
+
+    // 音频恢复状态
+    bool m_audioRecovering = false;
+    qint64 m_audioStallMs = 0;          ///< 停滞开始的时刻（最后一次消耗数据）
+    qint64 m_audioActionMs = 0;         ///< 重新打开音频设备的时刻
+};
+
+#endif // PIPELINEWATCHDOG_H
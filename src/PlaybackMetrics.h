@@ -0,0 +1,348 @@
+/**
+ * @file PlaybackMetrics.h
+ * @brief 播放管线运行指标
+ *
+ * 解码线程用原子操作累加，其他线程随时读取快照，不加锁、不影响热路径。
+ */
+
+#ifndef PLAYBACKMETRICS_H
+#define PLAYBACKMETRICS_H
+
+#include "AudioTelemetry.h"
+#include "MemoryAccounting.h"
+
+#include <QElapsedTimer>
+#include <QtGlobal>
+#include <atomic>
+
+/**
+ * @brief 管线阶段（按数据流顺序）
+ */
+enum class PipelineStage {
+    Demux,      ///< 读包，进度为最近一个包的 PTS
+    Decode,     ///< 解码并入队，进度为最近一帧的 PTS
+    Present,    ///< 呈现，进度为最近显示帧的 PTS
+    Audio,      ///< 音频设备消耗，进度为已播放字节数
+};
+static constexpr int PIPELINE_STAGE_COUNT = 4;
+
+/**
+ * @brief 停滞恢复动作（按升级顺序）
+ */
+enum class RecoveryAction {
+    FlushResync,        ///< 清空解码器，跳到下一个关键帧
+    ReopenDecoder,      ///< 重新创建视频解码器
+    SoftwareFallback,   ///< 放弃硬件解码，改用软件解码
+    ReopenFile,         ///< 重新打开文件并回到停滞位置
+    ReopenAudio,        ///< 重新打开音频设备（音频单独处理，不参与升级）
+};
+static constexpr int RECOVERY_ACTION_COUNT = 5;
+
+/**
+ * @brief 解码耗时直方图的分桶上界（微秒），最后一桶为超过最大上界
+ */
+static constexpr double DECODE_TIME_BUCKETS_US[] = {1000, 2000, 4000, 8000, 16000, 33000, 66000};
+static constexpr int DECODE_TIME_BUCKET_COUNT = 8;
+
+/**
+ * @brief 指标快照
+ */
+struct PlaybackMetricsSnapshot {
+    quint64 videoFrames = 0;        ///< 已入队的视频帧
+    quint64 audioFrames = 0;        ///< 已入队的音频块
+    quint64 loops = 0;              ///< 到达文件结尾的次数
+    int videoQueueHighWater = 0;    ///< 视频队列最大深度（自上次 resetHighWater）
+    int audioQueueHighWater = 0;    ///< 音频队列最大深度（自上次 resetHighWater）
+
+    double stagePosition[PIPELINE_STAGE_COUNT] = {};    ///< 各阶段最近进度
+    quint64 stalls[PIPELINE_STAGE_COUNT] = {};          ///< 按起因阶段统计的停滞次数
+    quint64 recoveries[RECOVERY_ACTION_COUNT] = {};     ///< 各恢复动作成功次数
+    quint64 failedRecoveries = 0;   ///< 整条升级链走完仍未恢复的次数
+    quint64 hwTransferFailures = 0; ///< 硬件帧 GPU→CPU 传输失败次数
+    quint64 reconfigurations = 0;   ///< 流中途分辨率 / 像素格式变化次数
+    int lastRecoveryMs = 0;         ///< 最近一次恢复耗时（停滞检测 → 恢复出帧）
+    int maxRecoveryMs = 0;          ///< 最长恢复耗时
+
+    quint64 presentedFrames = 0;    ///< 已呈现的帧（隔行片源按场计）
+    quint64 droppedFrames = 0;      ///< 呈现端为追赶时钟丢弃的帧
+    quint64 skippedFrames = 0;      ///< 限制呈现帧率而未转换的帧（解码器跳过的非参考帧不计）
+    quint64 seamGaps = 0;           ///< 循环接缝次数
+    double lastSeamGapMs = 0;       ///< 最近一次接缝处多出的呈现间隔
+    double maxSeamGapMs = 0;        ///< 最长接缝间隔
+    double avOffsetMs = 0;          ///< 最近呈现帧相对主时钟的偏移（正值表示视频超前）
+    int videoQueueDepth = 0;        ///< 最近一次呈现时的视频队列深度
+    int audioQueueDepth = 0;        ///< 最近一次音频写入时的音频队列深度
+    bool hardwareDecoding = false;  ///< 当前文件是否走硬件解码
+    int abrVariant = -1;            ///< 自适应码率当前变体（按码率升序，-1 表示未启用）
+    qint64 abrBandwidth = 0;        ///< 当前变体的标称码率（bit/s）
+    double abrThroughputBps = 0;    ///< 下载吞吐估计（bit/s）
+    quint64 abrSwitches = 0;        ///< 变体切换次数
+    quint64 decodeTimeHistogram[DECODE_TIME_BUCKET_COUNT] = {};
+    double decodeTimeTotalUs = 0;   ///< 解码耗时累计（直方图的 sum）
+
+    AudioTelemetrySnapshot audio;   ///< 音频输出遥测
+    MemoryUsageSnapshot memory;     ///< 按子系统的内存记账
+
+    quint64 decodeTimeCount() const
+    {
+        quint64 count = 0;
+        for (quint64 bucket : decodeTimeHistogram) count += bucket;
+        return count;
+    }
+
+    /**
+     * @brief 由直方图估计解码耗时分位数（桶内线性插值，落在最后一桶时返回最大上界）
+     */
+    double decodeTimePercentileUs(double quantile) const
+    {
+        const quint64 count = decodeTimeCount();
+        if (count == 0) return 0;
+        const double rank = quantile * count;
+        quint64 cumulative = 0;
+        for (int i = 0; i < DECODE_TIME_BUCKET_COUNT - 1; i++) {
+            const quint64 next = cumulative + decodeTimeHistogram[i];
+            if (next >= rank && decodeTimeHistogram[i] > 0) {
+                const double lower = i > 0 ? DECODE_TIME_BUCKETS_US[i - 1] : 0;
+                const double fraction = (rank - cumulative) / decodeTimeHistogram[i];
+                return lower + (DECODE_TIME_BUCKETS_US[i] - lower) * fraction;
+            }
+            cumulative = next;
+        }
+        return DECODE_TIME_BUCKETS_US[DECODE_TIME_BUCKET_COUNT - 2];
+    }
+};
+
+/**
+ * @brief 播放管线运行指标
+ */
+class PlaybackMetrics
+{
+public:
+    void addVideoFrame(int queueDepth)
+    {
+        m_videoFrames.fetch_add(1, std::memory_order_relaxed);
+        updateMax(m_videoQueueHighWater, queueDepth);
+    }
+
+    void addAudioFrame(int queueDepth)
+    {
+        m_audioFrames.fetch_add(1, std::memory_order_relaxed);
+        updateMax(m_audioQueueHighWater, queueDepth);
+    }
+
+    void addLoop() { m_loops.fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * @brief 记录阶段进度（热路径：两次 relaxed 原子写）
+     */
+    void markProgress(PipelineStage stage, double position)
+    {
+        const int index = static_cast<int>(stage);
+        m_stagePosition[index].store(position, std::memory_order_relaxed);
+        m_stageProgress[index].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 阶段进度计数，看门狗比较两次读数判断是否前进
+     */
+    quint64 progressCount(PipelineStage stage) const
+    {
+        return m_stageProgress[static_cast<int>(stage)].load(std::memory_order_relaxed);
+    }
+
+    void addStall(PipelineStage stage)
+    {
+        m_stalls[static_cast<int>(stage)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void addRecovery(RecoveryAction action, int elapsedMs)
+    {
+        m_recoveries[static_cast<int>(action)].fetch_add(1, std::memory_order_relaxed);
+        m_lastRecoveryMs.store(elapsedMs, std::memory_order_relaxed);
+        updateMax(m_maxRecoveryMs, elapsedMs);
+    }
+
+    void addFailedRecovery() { m_failedRecoveries.fetch_add(1, std::memory_order_relaxed); }
+    void addHwTransferFailure() { m_hwTransferFailures.fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * @brief 记录一次呈现（呈现线程单线程调用）
+     *
+     * 文件内位置回绕即为循环接缝，接缝处的呈现间隔超出上一个正常间隔的部分记为接缝间隔。
+     */
+    void addPresentedFrame(double position)
+    {
+        m_presentedFrames.fetch_add(1, std::memory_order_relaxed);
+        if (!m_presentClock.isValid()) {
+            m_presentClock.start();
+        }
+        const qint64 now = m_presentClock.nsecsElapsed();
+        if (m_lastPresentNs >= 0) {
+            const qint64 interval = now - m_lastPresentNs;
+            if (position + SEAM_REWIND_SECONDS < m_lastPresentPosition) {
+                const double gapMs = qMax<qint64>(0, interval - m_lastPresentInterval) / 1e6;
+                m_seamGaps.fetch_add(1, std::memory_order_relaxed);
+                m_lastSeamGapMs.store(gapMs, std::memory_order_relaxed);
+                if (gapMs > m_maxSeamGapMs.load(std::memory_order_relaxed)) {
+                    m_maxSeamGapMs.store(gapMs, std::memory_order_relaxed);
+                }
+            } else {
+                m_lastPresentInterval = interval;
+            }
+        }
+        m_lastPresentNs = now;
+        m_lastPresentPosition = position;
+    }
+
+    /**
+     * @brief 时间轴不连续（seek、暂停）：下一次呈现不参与接缝判断
+     */
+    void resetPresentation() { m_lastPresentNs = -1; }
+
+    void addDroppedFrames(int count) { m_droppedFrames.fetch_add(count, std::memory_order_relaxed); }
+    void addReconfiguration() { m_reconfigurations.fetch_add(1, std::memory_order_relaxed); }
+    void addSkippedFrame() { m_skippedFrames.fetch_add(1, std::memory_order_relaxed); }
+    void setAvOffset(double ms) { m_avOffsetMs.store(ms, std::memory_order_relaxed); }
+    void setVideoQueueDepth(int depth) { m_videoQueueDepth.store(depth, std::memory_order_relaxed); }
+    void setAudioQueueDepth(int depth) { m_audioQueueDepth.store(depth, std::memory_order_relaxed); }
+    void setHardwareDecoding(bool enabled) { m_hardwareDecoding.store(enabled, std::memory_order_relaxed); }
+    void setAbrVariant(int variant, qint64 bandwidth)
+    {
+        m_abrVariant.store(variant, std::memory_order_relaxed);
+        m_abrBandwidth.store(bandwidth, std::memory_order_relaxed);
+    }
+    void setAbrThroughput(double bps) { m_abrThroughputBps.store(bps, std::memory_order_relaxed); }
+    void addAbrSwitch() { m_abrSwitches.fetch_add(1, std::memory_order_relaxed); }
+
+    /**
+     * @brief 记录一次解码耗时（送包到取出帧，单位微秒）
+     */
+    void addDecodeTime(double us)
+    {
+        int bucket = 0;
+        while (bucket < DECODE_TIME_BUCKET_COUNT - 1 && us > DECODE_TIME_BUCKETS_US[bucket]) {
+            bucket++;
+        }
+        m_decodeTimeHistogram[bucket].fetch_add(1, std::memory_order_relaxed);
+        double total = m_decodeTimeTotalUs.load(std::memory_order_relaxed);
+        while (!m_decodeTimeTotalUs.compare_exchange_weak(total, total + us, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief 音频输出遥测（由音频写入路径更新）
+     */
+    AudioTelemetry &audio() { return m_audio; }
+
+    /**
+     * @brief 本播放器的内存记账（同时汇总到 MemoryAccounting::process()）
+     */
+    MemoryAccounting &memory() { return m_memory; }
+
+    PlaybackMetricsSnapshot snapshot() const
+    {
+        PlaybackMetricsSnapshot snapshot;
+        snapshot.videoFrames = m_videoFrames.load(std::memory_order_relaxed);
+        snapshot.audioFrames = m_audioFrames.load(std::memory_order_relaxed);
+        snapshot.loops = m_loops.load(std::memory_order_relaxed);
+        snapshot.videoQueueHighWater = m_videoQueueHighWater.load(std::memory_order_relaxed);
+        snapshot.audioQueueHighWater = m_audioQueueHighWater.load(std::memory_order_relaxed);
+        for (int i = 0; i < PIPELINE_STAGE_COUNT; i++) {
+            snapshot.stagePosition[i] = m_stagePosition[i].load(std::memory_order_relaxed);
+            snapshot.stalls[i] = m_stalls[i].load(std::memory_order_relaxed);
+        }
+        for (int i = 0; i < RECOVERY_ACTION_COUNT; i++) {
+            snapshot.recoveries[i] = m_recoveries[i].load(std::memory_order_relaxed);
+        }
+        snapshot.failedRecoveries = m_failedRecoveries.load(std::memory_order_relaxed);
+        snapshot.hwTransferFailures = m_hwTransferFailures.load(std::memory_order_relaxed);
+        snapshot.reconfigurations = m_reconfigurations.load(std::memory_order_relaxed);
+        snapshot.lastRecoveryMs = m_lastRecoveryMs.load(std::memory_order_relaxed);
+        snapshot.maxRecoveryMs = m_maxRecoveryMs.load(std::memory_order_relaxed);
+        snapshot.presentedFrames = m_presentedFrames.load(std::memory_order_relaxed);
+        snapshot.droppedFrames = m_droppedFrames.load(std::memory_order_relaxed);
+        snapshot.skippedFrames = m_skippedFrames.load(std::memory_order_relaxed);
+        snapshot.seamGaps = m_seamGaps.load(std::memory_order_relaxed);
+        snapshot.lastSeamGapMs = m_lastSeamGapMs.load(std::memory_order_relaxed);
+        snapshot.maxSeamGapMs = m_maxSeamGapMs.load(std::memory_order_relaxed);
+        snapshot.avOffsetMs = m_avOffsetMs.load(std::memory_order_relaxed);
+        snapshot.videoQueueDepth = m_videoQueueDepth.load(std::memory_order_relaxed);
+        snapshot.audioQueueDepth = m_audioQueueDepth.load(std::memory_order_relaxed);
+        snapshot.hardwareDecoding = m_hardwareDecoding.load(std::memory_order_relaxed);
+        snapshot.abrVariant = m_abrVariant.load(std::memory_order_relaxed);
+        snapshot.abrBandwidth = m_abrBandwidth.load(std::memory_order_relaxed);
+        snapshot.abrThroughputBps = m_abrThroughputBps.load(std::memory_order_relaxed);
+        snapshot.abrSwitches = m_abrSwitches.load(std::memory_order_relaxed);
+        for (int i = 0; i < DECODE_TIME_BUCKET_COUNT; i++) {
+            snapshot.decodeTimeHistogram[i] = m_decodeTimeHistogram[i].load(std::memory_order_relaxed);
+        }
+        snapshot.decodeTimeTotalUs = m_decodeTimeTotalUs.load(std::memory_order_relaxed);
+        snapshot.audio = m_audio.snapshot();
+        snapshot.memory = m_memory.snapshot();
+        return snapshot;
+    }
+
+    /**
+     * @brief 清零队列高水位（按采样周期统计）
+     */
+    void resetHighWater()
+    {
+        m_videoQueueHighWater.store(0, std::memory_order_relaxed);
+        m_audioQueueHighWater.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    static void updateMax(std::atomic<int> &target, int value)
+    {
+        int current = target.load(std::memory_order_relaxed);
+        while (value > current
+               && !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+
+    std::atomic<quint64> m_videoFrames{0};
+    std::atomic<quint64> m_audioFrames{0};
+    std::atomic<quint64> m_loops{0};
+    std::atomic<int> m_videoQueueHighWater{0};
+    std::atomic<int> m_audioQueueHighWater{0};
+
+    std::atomic<double> m_stagePosition[PIPELINE_STAGE_COUNT] = {};
+    std::atomic<quint64> m_stageProgress[PIPELINE_STAGE_COUNT] = {};
+    std::atomic<quint64> m_stalls[PIPELINE_STAGE_COUNT] = {};
+    std::atomic<quint64> m_recoveries[RECOVERY_ACTION_COUNT] = {};
+    std::atomic<quint64> m_failedRecoveries{0};
+    std::atomic<quint64> m_hwTransferFailures{0};
+    std::atomic<int> m_lastRecoveryMs{0};
+    std::atomic<int> m_maxRecoveryMs{0};
+
+    static constexpr double SEAM_REWIND_SECONDS = 0.5;  ///< 位置回退超过此值视为循环回到开头
+
+    // 呈现端状态（仅呈现线程访问）
+    QElapsedTimer m_presentClock;
+    qint64 m_lastPresentNs = -1;
+    qint64 m_lastPresentInterval = 0;
+    double m_lastPresentPosition = 0;
+
+    std::atomic<quint64> m_presentedFrames{0};
+    std::atomic<quint64> m_droppedFrames{0};
+    std::atomic<quint64> m_skippedFrames{0};
+    std::atomic<quint64> m_reconfigurations{0};
+    std::atomic<quint64> m_seamGaps{0};
+    std::atomic<double> m_lastSeamGapMs{0};
+    std::atomic<double> m_maxSeamGapMs{0};
+    std::atomic<double> m_avOffsetMs{0};
+    std::atomic<int> m_videoQueueDepth{0};
+    std::atomic<int> m_audioQueueDepth{0};
+    std::atomic<bool> m_hardwareDecoding{false};
+    std::atomic<int> m_abrVariant{-1};
+    std::atomic<qint64> m_abrBandwidth{0};
+    std::atomic<double> m_abrThroughputBps{0};
+    std::atomic<quint64> m_abrSwitches{0};
+    std::atomic<quint64> m_decodeTimeHistogram[DECODE_TIME_BUCKET_COUNT] = {};
+    std::atomic<double> m_decodeTimeTotalUs{0};
+
+    AudioTelemetry m_audio;
+    MemoryAccounting m_memory;
+};
+
+#endif // PLAYBACKMETRICS_H
@@ -0,0 +1,137 @@
+/**
+ * @file ProcessStats.cpp
+ * @brief 进程资源占用采样实现
+ */
+
+#include "ProcessStats.h"
+
+#include <QDir>
+#include <QFile>
+
+#if defined(Q_OS_LINUX)
+#include <malloc.h>
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#include <tlhelp32.h>
+#elif defined(Q_OS_MACOS)
+#include <mach/mach.h>
+#endif
+
+#if defined(Q_OS_LINUX)
+
+namespace {
+
+/**
+ * @brief 读取 /proc/self/status 中的一个数值字段
+ */
+qint64 statusField(const QByteArray &content, const char *name)
+{
+    for (const QByteArray &line : content.split('\n')) {
+        if (line.startsWith(name)) {
+            return line.mid(qstrlen(name)).trimmed().split(' ').first().toLongLong();
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+ProcessStats ProcessStats::sample()
+{
+    ProcessStats stats;
+
+    QFile status(QStringLiteral("/proc/self/status"));
+    if (status.open(QIODevice::ReadOnly)) {
+        const QByteArray content = status.readAll();
+        const qint64 rssKb = statusField(content, "VmRSS:");
+        stats.rssBytes = rssKb >= 0 ? rssKb * 1024 : -1;
+        stats.threads = static_cast<int>(statusField(content, "Threads:"));
+    }
+
+    // 列目录本身会占用一个描述符，数值整体偏移 1，不影响趋势判断
+    stats.openFiles = static_cast<int>(QDir(QStringLiteral("/proc/self/fd"))
+        .entryList(QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot).size());
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    const struct mallinfo2 info = mallinfo2();
+    stats.heapBytes = static_cast<qint64>(info.uordblks + info.hblkhd);
+#elif defined(__GLIBC__)
+    const struct mallinfo info = mallinfo();
+    stats.heapBytes = static_cast<qint64>(static_cast<unsigned>(info.uordblks))
+                    + static_cast<unsigned>(info.hblkhd);
+#endif
+    return stats;
+}
+
+#elif defined(Q_OS_WIN)
+
+ProcessStats ProcessStats::sample()
+{
+    ProcessStats stats;
+    HANDLE process = GetCurrentProcess();
+
+    PROCESS_MEMORY_COUNTERS_EX counters = {};
+    if (GetProcessMemoryInfo(process, reinterpret_cast<PROCESS_MEMORY_COUNTERS*>(&counters), sizeof(counters))) {
+        stats.rssBytes = static_cast<qint64>(counters.WorkingSetSize);
+        stats.heapBytes = static_cast<qint64>(counters.PrivateUsage);
+    }
+
+    DWORD handles = 0;
+    if (GetProcessHandleCount(process, &handles)) {
+        stats.openFiles = static_cast<int>(handles);
+    }
+
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPTHREAD, 0);
+    if (snapshot != INVALID_HANDLE_VALUE) {
+        const DWORD pid = GetCurrentProcessId();
+        THREADENTRY32 entry = {};
+        entry.dwSize = sizeof(entry);
+        int threads = 0;
+        for (BOOL ok = Thread32First(snapshot, &entry); ok; ok = Thread32Next(snapshot, &entry)) {
+            if (entry.th32OwnerProcessID == pid) threads++;
+        }
+        CloseHandle(snapshot);
+        stats.threads = threads;
+    }
+    return stats;
+}
+
+#elif defined(Q_OS_MACOS)
+
+ProcessStats ProcessStats::sample()
+{
+    ProcessStats stats;
+
+    mach_task_basic_info_data_t info = {};
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                  reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS) {
+        stats.rssBytes = static_cast<qint64>(info.resident_size);
+    }
+
+    thread_act_array_t threadList = nullptr;
+    mach_msg_type_number_t threadCount = 0;
+    if (task_threads(mach_task_self(), &threadList, &threadCount) == KERN_SUCCESS) {
+        stats.threads = static_cast<int>(threadCount);
+        for (mach_msg_type_number_t i = 0; i < threadCount; i++) {
+            mach_port_deallocate(mach_task_self(), threadList[i]);
+        }
+        vm_deallocate(mach_task_self(), reinterpret_cast<vm_address_t>(threadList),
+                      threadCount * sizeof(thread_act_t));
+    }
+
+    stats.openFiles = static_cast<int>(QDir(QStringLiteral("/dev/fd"))
+        .entryList(QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot).size());
+    return stats;
+}
+
+#else
+
+ProcessStats ProcessStats::sample()
+{
+    return ProcessStats();
+}
+
+#endif
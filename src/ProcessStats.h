@@ -0,0 +1,25 @@
+/**
+ * @file ProcessStats.h
+ * @brief 进程资源占用采样（常驻内存、堆、句柄、线程）
+ *
+ * 平台不支持的项为 -1。
+ */
+
+#ifndef PROCESSSTATS_H
+#define PROCESSSTATS_H
+
+#include <QtGlobal>
+
+struct ProcessStats {
+    qint64 rssBytes = -1;       ///< 常驻内存
+    qint64 heapBytes = -1;      ///< 已分配堆（glibc mallinfo2 / Windows 私有提交）
+    int openFiles = -1;         ///< 打开的文件描述符（Windows 为句柄数）
+    int threads = -1;           ///< 线程数
+
+    /**
+     * @brief 采样当前进程
+     */
+    static ProcessStats sample();
+};
+
+#endif // PROCESSSTATS_H
@@ -0,0 +1,467 @@
+/**
+ * @file ProxyCache.cpp
+ * @brief 全帧内代理缓存实现
+ */
+
+#include "ProxyCache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QThread>
+#include <memory>
+
+#if FFMPEG_AVAILABLE
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libswscale/swscale.h>
+}
+#endif
+
+namespace {
+
+static constexpr qint64 MAX_CACHE_BYTES = 2LL * 1024 * 1024 * 1024;
+static constexpr int PROXY_QSCALE = 4;          // MJPEG 量化参数：预览用，文件约为源的数倍
+
+QString cacheDir()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/proxies");
+}
+
+} // namespace
+
+// ============================================================================
+// 缓存目录
+// ============================================================================
+
+QString ProxyCache::proxyPath(const QString &master)
+{
+    // 源文件被替换（大小或修改时间变化）后自动对应到新的代理
+    const QFileInfo info(master);
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(info.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray::number(info.size()));
+    hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    return cacheDir() + QLatin1Char('/') + QString::fromLatin1(hash.result().toHex()) + QStringLiteral(".nut");
+}
+
+QString ProxyCache::lookup(const QString &master)
+{
+    const QString path = proxyPath(master);
+    QFile file(path);
+    if (!file.exists()) return QString();
+    // 修改时间即最近使用时间，供 prune 淘汰
+    if (file.open(QIODevice::ReadWrite)) {
+        file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+    return path;
+}
+
+void ProxyCache::prune()
+{
+    QDir dir(cacheDir());
+    QFileInfoList entries = dir.entryInfoList({ QStringLiteral("*.nut") }, QDir::Files, QDir::Time);
+    qint64 total = 0;
+    for (const QFileInfo &entry : entries) {
+        total += entry.size();
+    }
+    // entryInfoList 按修改时间从新到旧排列，从末尾删起
+    while (total > MAX_CACHE_BYTES && !entries.isEmpty()) {
+        const QFileInfo oldest = entries.takeLast();
+        if (QFile::remove(oldest.absoluteFilePath())) {
+            total -= oldest.size();
+            qDebug() << "[代理] 淘汰:" << oldest.fileName();
+        }
+    }
+}
+
+#if FFMPEG_AVAILABLE
+
+// ============================================================================
+// 转码
+// ============================================================================
+
+namespace {
+
+/**
+ * @brief 转码过程中的资源，析构时统一释放
+ */
+struct ProxyJob {
+    AVFormatContext *input = nullptr;
+    AVFormatContext *output = nullptr;
+    AVCodecContext *decoder = nullptr;
+    AVCodecContext *encoder = nullptr;
+    SwsContext *swsCtx = nullptr;
+    AVPacket *packet = nullptr;
+    AVFrame *frame = nullptr;
+    AVFrame *scaled = nullptr;
+    int videoIndex = -1;
+    AVStream *outStream = nullptr;
+    int64_t lastPts = AV_NOPTS_VALUE;
+
+    ~ProxyJob()
+    {
+        sws_freeContext(swsCtx);
+        av_frame_free(&scaled);
+        av_frame_free(&frame);
+        av_packet_free(&packet);
+        avcodec_free_context(&encoder);
+        avcodec_free_context(&decoder);
+        if (output) {
+            if (!(output->oformat->flags & AVFMT_NOFILE)) avio_closep(&output->pb);
+            avformat_free_context(output);
+        }
+        avformat_close_input(&input);
+    }
+
+    bool writePackets()
+    {
+        while (avcodec_receive_packet(encoder, packet) == 0) {
+            av_packet_rescale_ts(packet, encoder->time_base, outStream->time_base);
+            packet->stream_index = outStream->index;
+            if (av_interleaved_write_frame(output, packet) < 0) return false;
+        }
+        return true;
+    }
+
+    bool encode(const AVFrame *decoded)
+    {
+        // 源文件中途改变分辨率或格式时按新参数重建缩放上下文，代理尺寸不变
+        swsCtx = sws_getCachedContext(swsCtx, decoded->width, decoded->height,
+                                      static_cast<AVPixelFormat>(decoded->format),
+                                      scaled->width, scaled->height, AV_PIX_FMT_YUVJ420P,
+                                      SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if (!swsCtx || av_frame_make_writable(scaled) < 0) return false;
+        sws_scale(swsCtx, decoded->data, decoded->linesize, 0, decoded->height, scaled->data, scaled->linesize);
+        // 沿用源 PTS；缺失或不递增时顺延一个单位，保证复用器接受
+        int64_t pts = decoded->best_effort_timestamp;
+        if (pts == AV_NOPTS_VALUE || (lastPts != AV_NOPTS_VALUE && pts <= lastPts)) {
+            pts = lastPts == AV_NOPTS_VALUE ? 0 : lastPts + 1;
+        }
+        lastPts = pts;
+        scaled->pts = pts;
+        return avcodec_send_frame(encoder, scaled) >= 0 && writePackets();
+    }
+
+    bool drainDecoder()
+    {
+        while (avcodec_receive_frame(decoder, frame) == 0) {
+            const bool ok = encode(frame);
+            av_frame_unref(frame);
+            if (!ok) return false;
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief 在 maxSize 内保持宽高比（按显示宽高比），不放大，取偶数
+ */
+QSize fitSize(const AVCodecParameters *codecpar, const QSize &maxSize)
+{
+    double displayWidth = codecpar->width;
+    if (codecpar->sample_aspect_ratio.num > 0 && codecpar->sample_aspect_ratio.den > 0) {
+        displayWidth *= av_q2d(codecpar->sample_aspect_ratio);
+    }
+    const double scale = qMin(1.0, qMin(maxSize.width() / displayWidth,
+                                        double(maxSize.height()) / codecpar->height));
+    return QSize(qMax(2, qRound(displayWidth * scale) & ~1), qMax(2, qRound(codecpar->height * scale) & ~1));
+}
+
+} // namespace
+
+bool ProxyCache::build(const QString &master, const QSize &maxSize, const std::function<bool()> &keepGoing)
+{
+    const QString finalPath = proxyPath(master);
+    const QString partPath = finalPath + QStringLiteral(".part");
+    if (!QDir().mkpath(cacheDir())) {
+        qWarning() << "[代理] 无法创建缓存目录:" << cacheDir();
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    // 资源在 lambda 返回时释放，之后才能删除或改名 .part
+    const bool ok = [&]() {
+        ProxyJob job;
+        if (avformat_open_input(&job.input, master.toUtf8().constData(), nullptr, nullptr) != 0
+            || avformat_find_stream_info(job.input, nullptr) < 0) {
+            qWarning() << "[代理] 无法打开源文件:" << master;
+            return false;
+        }
+        job.videoIndex = av_find_best_stream(job.input, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+        if (job.videoIndex < 0) return false;
+        for (unsigned i = 0; i < job.input->nb_streams; i++) {
+            if (int(i) != job.videoIndex) job.input->streams[i]->discard = AVDISCARD_ALL;
+        }
+        const AVStream *inStream = job.input->streams[job.videoIndex];
+
+        // 解码器：后台任务只用一个线程，不与播放争抢核心
+        const AVCodec *decoder = avcodec_find_decoder(inStream->codecpar->codec_id);
+        job.decoder = decoder ? avcodec_alloc_context3(decoder) : nullptr;
+        if (!job.decoder || avcodec_parameters_to_context(job.decoder, inStream->codecpar) < 0) return false;
+        job.decoder->thread_count = 1;
+        job.decoder->pkt_timebase = inStream->time_base;
+        if (avcodec_open2(job.decoder, decoder, nullptr) < 0) return false;
+
+        // 编码器：MJPEG 每帧独立成帧，任意帧都能直接跳转
+        const AVCodec *encoder = avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+        if (!encoder) {
+            qWarning("[代理] MJPEG 编码器不可用");
+            return false;
+        }
+        const QSize size = fitSize(inStream->codecpar, maxSize);
+        job.encoder = avcodec_alloc_context3(encoder);
+        if (!job.encoder) return false;
+        job.encoder->width = size.width();
+        job.encoder->height = size.height();
+        job.encoder->pix_fmt = AV_PIX_FMT_YUVJ420P;
+        job.encoder->time_base = inStream->time_base;
+        job.encoder->flags |= AV_CODEC_FLAG_QSCALE;
+        job.encoder->global_quality = FF_QP2LAMBDA * PROXY_QSCALE;
+        job.encoder->thread_count = 1;
+        if (avcodec_open2(job.encoder, encoder, nullptr) < 0) return false;
+
+        if (avformat_alloc_output_context2(&job.output, nullptr, "nut", partPath.toUtf8().constData()) < 0) {
+            return false;
+        }
+        job.outStream = avformat_new_stream(job.output, nullptr);
+        if (!job.outStream || avcodec_parameters_from_context(job.outStream->codecpar, job.encoder) < 0) {
+            return false;
+        }
+        job.outStream->time_base = inStream->time_base;
+        if (avio_open(&job.output->pb, partPath.toUtf8().constData(), AVIO_FLAG_WRITE) < 0
+            || avformat_write_header(job.output, nullptr) < 0) {
+            qWarning() << "[代理] 无法写入:" << partPath;
+            return false;
+        }
+
+        job.packet = av_packet_alloc();
+        job.frame = av_frame_alloc();
+        job.scaled = av_frame_alloc();
+        if (!job.packet || !job.frame || !job.scaled) return false;
+        job.scaled->format = job.encoder->pix_fmt;
+        job.scaled->width = size.width();
+        job.scaled->height = size.height();
+        if (av_frame_get_buffer(job.scaled, 0) < 0) return false;
+
+        bool cancelled = false;
+        bool failed = false;
+        while (!failed && av_read_frame(job.input, job.packet) >= 0) {
+            if (job.packet->stream_index == job.videoIndex) {
+                if (!keepGoing()) {
+                    cancelled = true;
+                    av_packet_unref(job.packet);
+                    break;
+                }
+                avcodec_send_packet(job.decoder, job.packet);     // 损坏的包跳过，继续后面的帧
+                av_packet_unref(job.packet);
+                failed = !job.drainDecoder();
+            } else {
+                av_packet_unref(job.packet);
+            }
+        }
+        if (cancelled || failed) return false;
+        avcodec_send_packet(job.decoder, nullptr);
+        return job.drainDecoder()
+               && avcodec_send_frame(job.encoder, nullptr) >= 0 && job.writePackets()
+               && av_write_trailer(job.output) >= 0;
+    }();
+
+    if (!ok || !QFile::rename(partPath, finalPath)) {
+        QFile::remove(partPath);
+        return false;
+    }
+    qDebug() << "[代理] 生成完成:" << QFileInfo(master).fileName() << "用时" << timer.elapsed() << "ms";
+    return true;
+}
+
+// ============================================================================
+// 拖动预览
+// ============================================================================
+
+ProxyScrubber::~ProxyScrubber()
+{
+    close();
+}
+
+bool ProxyScrubber::open(const QString &proxy)
+{
+    close();
+    if (avformat_open_input(&m_formatCtx, proxy.toUtf8().constData(), nullptr, nullptr) != 0) {
+        return false;
+    }
+    m_videoIndex = avformat_find_stream_info(m_formatCtx, nullptr) >= 0
+        ? av_find_best_stream(m_formatCtx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0) : -1;
+    const AVCodec *codec = m_videoIndex >= 0
+        ? avcodec_find_decoder(m_formatCtx->streams[m_videoIndex]->codecpar->codec_id) : nullptr;
+    m_codecCtx = codec ? avcodec_alloc_context3(codec) : nullptr;
+    if (!m_codecCtx
+        || avcodec_parameters_to_context(m_codecCtx, m_formatCtx->streams[m_videoIndex]->codecpar) < 0
+        || avcodec_open2(m_codecCtx, codec, nullptr) < 0) {
+        close();
+        return false;
+    }
+    m_packet = av_packet_alloc();
+    m_frame = av_frame_alloc();
+    m_path = proxy;
+    return m_packet && m_frame;
+}
+
+void ProxyScrubber::close()
+{
+    sws_freeContext(m_swsCtx);
+    m_swsCtx = nullptr;
+    av_frame_free(&m_frame);
+    av_packet_free(&m_packet);
+    avcodec_free_context(&m_codecCtx);
+    avformat_close_input(&m_formatCtx);
+    m_videoIndex = -1;
+    m_path.clear();
+}
+
+bool ProxyScrubber::isOpen() const
+{
+    return m_codecCtx != nullptr;
+}
+
+QImage ProxyScrubber::frameAt(double seconds, int width)
+{
+    if (!isOpen() || width < 2) return QImage();
+
+    // 每帧都是关键帧：向后跳转落在的就是目标时刻之前最近的帧
+    const int64_t timestamp = static_cast<int64_t>(seconds * AV_TIME_BASE);
+    if (av_seek_frame(m_formatCtx, -1, timestamp, AVSEEK_FLAG_BACKWARD) < 0) return QImage();
+    avcodec_flush_buffers(m_codecCtx);
+
+    bool gotFrame = false;
+    while (!gotFrame && av_read_frame(m_formatCtx, m_packet) >= 0) {
+        if (m_packet->stream_index == m_videoIndex && avcodec_send_packet(m_codecCtx, m_packet) >= 0) {
+            gotFrame = avcodec_receive_frame(m_codecCtx, m_frame) == 0;
+        }
+        av_packet_unref(m_packet);
+    }
+    if (!gotFrame) return QImage();
+
+    const int height = qMax(2, qRound(double(width) * m_frame->height / qMax(1, m_frame->width)));
+    m_swsCtx = sws_getCachedContext(m_swsCtx, m_frame->width, m_frame->height,
+                                    static_cast<AVPixelFormat>(m_frame->format),
+                                    width, height, AV_PIX_FMT_RGB32, SWS_BILINEAR, nullptr, nullptr, nullptr);
+    QImage image(width, height, QImage::Format_RGB32);
+    if (!m_swsCtx || image.isNull()) {
+        av_frame_unref(m_frame);
+        return QImage();
+    }
+    uint8_t *dst[4] = { image.bits(), nullptr, nullptr, nullptr };
+    const int dstStride[4] = { static_cast<int>(image.bytesPerLine()), 0, 0, 0 };
+    sws_scale(m_swsCtx, m_frame->data, m_frame->linesize, 0, m_frame->height, dst, dstStride);
+    av_frame_unref(m_frame);
+    return image;
+}
+
+#else
+
+bool ProxyCache::build(const QString &master, const QSize &maxSize, const std::function<bool()> &keepGoing)
+{
+    Q_UNUSED(master)
+    Q_UNUSED(maxSize)
+    Q_UNUSED(keepGoing)
+    return false;
+}
+
+ProxyScrubber::~ProxyScrubber() = default;
+
+bool ProxyScrubber::open(const QString &proxy)
+{
+    Q_UNUSED(proxy)
+    return false;
+}
+
+void ProxyScrubber::close() {}
+
+bool ProxyScrubber::isOpen() const
+{
+    return false;
+}
+
+QImage ProxyScrubber::frameAt(double seconds, int width)
+{
+    Q_UNUSED(seconds)
+    Q_UNUSED(width)
+    return QImage();
+}
+
+#endif
+
+// ============================================================================
+// 生成队列
+// ============================================================================
+
+ProxyBuilder::ProxyBuilder(QObject *parent)
+    : QObject(parent)
+{
+}
+
+ProxyBuilder::~ProxyBuilder()
+{
+    {
+        QMutexLocker locker(&m_pauseMutex);
+        m_cancel = true;
+        m_resumed.wakeAll();
+    }
+    if (m_thread) {
+        m_thread->wait();
+        delete m_thread;
+    }
+}
+
+void ProxyBuilder::enqueue(const QString &master)
+{
+    if (master.isEmpty() || master == m_building || m_queue.contains(master)) return;
+    if (!ProxyCache::lookup(master).isEmpty()) return;
+    m_queue.append(master);
+    if (!m_thread) startNext();
+}
+
+void ProxyBuilder::setPaused(bool paused)
+{
+    QMutexLocker locker(&m_pauseMutex);
+    m_paused.store(paused, std::memory_order_relaxed);
+    if (!paused) m_resumed.wakeAll();
+}
+
+void ProxyBuilder::startNext()
+{
+    if (m_queue.isEmpty()) return;
+    m_building = m_queue.takeFirst();
+    const QString master = m_building;
+    const QSize maxSize = m_maxSize;
+    auto result = std::make_shared<bool>(false);
+    m_thread = QThread::create([this, master, maxSize, result]() {
+        *result = ProxyCache::build(master, maxSize, [this]() {
+            if (m_paused.load(std::memory_order_relaxed)) {
+                QMutexLocker locker(&m_pauseMutex);
+                while (m_paused.load(std::memory_order_relaxed) && !m_cancel.load(std::memory_order_relaxed)) {
+                    m_resumed.wait(&m_pauseMutex);
+                }
+            }
+            return !m_cancel.load(std::memory_order_relaxed);
+        });
+        if (*result) ProxyCache::prune();
+    });
+    connect(m_thread, &QThread::finished, this, [this, master, result]() {
+        m_thread->deleteLater();
+        m_thread = nullptr;
+        m_building.clear();
+        if (*result) emit proxyReady(master, ProxyCache::proxyPath(master));
+        startNext();
+    });
+    // 空闲优先级：只使用播放剩下的 CPU
+    m_thread->start(QThread::IdlePriority);
+}
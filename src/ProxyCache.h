@@ -0,0 +1,149 @@
+/**
+ * @file ProxyCache.h
+ * @brief 全帧内代理缓存：后台把循环片段转码为 MJPEG 代理，用于拖动预览与缩略图
+ *
+ * 长 GOP 的源文件跳转到任意时刻需要从前一个关键帧解到目标帧，拖动进度条时无法即时出图。
+ * 空闲时后台任务把每个打开过的文件转码为全帧内（MJPEG，每帧都是关键帧）的代理：
+ * - 分辨率缩到显示尺寸以内（不放大），只保留视频
+ * - 保留源文件的时间基与 PTS，代理与源文件共用同一条时间轴
+ * - 写到缓存目录（<CacheLocation>/proxies，按路径、大小、修改时间的 SHA-1 命名），
+ *   先写 .part，完成后改名，未完成的代理永远不会被使用
+ * - 总量超过 MAX_CACHE_BYTES 时按最近使用时间淘汰
+ *
+ * 正常播放始终使用源文件；代理只用于拖动进度条时的预览帧（ProxyScrubber）
+ * 和故事板的格子（有代理时每格都是精确时刻的帧，而不是之前最近的关键帧）。
+ */
+
+#ifndef PROXYCACHE_H
+#define PROXYCACHE_H
+
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <QWaitCondition>
+#include <atomic>
+#include <functional>
+
+class QThread;
+
+namespace ProxyCache {
+
+/**
+ * @brief 源文件对应的代理路径（不检查是否存在）
+ */
+QString proxyPath(const QString &master);
+
+/**
+ * @brief 查找已完成的代理，并刷新其最近使用时间
+ * @return 代理路径，不存在时返回空字符串
+ */
+QString lookup(const QString &master);
+
+/**
+ * @brief 转码生成代理（阻塞）
+ * @param maxSize 代理分辨率上限，保持宽高比
+ * @param keepGoing 每帧调用一次；返回 false 时放弃并删除未完成的文件（可在其中阻塞以实现暂停）
+ * @return 是否成功生成
+ */
+bool build(const QString &master, const QSize &maxSize, const std::function<bool()> &keepGoing);
+
+/**
+ * @brief 缓存总量超过上限时删除最久未使用的代理
+ */
+void prune();
+
+} // namespace ProxyCache
+
+/**
+ * @brief 代理生成队列：单个空闲优先级线程逐个转码
+ *
+ * 方法只在 GUI 线程调用。拖动预览期间调用 setPaused(true)，让出 CPU 与磁盘。
+ */
+class ProxyBuilder : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ProxyBuilder(QObject *parent = nullptr);
+    ~ProxyBuilder() override;
+
+    /**
+     * @brief 代理分辨率上限（一般为屏幕尺寸）
+     */
+    void setMaxSize(const QSize &size) { m_maxSize = size; }
+
+    /**
+     * @brief 加入队列（已有代理或已在队列中时忽略）
+     */
+    void enqueue(const QString &master);
+
+    /**
+     * @brief 暂停 / 继续转码（暂停期间转码线程阻塞在条件变量上，不定时唤醒）
+     */
+    void setPaused(bool paused);
+
+signals:
+    void proxyReady(const QString &master, const QString &proxy);
+
+private:
+    void startNext();
+
+    QThread *m_thread = nullptr;
+    QString m_building;
+    QStringList m_queue;
+    QSize m_maxSize{1920, 1080};
+    // 转码线程每帧无锁检查；修改在 m_pauseMutex 内进行并唤醒 m_resumed
+    std::atomic<bool> m_paused{false};
+    std::atomic<bool> m_cancel{false};
+    QMutex m_pauseMutex;
+    QWaitCondition m_resumed;
+};
+
+#if FFMPEG_AVAILABLE
+struct AVFormatContext;
+struct AVCodecContext;
+struct AVPacket;
+struct AVFrame;
+struct SwsContext;
+#endif
+
+/**
+ * @brief 从代理取预览帧：跳转到目标时刻之前最近的帧，只解一帧
+ *
+ * 同步调用，单帧耗时约为一次 JPEG 解码，可以直接在拖动进度条的回调中使用。
+ */
+class ProxyScrubber
+{
+public:
+    ProxyScrubber() = default;
+    ~ProxyScrubber();
+    ProxyScrubber(const ProxyScrubber&) = delete;
+    ProxyScrubber &operator=(const ProxyScrubber&) = delete;
+
+    bool open(const QString &proxy);
+    void close();
+    bool isOpen() const;
+    QString path() const { return m_path; }
+
+    /**
+     * @brief 取 seconds 时刻（与渲染器 seek 相同的时间轴）的帧，缩放到 width 宽
+     * @return 失败时返回空图
+     */
+    QImage frameAt(double seconds, int width);
+
+private:
+    QString m_path;
+#if FFMPEG_AVAILABLE
+    AVFormatContext *m_formatCtx = nullptr;
+    AVCodecContext *m_codecCtx = nullptr;
+    AVPacket *m_packet = nullptr;
+    AVFrame *m_frame = nullptr;
+    SwsContext *m_swsCtx = nullptr;
+    int m_videoIndex = -1;
+#endif
+};
+
+#endif // PROXYCACHE_H
@@ -0,0 +1,1988 @@
+/**
+ * @file RhiRenderer.cpp
+ * @brief Qt RHI 视频渲染器实现（跨平台）
+ */
+
+#include "RhiRenderer.h"
+#include "MediaProbe.h"
+#include "PipelineWatchdog.h"
+#include "StartupTimeline.h"
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QVBoxLayout>
+#include <QAudioFormat>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+// 音频输出格式：44100Hz，双声道，16 位
+static constexpr int AUDIO_SAMPLE_RATE = 44100;
+static constexpr int AUDIO_BYTES_PER_SECOND = AUDIO_SAMPLE_RATE * 2 * 2;
+
+// 统一缓冲：mat4 mvp + vec4 去隔行参数 + 2 × vec4 色彩参数（std140）
+static constexpr int UNIFORM_BUFFER_SIZE = 64 + 3 * 16;
+
+// HDR 色调映射：SDR 参考白（BT.2408）与缺少元数据时假定的内容峰值
+static constexpr float SDR_WHITE_NITS = 203.0f;
+static constexpr float DEFAULT_HDR_PEAK_NITS = 1000.0f;
+
+// 运动自适应去隔行：亮度差超过该值开始过渡到 bob，两倍时完全 bob
+static constexpr float MOTION_THRESHOLD = 10.0f / 255.0f;
+
+static QShader loadShader(const QString &name)
+{
+    QFile file(name);
+    if (file.open(QIODevice::ReadOnly)) {
+        return QShader::fromSerialized(file.readAll());
+    }
+    qWarning() << "无法加载着色器:" << name;
+    return QShader();
+}
+
+// ============================================
+// RhiVideoView 实现
+// ============================================
+
+RhiVideoView::RhiVideoView(QWidget *parent)
+    : QRhiWidget(parent)
+{
+    // 鼠标事件交给外层窗口处理（拖动、右键菜单等）
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+}
+
+void RhiVideoView::setFrame(RhiVideoFrame &&frame)
+{
+    // 同一帧的第二场：纹理已在 GPU 上，只切换显示的场
+    const bool uploaded = frame.secondField && !m_frameDirty
+        && frame.planes[0].constData() == m_frame.planes[0].constData();
+    m_frame = std::move(frame);
+    m_frameDirty = !uploaded;
+    update();
+}
+
+void RhiVideoView::clearFrame()
+{
+    m_frame = RhiVideoFrame();
+    m_frameDirty = false;
+    update();
+}
+
+void RhiVideoView::setMemoryAccounting(MemoryAccounting *accounting)
+{
+    m_textureCharge = MemoryCharge(accounting, MemoryCategory::GpuTextures, m_textureCharge.bytes());
+    m_prevLumaCharge = MemoryCharge(accounting, MemoryCategory::GpuTextures, m_prevLumaCharge.bytes());
+}
+
+void RhiVideoView::initialize(QRhiCommandBuffer *cb)
+{
+    Q_UNUSED(cb)
+
+    // 渲染目标尺寸变化时也会调用，仅在 QRhi 变化时重建资源
+    if (m_rhi == rhi()) return;
+
+    releaseResources();
+    m_rhi = rhi();
+    if (!m_rhi) return;
+    StartupTimeline::mark("rhi initialize");
+
+    // 顶点（位置 + 纹理坐标）随几何变换与窗口尺寸更新，只有 4 个顶点
+    m_vbuf.reset(m_rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::VertexBuffer, sizeof(m_quad)));
+    m_vbuf->create();
+    m_vbufUploaded = false;
+
+    m_ubuf.reset(m_rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, UNIFORM_BUFFER_SIZE));
+    m_ubuf->create();
+
+    m_sampler.reset(m_rhi->newSampler(QRhiSampler::Linear, QRhiSampler::Linear, QRhiSampler::None,
+                                      QRhiSampler::ClampToEdge, QRhiSampler::ClampToEdge));
+    m_sampler->create();
+
+    // 先创建 1x1 占位纹理，保证 SRB 与管线可以立即创建
+    // 亮度纹理可作为复制源：运动自适应去隔行在 GPU 上把它复制为上一帧
+    m_textureSize = QSize();
+    m_textureFormat = QRhiTexture::R8;
+    m_highBitDepth = m_rhi->isTextureFormatSupported(QRhiTexture::R16);
+    for (int i = 0; i < 3; i++) {
+        m_textures[i].reset(m_rhi->newTexture(QRhiTexture::R8, QSize(1, 1), 1,
+                                              i == 0 ? QRhiTexture::UsedAsTransferSource : QRhiTexture::Flags()));
+        m_textures[i]->create();
+    }
+    m_prevLuma.reset(m_rhi->newTexture(QRhiTexture::R8, QSize(1, 1)));
+    m_prevLuma->create();
+    m_prevLumaValid = false;
+
+    m_srb.reset(m_rhi->newShaderResourceBindings());
+    m_srb->setBindings({
+        QRhiShaderResourceBinding::uniformBuffer(0, QRhiShaderResourceBinding::VertexStage
+                                                        | QRhiShaderResourceBinding::FragmentStage,
+                                                 m_ubuf.get()),
+        QRhiShaderResourceBinding::sampledTexture(1, QRhiShaderResourceBinding::FragmentStage,
+                                                  m_textures[0].get(), m_sampler.get()),
+        QRhiShaderResourceBinding::sampledTexture(2, QRhiShaderResourceBinding::FragmentStage,
+                                                  m_textures[1].get(), m_sampler.get()),
+        QRhiShaderResourceBinding::sampledTexture(3, QRhiShaderResourceBinding::FragmentStage,
+                                                  m_textures[2].get(), m_sampler.get()),
+        QRhiShaderResourceBinding::sampledTexture(4, QRhiShaderResourceBinding::FragmentStage,
+                                                  m_prevLuma.get(), m_sampler.get()),
+    });
+    m_srb->create();
+
+    QRhiVertexInputLayout inputLayout;
+    inputLayout.setBindings({ { sizeof(VideoQuadVertex) } });
+    inputLayout.setAttributes({
+        { 0, 0, QRhiVertexInputAttribute::Float2, 0 },
+        { 0, 1, QRhiVertexInputAttribute::Float2, 2 * sizeof(float) },
+    });
+
+    m_pipeline.reset(m_rhi->newGraphicsPipeline());
+    m_pipeline->setShaderStages({
+        { QRhiShaderStage::Vertex, loadShader(QStringLiteral(":/shaders/video.vert.qsb")) },
+        { QRhiShaderStage::Fragment, loadShader(QStringLiteral(":/shaders/video.frag.qsb")) },
+    });
+    m_pipeline->setTopology(QRhiGraphicsPipeline::TriangleStrip);
+    m_pipeline->setVertexInputLayout(inputLayout);
+    m_pipeline->setShaderResourceBindings(m_srb.get());
+    m_pipeline->setSampleCount(sampleCount());
+    m_pipeline->setRenderPassDescriptor(renderTarget()->renderPassDescriptor());
+    if (!m_pipeline->create()) {
+        qCritical() << "RHI 管线创建失败";
+    }
+
+    qDebug() << "RHI 初始化完成，后端:" << m_rhi->backendName()
+             << "设备:" << m_rhi->driverInfo().deviceName;
+}
+
+bool RhiVideoView::ensureTextures(int width, int height, QRhiTexture::Format format)
+{
+    const QSize size(width, height);
+    if (size == m_textureSize && format == m_textureFormat) return true;
+
+    const QSize chromaSize((width + 1) / 2, (height + 1) / 2);
+    const QSize sizes[3] = { size, chromaSize, chromaSize };
+    for (int i = 0; i < 3; i++) {
+        m_textures[i]->setFormat(format);
+        m_textures[i]->setPixelSize(sizes[i]);
+        if (!m_textures[i]->create()) {
+            qWarning() << "RHI 纹理创建失败:" << sizes[i];
+            m_textureSize = QSize();
+            return false;
+        }
+    }
+
+    // 纹理重建后 SRB 需要重新生成；上一帧亮度尺寸不再匹配
+    m_srb->create();
+    m_textureSize = size;
+    m_textureFormat = format;
+    m_lumaUploaded = false;
+    m_prevLumaValid = false;
+    const int bytesPerTexel = (format == QRhiTexture::R16) ? 2 : 1;
+    m_textureCharge.resize(bytesPerTexel * (qint64(width) * height + 2 * qint64(chromaSize.width()) * chromaSize.height()));
+    qDebug() << "RHI 纹理重建:" << width << "x" << height << (bytesPerTexel == 2 ? "16 位" : "8 位");
+    return true;
+}
+
+bool RhiVideoView::ensurePrevLuma()
+{
+    if (m_prevLuma->pixelSize() == m_textureSize && m_prevLuma->format() == m_textureFormat) return true;
+
+    m_prevLuma->setFormat(m_textureFormat);
+    m_prevLuma->setPixelSize(m_textureSize);
+    if (!m_prevLuma->create()) {
+        qWarning() << "RHI 上一帧亮度纹理创建失败:" << m_textureSize;
+        return false;
+    }
+    m_srb->create();
+    m_prevLumaCharge.resize(qint64(m_textureSize.width()) * m_textureSize.height()
+                            * (m_textureFormat == QRhiTexture::R16 ? 2 : 1));
+    return true;
+}
+
+void RhiVideoView::uploadFrame(QRhiResourceUpdateBatch *batch)
+{
+    const QRhiTexture::Format format = m_frame.bitDepth > 8 ? QRhiTexture::R16 : QRhiTexture::R8;
+    if (!ensureTextures(m_frame.width, m_frame.height, format)) return;
+
+    // 运动自适应：覆盖前先在 GPU 上保留当前亮度作为上一帧（批次内按记录顺序执行）
+    if (m_frame.deinterlace == DeinterlaceMode::MotionAdaptive && ensurePrevLuma()) {
+        m_prevLumaValid = m_lumaUploaded;
+        if (m_lumaUploaded) {
+            batch->copyTexture(m_prevLuma.get(), m_textures[0].get());
+        }
+    } else {
+        m_prevLumaValid = false;
+    }
+
+    for (int i = 0; i < 3; i++) {
+        // QByteArray 隐式共享：上传描述不复制平面数据，按 linesize 直接读取
+        QRhiTextureSubresourceUploadDescription desc(m_frame.planes[i]);
+        desc.setDataStride(m_frame.linesize[i]);
+        batch->uploadTexture(m_textures[i].get(), QRhiTextureUploadEntry(0, 0, desc));
+    }
+    m_lumaUploaded = true;
+}
+
+void RhiVideoView::setVideoGeometry(const VideoGeometry &geometry, int streamRotation)
+{
+    m_geometry = geometry;
+    m_streamRotation = streamRotation;
+    update();
+}
+
+void RhiVideoView::updateQuad(QRhiResourceUpdateBatch *batch)
+{
+    // 旋转、翻转、裁剪、变焦与黑边都折算进顶点；没有变化时不上传
+    VideoQuadVertex quad[4];
+    m_geometry.quad(m_streamRotation, m_textureSize, m_textureSize, renderTarget()->pixelSize(), quad);
+    if (m_vbufUploaded && std::memcmp(quad, m_quad, sizeof(quad)) == 0) return;
+
+    std::memcpy(m_quad, quad, sizeof(quad));
+    batch->updateDynamicBuffer(m_vbuf.get(), 0, sizeof(m_quad), m_quad);
+    m_vbufUploaded = true;
+}
+
+QVector4D RhiVideoView::deinterlaceParams() const
+{
+    DeinterlaceMode mode = m_frame.deinterlace;
+    // 首帧或尺寸刚变化时还没有上一帧，先按 bob 显示
+    if (mode == DeinterlaceMode::MotionAdaptive && !m_prevLumaValid) {
+        mode = DeinterlaceMode::Bob;
+    }
+    return QVector4D(float(static_cast<int>(mode)),
+                     m_frame.bottomField ? 1.0f : 0.0f,
+                     float(m_textureSize.height()),
+                     MOTION_THRESHOLD);
+}
+
+QVector4D RhiVideoView::colorParams() const
+{
+    // 高位深样本位于 16 位容器的低位，R16 采样值需要放大回 [0, 1]
+    const float sampleScale = m_frame.bitDepth > 8 ? 65535.0f / ((1 << m_frame.bitDepth) - 1) : 1.0f;
+    const float peak = m_frame.peakNits > 0 ? m_frame.peakNits : DEFAULT_HDR_PEAK_NITS;
+    return QVector4D(float(static_cast<int>(m_frame.transfer)),
+                     m_frame.bt2020 ? 1.0f : 0.0f,
+                     sampleScale,
+                     peak);
+}
+
+void RhiVideoView::render(QRhiCommandBuffer *cb)
+{
+    if (!m_rhi || !m_pipeline) return;
+
+    QRhiResourceUpdateBatch *batch = m_rhi->nextResourceUpdateBatch();
+
+    if (m_frameDirty) {
+        uploadFrame(batch);
+        m_frameDirty = false;
+    }
+    updateQuad(batch);
+
+    const QMatrix4x4 mvp = m_rhi->clipSpaceCorrMatrix();
+    batch->updateDynamicBuffer(m_ubuf.get(), 0, 64, mvp.constData());
+    const QVector4D deint = deinterlaceParams();
+    const QVector4D color = colorParams();
+    const float fragmentData[12] = {
+        deint.x(), deint.y(), deint.z(), deint.w(),
+        color.x(), color.y(), color.z(), color.w(),
+        m_frame.fullRange ? 1.0f : 0.0f, SDR_WHITE_NITS, 0.0f, 0.0f,
+    };
+    batch->updateDynamicBuffer(m_ubuf.get(), 64, sizeof(fragmentData), fragmentData);
+
+    const QSize outputSize = renderTarget()->pixelSize();
+    cb->beginPass(renderTarget(), Qt::black, { 1.0f, 0 }, batch);
+
+    if (m_textureSize.isValid()) {
+        cb->setGraphicsPipeline(m_pipeline.get());
+        cb->setViewport(QRhiViewport(0, 0, outputSize.width(), outputSize.height()));
+        cb->setShaderResources();
+        const QRhiCommandBuffer::VertexInput vbufBinding(m_vbuf.get(), 0);
+        cb->setVertexInput(0, 1, &vbufBinding);
+        cb->draw(4);
+    }
+
+    cb->endPass();
+
+    if (m_textureSize.isValid()) {
+        StartupTimeline::firstFrame();
+    }
+}
+
+void RhiVideoView::releaseResources()
+{
+    m_pipeline.reset();
+    m_srb.reset();
+    for (auto &texture : m_textures) {
+        texture.reset();
+    }
+    m_prevLuma.reset();
+    m_prevLumaCharge.resize(0);
+    m_lumaUploaded = false;
+    m_prevLumaValid = false;
+    m_sampler.reset();
+    m_ubuf.reset();
+    m_vbuf.reset();
+    m_textureSize = QSize();
+    m_textureCharge.resize(0);
+    m_rhi = nullptr;
+    // 保留 m_frame，资源重建后重新上传
+    m_frameDirty = m_frame.width > 0;
+}
+
+// ============================================
+// RhiRenderer 实现
+// ============================================
+
+RhiRenderer::RhiRenderer(QWidget *parent)
+    : VideoRendererBase(parent)
+{
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    m_view = new RhiVideoView(this);
+    m_view->setMemoryAccounting(&m_metrics.memory());
+    layout->addWidget(m_view);
+
+    // 渲染定时器（实际帧率由主时钟控制，呈现与 vsync 对齐）
+    m_renderTimer = new QTimer(this);
+    m_renderTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_renderTimer, &QTimer::timeout, this, &RhiRenderer::onRenderTimer);
+
+    // 音频定时器
+    m_audioTimer = new QTimer(this);
+    m_audioTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_audioTimer, &QTimer::timeout, this, &RhiRenderer::onAudioTimer);
+
+    // 停滞看门狗：呈现停住时逐级恢复（动作在 GUI 线程执行）
+    m_watchdog = new PipelineWatchdog(m_metrics, this);
+    m_watchdog->setRecoveryHandler([this](RecoveryAction action) { return runRecovery(action); });
+
+    qDebug() << "RhiRenderer 创建";
+}
+
+RhiRenderer::~RhiRenderer()
+{
+    releaseCue();
+    stop();
+    closeFile();
+}
+
+bool RhiRenderer::openFile(const QString &filename)
+{
+#if FFMPEG_AVAILABLE
+    closeFile();
+    m_seeking = false;  // 新容器从开头读（排期切换接管的容器停在预热位置，不能再跳转）
+    if (filename != m_currentFile) {
+        m_hardwareAllowed = true;   // 看门狗的软件回退只对出问题的文件生效
+    }
+
+    // 优先使用排期切换预加载的容器与解码器（仅限到期的切换本身），其次是启动时后台预探测的结果
+    // （与窗口、RHI 初始化并行完成）
+    PreparedCue *cue = (m_cue.isDue() && m_cueReady && m_cuePrepared.formatCtx && m_cuePrepared.file == filename)
+        ? &m_cuePrepared : nullptr;
+    const bool primed = cue && cue->videoCodecCtx;
+    if (cue) {
+        m_formatCtx = std::exchange(cue->formatCtx, nullptr);
+    } else {
+        m_formatCtx = MediaProbe::take(filename);
+    }
+    if (!m_formatCtx) {
+        if (avformat_open_input(&m_formatCtx, filename.toUtf8().constData(), nullptr, nullptr) != 0) {
+            emit errorOccurred("无法打开文件: " + filename);
+            return false;
+        }
+
+        if (avformat_find_stream_info(m_formatCtx, nullptr) < 0) {
+            emit errorOccurred("无法获取流信息");
+            closeFile();
+            return false;
+        }
+    }
+
+    // 停止管线时打断阻塞中的读包：网络源停滞时关闭不必等到读超时
+    m_formatCtx->interrupt_callback = AVIOInterruptCB{ &RhiRenderer::interruptIo, this };
+
+    if (m_formatCtx->duration != AV_NOPTS_VALUE) {
+        m_duration = static_cast<double>(m_formatCtx->duration) / AV_TIME_BASE;
+        emit durationChanged(m_duration);
+    }
+
+    m_videoStreamIndex = primed ? cue->videoStream
+                                : av_find_best_stream(m_formatCtx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (m_videoStreamIndex < 0) {
+        emit errorOccurred("未找到视频流");
+        closeFile();
+        return false;
+    }
+    // HLS / DASH 多变体：从码率最低的变体起播，解码器按该变体打开
+    if (m_abr.open(m_formatCtx, m_videoStreamIndex)) {
+        m_videoStreamIndex = m_abr.current().videoStream;
+    }
+    m_audioStreamIndex = av_find_best_stream(m_formatCtx, AVMEDIA_TYPE_AUDIO, -1, m_videoStreamIndex, nullptr, 0);
+
+    // 初始化视频解码器
+    AVCodecParameters *codecpar = m_formatCtx->streams[m_videoStreamIndex]->codecpar;
+    const AVCodec *codec = avcodec_find_decoder(codecpar->codec_id);
+    if (!codec) {
+        emit errorOccurred("找不到视频解码器");
+        closeFile();
+        return false;
+    }
+
+    const AVStream *videoStream = m_formatCtx->streams[m_videoStreamIndex];
+    const AVRational frameRate = videoStream->avg_frame_rate.num > 0 ? videoStream->avg_frame_rate
+                                                                     : videoStream->r_frame_rate;
+    m_sourceFps = frameRate.num > 0 && frameRate.den > 0 ? av_q2d(frameRate) : 0;
+    m_skipNonRef = true;
+    m_presentSerial = -1;
+
+    // 短循环磁盘帧缓存：命中时视频帧直接来自映射，解码器只用于读取流参数，不初始化硬件解码
+    openFrameCache(filename, videoStream);
+    if (m_cacheWriter && primed) {
+        m_cacheWriter.reset();  // 预卷帧已从解码器取走，第一轮不完整
+    }
+    if (m_cacheWriter) {
+        m_skipNonRef = false;   // 录制需要第一轮的每一帧
+    }
+
+    if (primed) {
+        // 排期切换：解码器已在预加载线程打开并解出首帧，预热时的输出与音频包在管线启动时先送出
+        m_videoCodecCtx = std::exchange(cue->videoCodecCtx, nullptr);
+        m_hwDeviceCtx = std::exchange(cue->hwDeviceCtx, nullptr);
+        m_primedFrames = std::move(cue->frames);
+        cue->frames.clear();
+    } else {
+        QString error;
+        if (!openVideoDecoder(codec, codecpar, error)) {
+            emit errorOccurred(error);
+            closeFile();
+            return false;
+        }
+    }
+
+    m_videoWidth = m_videoCodecCtx->width;
+    m_videoHeight = m_videoCodecCtx->height;
+
+    // 手机拍摄的片段带显示矩阵旋转
+    const AVPacketSideData *displayMatrix = av_packet_side_data_get(
+        codecpar->coded_side_data, codecpar->nb_coded_side_data, AV_PKT_DATA_DISPLAYMATRIX);
+    m_streamRotation = displayMatrix
+        ? VideoGeometry::rotationFromDisplayMatrix(reinterpret_cast<const int32_t *>(displayMatrix->data)) : 0;
+    if (m_streamRotation != 0) {
+        qDebug() << "流旋转:" << m_streamRotation << "度";
+    }
+    m_view->setVideoGeometry(m_videoGeometry, m_streamRotation);
+
+    // 初始化音频解码器
+    if (primed) {
+        m_audioStreamIndex = cue->audioStream;
+        m_audioCodecCtx = std::exchange(cue->audioCodecCtx, nullptr);
+        m_swrCtx = std::exchange(cue->swrCtx, nullptr);
+        m_primedAudioPackets = std::move(cue->audioPackets);
+        cue->audioPackets.clear();
+    } else if (m_audioStreamIndex >= 0) {
+        openAudioDecoder(m_formatCtx->streams[m_audioStreamIndex], m_audioCodecCtx, m_swrCtx);
+    }
+    m_hasAudio = (m_audioCodecCtx && m_swrCtx);
+
+    qDebug() << "========================================";
+    qDebug() << "RHI 播放器 - 文件已打开:" << filename;
+    qDebug() << "时长:" << m_duration << "秒";
+    qDebug() << "视频:" << m_videoWidth << "x" << m_videoHeight;
+    qDebug() << "硬件解码:" << (m_hwDeviceCtx ? av_hwdevice_get_type_name(
+                    reinterpret_cast<AVHWDeviceContext*>(m_hwDeviceCtx->data)->type) : "软件");
+    qDebug() << "========================================";
+
+    m_currentFile = filename;
+    m_firstFramePending = true;
+    m_metrics.setHardwareDecoding(m_hwDeviceCtx != nullptr);
+    emit fileLoaded();
+    if (m_abr.isActive()) {
+        const AbrVariant &variant = m_abr.current();
+        emit variantSwitched(m_abr.currentIndex(), QSize(variant.width, variant.height), variant.bandwidth);
+    }
+    StartupTimeline::mark("decoder open");
+    return true;
+#else
+    Q_UNUSED(filename)
+    emit errorOccurred("FFmpeg 未配置");
+    return false;
+#endif
+}
+
+#if FFMPEG_AVAILABLE
+/**
+ * @brief 创建并打开视频解码器（openFile 与看门狗重建解码器共用）
+ * @param error 失败时的错误信息
+ */
+bool RhiRenderer::openVideoDecoder(const AVCodec *codec, const AVCodecParameters *codecpar, QString &error)
+{
+    m_videoCodecCtx = avcodec_alloc_context3(codec);
+    avcodec_parameters_to_context(m_videoCodecCtx, codecpar);
+
+    if (m_frameCache) {
+        qDebug() << "帧缓存命中，不启动视频解码";
+    } else if (m_decodeMode == Software) {
+        qDebug() << "强制使用软件解码";
+    } else if (!m_hardwareAllowed) {
+        qDebug() << "看门狗已回退软件解码";
+    } else if (!initHardwareDecoder(m_videoCodecCtx, codec, m_hwDeviceCtx)) {
+        if (m_decodeMode == Hardware) {
+            error = "硬件解码初始化失败，且设置为强制硬件模式";
+            return false;
+        }
+        qWarning() << "硬件解码不可用，使用软件解码";
+    }
+    m_bufferPools.install(m_videoCodecCtx);
+
+    if (avcodec_open2(m_videoCodecCtx, codec, nullptr) < 0) {
+        error = "无法打开视频解码器";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 看门狗恢复：停止管线，释放并重新打开视频解码器，从当前位置重新解码
+ *
+ * 容器与音频解码器保留。停止管线需等待各阶段协程退出：解码调用本身卡死（驱动不返回）时
+ * 协程无法被强制结束，这一级同样会卡住，看门狗对此无能为力。
+ */
+bool RhiRenderer::reopenVideoDecoder()
+{
+    if (!m_formatCtx || m_frameCache) return false;    // 帧缓存命中时不经过解码器
+
+    const double position = m_currentPts;
+    stopPipeline();
+    clearQueues();
+    m_primedFrames.clear();
+    avcodec_free_context(&m_videoCodecCtx);
+    av_buffer_unref(&m_hwDeviceCtx);
+
+    const AVCodecParameters *codecpar = m_formatCtx->streams[m_videoStreamIndex]->codecpar;
+    QString error;
+    const bool opened = openVideoDecoder(avcodec_find_decoder(codecpar->codec_id), codecpar, error);
+    m_metrics.setHardwareDecoding(opened && m_hwDeviceCtx);
+    if (!opened) {
+        qWarning() << "[看门狗] 重建解码器失败:" << error;
+        return false;
+    }
+
+    seek(position);
+    startPipeline();
+    return true;
+}
+
+bool RhiRenderer::initHardwareDecoder(AVCodecContext *codecCtx, const AVCodec *codec, AVBufferRef *&hwDeviceCtx)
+{
+    // 各平台首选的硬件解码类型（按优先级）
+    const AVHWDeviceType hwTypes[] = {
+#ifdef _WIN32
+        AV_HWDEVICE_TYPE_D3D11VA,
+        AV_HWDEVICE_TYPE_DXVA2,
+#elif defined(__APPLE__)
+        AV_HWDEVICE_TYPE_VIDEOTOOLBOX,
+#else
+        AV_HWDEVICE_TYPE_VAAPI,
+        AV_HWDEVICE_TYPE_VDPAU,
+#endif
+    };
+
+    for (AVHWDeviceType hwType : hwTypes) {
+        for (int i = 0;; i++) {
+            const AVCodecHWConfig *config = avcodec_get_hw_config(codec, i);
+            if (!config) break;
+
+            if (!(config->methods & AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX) ||
+                config->device_type != hwType) {
+                continue;
+            }
+
+            if (av_hwdevice_ctx_create(&hwDeviceCtx, hwType, nullptr, nullptr, 0) == 0) {
+                codecCtx->hw_device_ctx = av_buffer_ref(hwDeviceCtx);
+                qDebug() << "✓ 硬件解码已启用:" << av_hwdevice_get_type_name(hwType);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+int RhiRenderer::interruptIo(void *opaque)
+{
+    return static_cast<RhiRenderer *>(opaque)->m_interruptIo.load(std::memory_order_relaxed) ? 1 : 0;
+}
+
+bool RhiRenderer::openAudioDecoder(const AVStream *stream, AVCodecContext *&codecCtx, SwrContext *&swrCtx)
+{
+    const AVCodec *codec = avcodec_find_decoder(stream->codecpar->codec_id);
+    if (!codec) return false;
+
+    codecCtx = avcodec_alloc_context3(codec);
+    avcodec_parameters_to_context(codecCtx, stream->codecpar);
+    if (avcodec_open2(codecCtx, codec, nullptr) != 0) return false;
+
+    AVChannelLayout outLayout = AV_CHANNEL_LAYOUT_STEREO;
+    swr_alloc_set_opts2(&swrCtx,
+        &outLayout, AV_SAMPLE_FMT_S16, AUDIO_SAMPLE_RATE,
+        &codecCtx->ch_layout, codecCtx->sample_fmt, codecCtx->sample_rate,
+        0, nullptr);
+    if (swr_init(swrCtx) < 0) {
+        swr_free(&swrCtx);
+        return false;
+    }
+    return true;
+}
+#endif
+
+void RhiRenderer::closeFile()
+{
+#if FFMPEG_AVAILABLE
+    stopPipeline();
+    clearQueues();
+    m_primedFrames.clear();
+    m_primedAudioPackets.clear();
+
+    if (m_swrCtx) {
+        swr_free(&m_swrCtx);
+        m_swrCtx = nullptr;
+    }
+
+    if (m_swsCtx) {
+        sws_freeContext(m_swsCtx);
+        m_swsCtx = nullptr;
+    }
+
+    if (m_videoCodecCtx) {
+        avcodec_free_context(&m_videoCodecCtx);
+        m_videoCodecCtx = nullptr;
+    }
+
+    if (m_audioCodecCtx) {
+        avcodec_free_context(&m_audioCodecCtx);
+        m_audioCodecCtx = nullptr;
+    }
+
+    if (m_hwDeviceCtx) {
+        av_buffer_unref(&m_hwDeviceCtx);
+        m_hwDeviceCtx = nullptr;
+    }
+    m_metrics.setHardwareDecoding(false);
+
+    if (m_formatCtx) {
+        avformat_close_input(&m_formatCtx);
+        m_formatCtx = nullptr;
+    }
+
+    m_videoStreamIndex = -1;
+    m_audioStreamIndex = -1;
+    m_hasAudio = false;
+    m_duration = 0;
+    m_videoWidth = 0;
+    m_videoHeight = 0;
+    m_hdrPeakNits = 0;
+    m_lastTransfer = VideoTransfer::Sdr;
+    m_frameParams = FrameParams();
+    m_abr.close();
+    m_frameCache.reset();       // 画面上的最后一帧仍持有映射，换帧后解除
+    m_cacheWriter.reset();      // 未完成的录制随之删除
+    m_frameCacheCharge.resize(0);
+    m_streamRotation = 0;
+#endif
+}
+
+void RhiRenderer::play()
+{
+#if FFMPEG_AVAILABLE
+    if (!m_formatCtx) return;
+    if (m_playing && !m_paused) return;
+
+    if (!m_playing) {
+        // 音频设备在第一个音频块到达时才创建（processAudio），不阻塞首帧
+        m_audioPending = m_hasAudio;
+        resetClock();
+        startPipeline();
+    } else {
+        // 从暂停恢复：音频继续，无音频时以下一帧重新建立参考时钟
+        if (m_audioSink) {
+            m_audioSink->resume();
+        }
+        m_wallClockValid = false;
+    }
+
+    m_playing = true;
+    m_paused = false;
+
+    m_renderTimer->start(8);
+    m_audioTimer->start(5);
+    armWatchdog();
+
+    emit playbackStateChanged(true);
+#endif
+}
+
+void RhiRenderer::pause()
+{
+    if (!m_playing || m_paused) return;
+
+    m_paused = true;
+    m_watchdog->disarm();
+    m_renderTimer->stop();
+    m_audioTimer->stop();
+    if (m_audioSink) {
+        m_audioSink->suspend();
+    }
+    m_metrics.audio().reset();
+
+    emit playbackStateChanged(false);
+}
+
+void RhiRenderer::stop()
+{
+    m_playing = false;
+    m_paused = false;
+    m_currentPts = 0;
+
+    m_watchdog->disarm();
+    m_renderTimer->stop();
+    m_audioTimer->stop();
+
+    stopPipeline();
+    // 再次播放时从头开始：被打断的读包可能停在包中间，由跳转重新定位
+    m_seekTarget = 0;
+    m_seeking = true;
+    m_audioPending = false;
+    cleanupAudio();
+    clearQueues();
+    resetClock();
+    m_view->clearFrame();
+
+    emit positionChanged(0);
+    emit playbackStateChanged(false);
+}
+
+void RhiRenderer::togglePause()
+{
+    if (m_playing && !m_paused) {
+        pause();
+    } else {
+        play();
+    }
+}
+
+void RhiRenderer::seek(double seconds)
+{
+    seconds = qBound(0.0, seconds, m_duration);
+    m_seekTarget = seconds;
+    m_serial++;     // 先递增序号：清空后仍在途的旧包/旧帧由各阶段按序号丢弃
+    m_seeking = true;
+    m_currentPts = seconds;
+
+    clearQueues();
+    resetClock();
+    if (m_playing && !m_paused) {
+        armWatchdog();  // 播完后已停止监视的片段跳回时重新开始
+    } else {
+        m_watchdog->resetProgress();
+    }
+
+    // 重启音频输出以清空设备缓冲与 processedUSecs
+    if (m_audioSink) {
+        m_audioSink->stop();
+        m_audioDevice = m_audioSink->start();
+        if (m_paused) {
+            m_audioSink->suspend();
+        }
+    }
+
+    emit positionChanged(seconds);
+}
+
+void RhiRenderer::setVolume(int volume)
+{
+    m_volume = qBound(0, volume, 100);
+    if (m_audioSink) {
+        m_audioSink->setVolume(m_volume / 100.0f);
+    }
+}
+
+void RhiRenderer::setMaxPresentRate(double fps)
+{
+    VideoRendererBase::setMaxPresentRate(fps);
+    m_presentRateCap = fps;
+    if (m_watchdog->isArmed()) {
+        armWatchdog();  // 停滞阈值按新的呈现帧间隔
+    }
+}
+
+void RhiRenderer::startPipeline()
+{
+#if FFMPEG_AVAILABLE
+    // 解码管线：各阶段挂起在队列上，由共享执行器调度
+    const std::stop_token stop = m_pipeline.token();
+    m_pipeline.spawn(demuxTask(stop));
+    if (m_frameCache) {
+        m_pipeline.spawn(cachedVideoTask(stop));
+    } else {
+        m_pipeline.spawn(videoDecodeTask(stop));
+        m_pipeline.spawn(videoConvertTask(stop));
+    }
+    if (m_hasAudio) {
+        m_pipeline.spawn(audioDecodeTask(stop));
+    }
+#endif
+}
+
+void RhiRenderer::stopPipeline()
+{
+    // 关闭队列即取消：挂起在 push/pop 上的阶段被唤醒后检查 stop token 退出；阻塞中的读包被打断
+    m_pipeline.cancel();
+    m_interruptIo = true;
+#if FFMPEG_AVAILABLE
+    m_videoPackets.close();
+    m_audioPackets.close();
+    m_decodedFrames.close();
+#endif
+    m_frameQueue.close();
+    m_audioQueue.close();
+    m_pipeline.wait();
+    m_interruptIo = false;
+
+#if FFMPEG_AVAILABLE
+    m_videoPackets.reset();
+    m_audioPackets.reset();
+    m_decodedFrames.reset();
+#endif
+    m_frameQueue.reset();
+    m_audioQueue.reset();
+}
+
+// ========================================
+// 停滞看门狗
+// ========================================
+void RhiRenderer::armWatchdog()
+{
+#if FFMPEG_AVAILABLE
+    // 音频设备延迟创建：此时尚未创建则由 processAudio 创建后再开始监视音频
+    const double fps = m_sourceFps > 0 ? m_sourceFps / presentStride() : 0;
+    m_watchdog->arm(fps > 0 ? 1.0 / fps : 0.04, true, m_audioDevice != nullptr);
+#endif
+}
+
+/**
+ * @brief 执行看门狗下发的恢复动作
+ * @return false 表示动作不适用，看门狗直接升级
+ */
+bool RhiRenderer::runRecovery(RecoveryAction action)
+{
+#if FFMPEG_AVAILABLE
+    if (!m_formatCtx || !m_playing) return false;
+
+    const double position = m_currentPts;
+    switch (action) {
+    case RecoveryAction::FlushResync:
+        // 按序号丢弃在途的包与帧，解码阶段 flush 后从当前位置之前的关键帧重新解码
+        seek(position);
+        return true;
+    case RecoveryAction::SoftwareFallback:
+        if (!m_hwDeviceCtx || m_decodeMode == Hardware) {
+            return false;
+        }
+        m_hardwareAllowed = false;
+        [[fallthrough]];
+    case RecoveryAction::ReopenDecoder:
+        return reopenVideoDecoder();
+    case RecoveryAction::ReopenFile: {
+        const QString file = m_currentFile;
+        stop();
+        if (!openFile(file)) {
+            return false;
+        }
+        play();
+        seek(position);
+        return true;
+    }
+    case RecoveryAction::ReopenAudio:
+        setupAudio();
+        if (!m_audioDevice) {
+            return false;
+        }
+        m_audioClockValid = false;  // 新设备的 processedUSecs 从 0 开始，以下一块音频重新建立时钟
+        return true;
+    }
+    return false;
+#else
+    Q_UNUSED(action)
+    return false;
+#endif
+}
+
+void RhiRenderer::clearQueues()
+{
+#if FFMPEG_AVAILABLE
+    m_videoPackets.clear();
+    m_audioPackets.clear();
+    m_decodedFrames.clear();
+#endif
+    m_frameQueue.clear();
+    m_audioQueue.clear();
+}
+
+void RhiRenderer::resetClock()
+{
+    m_audioClock = 0;
+    m_audioStartPts = 0;
+    m_audioClockValid = false;
+    m_wallClockBasePts = 0;
+    m_wallClockValid = false;
+    m_clockAnchored = false;
+    m_cueSkipPts = -1;
+    m_metrics.audio().reset();
+    m_metrics.resetPresentation();
+}
+
+#if FFMPEG_AVAILABLE
+// ========================================
+// 解码管线（协程）
+// demux ──▶ 视频包 ──▶ 视频解码 ──▶ 解码帧 ──▶ 转换 ──▶ 帧队列（GUI 上传）
+//       └─▶ 音频包 ──▶ 音频解码（重采样）──────────────▶ 音频队列（GUI 写设备）
+// ========================================
+Task RhiRenderer::demuxTask(std::stop_token stop)
+{
+    qDebug() << "[RHI 管线] demux 启动";
+
+    const double startTime = (m_formatCtx->start_time != AV_NOPTS_VALUE)
+        ? static_cast<double>(m_formatCtx->start_time) / AV_TIME_BASE : 0.0;
+    int serial = m_serial;
+    double loopOffset = 0;      // 本轮循环在连续时间轴上的起点
+    double loopEndPts = 0;      // 本轮读到的最晚结束时间，即下一轮的起点
+    QElapsedTimer readTimer;
+
+    auto notifyVariant = [this]() {
+        const AbrVariant variant = m_abr.current();
+        const int index = m_abr.currentIndex();
+        QMetaObject::invokeMethod(this, [this, variant, index]() {
+            emit variantSwitched(index, QSize(variant.width, variant.height), variant.bandwidth);
+        }, Qt::QueuedConnection);
+    };
+
+    // 排期切换预热时读到的音频包先交给音频解码
+    bool open = true;
+    for (PacketPtr &packet : std::exchange(m_primedAudioPackets, {})) {
+        PacketItem item{std::move(packet), serial, 0};
+        if (!co_await m_audioPackets.push(std::move(item))) {
+            open = false;
+            break;
+        }
+    }
+
+    while (open && !stop.stop_requested()) {
+        // 队列唤醒后在共享执行器上恢复：读包、跳转之前回到 I/O 线程
+        co_await m_ioExecutor.schedule();
+
+        if (m_seeking.exchange(false)) {
+            serial = m_serial;
+            if (m_abr.resetTimeline()) notifyVariant();
+            int64_t timestamp = static_cast<int64_t>(m_seekTarget * AV_TIME_BASE);
+            av_seek_frame(m_formatCtx, -1, timestamp, AVSEEK_FLAG_BACKWARD);
+            loopOffset = 0;
+            loopEndPts = 0;
+        }
+
+        PacketPtr packet(av_packet_alloc());
+        readTimer.start();
+        int ret = av_read_frame(m_formatCtx, packet.get());
+        if (ret == AVERROR(EAGAIN)) {
+            // 实时源暂无数据：挂在定时器上，不占工作线程
+            co_await m_ioExecutor.sleepFor(std::chrono::milliseconds(10));
+            continue;
+        }
+        if (ret < 0) {
+            if (ret == AVERROR_EOF && m_loop) {
+                // 循环：解码阶段收到边界后排空尾帧并 flush，时间轴继续向前
+                if (!m_frameCache) {
+                    PacketItem videoBoundary{nullptr, serial, loopOffset};
+                    if (!co_await m_videoPackets.push(std::move(videoBoundary))) break;
+                }
+                PacketItem audioBoundary{nullptr, serial, loopOffset};
+                if (m_hasAudio && !co_await m_audioPackets.push(std::move(audioBoundary))) break;
+                loopOffset = loopEndPts;
+                m_metrics.addLoop();
+                if (m_abr.resetTimeline()) notifyVariant();
+                co_await m_ioExecutor.schedule();
+                av_seek_frame(m_formatCtx, -1, 0, AVSEEK_FLAG_BACKWARD);
+                continue;
+            }
+            if (ret == AVERROR_EOF) {
+                QMetaObject::invokeMethod(this, [this]() {
+                    m_watchdog->disarm();   // 播完后呈现不再前进，不是停滞
+                    emit endOfFile();
+                }, Qt::QueuedConnection);
+            }
+            break;
+        }
+
+        int index = packet->stream_index;
+        if (m_abr.isActive()) {
+            // 多变体：读包耗时计入吞吐，包映射到解码器对应的流，切换进行中时多余的包丢弃
+            m_abr.addRead(packet->size, readTimer.nsecsElapsed());
+            bool switched = false;
+            index = m_abr.route(packet.get(), m_videoStreamIndex, m_audioStreamIndex, switched);
+            if (switched) notifyVariant();
+            m_abr.evaluate();
+            if (index < 0) continue;
+        }
+        const bool isVideo = index == m_videoStreamIndex;
+        if (!isVideo && !(index == m_audioStreamIndex && m_hasAudio)) continue;
+
+        if (packet->pts != AV_NOPTS_VALUE) {
+            const double timeBase = av_q2d(m_formatCtx->streams[index]->time_base);
+            loopEndPts = qMax(loopEndPts, loopOffset + (packet->pts + packet->duration) * timeBase - startTime);
+            m_metrics.markProgress(PipelineStage::Demux, loopOffset + packet->pts * timeBase - startTime);
+        }
+        // 帧缓存命中：视频包只参与推算循环长度（与录制时一致），不再解码
+        if (isVideo && m_frameCache) continue;
+
+        AsyncQueue<PacketItem> &queue = isVideo ? m_videoPackets : m_audioPackets;
+        PacketItem item{std::move(packet), serial, loopOffset};
+        if (!co_await queue.push(std::move(item))) break;
+    }
+
+    // 下游取完剩余的包后结束
+    m_videoPackets.close();
+    m_audioPackets.close();
+    qDebug() << "[RHI 管线] demux 结束";
+}
+
+Task RhiRenderer::videoDecodeTask(std::stop_token stop)
+{
+    int serial = -1;
+    bool open = true;
+
+    // 排期切换接管的解码器：预卷帧之后已解出的帧先送出（解码器保持预热状态，不 flush）
+    for (FramePtr &frame : std::exchange(m_primedFrames, {})) {
+        DecodedItem decoded{std::move(frame), m_serial, 0};
+        if (!co_await m_decodedFrames.push(std::move(decoded))) {
+            open = false;
+            break;
+        }
+    }
+
+    while (open) {
+        std::optional<PacketItem> item = co_await m_videoPackets.pop();
+        if (!item || stop.stop_requested()) break;
+        if (item->serial != m_serial) continue;     // 跳转前读出的包
+        if (item->serial != serial) {
+            // 新位置：丢弃解码器内旧位置的参考帧
+            if (serial >= 0) avcodec_flush_buffers(m_videoCodecCtx);
+            serial = item->serial;
+        }
+
+        // 限制呈现帧率时不解码永远不会呈现的非参考帧（帧线程解码器在下一次送包时同步该设置）
+        m_videoCodecCtx->skip_frame = presentStride() > 1 && m_skipNonRef ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+
+        // 空包（循环边界）让解码器进入排空模式，吐出尾部的延迟帧
+        QElapsedTimer decodeTimer;
+        decodeTimer.start();
+        int ret = avcodec_send_packet(m_videoCodecCtx, item->packet.get());
+        while (ret >= 0) {
+            FramePtr frame(av_frame_alloc());
+            ret = avcodec_receive_frame(m_videoCodecCtx, frame.get());
+            if (ret < 0) break;
+            m_metrics.addDecodeTime(decodeTimer.nsecsElapsed() / 1000.0);
+            DecodedItem decoded{std::move(frame), serial, item->loopOffset};
+            if (!co_await m_decodedFrames.push(std::move(decoded))) {
+                open = false;
+                break;
+            }
+            decodeTimer.restart();  // 不计入在队列上挂起的时间
+        }
+        if (!item->packet) {
+            avcodec_flush_buffers(m_videoCodecCtx);
+        }
+    }
+    m_decodedFrames.close();
+}
+
+Task RhiRenderer::videoConvertTask(std::stop_token stop)
+{
+    FramePtr swFrame(av_frame_alloc());     // 硬件帧传回 CPU 用
+    while (std::optional<DecodedItem> item = co_await m_decodedFrames.pop()) {
+        if (stop.stop_requested()) break;
+        if (item->serial != m_serial) continue;
+
+        // 限制呈现帧率：不呈现的帧不做 GPU→CPU 传输与格式转换（帧缓存录制需要完整的第一轮，录制期间不跳过）
+        if (!m_cacheWriter) {
+            const AVFrame *frame = item->frame.get();
+            const double timeBase = av_q2d(m_formatCtx->streams[m_videoStreamIndex]->time_base);
+            const double pts = frame->best_effort_timestamp != AV_NOPTS_VALUE
+                ? frame->best_effort_timestamp * timeBase + item->loopOffset : item->loopOffset;
+            if (!selectPresentFrame(pts, item->serial)) continue;
+        }
+
+        RhiVideoFrame frames[2];
+        const int count = convertVideoFrame(*item, swFrame.get(), frames);
+        if (m_cacheWriter) recordLoopFrame(*item, frames, count);
+        bool open = true;
+        for (int i = 0; i < count && open; i++) {
+            const double pts = frames[i].pts;
+            open = co_await m_frameQueue.push(std::move(frames[i]));
+            if (open) {
+                m_metrics.addVideoFrame(static_cast<int>(m_frameQueue.size()));
+                m_metrics.markProgress(PipelineStage::Decode, pts);
+            }
+        }
+        if (!open) break;
+    }
+}
+
+Task RhiRenderer::cachedVideoTask(std::stop_token stop)
+{
+    const std::shared_ptr<const LoopFrameCache> cache = m_frameCache;
+    int serial = -1;
+    int index = 0;
+    double loopOffset = 0;
+    while (!stop.stop_requested()) {
+        if (serial != m_serial) {
+            // 跳转：与 demux 一样从目标位置开始、时间轴回到本轮起点
+            serial = m_serial;
+            index = serial == m_cacheSerial ? 0 : cache->frameAt(m_seekTarget);
+            loopOffset = 0;
+        }
+        if (index >= cache->frameCount()) {
+            if (!m_loop) break;
+            index = 0;
+            loopOffset += cache->loopDuration();
+        }
+
+        RhiVideoFrame frame;
+        cache->frame(index++, frame);
+        frame.pts = frame.position + loopOffset;
+        frame.serial = serial;
+        if (!selectPresentFrame(frame.pts, serial)) continue;
+        const double pts = frame.pts;
+        if (!co_await m_frameQueue.push(std::move(frame))) break;
+        m_metrics.addVideoFrame(static_cast<int>(m_frameQueue.size()));
+        m_metrics.markProgress(PipelineStage::Decode, pts);
+    }
+}
+
+Task RhiRenderer::audioDecodeTask(std::stop_token stop)
+{
+    FramePtr frame(av_frame_alloc());
+    int serial = -1;
+    bool open = true;
+    while (open) {
+        std::optional<PacketItem> item = co_await m_audioPackets.pop();
+        if (!item || stop.stop_requested()) break;
+        if (item->serial != m_serial) continue;
+        if (item->serial != serial) {
+            if (serial >= 0) avcodec_flush_buffers(m_audioCodecCtx);
+            serial = item->serial;
+        }
+
+        int ret = avcodec_send_packet(m_audioCodecCtx, item->packet.get());
+        while (ret >= 0) {
+            ret = avcodec_receive_frame(m_audioCodecCtx, frame.get());
+            if (ret < 0) break;
+
+            AudioChunk chunk;
+            if (!convertAudioFrame(frame.get(), item->loopOffset, chunk.data, chunk.pts)) continue;
+            chunk.serial = serial;
+            chunk.charge = MemoryCharge::shared(m_metrics.memory(), MemoryCategory::AudioBuffers, chunk.data.size());
+            if (!co_await m_audioQueue.push(std::move(chunk))) {
+                open = false;
+                break;
+            }
+            m_metrics.addAudioFrame(static_cast<int>(m_audioQueue.size()));
+        }
+        if (!item->packet) {
+            avcodec_flush_buffers(m_audioCodecCtx);
+        }
+    }
+}
+
+int RhiRenderer::presentStride() const
+{
+    const double cap = m_presentRateCap;
+    if (cap <= 0 || m_sourceFps <= cap) return 1;
+    // 整数步长：60 → 30 每两帧取一帧；59.94 / 30 的微小超出不增加步长
+    return static_cast<int>(std::ceil(m_sourceFps / cap - 0.01));
+}
+
+bool RhiRenderer::selectPresentFrame(double pts, int serial)
+{
+    if (serial != m_presentSerial) {
+        // 跳转后第一帧总是呈现，步长从它开始计
+        m_presentSerial = serial;
+        m_nextPresentPts = -std::numeric_limits<double>::infinity();
+        m_lastDecodedPts = pts;
+    }
+    const int stride = presentStride();
+    const double interval = stride > 1 ? 1.0 / m_sourceFps : 0;
+    // 跳过非参考帧后解出的帧间隔已超过步长（非参考帧比要跳过的帧还密）：恢复完整解码，保持节奏均匀
+    if (stride > 1 && m_skipNonRef && pts - m_lastDecodedPts > (stride + 0.5) * interval) {
+        m_skipNonRef = false;
+        qDebug() << "[限帧] 非参考帧间隔超过步长" << stride << "，恢复完整解码";
+    }
+    m_lastDecodedPts = pts;
+    if (stride <= 1) return true;
+
+    if (pts < m_nextPresentPts - interval / 2) {
+        m_metrics.addSkippedFrame();
+        return false;
+    }
+    m_nextPresentPts = pts + stride * interval;
+    return true;
+}
+
+void RhiRenderer::openFrameCache(const QString &filename, const AVStream *stream)
+{
+    m_cacheSerial = m_serial;
+    if (!m_frameCacheEnabled || m_abr.isActive() || !QFileInfo(filename).isFile()) return;
+
+    const AVRational rate = stream->avg_frame_rate.num > 0 ? stream->avg_frame_rate : stream->r_frame_rate;
+    const QSize display = m_view->size() * m_view->devicePixelRatioF();
+    const QSize output = LoopFrameCache::outputSize(QSize(stream->codecpar->width, stream->codecpar->height), display);
+    if (rate.num <= 0 || rate.den <= 0 || !LoopFrameCache::eligible(m_duration, av_q2d(rate), output)) return;
+
+    const QString key = LoopFrameCache::key(filename, output);
+    m_frameCache = LoopFrameCache::open(key);
+    if (m_frameCache) {
+        m_frameCacheCharge.resize(m_frameCache->mappedBytes());
+    } else if (!key.isEmpty()) {
+        m_cacheWriter = std::make_unique<LoopFrameCacheWriter>(key, output);
+    }
+}
+
+void RhiRenderer::recordLoopFrame(const DecodedItem &item, const RhiVideoFrame (&frames)[2], int count)
+{
+    // 第二轮的第一帧：第一轮已完整写入，本轮起点即循环长度
+    if (item.loopOffset > 0) {
+        m_cacheWriter->finish(item.loopOffset);
+        m_cacheWriter.reset();
+    } else if (item.serial != m_cacheSerial || count != 1 || !m_cacheWriter->add(frames[0])) {
+        // 跳转过、隔行（两场）或转换失败的帧不能代表完整的第一轮：放弃（析构时删除未完成的文件）
+        m_cacheWriter.reset();
+    }
+    if (!m_cacheWriter) {
+        // 录制结束或放弃：恢复限帧时跳过非参考帧（非参考帧过密时 selectPresentFrame 会重新关闭）
+        m_skipNonRef = true;
+    }
+}
+
+/**
+ * @brief 内容峰值亮度：HDR10+ 动态元数据优先，其次 MaxCLL、母版显示器峰值
+ */
+static float framePeakNits(const AVFrame *frame)
+{
+    if (const AVFrameSideData *sd = av_frame_get_side_data(frame, AV_FRAME_DATA_DYNAMIC_HDR_PLUS)) {
+        const auto *hdrPlus = reinterpret_cast<const AVDynamicHDRPlus *>(sd->data);
+        if (hdrPlus->num_windows > 0) {
+            const AVRational *maxscl = hdrPlus->params[0].maxscl;
+            const double peak = qMax(av_q2d(maxscl[0]), qMax(av_q2d(maxscl[1]), av_q2d(maxscl[2])));
+            if (peak > 0) return static_cast<float>(peak * 10000.0);   // 归一化到 10000 nit
+        }
+    }
+    if (const AVFrameSideData *sd = av_frame_get_side_data(frame, AV_FRAME_DATA_CONTENT_LIGHT_LEVEL)) {
+        const auto *cll = reinterpret_cast<const AVContentLightMetadata *>(sd->data);
+        if (cll->MaxCLL > 0) return static_cast<float>(cll->MaxCLL);
+    }
+    if (const AVFrameSideData *sd = av_frame_get_side_data(frame, AV_FRAME_DATA_MASTERING_DISPLAY_METADATA)) {
+        const auto *mdcv = reinterpret_cast<const AVMasteringDisplayMetadata *>(sd->data);
+        if (mdcv->has_luminance && av_q2d(mdcv->max_luminance) > 0) {
+            return static_cast<float>(av_q2d(mdcv->max_luminance));
+        }
+    }
+    return 0;
+}
+
+bool RhiRenderer::fillFrame(const AVFrame *srcFrame, SwsContext *&swsCtx, RhiVideoFrame &vf, bool highBitDepth)
+{
+    vf.width = srcFrame->width;
+    vf.height = srcFrame->height;
+
+    switch (srcFrame->color_trc) {
+    case AVCOL_TRC_SMPTE2084:    vf.transfer = VideoTransfer::Pq; break;
+    case AVCOL_TRC_ARIB_STD_B67: vf.transfer = VideoTransfer::Hlg; break;
+    default:                     vf.transfer = VideoTransfer::Sdr; break;
+    }
+    vf.bt2020 = srcFrame->color_primaries == AVCOL_PRI_BT2020
+             || srcFrame->colorspace == AVCOL_SPC_BT2020_NCL;
+    vf.fullRange = srcFrame->color_range == AVCOL_RANGE_JPEG;
+    vf.peakNits = framePeakNits(srcFrame);
+
+    const int chromaWidth = (vf.width + 1) / 2;
+    const int chromaHeight = (vf.height + 1) / 2;
+    const int planeHeights[3] = { vf.height, chromaHeight, chromaHeight };
+
+    // 目标格式：8 位源 → YUV420P；高位深源 → 保留位深的 16 位平面（10/12 位直接复制，其余转 10 位）
+    AVPixelFormat srcFmt = static_cast<AVPixelFormat>(srcFrame->format);
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(srcFmt);
+    const int srcDepth = desc ? desc->comp[0].depth : 8;
+    AVPixelFormat dstFmt = AV_PIX_FMT_YUV420P;
+    vf.bitDepth = 8;
+    if (highBitDepth && srcDepth > 8) {
+        dstFmt = (srcFmt == AV_PIX_FMT_YUV420P12LE) ? AV_PIX_FMT_YUV420P12LE : AV_PIX_FMT_YUV420P10LE;
+        vf.bitDepth = (dstFmt == AV_PIX_FMT_YUV420P12LE) ? 12 : 10;
+    }
+    const int bytesPerSample = vf.bitDepth > 8 ? 2 : 1;
+
+    if (srcFmt == dstFmt || (dstFmt == AV_PIX_FMT_YUV420P && srcFmt == AV_PIX_FMT_YUVJ420P)) {
+        // 直接复制平面
+        for (int i = 0; i < 3; i++) {
+            vf.linesize[i] = srcFrame->linesize[i];
+            vf.planes[i] = QByteArray(reinterpret_cast<const char*>(srcFrame->data[i]),
+                                      srcFrame->linesize[i] * planeHeights[i]);
+        }
+        return true;
+    }
+
+    // 其他格式（NV12、P010 等）转换到目标平面格式（只做排布/位深转换，色调映射在着色器）
+    swsCtx = sws_getCachedContext(swsCtx,
+        vf.width, vf.height, srcFmt,
+        vf.width, vf.height, dstFmt,
+        SWS_FAST_BILINEAR, nullptr, nullptr, nullptr);
+    if (!swsCtx) return false;
+
+    vf.linesize[0] = FFALIGN(vf.width * bytesPerSample, 32);
+    vf.linesize[1] = vf.linesize[2] = FFALIGN(chromaWidth * bytesPerSample, 32);
+
+    uint8_t *dstData[4] = {};
+    int dstLinesize[4] = {};
+    for (int i = 0; i < 3; i++) {
+        vf.planes[i].resize(vf.linesize[i] * planeHeights[i]);
+        dstData[i] = reinterpret_cast<uint8_t*>(vf.planes[i].data());
+        dstLinesize[i] = vf.linesize[i];
+    }
+
+    sws_scale(swsCtx, srcFrame->data, srcFrame->linesize, 0, vf.height,
+              dstData, dstLinesize);
+    return true;
+}
+
+int RhiRenderer::convertVideoFrame(const DecodedItem &item, AVFrame *swFrame, RhiVideoFrame (&out)[2])
+{
+    const AVFrame *frame = item.frame.get();
+    AVStream *stream = m_formatCtx->streams[m_videoStreamIndex];
+    const double timeBase = av_q2d(stream->time_base);
+    const double startTime = (m_formatCtx->start_time != AV_NOPTS_VALUE)
+        ? static_cast<double>(m_formatCtx->start_time) / AV_TIME_BASE : 0.0;
+
+    // 流中途改变分辨率 / 格式：纹理在上传时按帧尺寸重建，其余状态不受影响，管线无需排空
+    if (m_frameParams.update(frame, "RHI 解码")) {
+        m_metrics.addReconfiguration();
+    }
+
+    // 硬件帧：传回 CPU
+    const AVFrame *srcFrame = frame;
+    if (frame->hw_frames_ctx) {
+        av_frame_unref(swFrame);
+        if (av_hwframe_transfer_data(swFrame, frame, 0) < 0) {
+            return 0;
+        }
+        av_frame_copy_props(swFrame, frame);   // 色彩属性与 HDR 元数据
+        srcFrame = swFrame;
+        m_transferCharge.resize(av_image_get_buffer_size(static_cast<AVPixelFormat>(swFrame->format),
+                                                         swFrame->width, swFrame->height, 1));
+    }
+
+    RhiVideoFrame &vf = out[0];
+    const int64_t framePts = frame->best_effort_timestamp;
+    vf.position = (framePts != AV_NOPTS_VALUE) ? framePts * timeBase - startTime : 0.0;
+    vf.pts = vf.position + item.loopOffset;
+    vf.serial = item.serial;
+
+    const double frameDuration = frame->duration > 0 ? frame->duration * timeBase : 0.04;
+
+    if (!fillFrame(srcFrame, m_swsCtx, vf, m_view->supportsHighBitDepth())) return 0;
+
+    // 静态元数据通常只随关键帧出现，动态元数据按场景更新：沿用最近一次的峰值
+    if (vf.peakNits > 0) {
+        m_hdrPeakNits = vf.peakNits;
+    } else {
+        vf.peakNits = m_hdrPeakNits;
+    }
+    if (vf.transfer != m_lastTransfer) {
+        m_lastTransfer = vf.transfer;
+        static const char *const names[] = { "SDR", "PQ", "HLG" };
+        qDebug() << "[RHI 解码] 传递函数:" << names[static_cast<int>(vf.transfer)]
+                 << (vf.bt2020 ? "BT.2020" : "BT.709") << "位深" << vf.bitDepth
+                 << "峰值" << vf.peakNits << "nit";
+    }
+    vf.charge = MemoryCharge::shared(m_metrics.memory(), MemoryCategory::FrameQueue,
+                                     vf.planes[0].size() + vf.planes[1].size() + vf.planes[2].size());
+
+    // 隔行帧：拆成两场按场频显示，第二场共享平面数据，由着色器选择显示的场
+#ifdef AV_FRAME_FLAG_INTERLACED
+    const bool interlaced = frame->flags & AV_FRAME_FLAG_INTERLACED;
+    const bool topFieldFirst = frame->flags & AV_FRAME_FLAG_TOP_FIELD_FIRST;
+#else
+    const bool interlaced = frame->interlaced_frame;
+    const bool topFieldFirst = frame->top_field_first;
+#endif
+    if (interlaced != m_interlaced) {
+        m_interlaced = interlaced;
+        qDebug() << "[RHI 解码]" << (interlaced ? "检测到隔行帧，按场去隔行" : "逐行帧")
+                 << (interlaced ? (topFieldFirst ? "(顶场优先)" : "(底场优先)") : "");
+    }
+
+    const DeinterlaceMode mode = m_deinterlaceMode;
+    if (!interlaced || mode == DeinterlaceMode::Off) {
+        return 1;
+    }
+
+    vf.deinterlace = mode;
+    vf.bottomField = !topFieldFirst;
+    RhiVideoFrame &second = out[1];
+    second = vf;
+    second.secondField = true;
+    second.bottomField = topFieldFirst;
+    second.pts += frameDuration / 2;
+    second.position += frameDuration / 2;
+    return 2;
+}
+
+bool RhiRenderer::convertAudioFrame(const AVFrame *frame, double loopOffset, QByteArray &data, double &pts)
+{
+    AVStream *stream = m_formatCtx->streams[m_audioStreamIndex];
+    const double timeBase = av_q2d(stream->time_base);
+    const double startTime = (m_formatCtx->start_time != AV_NOPTS_VALUE)
+        ? static_cast<double>(m_formatCtx->start_time) / AV_TIME_BASE : 0.0;
+
+    pts = loopOffset;
+    if (frame->pts != AV_NOPTS_VALUE) {
+        pts += frame->pts * timeBase - startTime;
+    }
+
+    int outSamples = static_cast<int>(av_rescale_rnd(
+        swr_get_delay(m_swrCtx, m_audioCodecCtx->sample_rate) + frame->nb_samples,
+        AUDIO_SAMPLE_RATE, m_audioCodecCtx->sample_rate, AV_ROUND_UP));
+
+    data = QByteArray(outSamples * 2 * 2, Qt::Uninitialized);
+    uint8_t *outBuffer = reinterpret_cast<uint8_t*>(data.data());
+
+    int samples = swr_convert(m_swrCtx, &outBuffer, outSamples,
+                              const_cast<const uint8_t**>(frame->extended_data), frame->nb_samples);
+    if (samples <= 0) return false;
+
+    data.resize(samples * 2 * 2);
+    return true;
+}
+#endif
+
+double RhiRenderer::masterClock() const
+{
+    if (m_audioClockValid) {
+        return m_audioClock;
+    }
+    if (m_wallClockValid) {
+        return m_wallClockBasePts + m_wallClock.nsecsElapsed() / 1e9;
+    }
+    return -1;  // 尚无参考时钟
+}
+
+void RhiRenderer::setVideoGeometry(const VideoGeometry &geometry)
+{
+    m_videoGeometry = geometry;
+    m_view->setVideoGeometry(m_videoGeometry, m_streamRotation);
+}
+
+QImage RhiRenderer::grabFrame()
+{
+    // 离屏重新渲染一次当前帧（含几何变换与色调映射），尚未显示过帧时返回空图像
+    if (m_currentFile.isEmpty() || m_firstFramePending) return QImage();
+    return m_view->grabFramebuffer();
+}
+
+// ============================================
+// 排期切换
+// ============================================
+
+void RhiRenderer::scheduleSwitch(const QString &filename, const QDateTime &at, bool atLoopBoundary)
+{
+    releaseCue();
+    VideoRendererBase::scheduleSwitch(filename, at, atLoopBoundary);
+    prepareCue(filename);
+}
+
+void RhiRenderer::cancelScheduledSwitch()
+{
+    VideoRendererBase::cancelScheduledSwitch();
+    releaseCue();
+}
+
+void RhiRenderer::prepareCue(const QString &filename)
+{
+#if FFMPEG_AVAILABLE
+    m_cuePrepared.file = filename;
+    const bool highBitDepth = m_view->supportsHighBitDepth();
+    const DecodeMode decodeMode = m_decodeMode;
+    m_cueThread = QThread::create([this, filename, highBitDepth, decodeMode]() {
+        preloadCue(filename, highBitDepth, decodeMode, &m_bufferPools, m_cuePrepared);
+    });
+    const int generation = m_cueGeneration;
+    connect(m_cueThread, &QThread::finished, this, [this, generation]() {
+        if (generation != m_cueGeneration) return;  // 已取消
+        m_cueReady = true;
+        if (m_cueWaiting) {
+            m_cueWaiting = false;
+            cutToCue();
+        }
+    });
+    m_cueThread->start(QThread::LowPriority);
+#else
+    Q_UNUSED(filename)
+#endif
+}
+
+void RhiRenderer::releaseCue()
+{
+    if (m_cueThread) {
+        m_cueThread->wait();
+        delete m_cueThread;
+        m_cueThread = nullptr;
+    }
+    m_cueGeneration++;
+#if FFMPEG_AVAILABLE
+    freeCue(m_cuePrepared);
+    m_cuePrepared = PreparedCue();
+#endif
+    m_cueReady = false;
+    m_cueWaiting = false;
+    m_cueAtBoundary = false;
+    disconnect(m_cueSubmitted);
+}
+
+void RhiRenderer::onCueDue()
+{
+#if FFMPEG_AVAILABLE
+    if (m_cue.atLoopBoundary() && m_playing && !m_paused) {
+        m_cueAtBoundary = true;
+        return;
+    }
+    if (!m_cueReady) {
+        qWarning() << "[排期] 已到期，预加载尚未完成";
+        m_cueWaiting = true;
+        return;
+    }
+    cutToCue();
+#else
+    VideoRendererBase::onCueDue();
+#endif
+}
+
+void RhiRenderer::cutToCue()
+{
+#if FFMPEG_AVAILABLE
+    const QString file = m_cue.file();
+    if (!m_cuePrepared.ok) {
+        qWarning() << "[排期] 预加载失败，按普通方式打开:" << file;
+        releaseCue();
+        VideoRendererBase::onCueDue();
+        return;
+    }
+
+    // 旧片段停在当前帧，预卷帧在下一次刷新时上屏；随后接管预热好的解码器继续播放
+    m_watchdog->disarm();
+    m_renderTimer->stop();
+    m_audioTimer->stop();
+    if (m_audioSink) {
+        m_audioSink->suspend();
+    }
+    // 新时间轴的起点：按时刻切换为截止时间（预加载迟到时之后的帧追赶），循环边界切换为此刻
+    m_cueAnchorNs = m_cue.atLoopBoundary() ? CueScheduler::nowNs() : m_cue.deadlineNs();
+    RhiVideoFrame preroll = m_cuePrepared.preroll;
+    m_view->setVideoGeometry(m_videoGeometry, m_cuePrepared.streamRotation);
+    m_view->setFrame(std::move(preroll));
+    m_view->update();
+
+    m_cueSubmitted = connect(m_view, &QRhiWidget::frameSubmitted, this, [this, file]() {
+        disconnect(m_cueSubmitted);
+        const double lateMs = m_cue.lateMs();
+        qDebug() << "[排期] 已切换到" << file << "偏差" << lateMs << "ms";
+        // 排队执行：不在 frameSubmitted 的调用栈内重建管线
+        QMetaObject::invokeMethod(this, [this, file]() { finishCue(file); }, Qt::QueuedConnection);
+        emit cueSwitched(file, lateMs);
+    });
+#endif
+}
+
+void RhiRenderer::finishCue(const QString &filename)
+{
+#if FFMPEG_AVAILABLE
+    const double prerollPts = m_cuePrepared.preroll.pts;
+    const double prerollPosition = m_cuePrepared.preroll.position;
+
+    // 不经过 stop()：画面保持预卷帧；openFile 停止旧管线并接管预加载线程打开的容器与解码器
+    m_playing = false;
+    m_paused = false;
+    if (!openFile(filename)) {
+        m_cue.finish();
+        releaseCue();
+        stop();
+        return;
+    }
+    m_cue.finish();
+    releaseCue();
+
+    // 输出格式固定，音频设备保留，只清空旧片段的缓冲
+    if (!m_hasAudio) {
+        cleanupAudio();
+    } else if (m_audioSink) {
+        m_audioSink->stop();
+        m_audioDevice = m_audioSink->start();
+    }
+    m_audioPending = m_hasAudio && !m_audioDevice;
+
+    // 时钟锚定：预卷帧的 PTS 对应锚定时刻，之后的帧按各自 PTS 相对该时刻呈现；音频从当前时钟处开始
+    resetClock();
+    m_wallClockBasePts = prerollPts + (CueScheduler::nowNs() - m_cueAnchorNs) / 1e9;
+    m_wallClock.start();
+    m_wallClockValid = true;
+    m_clockAnchored = true;
+    m_cueSkipPts = prerollPts;
+    m_currentPts = prerollPosition;
+    m_firstFramePending = false;
+    startPipeline();
+
+    m_playing = true;
+    m_renderTimer->start(8);
+    m_audioTimer->start(5);
+    armWatchdog();
+    emit positionChanged(m_currentPts);
+    emit playbackStateChanged(true);
+#else
+    Q_UNUSED(filename)
+#endif
+}
+
+#if FFMPEG_AVAILABLE
+void RhiRenderer::preloadCue(const QString &filename, bool highBitDepth, DecodeMode decodeMode,
+                             AccountedBufferPools *pools, PreparedCue &cue)
+{
+    AVFormatContext *formatCtx = nullptr;
+    if (avformat_open_input(&formatCtx, filename.toUtf8().constData(), nullptr, nullptr) != 0) {
+        qWarning() << "[排期] 无法打开文件:" << filename;
+        return;
+    }
+    cue.formatCtx = formatCtx;
+    if (avformat_find_stream_info(formatCtx, nullptr) < 0) {
+        qWarning() << "[排期] 无法获取流信息:" << filename;
+        freeCue(cue);
+        return;
+    }
+
+    // 与 openFile 相同的解码器配置：硬件解码按解码模式初始化，帧缓冲走渲染器的记账池
+    const int videoIndex = av_find_best_stream(formatCtx, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    const AVCodec *codec = videoIndex >= 0
+        ? avcodec_find_decoder(formatCtx->streams[videoIndex]->codecpar->codec_id) : nullptr;
+    AVCodecContext *codecCtx = codec ? avcodec_alloc_context3(codec) : nullptr;
+    cue.videoCodecCtx = codecCtx;
+    if (!codecCtx || avcodec_parameters_to_context(codecCtx, formatCtx->streams[videoIndex]->codecpar) < 0) {
+        qWarning() << "[排期] 无法打开视频解码器:" << filename;
+        freeCue(cue);
+        return;
+    }
+    if (decodeMode != Software && !initHardwareDecoder(codecCtx, codec, cue.hwDeviceCtx)
+        && decodeMode == Hardware) {
+        qWarning() << "[排期] 硬件解码初始化失败，且设置为强制硬件模式:" << filename;
+        freeCue(cue);
+        return;
+    }
+    pools->install(codecCtx);
+    if (avcodec_open2(codecCtx, codec, nullptr) < 0) {
+        qWarning() << "[排期] 无法打开视频解码器:" << filename;
+        freeCue(cue);
+        return;
+    }
+    cue.videoStream = videoIndex;
+
+    cue.audioStream = av_find_best_stream(formatCtx, AVMEDIA_TYPE_AUDIO, -1, videoIndex, nullptr, 0);
+    if (cue.audioStream >= 0
+        && !openAudioDecoder(formatCtx->streams[cue.audioStream], cue.audioCodecCtx, cue.swrCtx)) {
+        avcodec_free_context(&cue.audioCodecCtx);
+        cue.audioStream = -1;
+    }
+
+    // 解出首帧作为预卷帧：解码器保持预热状态交给 openFile，读过的音频包留给音频解码
+    AVPacket *packet = av_packet_alloc();
+    FramePtr frame(av_frame_alloc());
+    bool gotFrame = false;
+    while (!gotFrame && av_read_frame(formatCtx, packet) >= 0) {
+        if (packet->stream_index == videoIndex && avcodec_send_packet(codecCtx, packet) >= 0) {
+            gotFrame = avcodec_receive_frame(codecCtx, frame.get()) == 0;
+        } else if (packet->stream_index == cue.audioStream && cue.audioCodecCtx) {
+            cue.audioPackets.emplace_back(av_packet_clone(packet));
+        }
+        av_packet_unref(packet);
+    }
+    const bool drained = !gotFrame;
+    if (drained) {
+        avcodec_send_packet(codecCtx, nullptr);
+        gotFrame = avcodec_receive_frame(codecCtx, frame.get()) == 0;
+    }
+    av_packet_free(&packet);
+
+    // 同一个包解出的其余帧：不取出的话下一次送包会返回 EAGAIN
+    for (;;) {
+        FramePtr next(av_frame_alloc());
+        if (avcodec_receive_frame(codecCtx, next.get()) != 0) break;
+        cue.frames.push_back(std::move(next));
+    }
+
+    if (gotFrame) {
+        const AVFrame *source = frame.get();
+        FramePtr swFrame;
+        if (frame->hw_frames_ctx) {
+            swFrame.reset(av_frame_alloc());
+            if (av_hwframe_transfer_data(swFrame.get(), frame.get(), 0) < 0) {
+                gotFrame = false;
+            }
+            av_frame_copy_props(swFrame.get(), frame.get());   // 色彩属性与 HDR 元数据
+            source = swFrame.get();
+        }
+        SwsContext *swsCtx = nullptr;
+        gotFrame = gotFrame && fillFrame(source, swsCtx, cue.preroll, highBitDepth);
+        sws_freeContext(swsCtx);
+
+        // 与 convertVideoFrame 相同的时间轴：减去容器起始时间（MPEG-TS 等起点不为 0）
+        const AVStream *stream = formatCtx->streams[videoIndex];
+        const double startTime = (formatCtx->start_time != AV_NOPTS_VALUE)
+            ? static_cast<double>(formatCtx->start_time) / AV_TIME_BASE : 0.0;
+        const double position = frame->best_effort_timestamp != AV_NOPTS_VALUE
+            ? frame->best_effort_timestamp * av_q2d(stream->time_base) - startTime : 0;
+        cue.preroll.pts = position;
+        cue.preroll.position = position;
+
+        const AVPacketSideData *displayMatrix = av_packet_side_data_get(
+            stream->codecpar->coded_side_data, stream->codecpar->nb_coded_side_data, AV_PKT_DATA_DISPLAYMATRIX);
+        cue.streamRotation = displayMatrix
+            ? VideoGeometry::rotationFromDisplayMatrix(reinterpret_cast<const int32_t *>(displayMatrix->data)) : 0;
+    }
+    if (!gotFrame) {
+        qWarning() << "[排期] 无法预解码首帧:" << filename;
+        freeCue(cue);
+        return;
+    }
+
+    // 多变体输入（HLS / DASH 阶梯）的起始变体由 openFile 中的 ABR 选择：回到开头，解码器在接管时打开
+    int videoStreams = 0;
+    for (unsigned i = 0; i < formatCtx->nb_streams; i++) {
+        const AVStream *stream = formatCtx->streams[i];
+        if (stream->codecpar->codec_type == AVMEDIA_TYPE_VIDEO && !(stream->disposition & AV_DISPOSITION_ATTACHED_PIC)) {
+            videoStreams++;
+        }
+    }
+    if (drained || videoStreams > 1) {
+        if (av_seek_frame(formatCtx, -1, 0, AVSEEK_FLAG_BACKWARD) < 0) {
+            qWarning() << "[排期] 无法回到开头:" << filename;
+            freeCue(cue);
+            return;
+        }
+        cue.formatCtx = nullptr;    // 暂时摘下，释放解码器后放回
+        freeCue(cue);
+        cue.formatCtx = formatCtx;
+    }
+    cue.ok = true;
+    qDebug() << "[排期] 预加载完成:" << filename << (cue.videoCodecCtx ? "（解码器已预热）" : "");
+}
+
+void RhiRenderer::freeCue(PreparedCue &cue)
+{
+    if (cue.formatCtx) {
+        avformat_close_input(&cue.formatCtx);
+    }
+    avcodec_free_context(&cue.videoCodecCtx);
+    avcodec_free_context(&cue.audioCodecCtx);
+    if (cue.hwDeviceCtx) {
+        av_buffer_unref(&cue.hwDeviceCtx);
+    }
+    if (cue.swrCtx) {
+        swr_free(&cue.swrCtx);
+    }
+    cue.frames.clear();
+    cue.audioPackets.clear();
+    cue.videoStream = -1;
+    cue.audioStream = -1;
+}
+#endif
+
+void RhiRenderer::onRenderTimer()
+{
+    if (!m_playing || m_paused) return;
+
+    // 音频断粮且视频队列已满：强制推进，避免转换阶段一直挂起
+    const bool starving = m_audioClockValid && m_frameQueue.size() >= MAX_FRAME_QUEUE
+                       && m_audioQueue.isEmpty();
+    const int serial = m_serial;
+
+    std::optional<RhiVideoFrame> frame = m_frameQueue.consume(
+        [&](std::deque<RhiVideoFrame> &queue) -> std::optional<RhiVideoFrame> {
+        // 跳转前解出的帧；排期切换后已作为预卷帧显示过的帧
+        while (!queue.empty() && (queue.front().serial != serial || queue.front().pts <= m_cueSkipPts)) {
+            queue.pop_front();
+        }
+        if (queue.empty()) return std::nullopt;
+
+        double clock = masterClock();
+        if (clock < 0) {
+            // 首帧：以其 PTS 建立参考时钟
+            m_wallClockBasePts = queue.front().pts;
+            m_wallClock.start();
+            m_wallClockValid = true;
+            clock = m_wallClockBasePts;
+        }
+
+        // 丢弃已过期的帧（下一帧也已到期）
+        int dropped = 0;
+        while (queue.size() > 1 && queue[1].pts <= clock) {
+            queue.pop_front();
+            dropped++;
+        }
+        if (dropped > 0) {
+            m_metrics.addDroppedFrames(dropped);
+            qDebug() << "[AVSync] 视频落后，丢帧 dropped=" << dropped;
+        }
+
+        if (queue.front().pts <= clock + 0.005 || starving) {
+            RhiVideoFrame head = std::move(queue.front());
+            queue.pop_front();
+            m_metrics.setAvOffset((head.pts - clock) * 1000.0);
+            m_metrics.setVideoQueueDepth(static_cast<int>(queue.size()));
+            return head;
+        }
+        return std::nullopt;
+    });
+
+    if (frame) {
+        // 循环边界排期：位置回绕即为接缝，新循环的首帧不再显示，直接切到预卷帧
+        if (m_cueAtBoundary && frame->position < m_currentPts - 0.5) {
+            m_cueAtBoundary = false;
+            if (m_cueReady) {
+                cutToCue();
+            } else {
+                qWarning() << "[排期] 已到循环边界，预加载尚未完成";
+                m_cueWaiting = true;
+            }
+            return;
+        }
+        m_metrics.addPresentedFrame(frame->position);
+        m_metrics.markProgress(PipelineStage::Present, frame->position);
+        m_currentPts = frame->position;
+        m_view->setFrame(std::move(*frame));
+        emit positionChanged(m_currentPts);
+        if (m_firstFramePending) {
+            m_firstFramePending = false;
+            emit firstFrameShown();
+        }
+    }
+}
+
+void RhiRenderer::onAudioTimer()
+{
+    processAudio();
+}
+
+void RhiRenderer::setupAudio()
+{
+    cleanupAudio();
+
+    QAudioFormat format;
+    format.setSampleRate(AUDIO_SAMPLE_RATE);
+    format.setChannelCount(2);
+    format.setSampleFormat(QAudioFormat::Int16);
+
+    m_audioSink = std::make_unique<QAudioSink>(format);
+    m_audioSink->setBufferSize(AUDIO_BYTES_PER_SECOND / 5);  // 200ms
+    m_audioSink->setVolume(m_volume / 100.0f);
+    m_audioDevice = m_audioSink->start();
+    m_lastAudioProcessed = -1;
+    m_audioSinkCharge = MemoryCharge(&m_metrics.memory(), MemoryCategory::AudioBuffers, m_audioSink->bufferSize());
+    m_metrics.audio().setDeviceLatency(m_audioSink->bufferSize() * 1000.0 / AUDIO_BYTES_PER_SECOND);
+    m_metrics.audio().reset();
+}
+
+void RhiRenderer::cleanupAudio()
+{
+    if (m_audioSink) {
+        m_audioSink->stop();
+        m_audioSink.reset();
+    }
+    m_audioDevice = nullptr;
+    m_audioSinkCharge = MemoryCharge();
+}
+
+void RhiRenderer::processAudio()
+{
+    if (!m_playing || m_paused) return;
+
+    if (!m_audioDevice) {
+        if (!m_audioPending || m_audioQueue.isEmpty()) return;
+        // 延迟初始化：音频后端加载与设备打开和解码、首帧上屏并行
+        m_audioPending = false;
+        setupAudio();
+        StartupTimeline::mark("audio ready");
+        if (!m_audioDevice) return;
+        if (m_watchdog->isArmed()) {
+            m_watchdog->setWatchAudio(true);
+        }
+    }
+    m_metrics.audio().beginWrite();
+
+    const int serial = m_serial;
+    const bool drained = m_audioQueue.consume([&](std::deque<AudioChunk> &queue) {
+        while (!queue.empty()) {
+            AudioChunk &chunk = queue.front();
+            if (chunk.serial != serial) {
+                queue.pop_front();  // 跳转前解出的音频
+                continue;
+            }
+            if (m_audioSink->bytesFree() < 1024) break;  // 避免反复调用 write 占满事件循环
+
+            if (!m_audioClockValid) {
+                if (m_clockAnchored) {
+                    // 排期切换：时钟已锚定在截止时刻，音频从当前时钟处开始，不把时钟拉回
+                    const double clock = masterClock();
+                    const double chunkEnd = chunk.pts + double(chunk.data.size()) / AUDIO_BYTES_PER_SECOND;
+                    if (chunkEnd <= clock) {
+                        queue.pop_front();
+                        continue;
+                    }
+                    const qsizetype skip = qsizetype((clock - chunk.pts) * AUDIO_BYTES_PER_SECOND) & ~qsizetype(3);
+                    if (skip > 0) {
+                        chunk.data.remove(0, skip);
+                        chunk.pts += double(skip) / AUDIO_BYTES_PER_SECOND;
+                    }
+                }
+                m_audioStartPts = chunk.pts;
+                m_audioClockValid = true;
+            }
+
+            qint64 written = m_audioDevice->write(chunk.data.constData(), chunk.data.size());
+            if (written <= 0) break;
+
+            if (written < chunk.data.size()) {
+                // 部分写入：保留剩余数据，保持 PTS 连续
+                chunk.data.remove(0, written);
+                chunk.pts += static_cast<double>(written) / AUDIO_BYTES_PER_SECOND;
+                break;
+            }
+            queue.pop_front();
+        }
+        m_metrics.setAudioQueueDepth(static_cast<int>(queue.size()));
+        return queue.empty();
+    });
+
+    const qint64 processedUs = m_audioSink->processedUSecs();
+    if (m_audioClockValid) {
+        m_audioClock = m_audioStartPts + processedUs / 1000000.0;
+    }
+    // 设备消耗进度：已播放时长前进，或数据已播完处于空闲（欠载不算设备故障）
+    if (processedUs != m_lastAudioProcessed || m_audioSink->state() == QAudio::IdleState) {
+        m_lastAudioProcessed = processedUs;
+        m_metrics.markProgress(PipelineStage::Audio, processedUs * double(AUDIO_BYTES_PER_SECOND) / 1e6);
+    }
+
+    const qint64 bufferedBytes = m_audioSink->bufferSize() - m_audioSink->bytesFree();
+    m_metrics.audio().endWrite(bufferedBytes * 1000.0 / AUDIO_BYTES_PER_SECOND, drained,
+                               processedUs / 1000000.0);
+}
@@ -0,0 +1,446 @@
+/**
+ * @file RhiRenderer.h
+ * @brief 基于 Qt RHI 的视频渲染器（跨平台：OpenGL/Vulkan/Metal/D3D）
+ *
+ * 使用 QRhiWidget (Qt 6.7+) 实现统一的 GPU 路径：
+ * - 一套 YUV→RGB 着色器管线（构建时由 qt_add_shaders 预编译为 .qsb）
+ * - 一条上传路径：动态纹理 + 资源更新批次（staging 由 RHI 后端管理）
+ * - 同一份代码运行在 OpenGL / Vulkan / Metal / D3D11 / D3D12 之上
+ */
+
+#ifndef RHIRENDERER_H
+#define RHIRENDERER_H
+
+#include "AbrController.h"
+#include "FrameConverter.h"
+#include "LoopFrameCache.h"
+#include "TaskGraph.h"
+#include "VideoRendererBase.h"
+#include "VideoGeometry.h"
+#include <QRhiWidget>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QVector4D>
+#include <memory>
+#include <atomic>
+#include <vector>
+
+#include <rhi/qrhi.h>
+
+class PipelineWatchdog;
+
+#if FFMPEG_AVAILABLE
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/hdr_dynamic_metadata.h>
+#include <libavutil/hwcontext.h>
+#include <libavutil/imgutils.h>
+#include <libavutil/mastering_display_metadata.h>
+#include <libavutil/pixdesc.h>
+#include <libswresample/swresample.h>
+#include <libswscale/swscale.h>
+}
+#endif
+
+#include <QAudioSink>
+#include <QIODevice>
+
+/**
+ * @brief 去隔行模式（片段着色器内完成，不占用 CPU）
+ */
+enum class DeinterlaceMode {
+    Off,            ///< 按逐行显示（交织）
+    Bob,            ///< 每场单独显示，缺失行取上下行平均
+    MotionAdaptive, ///< 静止区域交织、运动区域 bob（需要上一帧亮度纹理）
+};
+
+/**
+ * @brief 传递函数（HDR 由着色器色调映射到 SDR）
+ */
+enum class VideoTransfer {
+    Sdr,    ///< BT.709 / sRGB 等 SDR 伽马
+    Pq,     ///< SMPTE ST 2084（HDR10 / HDR10+）
+    Hlg,    ///< ARIB STD-B67
+};
+
+/**
+ * @brief 待上传的 YUV420P 帧
+ *
+ * 平面数据使用 QByteArray，上传时隐式共享给 RHI，不再额外拷贝
+ */
+struct RhiVideoFrame {
+    QByteArray planes[3];   ///< Y / U / V
+    int linesize[3] = {0, 0, 0};
+    int width = 0;
+    int height = 0;
+    double pts = 0;         ///< 连续时间轴上的 PTS（跨循环单调递增）
+    double position = 0;    ///< 文件内位置（秒）
+    int serial = 0;         ///< 跳转序号，与当前序号不一致的帧直接丢弃
+    std::shared_ptr<MemoryCharge> charge;   ///< 平面内存记账
+    std::shared_ptr<const void> backing;    ///< 平面引用的磁盘帧缓存映射，帧存活期间不解除映射
+
+    // 隔行帧拆成两场先后显示，两场共享同一份平面数据
+    DeinterlaceMode deinterlace = DeinterlaceMode::Off;
+    bool bottomField = false;   ///< 本次显示底场
+    bool secondField = false;   ///< 同一帧的第二场（纹理已上传，只切换场）
+
+    // 位深与色彩属性（来自 AVFrame，HDR 在着色器内完成色调映射）
+    int bitDepth = 8;           ///< 样本位深，>8 时平面为 16 位小端（以 R16 上传）
+    VideoTransfer transfer = VideoTransfer::Sdr;
+    bool bt2020 = false;        ///< BT.2020 原色与矩阵
+    bool fullRange = false;
+    float peakNits = 0;         ///< 内容峰值亮度（动态/静态元数据，0 表示未知）
+};
+
+/**
+ * @brief RHI 视频画面
+ *
+ * 负责 GPU 资源与绘制，帧调度由 RhiRenderer 完成。
+ * 所有方法都在 GUI 线程调用，无需加锁。
+ */
+class RhiVideoView : public QRhiWidget
+{
+public:
+    explicit RhiVideoView(QWidget *parent = nullptr);
+
+    /**
+     * @brief 设置下一帧（下一次 render() 时上传）
+     */
+    void setFrame(RhiVideoFrame &&frame);
+
+    /**
+     * @brief 清空画面
+     */
+    void clearFrame();
+
+    /**
+     * @brief 纹理内存计入指定记账
+     */
+    void setMemoryAccounting(MemoryAccounting *accounting);
+
+    /**
+     * @brief 后端是否支持 R16 纹理（高位深平面直接上传，任意线程可读）
+     */
+    bool supportsHighBitDepth() const { return m_highBitDepth; }
+
+    /**
+     * @brief 几何变换（只改变顶点与纹理坐标）
+     * @param streamRotation 流元数据要求的顺时针旋转（度）
+     */
+    void setVideoGeometry(const VideoGeometry &geometry, int streamRotation);
+
+protected:
+    void initialize(QRhiCommandBuffer *cb) override;
+    void render(QRhiCommandBuffer *cb) override;
+    void releaseResources() override;
+
+private:
+    bool ensureTextures(int width, int height, QRhiTexture::Format format);
+    bool ensurePrevLuma();
+    void uploadFrame(QRhiResourceUpdateBatch *batch);
+    void updateQuad(QRhiResourceUpdateBatch *batch);
+    QVector4D deinterlaceParams() const;
+    QVector4D colorParams() const;
+
+    QRhi *m_rhi = nullptr;
+    std::unique_ptr<QRhiBuffer> m_vbuf;
+    std::unique_ptr<QRhiBuffer> m_ubuf;
+    std::unique_ptr<QRhiSampler> m_sampler;
+    std::unique_ptr<QRhiTexture> m_textures[3];
+    std::unique_ptr<QRhiTexture> m_prevLuma;    ///< 上一帧亮度（运动自适应去隔行，按需分配）
+    std::unique_ptr<QRhiShaderResourceBindings> m_srb;
+    std::unique_ptr<QRhiGraphicsPipeline> m_pipeline;
+    bool m_vbufUploaded = false;
+    VideoQuadVertex m_quad[4] = {};     ///< 最近上传的顶点
+    VideoGeometry m_geometry;
+    int m_streamRotation = 0;
+
+    RhiVideoFrame m_frame;
+    QSize m_textureSize;     ///< 当前纹理对应的视频尺寸
+    QRhiTexture::Format m_textureFormat = QRhiTexture::R8;   ///< R8 或 R16（高位深）
+    std::atomic<bool> m_highBitDepth{false};
+    bool m_frameDirty = false;
+    bool m_lumaUploaded = false;    ///< 亮度纹理已有一帧内容（可复制为上一帧）
+    bool m_prevLumaValid = false;   ///< m_prevLuma 内容是上一帧（否则只能 bob）
+    MemoryCharge m_textureCharge;
+    MemoryCharge m_prevLumaCharge;
+};
+
+/**
+ * @brief RHI 视频播放器（跨平台）
+ *
+ * 继承 VideoRendererBase，内部持有一个 RhiVideoView 负责绘制。
+ *
+ * 特点：
+ * - 跨平台：Windows, macOS, Linux
+ * - 支持各平台硬件解码（D3D11VA / VideoToolbox / VAAPI）
+ * - 解码线程输出 YUV420P，着色器完成 YUV→RGB
+ * - 时间轴跨循环连续，循环时无需重置音视频时钟
+ */
+class RhiRenderer : public VideoRendererBase
+{
+    Q_OBJECT
+
+public:
+    explicit RhiRenderer(QWidget *parent = nullptr);
+    ~RhiRenderer() override;
+
+    // ========================================
+    // 实现 VideoRendererBase 接口
+    // ========================================
+    bool openFile(const QString &filename) override;
+    void closeFile() override;
+    void play() override;
+    void pause() override;
+    void stop() override;
+    void togglePause() override;
+    void seek(double seconds) override;
+    void setVolume(int volume) override;
+    void setMaxPresentRate(double fps) override;
+    bool supportsMaxPresentRate() const override { return true; }
+
+    QString rendererName() const override { return "RHI (OpenGL/Vulkan/Metal/D3D)"; }
+
+    /**
+     * @brief 隔行片源的去隔行方式（检测到隔行帧时自动生效，输出场频）
+     */
+    void setDeinterlaceMode(DeinterlaceMode mode) { m_deinterlaceMode = mode; }
+    DeinterlaceMode deinterlaceMode() const { return m_deinterlaceMode; }
+    PlaybackMetrics *metrics() override { return &m_metrics; }
+    void setVideoGeometry(const VideoGeometry &geometry) override;
+    QImage grabFrame() override;
+
+    /**
+     * @brief 排期切换：立即在后台打开新文件并预解码首帧，到期后下一次刷新即显示该帧
+     */
+    void scheduleSwitch(const QString &filename, const QDateTime &at, bool atLoopBoundary = false) override;
+    void cancelScheduledSwitch() override;
+#if FFMPEG_AVAILABLE
+    bool isHardwareDecoding() const override { return m_hwDeviceCtx != nullptr; }
+
+    /**
+     * @brief 把 CPU 上的解码帧整理为待上传的 YUV420P 平面与色彩属性（不设置 PTS）
+     * @param swsCtx 非 YUV420P 源使用的转换上下文（按需创建/复用）
+     * @param highBitDepth 高位深源保留为 16 位平面（否则转换到 8 位）
+     */
+    static bool fillFrame(const AVFrame *srcFrame, SwsContext *&swsCtx, RhiVideoFrame &frame,
+                          bool highBitDepth = false);
+#endif
+
+protected:
+    void onCueDue() override;
+
+private slots:
+    void onRenderTimer();
+    void onAudioTimer();
+
+private:
+#if FFMPEG_AVAILABLE
+    // FFmpeg 初始化（静态：排期切换的预加载线程同样使用）
+    static bool initHardwareDecoder(AVCodecContext *codecCtx, const AVCodec *codec, AVBufferRef *&hwDeviceCtx);
+    static bool openAudioDecoder(const AVStream *stream, AVCodecContext *&codecCtx, SwrContext *&swrCtx);
+    static int interruptIo(void *opaque);
+    bool openVideoDecoder(const AVCodec *codec, const AVCodecParameters *codecpar, QString &error);
+    bool reopenVideoDecoder();
+
+    // 解码管线（协程）：demux → 视频解码 → 转换；demux → 音频解码
+    struct PacketDeleter {
+        void operator()(AVPacket *packet) const { av_packet_free(&packet); }
+    };
+    struct FrameDeleter {
+        void operator()(AVFrame *frame) const { av_frame_free(&frame); }
+    };
+    using PacketPtr = std::unique_ptr<AVPacket, PacketDeleter>;
+    using FramePtr = std::unique_ptr<AVFrame, FrameDeleter>;
+
+    struct PacketItem {
+        PacketPtr packet;       // 空指针表示循环边界：排空解码器后 flush
+        int serial = 0;
+        double loopOffset = 0;  // 本轮循环在连续时间轴上的起点
+    };
+    struct DecodedItem {
+        FramePtr frame;
+        int serial = 0;
+        double loopOffset = 0;
+    };
+
+    Task demuxTask(std::stop_token stop);
+    Task videoDecodeTask(std::stop_token stop);
+    Task videoConvertTask(std::stop_token stop);
+    Task audioDecodeTask(std::stop_token stop);
+    Task cachedVideoTask(std::stop_token stop);     // 帧缓存命中时取代视频解码与转换
+
+    // 短循环磁盘帧缓存：命中时映射，否则录制第一轮
+    void openFrameCache(const QString &filename, const AVStream *stream);
+    void recordLoopFrame(const DecodedItem &item, const RhiVideoFrame (&frames)[2], int count);
+
+    // 限制呈现帧率：按固定步长选帧（转换阶段或帧缓存任务调用）
+    int presentStride() const;
+    bool selectPresentFrame(double pts, int serial);
+
+    // 转换一帧，返回待显示的队列项数（隔行帧拆成两场，失败为 0）
+    int convertVideoFrame(const DecodedItem &item, AVFrame *swFrame, RhiVideoFrame (&out)[2]);
+    bool convertAudioFrame(const AVFrame *frame, double loopOffset, QByteArray &data, double &pts);
+
+    // 排期切换：后台打开文件与解码器并解出首帧（预卷帧），切换时直接显示、openFile 接管预热好的解码器
+    struct PreparedCue {
+        QString file;
+        AVFormatContext *formatCtx = nullptr;       // 已探测；解码器已预热时读位置停在预热读过的包之后
+        AVCodecContext *videoCodecCtx = nullptr;    // 已送入首帧及之前的包（多变体输入为空：回到开头，由 openFile 按 ABR 起始变体打开）
+        AVBufferRef *hwDeviceCtx = nullptr;
+        AVCodecContext *audioCodecCtx = nullptr;
+        SwrContext *swrCtx = nullptr;
+        std::vector<FramePtr> frames;               // 预卷帧之后解码器已输出的帧
+        std::vector<PacketPtr> audioPackets;        // 预热期间读到的音频包
+        int videoStream = -1;
+        int audioStream = -1;
+        RhiVideoFrame preroll;
+        int streamRotation = 0;
+        bool ok = false;
+    };
+    static void preloadCue(const QString &filename, bool highBitDepth, DecodeMode decodeMode,
+                           AccountedBufferPools *pools, PreparedCue &cue);
+    static void freeCue(PreparedCue &cue);
+#endif
+
+    // 排期切换
+    void prepareCue(const QString &filename);
+    void releaseCue();
+    void cutToCue();
+    void finishCue(const QString &filename);
+
+    // 音频
+    void setupAudio();
+    void cleanupAudio();
+    void processAudio();
+
+    // 同步
+    double masterClock() const;
+    void resetClock();
+    void startPipeline();
+    void stopPipeline();
+    void clearQueues();
+
+    // 停滞看门狗
+    void armWatchdog();
+    bool runRecovery(RecoveryAction action);
+
+private:
+#if FFMPEG_AVAILABLE
+    AVFormatContext *m_formatCtx = nullptr;
+    AVCodecContext *m_videoCodecCtx = nullptr;
+    AVCodecContext *m_audioCodecCtx = nullptr;
+    AVBufferRef *m_hwDeviceCtx = nullptr;
+    SwrContext *m_swrCtx = nullptr;
+    SwsContext *m_swsCtx = nullptr;
+
+    int m_videoStreamIndex = -1;
+    int m_audioStreamIndex = -1;
+#endif
+
+    RhiVideoView *m_view = nullptr;
+
+    // 解码管线：各阶段为协程，在共享执行器上调度；跳转时序号 +1，旧序号的包和帧被丢弃
+    // demux 的读包与跳转会阻塞（网络源可能停滞数秒），在本播放器专用的 I/O 线程上执行，不占共享线程
+    Executor m_ioExecutor{1};
+    TaskGroup m_pipeline{Executor::shared()};
+    std::atomic<bool> m_interruptIo{false};     // 停止管线期间打断阻塞中的读包（AVIOInterruptCB）
+    std::atomic<int> m_serial{0};
+    std::atomic<bool> m_seeking{false};
+    std::atomic<double> m_seekTarget{0};
+
+    std::atomic<DeinterlaceMode> m_deinterlaceMode{DeinterlaceMode::MotionAdaptive};
+    bool m_interlaced = false;          // 最近一帧是否隔行（仅转换阶段访问，用于日志）
+    VideoTransfer m_lastTransfer = VideoTransfer::Sdr;  // 仅转换阶段访问，用于日志
+    float m_hdrPeakNits = 0;            // 最近一次元数据给出的内容峰值（仅转换阶段访问）
+#if FFMPEG_AVAILABLE
+    FrameParams m_frameParams;          // 最近解码帧的尺寸 / 格式（仅转换阶段访问）
+#endif
+
+    // 音频
+    struct AudioChunk {
+        QByteArray data;
+        double pts = 0;
+        int serial = 0;
+        std::shared_ptr<MemoryCharge> charge;
+    };
+    std::unique_ptr<QAudioSink> m_audioSink;
+    QIODevice *m_audioDevice = nullptr;
+    qint64 m_lastAudioProcessed = -1;   // 上次读到的设备已播放时长（微秒）
+    bool m_hasAudio = false;
+    bool m_audioPending = false;    // 已开始播放但音频设备尚未创建（等待第一个音频块）
+    bool m_firstFramePending = false;   // openFile 后尚未显示过帧
+    PlaybackMetrics m_metrics;      // 音频遥测、内存记账
+    PipelineWatchdog *m_watchdog = nullptr;
+    bool m_hardwareAllowed = true;  // 看门狗回退软件解码后，本文件不再尝试硬件解码
+    MemoryCharge m_audioSinkCharge;
+    static constexpr int MAX_AUDIO_QUEUE = 100;
+#if FFMPEG_AVAILABLE
+    AccountedBufferPools m_bufferPools{m_metrics.memory()};
+    MemoryCharge m_transferCharge{&m_metrics.memory(), MemoryCategory::ConversionBuffers, 0};
+    AbrController m_abr{m_metrics};     // 多变体输入的码率切换（openFile 后仅 demux 协程访问）
+    std::shared_ptr<const LoopFrameCache> m_frameCache;     // 命中的帧缓存（openFile 后只读）
+    std::unique_ptr<LoopFrameCacheWriter> m_cacheWriter;    // 录制中的帧缓存（仅转换阶段访问）
+    int m_cacheSerial = 0;              // 打开文件时的序号：之后发生跳转则放弃录制、命中时从头播放
+    MemoryCharge m_frameCacheCharge{&m_metrics.memory(), MemoryCategory::Caches, 0};
+
+    // 呈现帧率上限：步长 = ceil(源帧率 / 上限)，按步长选帧保持均匀节奏
+    std::atomic<double> m_presentRateCap{0};
+    double m_sourceFps = 0;             // openFile 时确定，管线运行期间只读
+    std::atomic<bool> m_skipNonRef{true};   // 解码器跳过非参考帧（非参考帧过密时关闭，录制帧缓存期间暂停）
+    int m_presentSerial = -1;           // 以下仅转换阶段访问
+    double m_nextPresentPts = 0;
+    double m_lastDecodedPts = 0;
+
+    // 阶段间队列（满时生产者挂起，空时消费者挂起）
+    AsyncQueue<PacketItem> m_videoPackets{Executor::shared(), MAX_VIDEO_PACKETS};
+    AsyncQueue<PacketItem> m_audioPackets{Executor::shared(), MAX_AUDIO_PACKETS};
+    AsyncQueue<DecodedItem> m_decodedFrames{Executor::shared(), MAX_DECODED_FRAMES};
+    static constexpr int MAX_VIDEO_PACKETS = 32;
+    static constexpr int MAX_AUDIO_PACKETS = 64;
+    static constexpr int MAX_DECODED_FRAMES = 2;    // 解码与转换并行的缓冲，不多占解码表面
+
+    // 排期切换接管的预热结果：管线启动时各阶段先送出（之后为空）
+    std::vector<FramePtr> m_primedFrames;
+    std::vector<PacketPtr> m_primedAudioPackets;
+#endif
+
+    // 输出队列：GUI 线程的呈现 / 音频定时器通过 consume() 取用
+    AsyncQueue<AudioChunk> m_audioQueue{Executor::shared(), MAX_AUDIO_QUEUE};
+    AsyncQueue<RhiVideoFrame> m_frameQueue{Executor::shared(), MAX_FRAME_QUEUE};
+    static constexpr int MAX_FRAME_QUEUE = 6;     // 按队列项计，隔行片源每帧占两项
+
+    // 时钟
+    double m_audioClock = 0;          // 音频主时钟（连续时间轴）
+    double m_audioStartPts = 0;       // 写入设备的第一块音频 PTS
+    bool m_audioClockValid = false;
+    QElapsedTimer m_wallClock;        // 无音频时的参考时钟
+    double m_wallClockBasePts = 0;
+    bool m_wallClockValid = false;
+    bool m_clockAnchored = false;     // 排期切换锚定的时钟：音频从当前时钟处开始，不把时钟拉回
+    double m_cueSkipPts = -1;         // 排期切换后不晚于预卷帧的帧已显示过（帧缓存从首帧开始）
+
+    // 视频信息
+    int m_videoWidth = 0;
+    int m_videoHeight = 0;
+
+    // 排期切换：预加载线程结束后 GUI 线程才读取 m_cuePrepared
+#if FFMPEG_AVAILABLE
+    PreparedCue m_cuePrepared;
+#endif
+    QThread *m_cueThread = nullptr;
+    int m_cueGeneration = 0;        // 每次释放 +1，丢弃已取消预加载的结束通知
+    bool m_cueReady = false;        // 预加载已结束（成功或失败）
+    bool m_cueWaiting = false;      // 已到期，等待预加载结束
+    bool m_cueAtBoundary = false;   // 已到期，等待循环接缝
+    qint64 m_cueAnchorNs = 0;       // 预卷帧对应的时刻：截止时间（循环边界切换为切换时刻）
+    QMetaObject::Connection m_cueSubmitted;
+
+    // 定时器
+    QTimer *m_renderTimer = nullptr;
+    QTimer *m_audioTimer = nullptr;
+};
+
+#endif // RHIRENDERER_H
@@ -0,0 +1,99 @@
+/**
+ * @file SessionResume.cpp
+ * @brief 上次会话恢复实现
+ */
+
+#include "SessionResume.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QThread>
+
+#if defined(Q_OS_LINUX)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+QString SessionResume::snapshotPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+         + QStringLiteral("/last_frame.jpg");
+}
+
+SessionState SessionResume::load()
+{
+    SessionState state;
+    QSettings settings;
+    const QString file = settings.value(QStringLiteral("session/file")).toString();
+    if (file.isEmpty() || !QFileInfo::exists(file)) {
+        return state;
+    }
+    state.file = file;
+    state.position = qMax(0.0, settings.value(QStringLiteral("session/position")).toDouble());
+    // 快照只对应保存时的文件
+    state.snapshot.load(snapshotPath());
+    return state;
+}
+
+void SessionResume::save(const QString &file, double position, const QImage &snapshot)
+{
+    QSettings settings;
+    settings.setValue(QStringLiteral("session/file"), file);
+    settings.setValue(QStringLiteral("session/position"), position);
+
+    const QString path = snapshotPath();
+    if (snapshot.isNull()) {
+        QFile::remove(path);
+        return;
+    }
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    const QImage image = snapshot.width() > SNAPSHOT_MAX_WIDTH
+        ? snapshot.scaledToWidth(SNAPSHOT_MAX_WIDTH, Qt::SmoothTransformation)
+        : snapshot;
+    if (!image.save(path, "JPG", SNAPSHOT_QUALITY)) {
+        qWarning() << "会话快照保存失败:" << path;
+    }
+}
+
+void SessionResume::prefetch(const QString &file)
+{
+#if defined(Q_OS_LINUX)
+    // 只是预读提示，内核异步读取，不占用调用线程
+    const int fd = ::open(QFile::encodeName(file).constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    const qint64 size = QFileInfo(file).size();
+    posix_fadvise(fd, 0, qMin(size, PREFETCH_HEAD_BYTES), POSIX_FADV_WILLNEED);
+    if (size > PREFETCH_HEAD_BYTES) {
+        const qint64 tail = qMax(PREFETCH_HEAD_BYTES, size - PREFETCH_TAIL_BYTES);
+        posix_fadvise(fd, tail, size - tail, POSIX_FADV_WILLNEED);
+    }
+    ::close(fd);
+#else
+    // 没有预读提示的平台：后台线程顺序读一遍头尾
+    QThread *thread = QThread::create([file]() {
+        QFile input(file);
+        if (!input.open(QIODevice::ReadOnly)) return;
+        const qint64 size = input.size();
+        QByteArray buffer(1024 * 1024, Qt::Uninitialized);
+        auto touch = [&](qint64 offset, qint64 length) {
+            input.seek(offset);
+            while (length > 0) {
+                const qint64 n = input.read(buffer.data(), qMin<qint64>(length, buffer.size()));
+                if (n <= 0) break;
+                length -= n;
+            }
+        };
+        touch(0, qMin(size, PREFETCH_HEAD_BYTES));
+        if (size > PREFETCH_HEAD_BYTES) {
+            const qint64 tail = qMax(PREFETCH_HEAD_BYTES, size - PREFETCH_TAIL_BYTES);
+            touch(tail, size - tail);
+        }
+    });
+    QObject::connect(thread, &QThread::finished, thread, &QObject::deleteLater);
+    thread->start();
+#endif
+}
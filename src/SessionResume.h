@@ -0,0 +1,50 @@
+/**
+ * @file SessionResume.h
+ * @brief 上次会话恢复（文件、位置、退出时画面快照）
+ *
+ * 退出时保存当前文件、播放位置和屏幕上的画面（JPEG）；下次启动先显示快照，
+ * 同时预热文件头尾的页缓存，后台打开并从保存的位置继续播放。
+ */
+
+#ifndef SESSIONRESUME_H
+#define SESSIONRESUME_H
+
+#include <QImage>
+#include <QString>
+
+struct SessionState {
+    QString file;           ///< 上次播放的文件（绝对路径）
+    double position = 0;    ///< 退出时的播放位置（秒）
+    QImage snapshot;        ///< 退出时屏幕上的画面，可能为空
+
+    bool isValid() const { return !file.isEmpty(); }
+};
+
+class SessionResume
+{
+public:
+    /**
+     * @brief 读取上次会话（文件已不存在时返回无效状态）
+     */
+    static SessionState load();
+
+    /**
+     * @brief 保存会话，snapshot 为空时删除旧快照
+     */
+    static void save(const QString &file, double position, const QImage &snapshot);
+
+    /**
+     * @brief 预热文件头部与尾部（容器头、索引）的页缓存，不阻塞调用线程
+     */
+    static void prefetch(const QString &file);
+
+private:
+    static QString snapshotPath();
+
+    static constexpr qint64 PREFETCH_HEAD_BYTES = 8 * 1024 * 1024;  // 容器头 + 前几个 GOP
+    static constexpr qint64 PREFETCH_TAIL_BYTES = 2 * 1024 * 1024;  // MP4 尾部 moov / MKV Cues
+    static constexpr int SNAPSHOT_MAX_WIDTH = 1920;
+    static constexpr int SNAPSHOT_QUALITY = 85;
+};
+
+#endif // SESSIONRESUME_H
@@ -0,0 +1,76 @@
+/**
+ * @file ShmPresenter.cpp
+ * @brief 共享内存软件呈现 - 公共合成逻辑与工厂
+ */
+
+#include "ShmPresenter.h"
+#include <QGuiApplication>
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+std::unique_ptr<ShmPresenter> ShmPresenter::create(QWidget *widget)
+{
+    // LOOP_SHM_PRESENT=0 时禁用，回退到 QPainter
+    if (qEnvironmentVariable("LOOP_SHM_PRESENT") == "0") {
+        return nullptr;
+    }
+
+    const QString platform = QGuiApplication::platformName();
+    std::unique_ptr<ShmPresenter> presenter;
+
+#if SHM_X11_AVAILABLE
+    if (platform == "xcb") {
+        presenter = createX11ShmPresenter(widget);
+    }
+#endif
+
+#if SHM_WAYLAND_AVAILABLE
+    if (platform.startsWith("wayland")) {
+        presenter = createWaylandShmPresenter(widget);
+    }
+#endif
+
+    Q_UNUSED(widget)
+    if (presenter) {
+        qDebug() << "✓ 共享内存呈现已启用:" << presenter->name();
+    } else {
+        qDebug() << "共享内存呈现不可用，使用 QPainter，平台:" << platform;
+    }
+    return presenter;
+}
+
+bool ShmPresenter::present(const QImage &frame, const QRect &videoRect, const QSize &targetSize)
+{
+    if (frame.isNull() || targetSize.isEmpty()) return false;
+
+    ShmBuffer *buffer = acquireBuffer(targetSize);
+    if (!buffer) return false;
+
+    // 视频区域与帧尺寸可能短暂不一致（窗口缩放后解码线程尚未跟上），取交集
+    const QRect dst = QRect(videoRect.topLeft(), frame.size())
+                          .intersected(QRect(QPoint(0, 0), targetSize));
+    if (dst.isEmpty()) return false;
+
+    // 黑边：只在视频区域变化后重填，稳定播放时每帧只写视频像素
+    QRect damage = dst;
+    if (buffer->lastVideoRect != dst) {
+        for (int y = 0; y < targetSize.height(); y++) {
+            auto *line = reinterpret_cast<QRgb*>(buffer->data + y * buffer->stride);
+            std::fill(line, line + targetSize.width(), m_background);
+        }
+        buffer->lastVideoRect = dst;
+        damage = QRect(QPoint(0, 0), targetSize);
+    }
+
+    const int rowBytes = dst.width() * 4;
+    for (int y = 0; y < dst.height(); y++) {
+        std::memcpy(buffer->data + (dst.y() + y) * buffer->stride + dst.x() * 4,
+                    frame.constScanLine(y), rowBytes);
+    }
+
+    buffer->busy = true;
+    buffer->submitted.start();
+    submitBuffer(buffer, damage);
+    return true;
+}
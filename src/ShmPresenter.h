@@ -0,0 +1,118 @@
+/**
+ * @file ShmPresenter.h
+ * @brief 共享内存软件呈现（无 GPU 的 Linux 瘦客户端）
+ *
+ * 绕过 QPainter/backing store，把已缩放到显示尺寸的像素直接写入
+ * 显示服务器可读取的共享内存缓冲区：
+ * - X11:     MIT-SHM (xcb_shm_put_image)，完成事件归还缓冲区
+ * - Wayland: wl_shm 缓冲区挂在子表面上，frame 回调控制节奏
+ *
+ * 双缓冲：一个缓冲区在服务器手中时，另一个用于写入下一帧。
+ * 服务器持有的缓冲区只在 release / 完成事件到达后才归还，绝不提前复用；
+ * 事件迟迟不来时追加缓冲区（至多 MAX_BUFFER_COUNT 个），仍无空闲则跳过本帧。
+ */
+
+#ifndef SHMPRESENTER_H
+#define SHMPRESENTER_H
+
+#include <QImage>
+#include <QRect>
+#include <QColor>
+#include <QElapsedTimer>
+#include <memory>
+
+class QWidget;
+
+/**
+ * @brief 共享内存呈现器基类
+ *
+ * 负责把视频帧与黑边合成到空闲缓冲区，缓冲区分配与提交由各后端实现。
+ * 所有方法都在 GUI 线程调用。
+ */
+class ShmPresenter
+{
+public:
+    virtual ~ShmPresenter() = default;
+
+    /**
+     * @brief 按当前 Qt 平台插件创建呈现器
+     * @param widget 视频所在的 widget（X11 需要原生窗口）
+     * @return 不支持时返回 nullptr（调用方回退到 QPainter）
+     */
+    static std::unique_ptr<ShmPresenter> create(QWidget *widget);
+
+    /**
+     * @brief 呈现一帧
+     * @param frame 已缩放到显示尺寸的 RGB32 帧
+     * @param videoRect 视频在 widget 内的区域（设备像素）
+     * @param targetSize widget 尺寸（设备像素）
+     * @return 没有空闲缓冲区（上一帧尚未显示）时返回 false
+     */
+    bool present(const QImage &frame, const QRect &videoRect, const QSize &targetSize);
+
+    /**
+     * @brief 清除已呈现的画面（停止播放时调用）
+     */
+    virtual void clear() {}
+
+    /**
+     * @brief 黑边颜色
+     */
+    void setBackground(const QColor &color) { m_background = color.rgb(); }
+
+    virtual const char *name() const = 0;
+
+protected:
+    /**
+     * @brief 共享内存缓冲区（后端派生以保存句柄）
+     */
+    struct ShmBuffer {
+        uchar *data = nullptr;
+        int stride = 0;
+        QSize size;
+        bool busy = false;          ///< 服务器仍在读取
+        QRect lastVideoRect;        ///< 上次写入视频的区域（黑边只在变化时重填）
+        QElapsedTimer submitted;    ///< 提交时间，用于判断是否追加缓冲区
+    };
+
+    /**
+     * @brief 获取一个指定尺寸的空闲缓冲区
+     * @return 需要等待时返回 nullptr
+     */
+    virtual ShmBuffer *acquireBuffer(const QSize &size) = 0;
+
+    /**
+     * @brief 提交缓冲区给显示服务器
+     */
+    virtual void submitBuffer(ShmBuffer *buffer, const QRect &damage) = 0;
+
+    /**
+     * @brief 没有空闲缓冲区时是否再分配一个
+     * @param count 现有缓冲区数
+     * @param newestBusyMs 最近一次提交距今（毫秒）
+     *
+     * 前 BUFFER_COUNT 个直接分配；之后只在全部占用超过 BUSY_TIMEOUT_MS 时追加
+     */
+    static bool shouldAddBuffer(int count, qint64 newestBusyMs)
+    {
+        if (count < BUFFER_COUNT) return true;
+        return count < MAX_BUFFER_COUNT && newestBusyMs > BUSY_TIMEOUT_MS;
+    }
+
+    static constexpr int BUFFER_COUNT = 2;
+    static constexpr int MAX_BUFFER_COUNT = 4;
+    static constexpr qint64 BUSY_TIMEOUT_MS = 200;
+
+private:
+    QRgb m_background = qRgb(26, 26, 46);
+};
+
+#if SHM_X11_AVAILABLE
+std::unique_ptr<ShmPresenter> createX11ShmPresenter(QWidget *widget);
+#endif
+
+#if SHM_WAYLAND_AVAILABLE
+std::unique_ptr<ShmPresenter> createWaylandShmPresenter(QWidget *widget);
+#endif
+
+#endif // SHMPRESENTER_H
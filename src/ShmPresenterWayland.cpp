@@ -0,0 +1,308 @@
+/**
+ * @file ShmPresenterWayland.cpp
+ * @brief 共享内存软件呈现 - Wayland wl_shm 后端
+ *
+ * 在顶层窗口的 wl_surface 下创建一个非同步子表面，视频缓冲区挂在子表面上，
+ * 与 Qt 自己的 backing store 互不干扰。缓冲区为 memfd + wl_shm_pool，
+ * 通过 frame 回调控制提交节奏，wl_buffer.release 归还缓冲区。
+ *
+ * 所有 Wayland 对象放在私有事件队列上，由 GUI 线程在呈现前分发，
+ * 不会与 Qt 的事件分发线程竞争。
+ */
+
+#include "ShmPresenter.h"
+
+#if SHM_WAYLAND_AVAILABLE
+
+#include <QWidget>
+#include <QWindow>
+#include <QGuiApplication>
+#include <QDebug>
+#include <qpa/qplatformnativeinterface.h>
+
+#include <wayland-client.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstring>
+#include <vector>
+
+class WaylandShmPresenter : public ShmPresenter
+{
+public:
+    WaylandShmPresenter(QWidget *widget, wl_display *display, wl_surface *parent)
+        : m_widget(widget), m_display(display), m_parent(parent) {}
+    ~WaylandShmPresenter() override;
+
+    bool init();
+    const char *name() const override { return "Wayland wl_shm"; }
+    void clear() override;
+
+protected:
+    ShmBuffer *acquireBuffer(const QSize &size) override;
+    void submitBuffer(ShmBuffer *buffer, const QRect &damage) override;
+
+private:
+    struct WlBuffer : ShmBuffer {
+        wl_buffer *buffer = nullptr;
+        size_t mapSize = 0;
+    };
+
+    bool createBuffer(WlBuffer &buffer, const QSize &size);
+    void destroyBuffer(WlBuffer &buffer);
+
+    // Wayland 回调
+    static void onRegistryGlobal(void *data, wl_registry *registry, uint32_t name,
+                                 const char *interface, uint32_t version);
+    static void onRegistryGlobalRemove(void *data, wl_registry *registry, uint32_t name);
+    static void onBufferRelease(void *data, wl_buffer *buffer);
+    static void onFrameDone(void *data, wl_callback *callback, uint32_t time);
+
+    static const wl_registry_listener s_registryListener;
+    static const wl_buffer_listener s_bufferListener;
+    static const wl_callback_listener s_frameListener;
+
+    QWidget *m_widget = nullptr;
+    wl_display *m_display = nullptr;
+    wl_surface *m_parent = nullptr;
+    wl_event_queue *m_queue = nullptr;
+    wl_registry *m_registry = nullptr;
+    wl_compositor *m_compositor = nullptr;
+    wl_subcompositor *m_subcompositor = nullptr;
+    wl_shm *m_shm = nullptr;
+    wl_surface *m_surface = nullptr;
+    wl_subsurface *m_subsurface = nullptr;
+    wl_callback *m_frameCallback = nullptr;
+    bool m_frameDone = true;
+    QElapsedTimer m_frameRequested;
+    int m_bufferScale = 1;
+    std::vector<std::unique_ptr<WlBuffer>> m_buffers;   // 地址稳定（作为 release 监听器数据）
+};
+
+const wl_registry_listener WaylandShmPresenter::s_registryListener = {
+    &WaylandShmPresenter::onRegistryGlobal,
+    &WaylandShmPresenter::onRegistryGlobalRemove,
+};
+
+const wl_buffer_listener WaylandShmPresenter::s_bufferListener = {
+    &WaylandShmPresenter::onBufferRelease,
+};
+
+const wl_callback_listener WaylandShmPresenter::s_frameListener = {
+    &WaylandShmPresenter::onFrameDone,
+};
+
+WaylandShmPresenter::~WaylandShmPresenter()
+{
+    if (m_frameCallback) wl_callback_destroy(m_frameCallback);
+    for (auto &buffer : m_buffers) {
+        destroyBuffer(*buffer);
+    }
+    if (m_subsurface) wl_subsurface_destroy(m_subsurface);
+    if (m_surface) wl_surface_destroy(m_surface);
+    if (m_shm) wl_shm_destroy(m_shm);
+    if (m_subcompositor) wl_subcompositor_destroy(m_subcompositor);
+    if (m_compositor) wl_compositor_destroy(m_compositor);
+    if (m_registry) wl_registry_destroy(m_registry);
+    wl_display_flush(m_display);
+    if (m_queue) wl_event_queue_destroy(m_queue);
+}
+
+bool WaylandShmPresenter::init()
+{
+    m_queue = wl_display_create_queue(m_display);
+
+    // 在私有队列上获取 registry 并绑定所需全局对象
+    auto *displayWrapper = static_cast<wl_display*>(wl_proxy_create_wrapper(m_display));
+    wl_proxy_set_queue(reinterpret_cast<wl_proxy*>(displayWrapper), m_queue);
+    m_registry = wl_display_get_registry(displayWrapper);
+    wl_proxy_wrapper_destroy(displayWrapper);
+
+    wl_registry_add_listener(m_registry, &s_registryListener, this);
+    wl_display_roundtrip_queue(m_display, m_queue);
+
+    if (!m_compositor || !m_subcompositor || !m_shm) {
+        qWarning() << "Wayland 合成器缺少 wl_compositor / wl_subcompositor / wl_shm";
+        return false;
+    }
+
+    m_surface = wl_compositor_create_surface(m_compositor);
+    m_subsurface = wl_subcompositor_get_subsurface(m_subcompositor, m_surface, m_parent);
+    // 非同步模式：子表面提交立即生效，不等父表面
+    wl_subsurface_set_desync(m_subsurface);
+
+    m_bufferScale = qMax(1, qRound(m_widget->devicePixelRatioF()));
+    wl_surface_set_buffer_scale(m_surface, m_bufferScale);
+    return true;
+}
+
+void WaylandShmPresenter::onRegistryGlobal(void *data, wl_registry *registry, uint32_t name,
+                                           const char *interface, uint32_t version)
+{
+    auto *self = static_cast<WaylandShmPresenter*>(data);
+    if (std::strcmp(interface, wl_compositor_interface.name) == 0 && version >= 4) {
+        self->m_compositor = static_cast<wl_compositor*>(
+            wl_registry_bind(registry, name, &wl_compositor_interface, 4));
+    } else if (std::strcmp(interface, wl_subcompositor_interface.name) == 0) {
+        self->m_subcompositor = static_cast<wl_subcompositor*>(
+            wl_registry_bind(registry, name, &wl_subcompositor_interface, 1));
+    } else if (std::strcmp(interface, wl_shm_interface.name) == 0) {
+        self->m_shm = static_cast<wl_shm*>(
+            wl_registry_bind(registry, name, &wl_shm_interface, 1));
+    }
+}
+
+void WaylandShmPresenter::onRegistryGlobalRemove(void *data, wl_registry *registry, uint32_t name)
+{
+    Q_UNUSED(data)
+    Q_UNUSED(registry)
+    Q_UNUSED(name)
+}
+
+void WaylandShmPresenter::onBufferRelease(void *data, wl_buffer *buffer)
+{
+    Q_UNUSED(buffer)
+    static_cast<WlBuffer*>(data)->busy = false;
+}
+
+void WaylandShmPresenter::onFrameDone(void *data, wl_callback *callback, uint32_t time)
+{
+    Q_UNUSED(time)
+    auto *self = static_cast<WaylandShmPresenter*>(data);
+    wl_callback_destroy(callback);
+    self->m_frameCallback = nullptr;
+    self->m_frameDone = true;
+}
+
+bool WaylandShmPresenter::createBuffer(WlBuffer &buffer, const QSize &size)
+{
+    const int stride = size.width() * 4;
+    const size_t mapSize = static_cast<size_t>(stride) * size.height();
+
+    int fd = memfd_create("loop-video-shm", MFD_CLOEXEC);
+    if (fd < 0) return false;
+    if (ftruncate(fd, static_cast<off_t>(mapSize)) < 0) {
+        close(fd);
+        return false;
+    }
+
+    void *addr = mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (addr == MAP_FAILED) {
+        close(fd);
+        return false;
+    }
+
+    wl_shm_pool *pool = wl_shm_create_pool(m_shm, fd, static_cast<int32_t>(mapSize));
+    buffer.buffer = wl_shm_pool_create_buffer(pool, 0, size.width(), size.height(),
+                                              stride, WL_SHM_FORMAT_XRGB8888);
+    wl_shm_pool_destroy(pool);
+    close(fd);
+
+    wl_buffer_add_listener(buffer.buffer, &s_bufferListener, &buffer);
+
+    buffer.data = static_cast<uchar*>(addr);
+    buffer.mapSize = mapSize;
+    buffer.stride = stride;
+    buffer.size = size;
+    buffer.busy = false;
+    buffer.lastVideoRect = QRect();
+    return true;
+}
+
+void WaylandShmPresenter::destroyBuffer(WlBuffer &buffer)
+{
+    if (buffer.buffer) {
+        wl_buffer_destroy(buffer.buffer);
+        buffer.buffer = nullptr;
+    }
+    if (buffer.data) {
+        munmap(buffer.data, buffer.mapSize);
+        buffer.data = nullptr;
+    }
+    buffer.mapSize = 0;
+    buffer.size = QSize();
+    buffer.busy = false;
+}
+
+ShmPresenter::ShmBuffer *WaylandShmPresenter::acquireBuffer(const QSize &size)
+{
+    // 处理已到达的 release / frame 事件（读取由 Qt 的事件线程完成）
+    wl_display_dispatch_queue_pending(m_display, m_queue);
+
+    // frame 回调长时间不来（窗口被遮挡/最小化）时不要永久停住
+    if (!m_frameDone && m_frameRequested.elapsed() > BUSY_TIMEOUT_MS) {
+        wl_callback_destroy(m_frameCallback);
+        m_frameCallback = nullptr;
+        m_frameDone = true;
+    }
+
+    // 合成器尚未请求下一帧：跳过，避免提交看不到的帧
+    if (!m_frameDone) return nullptr;
+
+    // 忙碌的缓冲区归合成器所有，只有 wl_buffer.release 能归还；提前复用违反协议并撕裂画面
+    qint64 newestBusyMs = BUSY_TIMEOUT_MS + 1;
+    for (auto &buffer : m_buffers) {
+        if (buffer->busy) {
+            newestBusyMs = qMin(newestBusyMs, buffer->submitted.elapsed());
+            continue;
+        }
+        if (buffer->size != size) {
+            destroyBuffer(*buffer);
+            if (!createBuffer(*buffer, size)) return nullptr;
+        }
+        return buffer.get();
+    }
+
+    // 全部在合成器手中（窗口最小化时可能一直不释放）：追加一个，达到上限后跳过本帧
+    if (!shouldAddBuffer(int(m_buffers.size()), newestBusyMs)) return nullptr;
+    auto buffer = std::make_unique<WlBuffer>();
+    if (!createBuffer(*buffer, size)) return nullptr;
+    if (m_buffers.size() >= BUFFER_COUNT) {
+        qDebug() << "[wl_shm] release 延迟，追加缓冲区:" << m_buffers.size() + 1;
+    }
+    m_buffers.push_back(std::move(buffer));
+    return m_buffers.back().get();
+}
+
+void WaylandShmPresenter::submitBuffer(ShmBuffer *buffer, const QRect &damage)
+{
+    auto *wlBuffer = static_cast<WlBuffer*>(buffer);
+
+    // 子表面位置以父表面的逻辑坐标表示（在父表面下次提交时生效）
+    const QPoint pos = m_widget->mapTo(m_widget->window(), QPoint(0, 0));
+    wl_subsurface_set_position(m_subsurface, pos.x(), pos.y());
+
+    m_frameCallback = wl_surface_frame(m_surface);
+    wl_callback_add_listener(m_frameCallback, &s_frameListener, this);
+    m_frameDone = false;
+    m_frameRequested.start();
+
+    wl_surface_attach(m_surface, wlBuffer->buffer, 0, 0);
+    wl_surface_damage_buffer(m_surface, damage.x(), damage.y(), damage.width(), damage.height());
+    wl_surface_commit(m_surface);
+    wl_display_flush(m_display);
+}
+
+void WaylandShmPresenter::clear()
+{
+    // 子表面位于 Qt 绘制内容之上，需要显式卸下缓冲区
+    wl_surface_attach(m_surface, nullptr, 0, 0);
+    wl_surface_commit(m_surface);
+    wl_display_flush(m_display);
+}
+
+std::unique_ptr<ShmPresenter> createWaylandShmPresenter(QWidget *widget)
+{
+    QPlatformNativeInterface *native = QGuiApplication::platformNativeInterface();
+    QWindow *window = widget->window()->windowHandle();
+    if (!native || !window) return nullptr;
+
+    auto *display = static_cast<wl_display*>(native->nativeResourceForIntegration("wl_display"));
+    auto *surface = static_cast<wl_surface*>(native->nativeResourceForWindow("surface", window));
+    if (!display || !surface) return nullptr;
+
+    auto presenter = std::make_unique<WaylandShmPresenter>(widget, display, surface);
+    if (!presenter->init()) return nullptr;
+    return presenter;
+}
+
+#endif // SHM_WAYLAND_AVAILABLE
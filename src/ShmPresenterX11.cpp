@@ -0,0 +1,229 @@
+/**
+ * @file ShmPresenterX11.cpp
+ * @brief 共享内存软件呈现 - X11 MIT-SHM 后端
+ *
+ * 缓冲区为 SysV 共享内存段，通过 xcb_shm_put_image 提交到窗口；
+ * 服务器读完后发送 ShmCompletion 事件，借 Qt 的原生事件过滤器接收并归还缓冲区。
+ */
+
+#include "ShmPresenter.h"
+
+#if SHM_X11_AVAILABLE
+
+#include <QWidget>
+#include <QGuiApplication>
+#include <QCoreApplication>
+#include <QAbstractNativeEventFilter>
+#include <QDebug>
+
+#include <xcb/xcb.h>
+#include <xcb/shm.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <vector>
+
+class X11ShmPresenter : public ShmPresenter, public QAbstractNativeEventFilter
+{
+public:
+    X11ShmPresenter(xcb_connection_t *connection, xcb_window_t window)
+        : m_conn(connection), m_window(window) {}
+    ~X11ShmPresenter() override;
+
+    bool init();
+    const char *name() const override { return "X11 MIT-SHM"; }
+
+    bool nativeEventFilter(const QByteArray &eventType, void *message, qintptr *result) override;
+
+protected:
+    ShmBuffer *acquireBuffer(const QSize &size) override;
+    void submitBuffer(ShmBuffer *buffer, const QRect &damage) override;
+
+private:
+    struct XcbBuffer : ShmBuffer {
+        xcb_shm_seg_t seg = 0;
+        int shmId = -1;
+    };
+
+    bool createBuffer(XcbBuffer &buffer, const QSize &size);
+    void destroyBuffer(XcbBuffer &buffer);
+
+    xcb_connection_t *m_conn = nullptr;
+    xcb_window_t m_window = 0;
+    xcb_gcontext_t m_gc = 0;
+    uint8_t m_depth = 24;
+    uint8_t m_completionEvent = 0;
+    std::vector<std::unique_ptr<XcbBuffer>> m_buffers;  // 地址稳定（完成事件按段查找）
+};
+
+X11ShmPresenter::~X11ShmPresenter()
+{
+    QCoreApplication::instance()->removeNativeEventFilter(this);
+    for (auto &buffer : m_buffers) {
+        destroyBuffer(*buffer);
+    }
+    if (m_gc) {
+        xcb_free_gc(m_conn, m_gc);
+    }
+    xcb_flush(m_conn);
+}
+
+bool X11ShmPresenter::init()
+{
+    // 检查 MIT-SHM 扩展（远程 X 连接不可用）
+    xcb_shm_query_version_reply_t *version =
+        xcb_shm_query_version_reply(m_conn, xcb_shm_query_version(m_conn), nullptr);
+    if (!version) {
+        qWarning() << "X 服务器不支持 MIT-SHM";
+        return false;
+    }
+    free(version);
+
+    const xcb_query_extension_reply_t *ext = xcb_get_extension_data(m_conn, &xcb_shm_id);
+    if (!ext || !ext->present) return false;
+    m_completionEvent = ext->first_event + XCB_SHM_COMPLETION;
+
+    // ZPixmap 深度必须与窗口一致（24/32 位 TrueColor 与 QImage::Format_RGB32 内存布局相同）
+    xcb_get_geometry_reply_t *geometry =
+        xcb_get_geometry_reply(m_conn, xcb_get_geometry(m_conn, m_window), nullptr);
+    if (!geometry) return false;
+    m_depth = geometry->depth;
+    free(geometry);
+    if (m_depth != 24 && m_depth != 32) {
+        qWarning() << "MIT-SHM 不支持的窗口深度:" << m_depth;
+        return false;
+    }
+
+    m_gc = xcb_generate_id(m_conn);
+    xcb_create_gc(m_conn, m_gc, m_window, 0, nullptr);
+
+    QCoreApplication::instance()->installNativeEventFilter(this);
+    return true;
+}
+
+bool X11ShmPresenter::createBuffer(XcbBuffer &buffer, const QSize &size)
+{
+    const int stride = size.width() * 4;
+    buffer.shmId = shmget(IPC_PRIVATE, static_cast<size_t>(stride) * size.height(), IPC_CREAT | 0600);
+    if (buffer.shmId < 0) {
+        qWarning() << "shmget 失败:" << size;
+        return false;
+    }
+
+    void *addr = shmat(buffer.shmId, nullptr, 0);
+    if (addr == reinterpret_cast<void*>(-1)) {
+        shmctl(buffer.shmId, IPC_RMID, nullptr);
+        buffer.shmId = -1;
+        return false;
+    }
+
+    buffer.seg = xcb_generate_id(m_conn);
+    xcb_generic_error_t *error =
+        xcb_request_check(m_conn, xcb_shm_attach_checked(m_conn, buffer.seg, buffer.shmId, 0));
+
+    // 服务器已 attach，立即标记删除，进程退出时段自动回收
+    shmctl(buffer.shmId, IPC_RMID, nullptr);
+
+    if (error) {
+        free(error);
+        shmdt(addr);
+        buffer.shmId = -1;
+        buffer.seg = 0;
+        qWarning() << "xcb_shm_attach 失败";
+        return false;
+    }
+
+    buffer.data = static_cast<uchar*>(addr);
+    buffer.stride = stride;
+    buffer.size = size;
+    buffer.busy = false;
+    buffer.lastVideoRect = QRect();
+    return true;
+}
+
+void X11ShmPresenter::destroyBuffer(XcbBuffer &buffer)
+{
+    if (buffer.seg) {
+        xcb_shm_detach(m_conn, buffer.seg);
+        buffer.seg = 0;
+    }
+    if (buffer.data) {
+        shmdt(buffer.data);
+        buffer.data = nullptr;
+    }
+    buffer.shmId = -1;
+    buffer.size = QSize();
+    buffer.busy = false;
+}
+
+ShmPresenter::ShmBuffer *X11ShmPresenter::acquireBuffer(const QSize &size)
+{
+    // 忙碌的缓冲区服务器可能仍在读取，只有完成事件能归还；提前复用会撕裂画面
+    qint64 newestBusyMs = BUSY_TIMEOUT_MS + 1;
+    for (auto &buffer : m_buffers) {
+        if (buffer->busy) {
+            newestBusyMs = qMin(newestBusyMs, buffer->submitted.elapsed());
+            continue;
+        }
+        if (buffer->size != size) {
+            destroyBuffer(*buffer);
+            if (!createBuffer(*buffer, size)) return nullptr;
+        }
+        return buffer.get();
+    }
+
+    // 全部在服务器手中：完成事件迟迟不来时追加一个，达到上限后跳过本帧
+    if (!shouldAddBuffer(int(m_buffers.size()), newestBusyMs)) return nullptr;
+    auto buffer = std::make_unique<XcbBuffer>();
+    if (!createBuffer(*buffer, size)) return nullptr;
+    if (m_buffers.size() >= BUFFER_COUNT) {
+        qDebug() << "[MIT-SHM] 完成事件延迟，追加缓冲区:" << m_buffers.size() + 1;
+    }
+    m_buffers.push_back(std::move(buffer));
+    return m_buffers.back().get();
+}
+
+void X11ShmPresenter::submitBuffer(ShmBuffer *buffer, const QRect &damage)
+{
+    auto *xcbBuffer = static_cast<XcbBuffer*>(buffer);
+    xcb_shm_put_image(m_conn, m_window, m_gc,
+                      buffer->size.width(), buffer->size.height(),
+                      damage.x(), damage.y(), damage.width(), damage.height(),
+                      damage.x(), damage.y(),
+                      m_depth, XCB_IMAGE_FORMAT_Z_PIXMAP,
+                      1 /* send_event：完成后通知 */, xcbBuffer->seg, 0);
+    xcb_flush(m_conn);
+}
+
+bool X11ShmPresenter::nativeEventFilter(const QByteArray &eventType, void *message, qintptr *result)
+{
+    Q_UNUSED(result)
+    if (eventType != "xcb_generic_event_t") return false;
+
+    auto *event = static_cast<xcb_generic_event_t*>(message);
+    if ((event->response_type & 0x7f) != m_completionEvent) return false;
+
+    auto *completion = reinterpret_cast<xcb_shm_completion_event_t*>(event);
+    if (completion->drawable != m_window) return false;
+
+    for (auto &buffer : m_buffers) {
+        if (buffer->seg == completion->shmseg) {
+            buffer->busy = false;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::unique_ptr<ShmPresenter> createX11ShmPresenter(QWidget *widget)
+{
+    auto *x11 = qGuiApp->nativeInterface<QNativeInterface::QX11Application>();
+    if (!x11 || !x11->connection()) return nullptr;
+
+    // 需要原生子窗口，直接写入视频区域
+    const auto window = static_cast<xcb_window_t>(widget->winId());
+    auto presenter = std::make_unique<X11ShmPresenter>(x11->connection(), window);
+    if (!presenter->init()) return nullptr;
+    return presenter;
+}
+
+#endif // SHM_X11_AVAILABLE
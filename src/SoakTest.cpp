@@ -0,0 +1,328 @@
+/**
+ * @file SoakTest.cpp
+ * @brief 加速浸泡测试实现
+ */
+
+#include "SoakTest.h"
+#include "FFmpegPlayer.h"
+#include "MetricsExporter.h"
+#include "ProcessStats.h"
+#include "SyntheticClip.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <memory>
+
+#if FFMPEG_AVAILABLE
+
+namespace {
+
+static constexpr int CLIP_FPS = 24;
+static constexpr int CLIP_FRAMES = 12;              // 0.5 秒
+static constexpr int SAMPLE_INTERVAL = 50;          // 每 50 次循环采样一次
+static constexpr int REOPEN_INTERVAL = 25;          // 每 25 次循环走一次 closeFile/openFile
+static constexpr qint64 LOOP_TIMEOUT_MS = 10000;
+
+// 增长趋势判定：按采样序列线性回归，折算到每 1000 次循环
+static constexpr double RSS_LIMIT_PER_1000 = 2.0 * 1024 * 1024;
+static constexpr double HEAP_LIMIT_PER_1000 = 1.0 * 1024 * 1024;
+static constexpr double MEMORY_NOISE_BYTES = 512.0 * 1024;     // 全程增长小于此值视为噪声
+static constexpr int HANDLE_NOISE = 1;
+
+struct Sample {
+    int loop = 0;
+    qint64 elapsedMs = 0;
+    ProcessStats process;
+    PlaybackMetricsSnapshot metrics;
+    double maxSeamMs = 0;           ///< 本周期最大接缝耗时（上一轮末帧 → 下一轮首帧）
+    double maxPtsResetError = 0;    ///< 本周期每轮首帧 PTS 与第一轮的最大偏差（秒）
+    double avOffset = 0;            ///< 最近一轮音频首块与视频首帧的 PTS 差（秒）
+};
+
+/**
+ * @brief 最小二乘斜率（每次循环的增量）
+ */
+double slopePerLoop(const QList<Sample> &samples, const std::function<double(const Sample &)> &value)
+{
+    const int n = samples.size();
+    if (n < 2) return 0;
+    double meanX = 0, meanY = 0;
+    for (const Sample &s : samples) {
+        meanX += s.loop;
+        meanY += value(s);
+    }
+    meanX /= n;
+    meanY /= n;
+    double num = 0, den = 0;
+    for (const Sample &s : samples) {
+        num += (s.loop - meanX) * (value(s) - meanY);
+        den += (s.loop - meanX) * (s.loop - meanX);
+    }
+    return den > 0 ? num / den : 0;
+}
+
+/**
+ * @brief 内存类指标的趋势检查
+ * @return 失败描述，通过时为空
+ */
+QString checkMemoryTrend(const QList<Sample> &samples, const char *name, double limitPer1000,
+                         const std::function<double(const Sample &)> &value)
+{
+    if (value(samples.first()) < 0) return QString();   // 平台不支持
+    const double slope = slopePerLoop(samples, value);
+    const double span = samples.last().loop - samples.first().loop;
+    if (slope * 1000 > limitPer1000 && slope * span > MEMORY_NOISE_BYTES) {
+        return QString("%1 持续增长: %2 KB / 1000 次循环").arg(name).arg(slope * 1000 / 1024, 0, 'f', 1);
+    }
+    return QString();
+}
+
+QString checkHandleTrend(const QList<Sample> &samples, const char *name,
+                         const std::function<int(const Sample &)> &value)
+{
+    if (value(samples.first()) < 0) return QString();
+    const int growth = value(samples.last()) - value(samples.first());
+    if (growth > HANDLE_NOISE && slopePerLoop(samples, [&](const Sample &s) { return double(value(s)); }) > 0) {
+        return QString("%1 增长: %2 → %3").arg(name).arg(value(samples.first())).arg(value(samples.last()));
+    }
+    return QString();
+}
+
+void logSample(const Sample &s, QTextStream *csv)
+{
+    qDebug().noquote() << QString("[浸泡] 循环 %1  RSS %2 MB  堆 %3 MB  记账 %4 MB  fd %5  线程 %6  队列高水位 %7/%8  接缝 %9 ms  A/V %10 ms")
+        .arg(s.loop)
+        .arg(s.process.rssBytes / 1048576.0, 0, 'f', 1)
+        .arg(s.process.heapBytes / 1048576.0, 0, 'f', 1)
+        .arg(s.metrics.memory.total / 1048576.0, 0, 'f', 1)
+        .arg(s.process.openFiles)
+        .arg(s.process.threads)
+        .arg(s.metrics.videoQueueHighWater)
+        .arg(s.metrics.audioQueueHighWater)
+        .arg(s.maxSeamMs, 0, 'f', 2)
+        .arg(s.avOffset * 1000, 0, 'f', 2);
+
+    if (csv) {
+        *csv << s.loop << ',' << s.elapsedMs << ','
+             << s.process.rssBytes << ',' << s.process.heapBytes << ','
+             << s.metrics.memory.total << ',' << s.metrics.memory.totalHighWater << ','
+             << s.process.openFiles << ',' << s.process.threads << ','
+             << s.metrics.videoQueueHighWater << ',' << s.metrics.audioQueueHighWater << ','
+             << s.maxSeamMs << ',' << s.maxPtsResetError << ',' << s.avOffset << '\n';
+        csv->flush();
+    }
+}
+
+} // namespace
+
+int SoakTest::run(int loops, const QString &logPath, MetricsExporter *exporter)
+{
+    if (loops <= 0) {
+        qCritical() << "循环次数无效:" << loops;
+        return 1;
+    }
+
+    QTemporaryDir clipDir;
+    SyntheticClipSpec spec;
+    spec.name = "soak";
+    spec.width = 320;
+    spec.height = 180;
+    spec.frames = CLIP_FRAMES;
+    spec.fps = CLIP_FPS;
+    spec.codec = AV_CODEC_ID_MPEG4;
+    spec.audio = true;
+    const QString path = clipDir.filePath(QStringLiteral("soak.nut"));
+    if (!clipDir.isValid() || !SyntheticClip::write(spec, path)) {
+        qCritical() << "生成浸泡测试片段失败";
+        return 1;
+    }
+
+    QFile logFile(logPath);
+    std::unique_ptr<QTextStream> csv;
+    if (!logPath.isEmpty()) {
+        if (!logFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            qCritical() << "无法写入浸泡日志:" << logPath;
+            return 1;
+        }
+        csv = std::make_unique<QTextStream>(&logFile);
+        *csv << "loop,elapsed_ms,rss_bytes,heap_bytes,accounted_bytes,accounted_high_water,open_files,threads,"
+                "video_queue_high_water,audio_queue_high_water,max_seam_ms,max_pts_reset_error_s,av_offset_s\n";
+    }
+
+    DecodeThread decoder;
+    if (!decoder.openFile(path)) {
+        qCritical() << "无法打开浸泡测试片段";
+        return 1;
+    }
+
+    QElapsedTimer total;
+    total.start();
+    QElapsedTimer loopTimer;
+    loopTimer.start();
+    QElapsedTimer seamTimer;      // 上一轮最后一帧出队后开始计时
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    double firstPtsReference = nan;
+    double avOffsetReference = nan;
+    double loopFirstVideoPts = nan;
+    double loopFirstAudioPts = nan;
+    double maxAvDrift = 0;
+    double maxPtsResetError = 0;
+    double maxSeamMs = 0;
+    int loopFrames = 0;
+
+    Sample current;
+    QList<Sample> samples;
+    QStringList failures;
+
+    if (exporter) {
+        exporter->addSource(QStringLiteral("soak"), &decoder.metrics());
+    }
+    decoder.startDecoding();
+
+    int loop = 0;
+    while (loop < loops) {
+        VideoFrame videoFrame;
+        AudioFrame audioFrame;
+        bool progressed = false;
+
+        while (decoder.getVideoFrame(videoFrame)) {
+            progressed = true;
+            if (loopFrames == 0) {
+                loopFirstVideoPts = videoFrame.pts;
+                if (seamTimer.isValid()) {
+                    current.maxSeamMs = qMax(current.maxSeamMs, seamTimer.nsecsElapsed() / 1e6);
+                }
+            }
+            loopFrames++;
+            decoder.metrics().addPresentedFrame(videoFrame.pts);   // 测试本身即呈现端
+        }
+        while (decoder.getAudioFrame(audioFrame)) {
+            progressed = true;
+            if (std::isnan(loopFirstAudioPts)) loopFirstAudioPts = audioFrame.pts;
+        }
+
+        if (!progressed && decoder.isFinished()) {
+            // 线程结束后再取一次，避免漏掉最后入队的帧
+            if (decoder.getVideoFrame(videoFrame) || decoder.getAudioFrame(audioFrame)) {
+                continue;
+            }
+
+            if (loopFrames == 0) {
+                failures << QString("第 %1 次循环没有输出视频帧").arg(loop);
+                break;
+            }
+
+            // 每轮首帧 PTS 应与第一轮一致（循环复位正确）
+            if (std::isnan(firstPtsReference)) firstPtsReference = loopFirstVideoPts;
+            const double resetError = std::abs(loopFirstVideoPts - firstPtsReference);
+            current.maxPtsResetError = qMax(current.maxPtsResetError, resetError);
+            maxPtsResetError = qMax(maxPtsResetError, resetError);
+
+            // 音视频起始偏移不应随循环漂移
+            if (!std::isnan(loopFirstAudioPts)) {
+                current.avOffset = loopFirstAudioPts - loopFirstVideoPts;
+                if (std::isnan(avOffsetReference)) avOffsetReference = current.avOffset;
+                maxAvDrift = qMax(maxAvDrift, std::abs(current.avOffset - avOffsetReference));
+            }
+            maxSeamMs = qMax(maxSeamMs, current.maxSeamMs);
+
+            loop++;
+            loopFrames = 0;
+            loopFirstVideoPts = nan;
+            loopFirstAudioPts = nan;
+
+            if (loop % SAMPLE_INTERVAL == 0 || loop == loops) {
+                current.loop = loop;
+                current.elapsedMs = total.elapsed();
+                current.process = ProcessStats::sample();
+                current.metrics = decoder.metrics().snapshot();
+                decoder.metrics().resetHighWater();
+                logSample(current, csv.get());
+                samples.append(current);
+                current = Sample();
+            }
+            if (loop >= loops) break;
+
+            // 与 FFmpegPlayer 相同的循环方式；定期完整关闭并重新打开
+            if (loop % REOPEN_INTERVAL == 0) {
+                decoder.closeFile();
+                if (!decoder.openFile(path)) {
+                    failures << QString("第 %1 次循环重新打开失败").arg(loop);
+                    break;
+                }
+            } else {
+                decoder.seekTo(0);
+            }
+            seamTimer.start();
+            loopTimer.restart();
+            decoder.startDecoding();
+            continue;
+        }
+
+        if (loopTimer.elapsed() > LOOP_TIMEOUT_MS) {
+            failures << QString("第 %1 次循环超时（解码线程卡住）").arg(loop);
+            break;
+        }
+        if (!progressed) {
+            QThread::usleep(200);
+        }
+    }
+
+    decoder.stopDecoding();
+    decoder.closeFile();
+
+    // 前 1/4 采样视为预热（分配器、缓存达到稳态），不参与趋势判断
+    const QList<Sample> steady = samples.mid(samples.size() / 4);
+    if (steady.size() >= 3) {
+        failures << checkMemoryTrend(steady, "RSS", RSS_LIMIT_PER_1000,
+                                     [](const Sample &s) { return double(s.process.rssBytes); });
+        failures << checkMemoryTrend(steady, "堆", HEAP_LIMIT_PER_1000,
+                                     [](const Sample &s) { return double(s.process.heapBytes); });
+        failures << checkHandleTrend(steady, "文件描述符",
+                                     [](const Sample &s) { return s.process.openFiles; });
+        failures << checkHandleTrend(steady, "线程",
+                                     [](const Sample &s) { return s.process.threads; });
+    } else {
+        qWarning() << "采样点不足，跳过趋势判断（至少需要" << SAMPLE_INTERVAL * 4 << "次循环）";
+    }
+
+    const double frameDuration = 1.0 / CLIP_FPS;
+    if (maxPtsResetError > frameDuration / 2) {
+        failures << QString("循环后首帧 PTS 漂移 %1 ms").arg(maxPtsResetError * 1000, 0, 'f', 2);
+    }
+    if (maxAvDrift > frameDuration) {
+        failures << QString("音视频起始偏移漂移 %1 ms").arg(maxAvDrift * 1000, 0, 'f', 2);
+    }
+    failures.removeAll(QString());
+
+    if (exporter) {
+        exporter->removeSource(&decoder.metrics());
+    }
+    qDebug().noquote() << QString("[浸泡] 完成 %1 次循环，用时 %2 s，最大接缝 %3 ms")
+        .arg(loop).arg(total.elapsed() / 1000.0, 0, 'f', 1).arg(maxSeamMs, 0, 'f', 2);
+    for (const QString &failure : failures) {
+        qWarning().noquote() << "[浸泡失败]" << failure;
+    }
+    return failures.isEmpty() ? 0 : 1;
+}
+
+#else
+
+int SoakTest::run(int loops, const QString &logPath, MetricsExporter *exporter)
+{
+    Q_UNUSED(loops)
+    Q_UNUSED(logPath)
+    Q_UNUSED(exporter)
+    qCritical("此版本未启用 FFmpeg，无法运行浸泡测试");
+    return 1;
+}
+
+#endif
@@ -0,0 +1,38 @@
+/**
+ * @file SoakTest.h
+ * @brief 加速浸泡测试（长时间循环播放）
+ *
+ * 用短参考片段（MPEG4 + PCM 音频）以最快速度循环解码、不输出画面，
+ * 几分钟内跑完数千次循环，周期性记录：
+ * - 常驻内存、堆、文件描述符、线程数
+ * - 音视频队列高水位
+ * - 循环接缝耗时、每轮首帧 PTS、音视频起始偏移
+ *
+ * 采样序列有增长趋势（泄漏）或接缝 PTS / 音视频偏移漂移时以非 0 退出码结束。
+ * 每隔若干次循环执行一次 closeFile/openFile，覆盖关闭路径。
+ *
+ * 用法：
+ *   LoopVideoPlayer --soak 5000 [--soak-log soak.csv] [--metrics 9464]
+ */
+
+#ifndef SOAKTEST_H
+#define SOAKTEST_H
+
+#include <QString>
+
+class MetricsExporter;
+
+namespace SoakTest {
+
+/**
+ * @brief 运行浸泡测试
+ * @param loops 循环次数
+ * @param logPath 采样 CSV 输出路径，为空时只打印日志
+ * @param exporter 不为空时把解码器指标登记到指标端点（CI 中边跑边抓取）
+ * @return 进程退出码：0 表示无泄漏趋势与漂移
+ */
+int run(int loops, const QString &logPath, MetricsExporter *exporter = nullptr);
+
+} // namespace SoakTest
+
+#endif // SOAKTEST_H
@@ -0,0 +1,168 @@
+/**
+ * @file SoftwareRenderer.cpp
+ * @brief 软件渲染器实现
+ */
+
+#include "SoftwareRenderer.h"
+#include "VideoWidget.h"
+
+#include <QDebug>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QPainter>
+#include <QVBoxLayout>
+
+SoftwareRenderer::SoftwareRenderer(QWidget *parent)
+    : VideoRendererBase(parent)
+    , m_video(new VideoWidget(this))
+{
+    auto *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(m_video);
+
+    connect(m_video, &VideoWidget::fileLoaded, this, &VideoRendererBase::fileLoaded);
+    connect(m_video, &VideoWidget::durationChanged, this, &VideoRendererBase::durationChanged);
+    connect(m_video, &VideoWidget::positionChanged, this, &VideoRendererBase::positionChanged);
+    connect(m_video, &VideoWidget::playbackStateChanged, this, &VideoRendererBase::playbackStateChanged);
+    connect(m_video, &VideoWidget::firstFrameShown, this, &VideoRendererBase::firstFrameShown);
+    connect(m_video, &VideoWidget::endOfFile, this, &VideoRendererBase::endOfFile);
+    connect(m_video, &VideoWidget::errorOccurred, this, &VideoRendererBase::errorOccurred);
+}
+
+SoftwareRenderer::~SoftwareRenderer() = default;
+
+// ============================================================================
+// 播放控制（转发给 VideoWidget / FFmpegPlayer）
+// ============================================================================
+
+bool SoftwareRenderer::openFile(const QString &filename)
+{
+    m_currentFile = filename;
+    m_video->setLoop(m_loop);
+    m_video->setVolume(m_volume);
+    return m_video->openFile(filename);
+}
+
+void SoftwareRenderer::closeFile()
+{
+    m_video->stop();
+    m_currentFile.clear();
+}
+
+void SoftwareRenderer::play()
+{
+    m_video->play();
+}
+
+void SoftwareRenderer::pause()
+{
+    m_video->pause();
+}
+
+void SoftwareRenderer::stop()
+{
+    m_video->stop();
+}
+
+void SoftwareRenderer::togglePause()
+{
+    m_video->togglePause();
+}
+
+void SoftwareRenderer::seek(double seconds)
+{
+    m_video->seek(seconds);
+}
+
+void SoftwareRenderer::setVolume(int volume)
+{
+    m_volume = volume;
+    m_video->setVolume(volume);
+}
+
+void SoftwareRenderer::setLoop(bool loop)
+{
+    m_loop = loop;
+    m_video->setLoop(loop);
+}
+
+int SoftwareRenderer::volume() const
+{
+    return m_video->volume();
+}
+
+double SoftwareRenderer::duration() const
+{
+    return m_video->duration();
+}
+
+double SoftwareRenderer::position() const
+{
+    return m_video->position();
+}
+
+bool SoftwareRenderer::isPlaying() const
+{
+    return m_video->isPlaying();
+}
+
+bool SoftwareRenderer::isPaused() const
+{
+    return m_video->isPaused();
+}
+
+PlaybackMetrics *SoftwareRenderer::metrics()
+{
+    return &m_video->metrics();
+}
+
+QImage SoftwareRenderer::grabFrame()
+{
+    // 共享内存呈现绕过 backing store，widget 截图里没有视频，直接用当前帧合成
+    const QImage frame = m_video->currentFrame();
+    if (frame.isNull()) return QImage();
+
+    const qreal dpr = devicePixelRatioF();
+    QImage image(size() * dpr, QImage::Format_RGB32);
+    image.fill(QColor(26, 26, 46));
+    QPainter painter(&image);
+    painter.drawImage((image.width() - frame.width()) / 2, (image.height() - frame.height()) / 2, frame);
+    return image;
+}
+
+QString SoftwareRenderer::rendererName() const
+{
+    return QStringLiteral("Software (%1)").arg(m_video->presenterName());
+}
+
+// ============================================================================
+// 硬件 OpenGL 检测
+// ============================================================================
+
+bool SoftwareRenderer::lacksHardwareOpenGL()
+{
+    static const bool lacks = []() {
+        QOffscreenSurface surface;
+        surface.create();
+        QOpenGLContext context;
+        if (!context.create() || !context.makeCurrent(&surface)) {
+            qDebug() << "[渲染器] 无法创建 OpenGL 上下文";
+            return true;
+        }
+        const auto *renderer = reinterpret_cast<const char *>(context.functions()->glGetString(GL_RENDERER));
+        const QString name = QString::fromLatin1(renderer ? renderer : "");
+        context.doneCurrent();
+
+        // Mesa 的软件光栅器：RHI 的着色器管线在 CPU 上运行，比直接写共享内存更慢
+        static const char *const SOFTWARE_RASTERIZERS[] = { "llvmpipe", "softpipe", "swrast", "Software Rasterizer" };
+        for (const char *software : SOFTWARE_RASTERIZERS) {
+            if (name.contains(QLatin1String(software), Qt::CaseInsensitive)) {
+                qDebug() << "[渲染器] 只有软件 OpenGL:" << name;
+                return true;
+            }
+        }
+        return false;
+    }();
+    return lacks;
+}
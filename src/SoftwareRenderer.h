@@ -0,0 +1,59 @@
+/**
+ * @file SoftwareRenderer.h
+ * @brief 软件渲染器：FFmpegPlayer 解码 + 共享内存 / QPainter 呈现（无 GPU 的 Linux 瘦客户端）
+ *
+ * 把 VideoWidget 包装为 VideoRendererBase，使 FloatingVideoPlayer 等按工厂创建渲染器的调用方
+ * 也能走 MIT-SHM / wl_shm 路径：解码线程直接缩放到显示尺寸，帧写入显示服务器的共享内存缓冲区，
+ * 共享内存不可用时回退到 QPainter。
+ *
+ * 由 createVideoRenderer 在 LOOP_RENDERER=shm 或没有硬件 OpenGL（只有 llvmpipe 等软件光栅器）时创建。
+ * 几何变换、排期预加载、帧缓存与帧率上限等 GPU 渲染器的功能使用基类默认实现（忽略或冷切换）。
+ */
+
+#ifndef SOFTWARERENDERER_H
+#define SOFTWARERENDERER_H
+
+#include "VideoRendererBase.h"
+
+class VideoWidget;
+
+class SoftwareRenderer : public VideoRendererBase
+{
+    Q_OBJECT
+
+public:
+    explicit SoftwareRenderer(QWidget *parent = nullptr);
+    ~SoftwareRenderer() override;
+
+    bool openFile(const QString &filename) override;
+    void closeFile() override;
+    void play() override;
+    void pause() override;
+    void stop() override;
+    void togglePause() override;
+    void seek(double seconds) override;
+    void setVolume(int volume) override;
+    void setLoop(bool loop) override;
+
+    int volume() const override;
+    double duration() const override;
+    double position() const override;
+    bool isPlaying() const override;
+    bool isPaused() const override;
+
+    PlaybackMetrics *metrics() override;
+    QImage grabFrame() override;
+    QString rendererName() const override;
+
+    /**
+     * @brief 当前环境是否只有软件 OpenGL（或没有 OpenGL），此时 RHI 渲染器不值得使用
+     *
+     * 创建一次离屏上下文读取 GL_RENDERER，结果缓存；需在 QGuiApplication 创建之后调用
+     */
+    static bool lacksHardwareOpenGL();
+
+private:
+    VideoWidget *m_video = nullptr;
+};
+
+#endif // SOFTWARERENDERER_H
@@ -0,0 +1,150 @@
+/**
+ * @file StartupTimeline.cpp
+ * @brief 冷启动时间线实现
+ */
+
+#include "StartupTimeline.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+#include <algorithm>
+#include <atomic>
+
+#if defined(Q_OS_LINUX)
+#include <unistd.h>
+#elif defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+
+namespace {
+
+struct TimelineMark {
+    QByteArray stage;
+    double ms = 0;
+};
+
+struct TimelineState {
+    QMutex mutex;
+    QElapsedTimer clock;
+    double processOffsetMs = 0;     // main 入口距进程创建的时长
+    QVector<TimelineMark> marks;
+    std::atomic<bool> reported{false};  // 报告后 mark/firstFrame 不再加锁，可放在每帧路径上
+};
+
+TimelineState &state()
+{
+    static TimelineState instance;
+    return instance;
+}
+
+/**
+ * @brief 进程创建到现在的毫秒数，平台不支持时返回 -1
+ */
+double processAgeMs()
+{
+#if defined(Q_OS_LINUX)
+    // /proc/self/stat 第 22 列为启动时刻（开机后的时钟滴答），/proc/uptime 为开机秒数
+    QFile statFile(QStringLiteral("/proc/self/stat"));
+    QFile uptimeFile(QStringLiteral("/proc/uptime"));
+    if (!statFile.open(QIODevice::ReadOnly) || !uptimeFile.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    const QByteArray stat = statFile.readAll();
+    // 进程名可能含空格，从最后一个 ')' 之后开始数（其后第一列为第 3 列）
+    const int nameEnd = stat.lastIndexOf(')');
+    if (nameEnd < 0) return -1;
+    const QList<QByteArray> fields = stat.mid(nameEnd + 2).split(' ');
+    if (fields.size() <= 19) return -1;
+    const double startTicks = fields.at(19).toDouble();
+    const double uptime = uptimeFile.readAll().split(' ').first().toDouble();
+    const long ticksPerSecond = sysconf(_SC_CLK_TCK);
+    if (ticksPerSecond <= 0) return -1;
+    return (uptime - startTicks / ticksPerSecond) * 1000.0;
+#elif defined(Q_OS_WIN)
+    FILETIME creation, exitTime, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exitTime, &kernel, &user)) {
+        return -1;
+    }
+    FILETIME now;
+    GetSystemTimeAsFileTime(&now);
+    ULARGE_INTEGER c, n;
+    c.LowPart = creation.dwLowDateTime;
+    c.HighPart = creation.dwHighDateTime;
+    n.LowPart = now.dwLowDateTime;
+    n.HighPart = now.dwHighDateTime;
+    return static_cast<double>(n.QuadPart - c.QuadPart) / 10000.0;  // 100ns → ms
+#else
+    return -1;
+#endif
+}
+
+} // namespace
+
+void StartupTimeline::begin()
+{
+    TimelineState &s = state();
+    QMutexLocker locker(&s.mutex);
+    if (s.clock.isValid()) return;
+    s.clock.start();
+    // /proc 的精度为时钟滴答（通常 10ms），只用作起点偏移
+    s.processOffsetMs = qMax(0.0, processAgeMs());
+    s.marks.append({QByteArrayLiteral("main"), s.processOffsetMs});
+}
+
+double StartupTimeline::elapsedMs()
+{
+    TimelineState &s = state();
+    if (!s.clock.isValid()) return 0;
+    return s.processOffsetMs + s.clock.nsecsElapsed() / 1e6;
+}
+
+void StartupTimeline::mark(const char *stage)
+{
+    TimelineState &s = state();
+    if (s.reported.load(std::memory_order_relaxed)) return;
+    QMutexLocker locker(&s.mutex);
+    if (!s.clock.isValid()) return;
+    for (const TimelineMark &mark : s.marks) {
+        if (mark.stage == stage) return;
+    }
+    s.marks.append({QByteArray(stage), s.processOffsetMs + s.clock.nsecsElapsed() / 1e6});
+}
+
+void StartupTimeline::firstFrame()
+{
+    TimelineState &s = state();
+    if (s.reported.load(std::memory_order_relaxed)) return;
+    mark("first frame");
+    {
+        QMutexLocker locker(&s.mutex);
+        if (!s.clock.isValid() || s.reported.load(std::memory_order_relaxed)) return;
+        s.reported.store(true, std::memory_order_relaxed);
+    }
+    qDebug().noquote() << report();
+}
+
+QString StartupTimeline::report()
+{
+    TimelineState &s = state();
+    QMutexLocker locker(&s.mutex);
+
+    QVector<TimelineMark> marks = s.marks;
+    std::stable_sort(marks.begin(), marks.end(), [](const TimelineMark &a, const TimelineMark &b) {
+        return a.ms < b.ms;
+    });
+
+    QString text = QStringLiteral("冷启动时间线（距进程创建，毫秒）:");
+    double previous = 0;
+    for (const TimelineMark &mark : marks) {
+        text += QStringLiteral("\n  %1  (+%2)  %3")
+            .arg(mark.ms, 8, 'f', 1)
+            .arg(mark.ms - previous, 6, 'f', 1)
+            .arg(QString::fromLatin1(mark.stage));
+        previous = mark.ms;
+    }
+    return text;
+}
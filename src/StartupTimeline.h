@@ -0,0 +1,44 @@
+/**
+ * @file StartupTimeline.h
+ * @brief 冷启动时间线（进程启动 → 首帧上屏）
+ *
+ * 各初始化阶段调用 mark() 打点（任意线程），首帧上屏时调用 firstFrame()，
+ * 打印一次按时间排序的报告。时间原点为进程创建时刻（平台不支持时退化为 main 入口）。
+ */
+
+#ifndef STARTUPTIMELINE_H
+#define STARTUPTIMELINE_H
+
+#include <QString>
+#include <QtGlobal>
+
+class StartupTimeline
+{
+public:
+    /**
+     * @brief 在 main 入口调用，记录计时原点
+     */
+    static void begin();
+
+    /**
+     * @brief 记录一个阶段（同名只记录第一次）
+     */
+    static void mark(const char *stage);
+
+    /**
+     * @brief 首帧上屏：记录并打印报告（只生效一次）
+     */
+    static void firstFrame();
+
+    /**
+     * @brief 距进程创建的毫秒数
+     */
+    static double elapsedMs();
+
+    /**
+     * @brief 按时间排序的报告文本
+     */
+    static QString report();
+};
+
+#endif // STARTUPTIMELINE_H
@@ -0,0 +1,399 @@
+/**
+ * @file Storyboard.cpp
+ * @brief 故事板 / 联系表批量生成实现
+ */
+
+#include "Storyboard.h"
+#include "ProxyCache.h"
+#include "TaskGraph.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QImage>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QThread>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#if FFMPEG_AVAILABLE
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libswscale/swscale.h>
+}
+#endif
+
+#if FFMPEG_AVAILABLE
+
+namespace {
+
+static constexpr int CELL_WIDTH = 320;          // 格子宽度（像素），不超过视频宽度
+static constexpr int JPEG_QUALITY = 85;
+
+const char *const VIDEO_FILTERS[] = {
+    "*.mp4", "*.avi", "*.mkv", "*.mov", "*.wmv", "*.flv", "*.webm", "*.m4v", "*.ts",
+    "*.m2ts", "*.rmvb", "*.rm", "*.3gp", "*.mpg", "*.mpeg", "*.vob", "*.ogv", "*.mts", "*.nut",
+};
+
+struct Cell {
+    double target = 0;      ///< 目标时刻（秒，相对流起点）
+    double pts = -1;        ///< 实际解出的关键帧时刻，-1 表示失败
+    QImage image;
+};
+
+/**
+ * @brief 一个文件的故事板（各段写入互不重叠的格子，无需加锁）
+ */
+struct Sheet {
+    QString file;
+    QString input;          ///< 实际解码的文件：有全帧内代理时用代理，否则为源文件
+    double duration = 0;
+    double startTime = 0;
+    int videoIndex = -1;
+    int videoWidth = 0;
+    int videoHeight = 0;
+    int cellWidth = 0;
+    int cellHeight = 0;
+    std::vector<Cell> cells;
+    std::atomic<int> remaining{0};  ///< 尚未完成的段数，归零的段负责写盘
+};
+
+struct FormatCloser {
+    void operator()(AVFormatContext *ctx) const { avformat_close_input(&ctx); }
+};
+using FormatPtr = std::unique_ptr<AVFormatContext, FormatCloser>;
+
+FormatPtr openInput(const QString &file)
+{
+    AVFormatContext *ctx = nullptr;
+    if (avformat_open_input(&ctx, file.toUtf8().constData(), nullptr, nullptr) != 0) {
+        return nullptr;
+    }
+    FormatPtr input(ctx);
+    if (avformat_find_stream_info(ctx, nullptr) < 0) {
+        return nullptr;
+    }
+    return input;
+}
+
+QStringList collectFiles(const QStringList &inputs)
+{
+    QStringList filters;
+    for (const char *filter : VIDEO_FILTERS) {
+        filters << QString::fromLatin1(filter);
+    }
+
+    QStringList files;
+    for (const QString &input : inputs) {
+        const QFileInfo info(input);
+        if (info.isDir()) {
+            QStringList found;
+            QDirIterator it(info.absoluteFilePath(), filters, QDir::Files, QDirIterator::Subdirectories);
+            while (it.hasNext()) {
+                found << it.next();
+            }
+            found.sort();
+            files << found;
+        } else if (info.isFile()) {
+            files << info.absoluteFilePath();
+        } else {
+            qWarning() << "[故事板] 路径不存在:" << input;
+        }
+    }
+    return files;
+}
+
+/**
+ * @brief 解码一段格子 [first, last)：逐个跳转到目标时刻前的关键帧，只解关键帧并缩放到格子大小
+ */
+void decodeCells(Sheet &sheet, AVFormatContext *formatCtx, int first, int last)
+{
+    const AVStream *stream = formatCtx->streams[sheet.videoIndex];
+    const AVCodec *codec = avcodec_find_decoder(stream->codecpar->codec_id);
+    AVCodecContext *codecCtx = codec ? avcodec_alloc_context3(codec) : nullptr;
+    if (!codecCtx || avcodec_parameters_to_context(codecCtx, stream->codecpar) < 0) {
+        avcodec_free_context(&codecCtx);
+        return;
+    }
+    // 并行来自多个解码器实例，单个实例不再开帧线程
+    codecCtx->thread_count = 1;
+    codecCtx->skip_frame = AVDISCARD_NONKEY;
+    int lowres = 0;
+    while (lowres < codec->max_lowres && (sheet.videoWidth >> (lowres + 1)) >= sheet.cellWidth) {
+        lowres++;
+    }
+    codecCtx->lowres = lowres;
+    if (avcodec_open2(codecCtx, codec, nullptr) < 0) {
+        avcodec_free_context(&codecCtx);
+        return;
+    }
+
+    AVPacket *packet = av_packet_alloc();
+    AVFrame *frame = av_frame_alloc();
+    SwsContext *swsCtx = nullptr;
+    const double timeBase = av_q2d(stream->time_base);
+
+    for (int i = first; i < last; i++) {
+        Cell &cell = sheet.cells[i];
+        const int64_t ts = static_cast<int64_t>((cell.target + sheet.startTime) / timeBase);
+        if (av_seek_frame(formatCtx, sheet.videoIndex, ts, AVSEEK_FLAG_BACKWARD) < 0) {
+            continue;
+        }
+        avcodec_flush_buffers(codecCtx);
+
+        bool gotFrame = false;
+        bool draining = false;
+        while (!gotFrame) {
+            if (!draining) {
+                if (av_read_frame(formatCtx, packet) < 0) {
+                    avcodec_send_packet(codecCtx, nullptr);
+                    draining = true;
+                } else {
+                    // 非关键帧直接跳过，不进入解码器
+                    const bool key = packet->stream_index == sheet.videoIndex && (packet->flags & AV_PKT_FLAG_KEY);
+                    if (key) {
+                        avcodec_send_packet(codecCtx, packet);
+                    }
+                    av_packet_unref(packet);
+                    if (!key) continue;
+                }
+            }
+            const int ret = avcodec_receive_frame(codecCtx, frame);
+            if (ret == 0) {
+                gotFrame = true;
+            } else if (ret != AVERROR(EAGAIN) || draining) {
+                break;
+            }
+        }
+        if (!gotFrame) continue;
+
+        swsCtx = sws_getCachedContext(swsCtx,
+            frame->width, frame->height, static_cast<AVPixelFormat>(frame->format),
+            sheet.cellWidth, sheet.cellHeight, AV_PIX_FMT_BGRA,
+            SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if (swsCtx) {
+            QImage image(sheet.cellWidth, sheet.cellHeight, QImage::Format_RGB32);
+            uint8_t *dstData[4] = { image.bits(), nullptr, nullptr, nullptr };
+            int dstLinesize[4] = { static_cast<int>(image.bytesPerLine()), 0, 0, 0 };
+            sws_scale(swsCtx, frame->data, frame->linesize, 0, frame->height, dstData, dstLinesize);
+            cell.image = std::move(image);
+            cell.pts = frame->best_effort_timestamp != AV_NOPTS_VALUE
+                ? frame->best_effort_timestamp * timeBase - sheet.startTime : cell.target;
+        }
+        av_frame_unref(frame);
+    }
+
+    sws_freeContext(swsCtx);
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+    avcodec_free_context(&codecCtx);
+}
+
+/**
+ * @brief 拼图并写出 JPG 与 JSON 索引，随后释放格子图像
+ */
+bool writeSheet(Sheet &sheet, const QString &outputDir)
+{
+    const QFileInfo source(sheet.file);
+    const QString dir = outputDir.isEmpty() ? source.absolutePath() : outputDir;
+    const QString base = QDir(dir).filePath(source.fileName() + ".storyboard");
+
+    const int count = static_cast<int>(sheet.cells.size());
+    const int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(count))));
+    const int rows = (count + columns - 1) / columns;
+
+    QImage image(columns * sheet.cellWidth, rows * sheet.cellHeight, QImage::Format_RGB32);
+    image.fill(Qt::black);
+
+    QJsonArray frames;
+    int decoded = 0;
+    for (int i = 0; i < count; i++) {
+        Cell &cell = sheet.cells[i];
+        const int x = (i % columns) * sheet.cellWidth;
+        const int y = (i / columns) * sheet.cellHeight;
+        if (!cell.image.isNull()) {
+            const qsizetype rowBytes = qsizetype(sheet.cellWidth) * 4;
+            for (int line = 0; line < sheet.cellHeight; line++) {
+                std::memcpy(image.scanLine(y + line) + qsizetype(x) * 4, cell.image.constScanLine(line), rowBytes);
+            }
+            cell.image = QImage();
+            decoded++;
+        }
+
+        QJsonObject entry;
+        entry["index"] = i;
+        entry["target"] = cell.target;
+        entry["pts"] = cell.pts >= 0 ? QJsonValue(cell.pts) : QJsonValue();
+        entry["x"] = x;
+        entry["y"] = y;
+        frames.append(entry);
+    }
+    if (decoded == 0) {
+        qWarning() << "[故事板] 未解出任何关键帧:" << sheet.file;
+        return false;
+    }
+
+    if (!image.save(base + ".jpg", "JPG", JPEG_QUALITY)) {
+        qWarning() << "[故事板] 无法写入:" << base + ".jpg";
+        return false;
+    }
+
+    QJsonObject root;
+    root["file"] = sheet.file;
+    root["proxy"] = sheet.input != sheet.file;
+    root["image"] = QFileInfo(base + ".jpg").fileName();
+    root["duration"] = sheet.duration;
+    root["videoWidth"] = sheet.videoWidth;
+    root["videoHeight"] = sheet.videoHeight;
+    root["columns"] = columns;
+    root["rows"] = rows;
+    root["cellWidth"] = sheet.cellWidth;
+    root["cellHeight"] = sheet.cellHeight;
+    root["frames"] = frames;
+
+    QSaveFile index(base + ".json");
+    if (!index.open(QIODevice::WriteOnly)
+        || index.write(QJsonDocument(root).toJson(QJsonDocument::Indented)) < 0
+        || !index.commit()) {
+        qWarning() << "[故事板] 无法写入:" << base + ".json";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 一段完成：最后完成的段负责写盘
+ */
+void finishSlice(Sheet &sheet, const QString &outputDir, std::atomic<int> &failures)
+{
+    if (sheet.remaining.fetch_sub(1) != 1) return;
+    if (!writeSheet(sheet, outputDir)) {
+        failures++;
+    }
+    sheet.cells.clear();
+    sheet.cells.shrink_to_fit();
+}
+
+/**
+ * @brief 后续段：独立打开文件，解码分到的格子
+ */
+Task sliceTask(Sheet &sheet, int first, int last, const QString &outputDir, std::atomic<int> &failures)
+{
+    if (FormatPtr input = openInput(sheet.input)) {
+        decodeCells(sheet, input.get(), first, last);
+    }
+    finishSlice(sheet, outputDir, failures);
+    co_return;
+}
+
+/**
+ * @brief 第一段：探测文件、划分格子并派生其余各段，自身解码第一段
+ */
+Task sheetTask(TaskGroup &group, Sheet &sheet, int frames, int slices, const QString &outputDir,
+               std::atomic<int> &failures)
+{
+    FormatPtr input = openInput(sheet.input);
+    const int videoIndex = input ? av_find_best_stream(input.get(), AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0) : -1;
+    if (videoIndex < 0 || input->duration == AV_NOPTS_VALUE || input->duration <= 0
+        || input->streams[videoIndex]->codecpar->width < 2) {
+        qWarning() << "[故事板] 无法打开或时长未知:" << sheet.file;
+        failures++;
+        co_return;
+    }
+
+    const AVCodecParameters *codecpar = input->streams[videoIndex]->codecpar;
+    sheet.videoIndex = videoIndex;
+    sheet.duration = static_cast<double>(input->duration) / AV_TIME_BASE;
+    sheet.startTime = input->start_time != AV_NOPTS_VALUE ? static_cast<double>(input->start_time) / AV_TIME_BASE : 0;
+    sheet.videoWidth = codecpar->width;
+    sheet.videoHeight = codecpar->height;
+    sheet.cellWidth = qMin(CELL_WIDTH, sheet.videoWidth) & ~1;
+    sheet.cellHeight = qMax(2, static_cast<int>(std::lround(double(sheet.cellWidth) * sheet.videoHeight
+                                                            / qMax(1, sheet.videoWidth))) & ~1);
+    sheet.cells.resize(frames);
+    for (int i = 0; i < frames; i++) {
+        sheet.cells[i].target = sheet.duration * (i + 0.5) / frames;
+    }
+
+    // 每段是连续的一组格子，段内只做向前跳转
+    sheet.remaining = slices;
+    for (int s = 1; s < slices; s++) {
+        group.spawn(sliceTask(sheet, s * frames / slices, (s + 1) * frames / slices, outputDir, failures));
+    }
+    decodeCells(sheet, input.get(), 0, frames / slices);
+    input.reset();
+    finishSlice(sheet, outputDir, failures);
+    co_return;
+}
+
+} // namespace
+
+int Storyboard::run(int frames, const QStringList &inputs, const QString &outputDir)
+{
+    if (frames <= 0) {
+        qCritical() << "格子数无效:" << frames;
+        return 1;
+    }
+    if (!outputDir.isEmpty() && !QDir().mkpath(outputDir)) {
+        qCritical() << "无法创建输出目录:" << outputDir;
+        return 1;
+    }
+
+    const QStringList files = collectFiles(inputs);
+    if (files.isEmpty()) {
+        qCritical("未找到视频文件");
+        return 1;
+    }
+
+    // 批处理模式独占全部核心；文件少于核心数时把每个文件拆成多段
+    const int threads = qMax(1, QThread::idealThreadCount());
+    const int slices = qBound(1, threads / static_cast<int>(files.size()), frames);
+    qDebug() << "故事板:" << files.size() << "个文件，每个" << frames << "格，" << threads << "线程，每文件"
+             << slices << "段";
+
+    QElapsedTimer timer;
+    timer.start();
+    std::atomic<int> failures{0};
+    std::vector<std::unique_ptr<Sheet>> sheets;
+    sheets.reserve(files.size());
+    {
+        Executor executor(threads);
+        TaskGroup group(executor);
+        for (const QString &file : files) {
+            sheets.push_back(std::make_unique<Sheet>());
+            sheets.back()->file = file;
+            // 代理每帧都是关键帧，格子取到的就是目标时刻的帧
+            const QString proxy = ProxyCache::lookup(file);
+            sheets.back()->input = proxy.isEmpty() ? file : proxy;
+            group.spawn(sheetTask(group, *sheets.back(), frames, slices, outputDir, failures));
+        }
+        group.wait();
+    }
+
+    const double seconds = timer.elapsed() / 1000.0;
+    qDebug() << "故事板完成:" << files.size() - failures << "/" << files.size() << "个文件，用时" << seconds
+             << "秒（" << (seconds > 0 ? files.size() / seconds : 0) << "个/秒）";
+    return failures ? 1 : 0;
+}
+
+#else
+
+int Storyboard::run(int frames, const QStringList &inputs, const QString &outputDir)
+{
+    Q_UNUSED(frames)
+    Q_UNUSED(inputs)
+    Q_UNUSED(outputDir)
+    qCritical("此版本未启用 FFmpeg，无法生成故事板");
+    return 1;
+}
+
+#endif
@@ -0,0 +1,38 @@
+/**
+ * @file Storyboard.h
+ * @brief 故事板 / 联系表批量生成
+ *
+ * 为内容库中的循环片段批量生成预览：每个文件取 N 个均匀分布的时刻，
+ * 拼成一张网格图（JPG）并写出 JSON 索引（每格的目标时刻、实际 PTS 与位置）。
+ *
+ * - 每个文件按格子分成若干段，每段使用独立的 demuxer + 解码器实例，在专用执行器上跨核并行
+ * - 每段跳转到各目标时刻之前的关键帧，解码器只解关键帧（skip_frame = NONKEY），
+ *   支持 lowres 的解码器直接以低分辨率解码
+ * - 一个文件的最后一段完成后立即拼图写盘，内存只占用正在处理的文件
+ * - 已有全帧内代理（ProxyCache）的文件改为解码代理，每格都是目标时刻的帧
+ *
+ * 用法：
+ *   LoopVideoPlayer --storyboard 16 clip.mp4
+ *   LoopVideoPlayer --storyboard 16 --storyboard-out previews/ library/
+ */
+
+#ifndef STORYBOARD_H
+#define STORYBOARD_H
+
+#include <QString>
+#include <QStringList>
+
+namespace Storyboard {
+
+/**
+ * @brief 生成故事板
+ * @param frames 每个文件的格子数
+ * @param inputs 文件或目录（目录递归查找视频文件）
+ * @param outputDir 输出目录，为空时写在源文件旁边（<文件名>.storyboard.jpg / .json）
+ * @return 进程退出码：0 表示全部文件成功
+ */
+int run(int frames, const QStringList &inputs, const QString &outputDir);
+
+} // namespace Storyboard
+
+#endif // STORYBOARD_H
@@ -0,0 +1,278 @@
+/**
+ * @file SyntheticClip.cpp
+ * @brief 参考片段生成实现
+ */
+
+#include "SyntheticClip.h"
+
+#include <QDebug>
+#include <cmath>
+#include <cstring>
+
+#if FFMPEG_AVAILABLE
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavutil/channel_layout.h>
+}
+
+namespace {
+
+static constexpr int AUDIO_SAMPLE_RATE = 44100;
+static constexpr int AUDIO_FRAME_SAMPLES = 1024;
+static constexpr double AUDIO_TONE_HZ = 440.0;
+static constexpr double TWO_PI = 6.283185307179586;
+
+/**
+ * @brief 输出流：编码器 + 容器流
+ */
+struct OutputStream {
+    AVCodecContext *enc = nullptr;
+    AVStream *stream = nullptr;
+    AVFrame *frame = nullptr;
+    int64_t nextPts = 0;
+};
+
+void closeStream(OutputStream &output)
+{
+    av_frame_free(&output.frame);
+    avcodec_free_context(&output.enc);
+}
+
+bool writePackets(OutputStream &output, AVFormatContext *oc, AVPacket *packet)
+{
+    int ret = 0;
+    while ((ret = avcodec_receive_packet(output.enc, packet)) >= 0) {
+        av_packet_rescale_ts(packet, output.enc->time_base, output.stream->time_base);
+        packet->stream_index = output.stream->index;
+        if (av_interleaved_write_frame(oc, packet) < 0) {
+            return false;
+        }
+    }
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF;
+}
+
+bool switchesSize(const SyntheticClipSpec &spec, const AVCodec *codec)
+{
+    return spec.switchFrame > 0 && spec.switchFrame < spec.frames
+        && codec->id != AV_CODEC_ID_RAWVIDEO;
+}
+
+bool isHls(const SyntheticClipSpec &spec)
+{
+    return std::strcmp(spec.container, "hls") == 0;
+}
+
+/**
+ * @brief 按指定尺寸打开视频编码器并分配输入帧（中途切换尺寸时重复调用）
+ */
+bool openVideoEncoder(const SyntheticClipSpec &spec, const AVCodec *codec, int width, int height,
+                      bool globalHeader, OutputStream &output)
+{
+    output.enc = avcodec_alloc_context3(codec);
+    if (!output.enc) return false;
+
+    output.enc->width = width;
+    output.enc->height = height;
+    output.enc->pix_fmt = spec.format;
+    output.enc->time_base = AVRational{ 1, spec.fps };
+    output.enc->framerate = AVRational{ spec.fps, 1 };
+    output.enc->gop_size = spec.fps;
+    if (codec->id != AV_CODEC_ID_RAWVIDEO) {
+        // 有损编码器只支持 YUV420P；质量固定，保证每次生成结果相同
+        output.enc->pix_fmt = AV_PIX_FMT_YUV420P;
+        output.enc->flags |= AV_CODEC_FLAG_QSCALE;
+        output.enc->global_quality = FF_QP2LAMBDA * 3;
+        output.enc->thread_count = 1;
+    }
+    if (globalHeader) {
+        output.enc->flags |= AV_CODEC_FLAG_GLOBAL_HEADER;
+    }
+    if (avcodec_open2(output.enc, codec, nullptr) < 0) {
+        return false;
+    }
+
+    av_frame_free(&output.frame);
+    output.frame = av_frame_alloc();
+    if (!output.frame) return false;
+    output.frame->format = output.enc->pix_fmt;
+    output.frame->width = width;
+    output.frame->height = height;
+    return av_frame_get_buffer(output.frame, 0) >= 0;
+}
+
+bool openVideo(const SyntheticClipSpec &spec, AVFormatContext *oc, OutputStream &output)
+{
+    const AVCodec *codec = avcodec_find_encoder(spec.codec);
+    if (!codec) {
+        qWarning() << "参考片段: 编码器不可用，回退到 rawvideo:" << avcodec_get_name(spec.codec);
+        codec = avcodec_find_encoder(AV_CODEC_ID_RAWVIDEO);
+    }
+    if (spec.switchFrame > 0 && codec && !switchesSize(spec, codec)) {
+        qWarning() << "参考片段: 当前编码器不支持中途切换尺寸，忽略切换:" << spec.name;
+    }
+    output.stream = codec ? avformat_new_stream(oc, nullptr) : nullptr;
+    if (!output.stream) return false;
+
+    // 切换尺寸时参数集必须在码流内，解码器才能在切换点看到新尺寸；HLS 每个分片都要能独立解码
+    const bool globalHeader = (oc->oformat->flags & AVFMT_GLOBALHEADER)
+                              && !switchesSize(spec, codec) && !isHls(spec);
+    if (!openVideoEncoder(spec, codec, spec.width, spec.height, globalHeader, output)
+        || avcodec_parameters_from_context(output.stream->codecpar, output.enc) < 0) {
+        return false;
+    }
+    output.stream->time_base = output.enc->time_base;
+    return true;
+}
+
+/**
+ * @brief 在切换帧处排空旧编码器，按新尺寸重开（时间基不变，pts 连续）
+ */
+bool reopenVideo(const SyntheticClipSpec &spec, AVFormatContext *oc, OutputStream &output, AVPacket *packet)
+{
+    const AVCodec *codec = output.enc->codec;
+    if (avcodec_send_frame(output.enc, nullptr) < 0 || !writePackets(output, oc, packet)) {
+        return false;
+    }
+    avcodec_free_context(&output.enc);
+    return openVideoEncoder(spec, codec, spec.switchWidth, spec.switchHeight, false, output);
+}
+
+bool openAudio(AVFormatContext *oc, OutputStream &output)
+{
+    const AVCodec *codec = avcodec_find_encoder(AV_CODEC_ID_PCM_S16LE);
+    output.stream = codec ? avformat_new_stream(oc, nullptr) : nullptr;
+    output.enc = codec ? avcodec_alloc_context3(codec) : nullptr;
+    if (!output.stream || !output.enc) return false;
+
+    output.enc->sample_fmt = AV_SAMPLE_FMT_S16;
+    output.enc->sample_rate = AUDIO_SAMPLE_RATE;
+    output.enc->time_base = AVRational{ 1, AUDIO_SAMPLE_RATE };
+    const AVChannelLayout stereo = AV_CHANNEL_LAYOUT_STEREO;
+    av_channel_layout_copy(&output.enc->ch_layout, &stereo);
+    if (avcodec_open2(output.enc, codec, nullptr) < 0
+        || avcodec_parameters_from_context(output.stream->codecpar, output.enc) < 0) {
+        return false;
+    }
+    output.stream->time_base = output.enc->time_base;
+
+    output.frame = av_frame_alloc();
+    output.frame->format = AV_SAMPLE_FMT_S16;
+    output.frame->sample_rate = AUDIO_SAMPLE_RATE;
+    output.frame->nb_samples = AUDIO_FRAME_SAMPLES;
+    av_channel_layout_copy(&output.frame->ch_layout, &stereo);
+    return av_frame_get_buffer(output.frame, 0) >= 0;
+}
+
+void fillTone(AVFrame *frame, int64_t firstSample)
+{
+    int16_t *samples = reinterpret_cast<int16_t*>(frame->data[0]);
+    for (int i = 0; i < frame->nb_samples; i++) {
+        const double t = double(firstSample + i) / AUDIO_SAMPLE_RATE;
+        const int16_t value = static_cast<int16_t>(std::lround(8000.0 * std::sin(TWO_PI * AUDIO_TONE_HZ * t)));
+        samples[i * 2] = value;
+        samples[i * 2 + 1] = value;
+    }
+}
+
+} // namespace
+
+void SyntheticClip::fillPattern(AVFrame *frame, int index)
+{
+    for (int y = 0; y < frame->height; y++) {
+        uint8_t *row = frame->data[0] + y * frame->linesize[0];
+        for (int x = 0; x < frame->width; x++) {
+            row[x] = x < 16 ? ((y & 1) ? 0 : 255)
+                            : static_cast<uint8_t>(x * 3 + y * 2 + index * 5);
+        }
+    }
+
+    const int chromaWidth = (frame->width + 1) / 2;
+    const int chromaHeight = (frame->height + 1) / 2;
+    for (int y = 0; y < chromaHeight; y++) {
+        for (int x = 0; x < chromaWidth; x++) {
+            const uint8_t u = static_cast<uint8_t>(x * 4 + index * 7);
+            const uint8_t v = static_cast<uint8_t>(y * 4 + 255 - index * 3);
+            if (frame->format == AV_PIX_FMT_NV12) {
+                uint8_t *uv = frame->data[1] + y * frame->linesize[1] + x * 2;
+                uv[0] = u;
+                uv[1] = v;
+            } else {
+                frame->data[1][y * frame->linesize[1] + x] = u;
+                frame->data[2][y * frame->linesize[2] + x] = v;
+            }
+        }
+    }
+}
+
+bool SyntheticClip::write(const SyntheticClipSpec &spec, const QString &path)
+{
+    const QByteArray fileName = path.toUtf8();
+    AVFormatContext *oc = nullptr;
+    if (avformat_alloc_output_context2(&oc, nullptr, spec.container, fileName.constData()) < 0) {
+        return false;
+    }
+
+    OutputStream video;
+    OutputStream audio;
+    AVPacket *packet = av_packet_alloc();
+    bool ok = packet && openVideo(spec, oc, video);
+    if (ok && spec.audio) {
+        ok = openAudio(oc, audio);
+    }
+    if (!(oc->oformat->flags & AVFMT_NOFILE)) {
+        ok = ok && avio_open(&oc->pb, fileName.constData(), AVIO_FLAG_WRITE) >= 0;
+    }
+    AVDictionary *options = nullptr;
+    if (isHls(spec)) {
+        // 关键帧间隔为 1 秒（gop_size = fps），每个分片从关键帧开始
+        av_dict_set(&options, "hls_time", "1", 0);
+        av_dict_set(&options, "hls_playlist_type", "vod", 0);
+    }
+    ok = ok && avformat_write_header(oc, &options) >= 0;
+    av_dict_free(&options);
+
+    const bool switches = ok && switchesSize(spec, video.enc->codec);
+    audio.nextPts = int64_t(spec.startFrame) * AUDIO_SAMPLE_RATE / spec.fps;
+    for (int i = 0; ok && i < spec.frames; i++) {
+        if (switches && i == spec.switchFrame) {
+            ok = reopenVideo(spec, oc, video, packet);
+            if (!ok) break;
+        }
+        ok = av_frame_make_writable(video.frame) >= 0;
+        if (!ok) break;
+        fillPattern(video.frame, i);
+        video.frame->pts = spec.startFrame + i;
+        ok = avcodec_send_frame(video.enc, video.frame) >= 0 && writePackets(video, oc, packet);
+
+        // 音频写到与下一帧视频相同的时间点，交织顺序由 av_interleaved_write_frame 保证
+        const int64_t audioEnd = int64_t(spec.startFrame + i + 1) * AUDIO_SAMPLE_RATE / spec.fps;
+        while (ok && audio.enc && audio.nextPts < audioEnd) {
+            ok = av_frame_make_writable(audio.frame) >= 0;
+            if (!ok) break;
+            fillTone(audio.frame, audio.nextPts);
+            audio.frame->pts = audio.nextPts;
+            audio.nextPts += audio.frame->nb_samples;
+            ok = avcodec_send_frame(audio.enc, audio.frame) >= 0 && writePackets(audio, oc, packet);
+        }
+    }
+
+    if (ok) {
+        ok = avcodec_send_frame(video.enc, nullptr) >= 0 && writePackets(video, oc, packet);
+    }
+    if (ok && audio.enc) {
+        ok = avcodec_send_frame(audio.enc, nullptr) >= 0 && writePackets(audio, oc, packet);
+    }
+    if (ok) {
+        ok = av_write_trailer(oc) >= 0;
+    }
+
+    if (oc->pb) avio_closep(&oc->pb);
+    av_packet_free(&packet);
+    closeStream(video);
+    closeStream(audio);
+    avformat_free_context(oc);
+    return ok;
+}
+
+#endif // FFMPEG_AVAILABLE
@@ -0,0 +1,59 @@
+/**
+ * @file SyntheticClip.h
+ * @brief 确定性参考片段生成（一致性检查、浸泡测试共用）
+ *
+ * 图案与音频只由帧序号决定，同一规格每次生成的解码结果相同。
+ */
+
+#ifndef SYNTHETICCLIP_H
+#define SYNTHETICCLIP_H
+
+#include <QString>
+
+#if FFMPEG_AVAILABLE
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+/**
+ * @brief 参考片段规格
+ */
+struct SyntheticClipSpec {
+    const char *name = "";
+    AVPixelFormat format = AV_PIX_FMT_YUV420P;
+    int width = 320;
+    int height = 180;
+    int frames = 24;
+    int fps = 24;
+    AVCodecID codec = AV_CODEC_ID_RAWVIDEO;     ///< rawvideo 无损；MPEG4 覆盖帧间解码
+    bool audio = false;                         ///< 附加 44100Hz 立体声 PCM 正弦波
+    int switchFrame = 0;                        ///< >0 时从该帧起改为下面的尺寸（仅有损编码器，流中途重配置）
+    int switchWidth = 0;
+    int switchHeight = 0;
+    const char *container = "nut";              ///< "hls" 时写点播播放列表与 1 秒分片（路径为播放列表）
+    int startFrame = 0;                         ///< 首帧 pts（以帧为单位），>0 时容器 start_time 不为 0
+};
+
+namespace SyntheticClip {
+
+/**
+ * @brief 写入容器文件（默认 NUT）
+ *
+ * 指定编码器不可用时回退到 rawvideo。中途切换尺寸时在切换帧处重开编码器，
+ * 参数集随码流带内发送，容器参数只记录起始尺寸；rawvideo 不支持切换，忽略并告警。
+ */
+bool write(const SyntheticClipSpec &spec, const QString &path);
+
+/**
+ * @brief 填充第 index 帧的测试图案
+ *
+ * 左侧 16 列为黑白交替行（覆盖 Y 极值与钳位），其余为随帧移动的渐变；
+ * 色度在水平/垂直方向各自变化，覆盖整个 UV 平面。
+ */
+void fillPattern(AVFrame *frame, int index);
+
+} // namespace SyntheticClip
+
+#endif // FFMPEG_AVAILABLE
+
+#endif // SYNTHETICCLIP_H
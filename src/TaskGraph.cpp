@@ -0,0 +1,144 @@
+/**
+ * @file TaskGraph.cpp
+ * @brief 协程执行器与任务组实现
+ */
+
+#include "TaskGraph.h"
+
+// ========================================
+// Executor
+// ========================================
+
+namespace {
+thread_local const Executor *t_currentExecutor = nullptr;     // 当前工作线程所属的执行器
+}
+
+Executor::Executor(int threads)
+{
+    const int count = threads > 0 ? threads : 1;
+    m_threads.reserve(count);
+    for (int i = 0; i < count; i++) {
+        m_threads.emplace_back([this]() { run(); });
+    }
+}
+
+Executor &Executor::shared()
+{
+    static Executor executor([]() {
+        const int cores = static_cast<int>(std::thread::hardware_concurrency());
+        return cores >= 8 ? 4 : (cores >= 4 ? 3 : 2);
+    }());
+    return executor;
+}
+
+Executor::~Executor()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_condition.notify_all();
+    for (std::thread &thread : m_threads) {
+        thread.join();
+    }
+}
+
+bool Executor::isCurrent() const
+{
+    return t_currentExecutor == this;
+}
+
+void Executor::post(std::coroutine_handle<> handle)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_ready.push_back(handle);
+    }
+    m_condition.notify_one();
+}
+
+void Executor::addTimer(Clock::time_point deadline, std::coroutine_handle<> handle)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_timers.push(Timer{deadline, m_timerSequence++, handle});
+    }
+    // 新定时器可能早于等待中的线程的截止时间，唤醒一个线程重新计算
+    m_condition.notify_one();
+}
+
+void Executor::run()
+{
+    t_currentExecutor = this;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+        const Clock::time_point now = Clock::now();
+        while (!m_timers.empty() && m_timers.top().deadline <= now) {
+            m_ready.push_back(m_timers.top().handle);
+            m_timers.pop();
+        }
+
+        if (!m_ready.empty()) {
+            std::coroutine_handle<> handle = m_ready.front();
+            m_ready.pop_front();
+            lock.unlock();
+            handle.resume();
+            lock.lock();
+            continue;
+        }
+
+        // 退出前跑完就绪协程；定时器上仍挂着的协程由其 TaskGroup 负责在析构前等待
+        if (m_stopping) return;
+
+        if (m_timers.empty()) {
+            m_condition.wait(lock);
+        } else {
+            m_condition.wait_until(lock, m_timers.top().deadline);
+        }
+    }
+}
+
+// ========================================
+// Task / TaskGroup
+// ========================================
+
+void Task::promise_type::FinalAwaiter::await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+{
+    TaskGroup *group = handle.promise().group;
+    handle.destroy();
+    if (group) group->taskFinished();
+}
+
+void TaskGroup::spawn(Task task)
+{
+    std::coroutine_handle<Task::promise_type> handle = std::exchange(task.m_handle, nullptr);
+    handle.promise().group = this;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_active++;
+    }
+    m_executor.post(handle);
+}
+
+void TaskGroup::taskFinished()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (--m_active == 0) {
+        m_condition.notify_all();
+    }
+}
+
+void TaskGroup::wait()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_condition.wait(lock, [this]() { return m_active == 0; });
+    if (m_stop.stop_requested()) {
+        m_stop = std::stop_source();
+    }
+}
+
+bool TaskGroup::isIdle()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_active == 0;
+}
@@ -0,0 +1,391 @@
+/**
+ * @file TaskGraph.h
+ * @brief 协程任务图：小型执行器 + 可等待队列 / 定时器
+ *
+ * 管线各阶段写成协程，挂起在有界队列（背压）和定时器上，由少量工作线程调度：
+ * - 队列满时生产者挂起、空时消费者挂起，不再有定时轮询唤醒
+ * - 关闭队列即取消：挂起的 push 返回 false、pop 返回 std::nullopt，协程自然退出
+ * - 线程数与阶段数无关；阶段内的阻塞调用（如 av_read_frame）会占用一个工作线程，
+ *   这类阶段用 co_await executor.schedule() 切到专用执行器上运行，不占共享线程
+ *
+ * 非协程一侧（GUI 线程的呈现/音频定时器）通过 tryPop()/consume() 取数据，
+ * 腾出的空间会唤醒挂起的生产者。
+ */
+
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <stop_token>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class TaskGroup;
+
+// ========================================
+// 执行器
+// ========================================
+
+/**
+ * @brief 固定线程数的协程执行器（就绪队列 + 定时器堆）
+ *
+ * 工作线程在没有就绪协程时等待到最近的定时器到期，不做周期轮询。
+ */
+class Executor
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit Executor(int threads = 2);
+    ~Executor();
+
+    Executor(const Executor &) = delete;
+    Executor &operator=(const Executor &) = delete;
+
+    /**
+     * @brief 进程共享的执行器（所有播放器的管线共用，线程数按 CPU 核数取 2~4）
+     */
+    static Executor &shared();
+
+    /**
+     * @brief 把协程放入就绪队列（任意线程）
+     */
+    void post(std::coroutine_handle<> handle);
+
+    struct TimerAwaiter {
+        Executor &executor;
+        Clock::time_point deadline;
+        bool await_ready() const noexcept { return Clock::now() >= deadline; }
+        void await_suspend(std::coroutine_handle<> handle) { executor.addTimer(deadline, handle); }
+        void await_resume() const noexcept {}
+    };
+
+    /**
+     * @brief co_await executor.sleepFor(d)：挂起到期后在工作线程恢复
+     */
+    TimerAwaiter sleepFor(Clock::duration duration) { return sleepUntil(Clock::now() + duration); }
+    TimerAwaiter sleepUntil(Clock::time_point deadline) { return TimerAwaiter{*this, deadline}; }
+
+    struct ScheduleAwaiter {
+        Executor &executor;
+        bool await_ready() const noexcept { return executor.isCurrent(); }
+        void await_suspend(std::coroutine_handle<> handle) { executor.post(handle); }
+        void await_resume() const noexcept {}
+    };
+
+    /**
+     * @brief co_await executor.schedule()：转到该执行器的工作线程继续（已在其上时不挂起）
+     *
+     * 队列唤醒的协程在队列所属的执行器上恢复，阻塞调用之前需要再次 schedule()
+     */
+    ScheduleAwaiter schedule() { return ScheduleAwaiter{*this}; }
+
+    /**
+     * @brief 当前线程是否为本执行器的工作线程
+     */
+    bool isCurrent() const;
+
+    int threadCount() const { return static_cast<int>(m_threads.size()); }
+
+private:
+    struct Timer {
+        Clock::time_point deadline;
+        std::uint64_t sequence;         // 同一时刻按加入顺序
+        std::coroutine_handle<> handle;
+        bool operator>(const Timer &other) const
+        {
+            return deadline != other.deadline ? deadline > other.deadline : sequence > other.sequence;
+        }
+    };
+
+    void addTimer(Clock::time_point deadline, std::coroutine_handle<> handle);
+    void run();
+
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::deque<std::coroutine_handle<>> m_ready;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> m_timers;
+    std::uint64_t m_timerSequence = 0;
+    bool m_stopping = false;
+    std::vector<std::thread> m_threads;
+};
+
+// ========================================
+// 任务
+// ========================================
+
+/**
+ * @brief 无返回值的惰性协程，交给 TaskGroup::spawn 后开始执行，结束时自行销毁
+ */
+class Task
+{
+public:
+    struct promise_type {
+        TaskGroup *group = nullptr;
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<promise_type> handle) noexcept;
+            void await_resume() const noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }    // 管线代码不使用异常
+    };
+
+    Task(Task &&other) noexcept : m_handle(std::exchange(other.m_handle, nullptr)) {}
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+    ~Task()
+    {
+        if (m_handle) m_handle.destroy();
+    }
+
+private:
+    friend class TaskGroup;
+    explicit Task(std::coroutine_handle<promise_type> handle) : m_handle(handle) {}
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+/**
+ * @brief 一组协同取消、统一等待结束的任务（一条管线）
+ */
+class TaskGroup
+{
+public:
+    explicit TaskGroup(Executor &executor) : m_executor(executor) {}
+    ~TaskGroup() { wait(); }
+
+    /**
+     * @brief 启动任务（在执行器上开始运行）
+     */
+    void spawn(Task task);
+
+    /**
+     * @brief 请求取消；任务需检查 token() 或由调用方关闭其等待的队列
+     */
+    void cancel() { m_stop.request_stop(); }
+    std::stop_token token() const { return m_stop.get_token(); }
+
+    /**
+     * @brief 阻塞等待所有任务结束，之后可再次 spawn（取消状态被重置）
+     */
+    void wait();
+
+    bool isIdle();
+
+private:
+    friend struct Task::promise_type::FinalAwaiter;
+    void taskFinished();
+
+    Executor &m_executor;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    int m_active = 0;
+    std::stop_source m_stop;
+};
+
+// ========================================
+// 可等待的有界队列
+// ========================================
+
+/**
+ * @brief 多生产者多消费者有界队列
+ *
+ * co_await push(v) → bool（false 表示已关闭，值被丢弃）
+ * co_await pop()   → std::optional<T>（关闭且取空后为 std::nullopt）
+ * 被唤醒的协程总是投递回执行器恢复，不会在调用方线程或持锁时内联执行。
+ */
+template <typename T>
+class AsyncQueue
+{
+public:
+    AsyncQueue(Executor &executor, std::size_t capacity)
+        : m_executor(executor), m_capacity(capacity > 0 ? capacity : 1) {}
+
+    AsyncQueue(const AsyncQueue &) = delete;
+    AsyncQueue &operator=(const AsyncQueue &) = delete;
+
+    class PushAwaiter
+    {
+    public:
+        PushAwaiter(AsyncQueue &queue, T value) : m_queue(queue), m_value(std::move(value)) {}
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            std::lock_guard<std::mutex> lock(m_queue.m_mutex);
+            if (m_queue.m_closed) {
+                m_result = false;
+                return false;
+            }
+            if (!m_queue.m_poppers.empty()) {
+                // 有消费者在等：直接交付
+                auto *popper = m_queue.m_poppers.front();
+                m_queue.m_poppers.pop_front();
+                popper->m_result = std::move(m_value);
+                m_queue.m_executor.post(popper->m_handle);
+                m_result = true;
+                return false;
+            }
+            if (m_queue.m_items.size() < m_queue.m_capacity) {
+                m_queue.m_items.push_back(std::move(m_value));
+                m_result = true;
+                return false;
+            }
+            m_handle = handle;
+            m_queue.m_pushers.push_back(this);
+            return true;
+        }
+        bool await_resume() const noexcept { return m_result; }
+
+    private:
+        friend class AsyncQueue;
+        AsyncQueue &m_queue;
+        T m_value;
+        std::coroutine_handle<> m_handle;
+        bool m_result = false;
+    };
+
+    class PopAwaiter
+    {
+    public:
+        explicit PopAwaiter(AsyncQueue &queue) : m_queue(queue) {}
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            std::lock_guard<std::mutex> lock(m_queue.m_mutex);
+            if (!m_queue.m_items.empty()) {
+                m_result = std::move(m_queue.m_items.front());
+                m_queue.m_items.pop_front();
+                m_queue.admitPushersLocked();
+                return false;
+            }
+            if (m_queue.m_closed) {
+                return false;
+            }
+            m_handle = handle;
+            m_queue.m_poppers.push_back(this);
+            return true;
+        }
+        std::optional<T> await_resume() { return std::move(m_result); }
+
+    private:
+        friend class AsyncQueue;
+        AsyncQueue &m_queue;
+        std::coroutine_handle<> m_handle;
+        std::optional<T> m_result;
+    };
+
+    PushAwaiter push(T value) { return PushAwaiter(*this, std::move(value)); }
+    PopAwaiter pop() { return PopAwaiter(*this); }
+
+    /**
+     * @brief 非协程一侧取一个元素
+     */
+    std::optional<T> tryPop()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_items.empty()) return std::nullopt;
+        std::optional<T> item(std::move(m_items.front()));
+        m_items.pop_front();
+        admitPushersLocked();
+        return item;
+    }
+
+    /**
+     * @brief 持锁访问内部队列（查看队首、部分消费等），返回后按腾出的空间唤醒生产者
+     */
+    template <typename F>
+    decltype(auto) consume(F &&fn)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        struct Admit {
+            AsyncQueue &queue;
+            ~Admit() { queue.admitPushersLocked(); }
+        } admit{*this};
+        return fn(m_items);
+    }
+
+    /**
+     * @brief 丢弃已排队的元素（跳转时），挂起的生产者随之补入
+     */
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_items.clear();
+        admitPushersLocked();
+    }
+
+    /**
+     * @brief 关闭：挂起的 push 返回 false，pop 取完剩余元素后返回 std::nullopt
+     */
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+        for (PushAwaiter *pusher : m_pushers) {
+            pusher->m_result = false;
+            m_executor.post(pusher->m_handle);
+        }
+        m_pushers.clear();
+        for (PopAwaiter *popper : m_poppers) {
+            m_executor.post(popper->m_handle);
+        }
+        m_poppers.clear();
+    }
+
+    /**
+     * @brief 清空并重新打开（管线重启前调用，此时不应有挂起的协程）
+     */
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_items.clear();
+        m_closed = false;
+    }
+
+    std::size_t size()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_items.size();
+    }
+
+    bool isEmpty() { return size() == 0; }
+    std::size_t capacity() const { return m_capacity; }
+
+private:
+    void admitPushersLocked()
+    {
+        while (!m_pushers.empty() && m_items.size() < m_capacity) {
+            PushAwaiter *pusher = m_pushers.front();
+            m_pushers.pop_front();
+            m_items.push_back(std::move(pusher->m_value));
+            pusher->m_result = true;
+            m_executor.post(pusher->m_handle);
+        }
+    }
+
+    Executor &m_executor;
+    const std::size_t m_capacity;
+    std::mutex m_mutex;
+    std::deque<T> m_items;
+    std::deque<PushAwaiter *> m_pushers;
+    std::deque<PopAwaiter *> m_poppers;
+    bool m_closed = false;
+};
+
+#endif // TASKGRAPH_H
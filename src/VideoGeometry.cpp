@@ -0,0 +1,117 @@
+/**
+ * @file VideoGeometry.cpp
+ * @brief 画面几何变换实现
+ */
+
+#include "VideoGeometry.h"
+
+#include <QtGlobal>
+#include <QRectF>
+#include <cmath>
+
+#if FFMPEG_AVAILABLE
+extern "C" {
+#include <libavutil/display.h>
+}
+#endif
+
+namespace {
+
+int normalizeRotation(int degrees)
+{
+    const int quarter = static_cast<int>(std::lround(degrees / 90.0));
+    return ((quarter % 4) + 4) % 4 * 90;
+}
+
+/**
+ * @brief 裁剪 + 变焦/平移后，在源纹理中可见的矩形（像素）
+ */
+QRectF visibleSourceRect(const VideoGeometry &geometry, const QSize &videoSize)
+{
+    QRectF visible(QPointF(0, 0), QSizeF(videoSize));
+    if (!geometry.crop.isEmpty()) {
+        visible = visible.intersected(QRectF(geometry.crop));
+        if (visible.isEmpty()) visible = QRectF(QPointF(0, 0), QSizeF(videoSize));
+    }
+
+    const double zoom = qMax(1.0, geometry.zoom);
+    if (zoom > 1.0) {
+        const QSizeF zoomed = visible.size() / zoom;
+        const double panX = qBound(-1.0, geometry.pan.x(), 1.0);
+        const double panY = qBound(-1.0, geometry.pan.y(), 1.0);
+        const QPointF center = visible.center()
+            + QPointF(panX * (visible.width() - zoomed.width()) / 2,
+                      panY * (visible.height() - zoomed.height()) / 2);
+        visible = QRectF(center - QPointF(zoomed.width() / 2, zoomed.height() / 2), zoomed);
+    }
+    return visible;
+}
+
+} // namespace
+
+void VideoGeometry::quad(int streamRotation, const QSize &videoSize, const QSize &textureSize,
+                         const QSize &outputSize, VideoQuadVertex out[4]) const
+{
+    const int totalRotation = normalizeRotation(streamRotation + rotation);
+    const bool transposed = totalRotation == 90 || totalRotation == 270;
+
+    QRectF visible = visibleSourceRect(*this, videoSize);
+    const QSizeF texSize(qMax(1, textureSize.width()), qMax(1, textureSize.height()));
+
+    // 黑边：按旋转后的可见区域宽高比适配输出
+    float scaleX = 1.0f;
+    float scaleY = 1.0f;
+    const QSizeF shown = transposed ? visible.size().transposed() : visible.size();
+    if (!shown.isEmpty() && !outputSize.isEmpty()) {
+        const QSizeF fitted = shown.scaled(QSizeF(outputSize), Qt::KeepAspectRatio);
+        scaleX = float(fitted.width() / outputSize.width());
+        scaleY = float(fitted.height() / outputSize.height());
+    }
+
+    // 显示角 (dx, dy)：左上、右上、左下、右下；dy 向下
+    static const int corners[4][2] = { {0, 0}, {1, 0}, {0, 1}, {1, 1} };
+    for (int i = 0; i < 4; i++) {
+        const int dx = corners[i][0];
+        const int dy = corners[i][1];
+
+        // 翻转作用在显示结果上
+        const int fx = flipHorizontal ? 1 - dx : dx;
+        const int fy = flipVertical ? 1 - dy : dy;
+
+        // 逆旋转回源坐标（顺时针旋转 θ 后显示角 (x, y) 取自源的 (s, t)）
+        int s = fx;
+        int t = fy;
+        switch (totalRotation) {
+        case 90:  s = fy;     t = 1 - fx; break;
+        case 180: s = 1 - fx; t = 1 - fy; break;
+        case 270: s = 1 - fy; t = fx;     break;
+        default: break;
+        }
+
+        out[i].x = (dx ? 1.0f : -1.0f) * scaleX;
+        out[i].y = (dy ? -1.0f : 1.0f) * scaleY;
+        out[i].u = float((s ? visible.right() : visible.left()) / texSize.width());
+        out[i].v = float((t ? visible.bottom() : visible.top()) / texSize.height());
+    }
+}
+
+QSize VideoGeometry::displaySize(int streamRotation, const QSize &videoSize) const
+{
+    const QSize visible = visibleSourceRect(*this, videoSize).size().toSize();
+    const int totalRotation = normalizeRotation(streamRotation + rotation);
+    return (totalRotation == 90 || totalRotation == 270) ? visible.transposed() : visible;
+}
+
+int VideoGeometry::rotationFromDisplayMatrix(const int32_t matrix[9])
+{
+#if FFMPEG_AVAILABLE
+    if (!matrix) return 0;
+    // av_display_rotation_get 返回逆时针角度，显示时需要顺时针转回
+    const double angle = av_display_rotation_get(matrix);
+    if (std::isnan(angle)) return 0;
+    return normalizeRotation(static_cast<int>(std::lround(-angle)));
+#else
+    Q_UNUSED(matrix)
+    return 0;
+#endif
+}
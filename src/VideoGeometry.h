@@ -0,0 +1,61 @@
+/**
+ * @file VideoGeometry.h
+ * @brief 画面几何变换：旋转、翻转、裁剪、数字变焦与平移
+ *
+ * 所有变换都折算成一个四边形的顶点位置与纹理坐标，GPU 渲染器只需更新 4 个顶点，
+ * 不触碰像素；黑边（保持宽高比）也在顶点里完成，因此与任意变换组合都保持正确。
+ */
+
+#ifndef VIDEOGEOMETRY_H
+#define VIDEOGEOMETRY_H
+
+#include <QPointF>
+#include <QRect>
+#include <QSize>
+#include <cstdint>
+
+/**
+ * @brief 四边形顶点（位置为 NDC，y 向上；纹理坐标 v 向下）
+ */
+struct VideoQuadVertex {
+    float x, y;
+    float u, v;
+};
+
+/**
+ * @brief 用户几何设置
+ *
+ * 应用顺序：裁剪 → 变焦/平移 → 旋转（流旋转 + 用户旋转）→ 翻转 → 保持宽高比居中。
+ */
+struct VideoGeometry {
+    int rotation = 0;               ///< 用户额外旋转，顺时针，90 的倍数
+    bool flipHorizontal = false;    ///< 显示后的水平镜像
+    bool flipVertical = false;      ///< 显示后的垂直镜像
+    QRect crop;                     ///< 源像素裁剪矩形，空表示整帧
+    double zoom = 1.0;              ///< 数字变焦倍数（>= 1）
+    QPointF pan;                    ///< 变焦后的平移，各分量 [-1, 1]，0 为居中
+
+    bool operator==(const VideoGeometry &other) const = default;
+
+    /**
+     * @brief 计算四边形，顶点顺序为三角形带：左上、右上、左下、右下
+     * @param streamRotation 流元数据要求的顺时针旋转（度）
+     * @param videoSize 视频有效尺寸（像素）
+     * @param textureSize 纹理分配尺寸（可能因对齐大于视频尺寸），纹理坐标按它归一化
+     * @param outputSize 输出区域尺寸（与视口单位一致）
+     */
+    void quad(int streamRotation, const QSize &videoSize, const QSize &textureSize,
+              const QSize &outputSize, VideoQuadVertex out[4]) const;
+
+    /**
+     * @brief 旋转后的显示尺寸（宽高比），用于窗口适配
+     */
+    QSize displaySize(int streamRotation, const QSize &videoSize) const;
+
+    /**
+     * @brief 从 FFmpeg 显示矩阵（AV_PKT_DATA_DISPLAYMATRIX）取顺时针旋转，取整到 90 度
+     */
+    static int rotationFromDisplayMatrix(const int32_t matrix[9]);
+};
+
+#endif // VIDEOGEOMETRY_H
@@ -4,8 +4,8 @@
  * 
  * 各平台实现：
  * - Windows: D3D11Renderer (D3D11VA 硬件解码)
- * - macOS:   MetalRenderer (VideoToolbox 硬件解码)
- * - Linux:   OpenGLRenderer (VAAPI/VDPAU 硬件解码)
+ * - 所有平台: RhiRenderer (Qt RHI：OpenGL/Vulkan/Metal/D3D 统一 GPU 路径)
+ * - macOS/Linux: SoftwareRenderer (共享内存 / QPainter，无 GPU 的瘦客户端)
  */
 
 #ifndef VIDEORENDERERBASE_H
@@ -13,6 +13,13 @@
 
 #include <QWidget>
 #include <QString>
+#include <QImage>
+#include <QDateTime>
+#include <QDebug>
+
+#include "CueScheduler.h"
+#include "PlaybackMetrics.h"
+#include "VideoGeometry.h"
 
 /**
  * @brief 视频渲染器抽象基类
@@ -34,7 +41,10 @@ public:
     };
     Q_ENUM(DecodeMode)
 
-    explicit VideoRendererBase(QWidget *parent = nullptr) : QWidget(parent) {}
+    explicit VideoRendererBase(QWidget *parent = nullptr) : QWidget(parent)
+    {
+        connect(&m_cue, &CueScheduler::due, this, &VideoRendererBase::onCueDue);
+    }
     virtual ~VideoRendererBase() = default;
 
     // ========================================
@@ -89,6 +99,40 @@ public:
     // 虚函数 - 有默认实现，可覆盖
     // ========================================
     
+    /**
+     * @brief 停止当前播放，打开新文件并自动播放
+     * @param filename 文件路径
+     */
+    virtual void loadFile(const QString &filename)
+    {
+        stop();
+        if (openFile(filename)) {
+            play();
+        }
+    }
+    
+    /**
+     * @brief 排期切换：在墙钟时刻 at 之后切换到 file
+     * @param atLoopBoundary 到期后等当前循环播完、在接缝处切换
+     *
+     * 默认实现到期后直接 loadFile（冷切换，不支持循环边界）；
+     * 支持的渲染器在后台预加载并预解码首帧，到期后下一次刷新即切换、不出黑帧
+     */
+    virtual void scheduleSwitch(const QString &filename, const QDateTime &at, bool atLoopBoundary = false)
+    {
+        m_cue.schedule(filename, at, atLoopBoundary);
+    }
+    
+    /**
+     * @brief 取消尚未执行的排期切换
+     */
+    virtual void cancelScheduledSwitch() { m_cue.cancel(); }
+    
+    /**
+     * @brief 是否有尚未执行的排期切换
+     */
+    bool hasScheduledSwitch() const { return m_cue.isPending(); }
+    
     /**
      * @brief 设置解码模式
      */
@@ -109,6 +153,25 @@ public:
      */
     virtual bool isLoop() const { return m_loop; }
     
+    /**
+     * @brief 短循环磁盘帧缓存：第一次播放时录制解码帧，之后直接从映射播放（不支持的渲染器忽略）
+     */
+    void setFrameCacheEnabled(bool enabled) { m_frameCacheEnabled = enabled; }
+    bool isFrameCacheEnabled() const { return m_frameCacheEnabled; }
+    
+    /**
+     * @brief 限制呈现帧率（0 表示不限制）：按整数步长只转换、呈现一部分帧（不支持的渲染器忽略）
+     *
+     * 与落后时丢帧不同，选帧是确定的，用于无风扇设备的功耗 / 温度预算；音频不受影响
+     */
+    virtual void setMaxPresentRate(double fps) { m_maxPresentRate = fps; }
+    double maxPresentRate() const { return m_maxPresentRate; }
+    
+    /**
+     * @brief 是否实现了呈现帧率上限（不支持时界面禁用对应菜单）
+     */
+    virtual bool supportsMaxPresentRate() const { return false; }
+    
     /**
      * @brief 获取当前音量
      */
@@ -139,6 +202,27 @@ public:
      */
     virtual bool isHardwareDecoding() const { return false; }
     
+    /**
+     * @brief 运行指标（音频遥测等），不支持的渲染器返回 nullptr
+     */
+    virtual PlaybackMetrics *metrics() { return nullptr; }
+    
+    /**
+     * @brief 画面几何变换（旋转、翻转、裁剪、变焦/平移），GPU 渲染器只更新顶点
+     */
+    virtual void setVideoGeometry(const VideoGeometry &geometry) { m_videoGeometry = geometry; }
+    const VideoGeometry &videoGeometry() const { return m_videoGeometry; }
+    
+    /**
+     * @brief 流元数据（显示矩阵）要求的顺时针旋转，与用户旋转叠加
+     */
+    int streamRotation() const { return m_streamRotation; }
+    
+    /**
+     * @brief 抓取当前显示的画面（窗口像素尺寸），不支持或尚无画面时返回空图像
+     */
+    virtual QImage grabFrame() { return QImage(); }
+    
     /**
      * @brief 获取渲染器名称（用于调试）
      */
@@ -150,6 +234,12 @@ signals:
      */
     void fileLoaded();
     
+    /**
+     * @brief 视频时长已知
+     * @param seconds 时长（秒）
+     */
+    void durationChanged(double seconds);
+    
     /**
      * @brief 播放位置改变
      * @param position 当前位置（秒）
@@ -162,6 +252,26 @@ signals:
      */
     void playbackStateChanged(bool playing);
     
+    /**
+     * @brief 打开文件后第一帧已上屏（每次 openFile 触发一次）
+     */
+    void firstFrameShown();
+    
+    /**
+     * @brief 排期切换的新画面已上屏
+     * @param file 切换到的文件
+     * @param lateMs 上屏时刻相对截止时间的偏差（毫秒，单调时钟）
+     */
+    void cueSwitched(const QString &file, double lateMs);
+    
+    /**
+     * @brief 多变体输入（HLS / DASH）的当前码率变体已改变（打开文件时也触发一次）
+     * @param variant 变体序号（按码率升序）
+     * @param size 变体的标称分辨率
+     * @param bandwidth 标称码率（bit/s）
+     */
+    void variantSwitched(int variant, const QSize &size, qint64 bandwidth);
+    
     /**
      * @brief 播放结束
      */
@@ -174,15 +284,35 @@ signals:
     void errorOccurred(const QString &error);
 
 protected:
+    /**
+     * @brief 排期到期（默认实现：冷切换）
+     */
+    virtual void onCueDue()
+    {
+        const QString file = m_cue.file();
+        if (m_cue.atLoopBoundary()) {
+            qWarning() << "[排期]" << rendererName() << "不支持循环边界切换，按时刻切换";
+        }
+        m_cue.finish();
+        loadFile(file);
+        emit cueSwitched(file, m_cue.lateMs());
+    }
+    
+    CueScheduler m_cue;
+    
     // 通用状态
     DecodeMode m_decodeMode = Auto;
     bool m_loop = true;
+    bool m_frameCacheEnabled = false;
+    double m_maxPresentRate = 0;
     bool m_playing = false;
     bool m_paused = false;
     int m_volume = 100;
     double m_duration = 0;
     double m_currentPts = 0;
     QString m_currentFile;
+    VideoGeometry m_videoGeometry;
+    int m_streamRotation = 0;
 };
 
 // ========================================
@@ -194,9 +324,9 @@ protected:
  * @param parent 父 widget
  * @return 渲染器实例
  * 
- * Windows → D3D11Renderer
- * macOS   → MetalRenderer (或 OpenGLRenderer)
- * Linux   → OpenGLRenderer
+ * Windows → D3D11Renderer（环境变量 LOOP_RENDERER=rhi 时使用 RhiRenderer）
+ * macOS   → RhiRenderer (Metal)
+ * Linux   → RhiRenderer (OpenGL/Vulkan)；没有硬件 OpenGL 或 LOOP_RENDERER=shm 时为 SoftwareRenderer
  */
 VideoRendererBase* createVideoRenderer(QWidget *parent = nullptr);
 
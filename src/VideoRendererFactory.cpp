@@ -11,20 +11,39 @@
 #include "D3D11Renderer.h"
 #endif
 
-// OpenGL 渲染器可在所有平台使用
-#include "OpenGLRenderer.h"
+#if RHI_RENDERER_AVAILABLE
+// RHI 渲染器可在所有平台使用
+#include "RhiRenderer.h"
+#endif
+
+#include "SoftwareRenderer.h"
 
 VideoRendererBase* createVideoRenderer(QWidget *parent)
 {
 #ifdef _WIN32
+#if RHI_RENDERER_AVAILABLE
+    // 环境变量 LOOP_RENDERER=rhi 时改用 RHI 渲染器
+    if (qEnvironmentVariable("LOOP_RENDERER").compare("rhi", Qt::CaseInsensitive) == 0) {
+        return new RhiRenderer(parent);
+    }
+#endif
     // Windows: 优先使用 D3D11
     return new D3D11Renderer(parent);
 #else
-    // macOS/Linux: 使用 OpenGL
-    // 注意：OpenGLRenderer 不继承 VideoRendererBase
-    // 这里需要一个适配器，或者直接返回 OpenGLRenderer*
-    // 由于 OpenGLRenderer 实现了相同的接口，调用方需要自行处理
-    return nullptr;  // 需要修改调用方式
+    // LOOP_RENDERER=shm：FFmpegPlayer 解码 + 共享内存 / QPainter 呈现
+    const QString choice = qEnvironmentVariable("LOOP_RENDERER");
+    if (choice.compare("shm", Qt::CaseInsensitive) == 0) {
+        return new SoftwareRenderer(parent);
+    }
+#if defined(Q_OS_LINUX)
+    // 无 GPU 的瘦客户端：只有 llvmpipe 等软件光栅器时 RHI 着色器在 CPU 上运行，改走共享内存
+    if (choice.compare("rhi", Qt::CaseInsensitive) != 0 && SoftwareRenderer::lacksHardwareOpenGL()) {
+        qDebug() << "[渲染器] 没有硬件 OpenGL，使用软件渲染器";
+        return new SoftwareRenderer(parent);
+    }
+#endif
+    // macOS/Linux: 使用 Qt RHI（Metal / Vulkan / OpenGL）
+    return new RhiRenderer(parent);
 #endif
 }
 
@@ -36,13 +55,14 @@ QStringList availableRenderers()
     list << "D3D11 (Windows)";
 #endif
 
-#ifdef __APPLE__
-    list << "Metal (macOS)";
+#if RHI_RENDERER_AVAILABLE
+    // RHI 在所有平台可用，后端由 Qt 按平台选择
+    list << "RHI (OpenGL/Vulkan/Metal/D3D)";
 #endif
 
-    // OpenGL 在所有平台可用
-    list << "OpenGL (Cross-Platform)";
+#ifndef _WIN32
+    list << "Software (MIT-SHM/wl_shm/QPainter)";
+#endif
     
     return list;
 }
-
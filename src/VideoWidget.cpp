@@ -1,4 +1,6 @@
 #include "VideoWidget.h"
+#include "ShmPresenter.h"
+#include <QGuiApplication>
 #include <QPainter>
 #include <QResizeEvent>
 #include <QDebug>
@@ -23,12 +25,27 @@ VideoWidget::VideoWidget(QWidget *parent)
     // 启用双缓冲，减少闪烁
     setAttribute(Qt::WA_OpaquePaintEvent);
     
+#if SHM_X11_AVAILABLE
+    // MIT-SHM 直接写入本 widget 的 X 窗口，需要原生子窗口
+    if (QGuiApplication::platformName() == "xcb") {
+        setAttribute(Qt::WA_NativeWindow);
+    }
+#endif
+    
+    // 共享内存缓冲区都在服务器手中时，稍后重试呈现最新帧
+    m_presentRetryTimer = new QTimer(this);
+    m_presentRetryTimer->setSingleShot(true);
+    m_presentRetryTimer->setTimerType(Qt::PreciseTimer);
+    m_presentRetryTimer->setInterval(2);
+    connect(m_presentRetryTimer, &QTimer::timeout, this, &VideoWidget::presentCurrentFrame);
+    
     // 连接播放器信号
     connect(m_player, &FFmpegPlayer::frameReady, this, &VideoWidget::onFrameReady);
     connect(m_player, &FFmpegPlayer::stateChanged, this, &VideoWidget::onStateChanged);
     connect(m_player, &FFmpegPlayer::positionChanged, this, &VideoWidget::onPositionChanged);
     connect(m_player, &FFmpegPlayer::durationChanged, this, &VideoWidget::onDurationChanged);
     connect(m_player, &FFmpegPlayer::fileLoaded, this, &VideoWidget::onFileLoaded);
+    connect(m_player, &FFmpegPlayer::videoSizeChanged, this, &VideoWidget::updateVideoRect);
     connect(m_player, &FFmpegPlayer::endOfFile, this, &VideoWidget::onEndOfFile);
     connect(m_player, &FFmpegPlayer::errorOccurred, this, &VideoWidget::onErrorOccurred);
     
@@ -39,9 +56,16 @@ VideoWidget::~VideoWidget() = default;
 
 void VideoWidget::loadFile(const QString &filename)
 {
-    m_player->loadFile(filename);
-    // 自动开始播放
-    m_player->play();
+    if (openFile(filename)) {
+        // 自动开始播放
+        m_player->play();
+    }
+}
+
+bool VideoWidget::openFile(const QString &filename)
+{
+    m_firstFramePending = true;
+    return m_player->loadFile(filename);
 }
 
 void VideoWidget::play()
@@ -64,6 +88,10 @@ void VideoWidget::stop()
     m_player->stop();
     m_currentFrame = QImage();
     m_scaledFrame = QImage();
+    m_presentRetryTimer->stop();
+    if (m_presenter) {
+        m_presenter->clear();
+    }
     update();
 }
 
@@ -107,15 +135,60 @@ bool VideoWidget::isPaused() const
     return m_player->isPaused();
 }
 
+QString VideoWidget::presenterName() const
+{
+    return m_presenter ? QString::fromLatin1(m_presenter->name()) : QStringLiteral("QPainter");
+}
+
 void VideoWidget::onFrameReady(const QImage &frame)
 {
-    // 直接存储帧，不做预缩放
-    // 让 paintEvent 中的 QPainter::drawImage 自动缩放
+    // 帧已由解码线程缩放到显示尺寸
     m_currentFrame = frame;
     
-    // 计算视频显示区域（保持宽高比）
-    if (!m_currentFrame.isNull() && m_keepAspectRatio) {
-        QSize frameSize = m_currentFrame.size();
+    if (m_videoRect.isEmpty()) {
+        updateVideoRect();
+    }
+    
+    // 首帧时（窗口已显示）尝试创建共享内存呈现器
+    if (!m_presenterChecked && isVisible()) {
+        m_presenterChecked = true;
+        m_presenter = ShmPresenter::create(this);
+        if (m_presenter) {
+            m_presenter->setBackground(QColor(26, 26, 46));
+        }
+    }
+    
+    if (m_presenter) {
+        presentCurrentFrame();
+    } else {
+        // 触发重绘
+        update();
+    }
+    
+    if (m_firstFramePending) {
+        m_firstFramePending = false;
+        emit firstFrameShown();
+    }
+}
+
+void VideoWidget::presentCurrentFrame()
+{
+    if (!m_presenter || m_currentFrame.isNull()) return;
+    
+    const qreal dpr = devicePixelRatioF();
+    const QRect deviceRect(m_videoRect.topLeft() * dpr, m_videoRect.size() * dpr);
+    if (!m_presenter->present(m_currentFrame, deviceRect, size() * dpr)) {
+        // 上一帧尚未显示，稍后用最新帧重试（期间到达的新帧会覆盖 m_currentFrame）
+        m_presentRetryTimer->start();
+    }
+}
+
+void VideoWidget::updateVideoRect()
+{
+    // 计算视频显示区域（保持宽高比），按原始视频宽高比而非当前帧尺寸
+    const QSize videoSize(m_player->videoWidth(), m_player->videoHeight());
+    if (!videoSize.isEmpty() && m_keepAspectRatio) {
+        QSize frameSize = videoSize;
         frameSize.scale(width(), height(), Qt::KeepAspectRatio);
         int x = (width() - frameSize.width()) / 2;
         int y = (height() - frameSize.height()) / 2;
@@ -124,8 +197,8 @@ void VideoWidget::onFrameReady(const QImage &frame)
         m_videoRect = rect();
     }
     
-    // 触发重绘
-    update();
+    // 解码线程直接输出显示尺寸（设备像素），省去绘制时的缩放
+    m_player->setOutputSize(m_videoRect.size() * devicePixelRatioF());
 }
 
 void VideoWidget::onStateChanged(FFmpegPlayer::PlaybackState state)
@@ -146,6 +219,7 @@ void VideoWidget::onDurationChanged(double seconds)
 void VideoWidget::onFileLoaded()
 {
     qDebug() << "Video loaded:" << m_player->videoWidth() << "x" << m_player->videoHeight();
+    updateVideoRect();
     emit fileLoaded();
 }
 
@@ -180,10 +254,11 @@ void VideoWidget::paintEvent(QPaintEvent *event)
     // 绘制背景
     painter.fillRect(rect(), QColor(26, 26, 46));
     
-    if (!m_currentFrame.isNull()) {
-        // 【优化】直接绘制原图到目标区域
-        // QPainter::drawImage 会自动缩放，比 QImage::scaled 快很多
-        // 因为 QPainter 可能使用硬件加速
+    if (m_presenter && !m_currentFrame.isNull()) {
+        // 共享内存呈现：Qt 的绘制会覆盖 X 窗口内容，绘制完成后重新呈现当前帧
+        QTimer::singleShot(0, this, &VideoWidget::presentCurrentFrame);
+    } else if (!m_currentFrame.isNull()) {
+        // 【优化】帧已是显示尺寸，drawImage 通常无需缩放
         painter.drawImage(m_videoRect, m_currentFrame);
     } else {
         // 显示提示信息
@@ -213,13 +288,5 @@ void VideoWidget::resizeEvent(QResizeEvent *event)
     QWidget::resizeEvent(event);
     
     // 窗口大小改变时，重新计算视频区域
-    if (!m_currentFrame.isNull() && m_keepAspectRatio) {
-        QSize frameSize = m_currentFrame.size();
-        frameSize.scale(width(), height(), Qt::KeepAspectRatio);
-        int x = (width() - frameSize.width()) / 2;
-        int y = (height() - frameSize.height()) / 2;
-        m_videoRect = QRect(x, y, frameSize.width(), frameSize.height());
-    } else {
-        m_videoRect = rect();
-    }
+    updateVideoRect();
 }
@@ -4,13 +4,17 @@
 #include <QWidget>
 #include <QImage>
 #include <QTimer>
+#include <memory>
 #include "FFmpegPlayer.h"
 
+class ShmPresenter;
+
 /**
  * @brief 视频渲染组件
  * 
  * 使用 FFmpeg 进行视频播放，支持几乎所有视频格式。
- * 通过 QPainter 进行渲染。
+ * 解码线程直接缩放到显示尺寸；Linux 上优先通过共享内存
+ * (MIT-SHM / wl_shm) 呈现，不可用时回退到 QPainter 渲染。
  */
 class VideoWidget : public QWidget
 {
@@ -26,6 +30,12 @@ public:
      */
     void loadFile(const QString &filename);
 
+    /**
+     * @brief 只打开文件，不自动播放
+     * @return 打开失败时返回 false
+     */
+    bool openFile(const QString &filename);
+
     /**
      * @brief 播放
      */
@@ -89,6 +99,21 @@ public:
      */
     bool isPaused() const;
 
+    /**
+     * @brief 运行指标（来自 FFmpegPlayer）
+     */
+    PlaybackMetrics &metrics() { return m_player->metrics(); }
+
+    /**
+     * @brief 当前显示的帧（显示尺寸），尚无画面时为空
+     */
+    QImage currentFrame() const { return m_currentFrame; }
+
+    /**
+     * @brief 当前使用的呈现方式（共享内存后端名称或 QPainter）
+     */
+    QString presenterName() const;
+
 signals:
     /**
      * @brief 播放位置改变
@@ -110,6 +135,11 @@ signals:
      */
     void fileLoaded();
 
+    /**
+     * @brief 打开文件后第一帧已显示
+     */
+    void firstFrameShown();
+
     /**
      * @brief 播放结束
      */
@@ -135,12 +165,20 @@ private slots:
 
 private:
     void updateScaledFrame();
+    void updateVideoRect();
+    void presentCurrentFrame();
 
     FFmpegPlayer *m_player;
     QImage m_currentFrame;
     QImage m_scaledFrame;
     QRect m_videoRect;
     bool m_keepAspectRatio = true;
+
+    // 共享内存呈现（无 GPU 的 Linux）
+    std::unique_ptr<ShmPresenter> m_presenter;
+    bool m_presenterChecked = false;
+    bool m_firstFramePending = false;
+    QTimer *m_presentRetryTimer = nullptr;
 };
 
 #endif // VIDEOWIDGET_H
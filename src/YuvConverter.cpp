@@ -0,0 +1,343 @@
+/**
+ * @file YuvConverter.cpp
+ * @brief YuvConverter 实现：标量内核、融合缩小与运行时分派
+ */
+
+#include "YuvConverter.h"
+#include "YuvConverterKernels.h"
+
+#include <QDebug>
+#include <QByteArray>
+#include <vector>
+
+#if FFMPEG_AVAILABLE
+extern "C" {
+#include <libavutil/pixfmt.h>
+}
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// ==================== 标量内核 ====================
+
+namespace YuvKernels {
+
+KernelTable scalarKernels()
+{
+    KernelTable table;
+    table.row420[0] = row420Scalar<false>;
+    table.row420[1] = row420Scalar<true>;
+    table.rowNv12[0] = rowNv12Scalar<false>;
+    table.rowNv12[1] = rowNv12Scalar<true>;
+    table.row444[0] = row444Scalar<false>;
+    table.row444[1] = row444Scalar<true>;
+    table.name = "标量";
+    return table;
+}
+
+} // namespace YuvKernels
+
+// ==================== CPU 特性检测 ====================
+
+namespace {
+
+using namespace YuvKernels;
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+struct CpuFeatures {
+    bool avx2 = false;
+    bool avx512bw = false;
+};
+
+void cpuid(int leaf, int subleaf, unsigned regs[4])
+{
+#if defined(_MSC_VER)
+    int r[4];
+    __cpuidex(r, leaf, subleaf);
+    for (int i = 0; i < 4; i++) regs[i] = static_cast<unsigned>(r[i]);
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+uint64_t readXcr0()
+{
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned eax, edx;
+    __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif
+}
+
+CpuFeatures detectCpu()
+{
+    CpuFeatures features;
+    unsigned regs[4] = {};
+
+    cpuid(0, 0, regs);
+    if (regs[0] < 7) return features;
+
+    cpuid(1, 0, regs);
+    const bool osxsave = regs[2] & (1u << 27);
+    if (!osxsave) return features;
+
+    // 操作系统需要保存对应的寄存器状态，否则即使 CPU 支持也不能用
+    const uint64_t xcr0 = readXcr0();
+    const bool ymmState = (xcr0 & 0x6) == 0x6;
+    const bool zmmState = (xcr0 & 0xE6) == 0xE6;
+
+    cpuid(7, 0, regs);
+    features.avx2 = ymmState && (regs[1] & (1u << 5));
+    features.avx512bw = zmmState && (regs[1] & (1u << 16)) && (regs[1] & (1u << 30));
+    return features;
+}
+
+#endif
+
+/**
+ * @brief 选择内核
+ *
+ * 环境变量 LOOP_YUV_KERNEL=scalar/avx2/avx512/neon 可强制指定（用于对比调试），
+ * 指定的指令集不可用时回退到自动选择。
+ */
+KernelTable selectKernels()
+{
+    const QByteArray forced = qgetenv("LOOP_YUV_KERNEL").toLower();
+    if (forced == "scalar") {
+        return scalarKernels();
+    }
+
+#if defined(__x86_64__) || defined(_M_X64)
+    const CpuFeatures cpu = detectCpu();
+    if (cpu.avx512bw && (forced.isEmpty() || forced == "avx512")) {
+        return avx512Kernels();
+    }
+    if (cpu.avx2 && (forced.isEmpty() || forced == "avx2" || forced == "avx512")) {
+        return avx2Kernels();
+    }
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    // AArch64 上 NEON 是基础指令集
+    return neonKernels();
+#endif
+
+    return scalarKernels();
+}
+
+const KernelTable &kernels()
+{
+    static const KernelTable table = [] {
+        KernelTable selected = selectKernels();
+        qDebug() << "YUV 转换内核:" << selected.name;
+        return selected;
+    }();
+    return table;
+}
+
+// ==================== 融合缩小 ====================
+
+/**
+ * @brief 把 factor x factor 的块求均值，缩小一行
+ * @param src 块的第一行
+ * @param stride 行字节数
+ * @param step 相邻样本间隔（交织 UV 为 2）
+ */
+void boxReduceRow(const uint8_t *src, int stride, int step, int factor, uint8_t *dst, int width)
+{
+    const int shift = factor == 4 ? 4 : (factor == 2 ? 2 : 0);
+    const int round = (1 << shift) >> 1;
+    for (int x = 0; x < width; x++) {
+        const uint8_t *block = src + x * factor * step;
+        int sum = 0;
+        for (int row = 0; row < factor; row++) {
+            const uint8_t *line = block + row * stride;
+            for (int col = 0; col < factor; col++) {
+                sum += line[col * step];
+            }
+        }
+        dst[x] = static_cast<uint8_t>((sum + round) >> shift);
+    }
+}
+
+/**
+ * @brief 4:2:0 色度按 factor 缩小到与输出亮度同宽
+ *
+ * 色度已是半分辨率：2× 时每个输出像素正好对应一个色度样本，4× 时对应 2x2 块。
+ */
+void reduceChromaRow(const uint8_t *src, int stride, int step, int factor, uint8_t *dst, int width)
+{
+    if (factor == 2) {
+        for (int x = 0; x < width; x++) {
+            dst[x] = src[x * step];
+        }
+    } else {
+        boxReduceRow(src, stride, step, factor / 2, dst, width);
+    }
+}
+
+} // namespace
+
+// ==================== 公共接口 ====================
+
+bool YuvConverter::sourceFormatFor(int avPixelFormat, SourceFormat *format)
+{
+#if FFMPEG_AVAILABLE
+    switch (avPixelFormat) {
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+        *format = YUV420P;
+        return true;
+    case AV_PIX_FMT_NV12:
+        *format = NV12;
+        return true;
+    default:
+        return false;
+    }
+#else
+    Q_UNUSED(avPixelFormat)
+    Q_UNUSED(format)
+    return false;
+#endif
+}
+
+YuvConverter::ColorRange YuvConverter::colorRangeFor(int avPixelFormat, int avColorRange)
+{
+#if FFMPEG_AVAILABLE
+    if (avPixelFormat == AV_PIX_FMT_YUVJ420P || avColorRange == AVCOL_RANGE_JPEG) {
+        return FullRange;
+    }
+#else
+    Q_UNUSED(avPixelFormat)
+    Q_UNUSED(avColorRange)
+#endif
+    return LimitedRange;
+}
+
+namespace {
+
+template <YuvConverter::SourceFormat Format, YuvConverter::ColorRange Range>
+void convertScaled(const uint8_t *const planes[3], const int strides[3], int width, int height,
+                   uint8_t *dst, int dstStride, int downscale)
+{
+    switch (downscale) {
+    case 1: YuvConverter::convert<Format, 1, Range>(planes, strides, width, height, dst, dstStride); break;
+    case 2: YuvConverter::convert<Format, 2, Range>(planes, strides, width, height, dst, dstStride); break;
+    default: YuvConverter::convert<Format, 4, Range>(planes, strides, width, height, dst, dstStride); break;
+    }
+}
+
+} // namespace
+
+bool YuvConverter::convertToBgra(SourceFormat format,
+                                 const uint8_t *const planes[3], const int strides[3],
+                                 int width, int height,
+                                 uint8_t *dst, int dstStride,
+                                 int downscale,
+                                 ColorRange range)
+{
+    if (width <= 0 || height <= 0 || !dst || !planes[0] || !planes[1]) {
+        return false;
+    }
+    if (format == YUV420P && !planes[2]) {
+        return false;
+    }
+    if (downscale != 1 && downscale != 2 && downscale != 4) {
+        return false;
+    }
+    if (width / downscale <= 0 || height / downscale <= 0) {
+        return false;
+    }
+
+    if (format == NV12) {
+        if (range == FullRange) {
+            convertScaled<NV12, FullRange>(planes, strides, width, height, dst, dstStride, downscale);
+        } else {
+            convertScaled<NV12, LimitedRange>(planes, strides, width, height, dst, dstStride, downscale);
+        }
+    } else {
+        if (range == FullRange) {
+            convertScaled<YUV420P, FullRange>(planes, strides, width, height, dst, dstStride, downscale);
+        } else {
+            convertScaled<YUV420P, LimitedRange>(planes, strides, width, height, dst, dstStride, downscale);
+        }
+    }
+    return true;
+}
+
+template <YuvConverter::SourceFormat Format, int Downscale, YuvConverter::ColorRange Range>
+void YuvConverter::convert(const uint8_t *const planes[3], const int strides[3],
+                           int width, int height,
+                           uint8_t *dst, int dstStride)
+{
+    static_assert(Downscale == 1 || Downscale == 2 || Downscale == 4, "缩小倍数只支持 1/2/4");
+    const KernelTable &k = kernels();
+    constexpr int r = Range == FullRange ? 1 : 0;
+
+    if constexpr (Downscale == 1) {
+        for (int row = 0; row < height; row++) {
+            const uint8_t *y = planes[0] + row * strides[0];
+            uint8_t *out = dst + row * dstStride;
+            if constexpr (Format == NV12) {
+                k.rowNv12[r](y, planes[1] + (row >> 1) * strides[1], out, width);
+            } else {
+                k.row420[r](y, planes[1] + (row >> 1) * strides[1],
+                            planes[2] + (row >> 1) * strides[2], out, width);
+            }
+        }
+    } else {
+        // 缩小：先在平面上求均值得到 4:4:4 行，再转换
+        const int outWidth = width / Downscale;
+        const int outHeight = height / Downscale;
+        if (outWidth <= 0 || outHeight <= 0) {
+            return;
+        }
+
+        thread_local std::vector<uint8_t> scratch;
+        scratch.resize(static_cast<size_t>(outWidth) * 3);
+        uint8_t *yRow = scratch.data();
+        uint8_t *uRow = yRow + outWidth;
+        uint8_t *vRow = uRow + outWidth;
+
+        constexpr int chromaStep = Format == NV12 ? 2 : 1;
+        const uint8_t *vPlane = Format == NV12 ? planes[1] + 1 : planes[2];
+        const int vStride = Format == NV12 ? strides[1] : strides[2];
+
+        for (int row = 0; row < outHeight; row++) {
+            const int chromaRow = row * Downscale / 2;
+            boxReduceRow(planes[0] + row * Downscale * strides[0], strides[0], 1, Downscale,
+                         yRow, outWidth);
+            reduceChromaRow(planes[1] + chromaRow * strides[1], strides[1], chromaStep, Downscale,
+                            uRow, outWidth);
+            reduceChromaRow(vPlane + chromaRow * vStride, vStride, chromaStep, Downscale,
+                            vRow, outWidth);
+            k.row444[r](yRow, uRow, vRow, dst + row * dstStride, outWidth);
+        }
+    }
+}
+
+template void YuvConverter::convert<YuvConverter::YUV420P, 1, YuvConverter::LimitedRange>(const uint8_t *const[3], const int[3], int, int, uint8_t *, int);
+template void YuvConverter::convert<YuvConverter::YUV420P, 2, YuvConverter::LimitedRange>(const uint8_t *const[3], const int[3], int, int, uint8_t *, int);
+template void YuvConverter::convert<YuvConverter::YUV420P, 4, YuvConverter::LimitedRange>(const uint8_t *const[3], const int[3], int, int, uint8_t *, int);
+template void YuvConverter::convert<YuvConverter::NV12, 1, YuvConverter::LimitedRange>(const uint8_t *const[3], const int[3], int, int, uint8_t *, int);
+template void YuvConverter::convert<YuvConverter::NV12, 2, YuvConverter::LimitedRange>(const uint8_t *const[3], const int[3], int, int, uint8_t *, int);
+template void YuvConverter::convert<YuvConverter::NV12, 4, YuvConverter::LimitedRange>(const uint8_t *const[3], const int[3], int, int, uint8_t *, int);
+template void YuvConverter::convert<YuvConverter::YUV420P, 1, YuvConverter::FullRange>(const uint8_t *const[3], const int[3], int, int, uint8_t *, int);
+template void YuvConverter::convert<YuvConverter::YUV420P, 2, YuvConverter::FullRange>(const uint8_t *const[3], const int[3], int, int, uint8_t *, int);
+template void YuvConverter::convert<YuvConverter::YUV420P, 4, YuvConverter::FullRange>(const uint8_t *const[3], const int[3], int, int, uint8_t *, int);
+template void YuvConverter::convert<YuvConverter::NV12, 1, YuvConverter::FullRange>(const uint8_t *const[3], const int[3], int, int, uint8_t *, int);
+template void YuvConverter::convert<YuvConverter::NV12, 2, YuvConverter::FullRange>(const uint8_t *const[3], const int[3], int, int, uint8_t *, int);
+template void YuvConverter::convert<YuvConverter::NV12, 4, YuvConverter::FullRange>(const uint8_t *const[3], const int[3], int, int, uint8_t *, int);
+
+const char *YuvConverter::kernelName()
+{
+    return kernels().name;
+}
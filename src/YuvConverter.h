@@ -0,0 +1,90 @@
+/**
+ * @file YuvConverter.h
+ * @brief YUV → BGRA 颜色转换（手写 SIMD 内核 + 运行时分派）
+ *
+ * 替代软件播放路径中的 sws_scale 热点组合：
+ * - YUV420P / NV12 → BGRA（内存字节序 B,G,R,A，即 QImage::Format_RGB32 / DXGI_FORMAT_B8G8R8A8）
+ * - 可选融合 2× / 4× 盒式缩小（先在 Y/UV 平面上求均值，再转换）
+ *
+ * 内核按指令集分文件编译（AVX2 / AVX-512BW / NEON / 标量），
+ * 首次调用时根据 CPU 特性选择，所有内核输出逐位一致。
+ * 颜色矩阵为 BT.601，6 位定点：有限范围（与 sws_scale 默认一致）与全范围（YUVJ / JPEG）各一套系数。
+ */
+
+#ifndef YUVCONVERTER_H
+#define YUVCONVERTER_H
+
+#include <cstdint>
+
+class YuvConverter
+{
+public:
+    /**
+     * @brief 支持的源格式
+     */
+    enum SourceFormat {
+        YUV420P,    ///< 三平面，色度 2x2 采样（含 YUVJ420P，范围另由 ColorRange 指定）
+        NV12        ///< Y 平面 + 交织 UV 平面
+    };
+
+    /**
+     * @brief 取值范围（选择颜色矩阵）
+     */
+    enum ColorRange {
+        LimitedRange,   ///< Y 16..235、UV 16..240（MPEG / TV）
+        FullRange       ///< 0..255（JPEG / PC）
+    };
+
+    /**
+     * @brief 由 AVPixelFormat 得到源格式
+     * @param avPixelFormat AVPixelFormat 值
+     * @param format 输出
+     * @return 不支持的格式返回 false（调用方回退到 sws_scale）
+     */
+    static bool sourceFormatFor(int avPixelFormat, SourceFormat *format);
+
+    /**
+     * @brief 由像素格式与帧的 color_range 得到取值范围
+     * @param avPixelFormat AVPixelFormat 值（YUVJ 格式总是全范围）
+     * @param avColorRange AVColorRange 值（未指定时按有限范围，与 sws_scale 一致）
+     */
+    static ColorRange colorRangeFor(int avPixelFormat, int avColorRange);
+
+    /**
+     * @brief 转换一帧到 BGRA
+     * @param format 源格式
+     * @param planes 源平面（NV12 只用前两个）
+     * @param strides 源平面行字节数
+     * @param width 源宽度
+     * @param height 源高度
+     * @param dst 目标缓冲区，尺寸为 (width / downscale) x (height / downscale)
+     * @param dstStride 目标行字节数
+     * @param downscale 缩小倍数：1、2 或 4
+     * @param range 取值范围
+     * @return 参数无效时返回 false
+     */
+    static bool convertToBgra(SourceFormat format,
+                              const uint8_t *const planes[3], const int strides[3],
+                              int width, int height,
+                              uint8_t *dst, int dstStride,
+                              int downscale = 1,
+                              ColorRange range = LimitedRange);
+
+    /**
+     * @brief 编译期确定源格式与缩小倍数的转换（FrameConverter 按流选定后直接调用）
+     *
+     * 与 convertToBgra 相同，但不做参数检查与格式分支。
+     * 已显式实例化：{YUV420P, NV12} x {1, 2, 4} x {LimitedRange, FullRange}。
+     */
+    template <SourceFormat Format, int Downscale, ColorRange Range = LimitedRange>
+    static void convert(const uint8_t *const planes[3], const int strides[3],
+                        int width, int height,
+                        uint8_t *dst, int dstStride);
+
+    /**
+     * @brief 当前使用的内核名称（"AVX-512BW" / "AVX2" / "NEON" / "标量"）
+     */
+    static const char *kernelName();
+};
+
+#endif // YUVCONVERTER_H
@@ -0,0 +1,128 @@
+/**
+ * @file YuvConverterAvx2.cpp
+ * @brief YUV → BGRA AVX2 内核（本文件以 -mavx2 编译，仅在运行时检测通过后调用）
+ */
+
+#include "YuvConverterKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#include <immintrin.h>
+
+namespace {
+
+using namespace YuvKernels;
+
+/**
+ * @brief 16 个像素：输入为 16 位 Y/U/V（色度已展开到每像素），输出 64 字节 BGRA
+ */
+template <bool FullRange>
+inline void convert16(__m256i y, __m256i u, __m256i v, uint8_t *dst)
+{
+    constexpr const ColorMatrix &m = colorMatrix<FullRange>();
+    const __m256i yt = _mm256_add_epi16(
+        _mm256_mullo_epi16(_mm256_sub_epi16(y, _mm256_set1_epi16(m.yOffset)), _mm256_set1_epi16(m.yMul)),
+        _mm256_set1_epi16(kRound));
+    const __m256i ut = _mm256_sub_epi16(u, _mm256_set1_epi16(128));
+    const __m256i vt = _mm256_sub_epi16(v, _mm256_set1_epi16(128));
+
+    // B 可能超出 int16，用饱和加法（饱和后仍 > 255，钳位结果不变）
+    const __m256i b = _mm256_srai_epi16(
+        _mm256_adds_epi16(yt, _mm256_mullo_epi16(ut, _mm256_set1_epi16(m.uToB))), 6);
+    const __m256i g = _mm256_srai_epi16(
+        _mm256_sub_epi16(_mm256_sub_epi16(yt, _mm256_mullo_epi16(ut, _mm256_set1_epi16(m.uToG))),
+                         _mm256_mullo_epi16(vt, _mm256_set1_epi16(m.vToG))), 6);
+    const __m256i r = _mm256_srai_epi16(
+        _mm256_add_epi16(yt, _mm256_mullo_epi16(vt, _mm256_set1_epi16(m.vToR))), 6);
+
+    // 钳位到 0..255 并收窄为字节
+    const __m128i b8 = _mm_packus_epi16(_mm256_castsi256_si128(b), _mm256_extracti128_si256(b, 1));
+    const __m128i g8 = _mm_packus_epi16(_mm256_castsi256_si128(g), _mm256_extracti128_si256(g, 1));
+    const __m128i r8 = _mm_packus_epi16(_mm256_castsi256_si128(r), _mm256_extracti128_si256(r, 1));
+    const __m128i a8 = _mm_set1_epi8(static_cast<char>(0xFF));
+
+    // 交织为 B,G,R,A
+    const __m128i bgLo = _mm_unpacklo_epi8(b8, g8);
+    const __m128i bgHi = _mm_unpackhi_epi8(b8, g8);
+    const __m128i raLo = _mm_unpacklo_epi8(r8, a8);
+    const __m128i raHi = _mm_unpackhi_epi8(r8, a8);
+
+    __m128i *out = reinterpret_cast<__m128i *>(dst);
+    _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(bgLo, raLo));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(bgLo, raLo));
+    _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(bgHi, raHi));
+    _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(bgHi, raHi));
+}
+
+inline __m256i loadY16(const uint8_t *y)
+{
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(y)));
+}
+
+// 8 个半宽色度样本展开为 16 个
+inline __m256i loadChromaDup(const uint8_t *c)
+{
+    const __m128i c8 = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(c));
+    return _mm256_cvtepu8_epi16(_mm_unpacklo_epi8(c8, c8));
+}
+
+template <bool FullRange>
+void row420Avx2(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int width)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        convert16<FullRange>(loadY16(y + x), loadChromaDup(u + x / 2), loadChromaDup(v + x / 2), dst + x * 4);
+    }
+    if (x < width) {
+        row420Scalar<FullRange>(y + x, u + x / 2, v + x / 2, dst + x * 4, width - x);
+    }
+}
+
+template <bool FullRange>
+void rowNv12Avx2(const uint8_t *y, const uint8_t *uv, uint8_t *dst, int width)
+{
+    // 交织 UV 拆分并展开：U 取偶数字节，V 取奇数字节，各重复一次
+    const __m128i uMask = _mm_setr_epi8(0, 0, 2, 2, 4, 4, 6, 6, 8, 8, 10, 10, 12, 12, 14, 14);
+    const __m128i vMask = _mm_setr_epi8(1, 1, 3, 3, 5, 5, 7, 7, 9, 9, 11, 11, 13, 13, 15, 15);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(uv + x));
+        convert16<FullRange>(loadY16(y + x),
+                  _mm256_cvtepu8_epi16(_mm_shuffle_epi8(c, uMask)),
+                  _mm256_cvtepu8_epi16(_mm_shuffle_epi8(c, vMask)),
+                  dst + x * 4);
+    }
+    if (x < width) {
+        rowNv12Scalar<FullRange>(y + x, uv + x, dst + x * 4, width - x);
+    }
+}
+
+template <bool FullRange>
+void row444Avx2(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int width)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        convert16<FullRange>(loadY16(y + x), loadY16(u + x), loadY16(v + x), dst + x * 4);
+    }
+    if (x < width) {
+        row444Scalar<FullRange>(y + x, u + x, v + x, dst + x * 4, width - x);
+    }
+}
+
+} // namespace
+
+YuvKernels::KernelTable YuvKernels::avx2Kernels()
+{
+    KernelTable table;
+    table.row420[0] = row420Avx2<false>;
+    table.row420[1] = row420Avx2<true>;
+    table.rowNv12[0] = rowNv12Avx2<false>;
+    table.rowNv12[1] = rowNv12Avx2<true>;
+    table.row444[0] = row444Avx2<false>;
+    table.row444[1] = row444Avx2<true>;
+    table.name = "AVX2";
+    return table;
+}
+
+#endif
@@ -0,0 +1,142 @@
+/**
+ * @file YuvConverterAvx512.cpp
+ * @brief YUV → BGRA AVX-512BW 内核（本文件以 -mavx512f -mavx512bw 编译，仅在运行时检测通过后调用）
+ */
+
+#include "YuvConverterKernels.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+
+#include <immintrin.h>
+
+namespace {
+
+using namespace YuvKernels;
+
+inline void storeBgra16(__m128i b8, __m128i g8, __m128i r8, uint8_t *dst)
+{
+    const __m128i a8 = _mm_set1_epi8(static_cast<char>(0xFF));
+    const __m128i bgLo = _mm_unpacklo_epi8(b8, g8);
+    const __m128i bgHi = _mm_unpackhi_epi8(b8, g8);
+    const __m128i raLo = _mm_unpacklo_epi8(r8, a8);
+    const __m128i raHi = _mm_unpackhi_epi8(r8, a8);
+
+    __m128i *out = reinterpret_cast<__m128i *>(dst);
+    _mm_storeu_si128(out + 0, _mm_unpacklo_epi16(bgLo, raLo));
+    _mm_storeu_si128(out + 1, _mm_unpackhi_epi16(bgLo, raLo));
+    _mm_storeu_si128(out + 2, _mm_unpacklo_epi16(bgHi, raHi));
+    _mm_storeu_si128(out + 3, _mm_unpackhi_epi16(bgHi, raHi));
+}
+
+// 负数先截到 0，再用无符号饱和收窄（> 255 截到 255）
+inline __m256i clampToBytes(__m512i value)
+{
+    return _mm512_maskz_cvtusepi16_epi8(~__mmask32(0), _mm512_max_epi16(value, _mm512_setzero_si512()));
+}
+
+/**
+ * @brief 32 个像素：输入为 16 位 Y/U/V（色度已展开到每像素），输出 128 字节 BGRA
+ */
+template <bool FullRange>
+inline void convert32(__m512i y, __m512i u, __m512i v, uint8_t *dst)
+{
+    constexpr const ColorMatrix &m = colorMatrix<FullRange>();
+    const __m512i yt = _mm512_add_epi16(
+        _mm512_mullo_epi16(_mm512_sub_epi16(y, _mm512_set1_epi16(m.yOffset)), _mm512_set1_epi16(m.yMul)),
+        _mm512_set1_epi16(kRound));
+    const __m512i ut = _mm512_sub_epi16(u, _mm512_set1_epi16(128));
+    const __m512i vt = _mm512_sub_epi16(v, _mm512_set1_epi16(128));
+
+    const __m512i b = _mm512_srai_epi16(
+        _mm512_adds_epi16(yt, _mm512_mullo_epi16(ut, _mm512_set1_epi16(m.uToB))), 6);
+    const __m512i g = _mm512_srai_epi16(
+        _mm512_sub_epi16(_mm512_sub_epi16(yt, _mm512_mullo_epi16(ut, _mm512_set1_epi16(m.uToG))),
+                         _mm512_mullo_epi16(vt, _mm512_set1_epi16(m.vToG))), 6);
+    const __m512i r = _mm512_srai_epi16(
+        _mm512_add_epi16(yt, _mm512_mullo_epi16(vt, _mm512_set1_epi16(m.vToR))), 6);
+
+    const __m256i b8 = clampToBytes(b);
+    const __m256i g8 = clampToBytes(g);
+    const __m256i r8 = clampToBytes(r);
+
+    storeBgra16(_mm256_castsi256_si128(b8), _mm256_castsi256_si128(g8),
+                _mm256_castsi256_si128(r8), dst);
+    storeBgra16(_mm256_extracti128_si256(b8, 1), _mm256_extracti128_si256(g8, 1),
+                _mm256_extracti128_si256(r8, 1), dst + 64);
+}
+
+inline __m512i loadY32(const uint8_t *y)
+{
+    return _mm512_cvtepu8_epi16(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(y)));
+}
+
+// 16 个半宽色度样本展开为 32 个
+inline __m512i loadChromaDup(const uint8_t *c)
+{
+    const __m128i c8 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(c));
+    return _mm512_cvtepu8_epi16(_mm256_set_m128i(_mm_unpackhi_epi8(c8, c8),
+                                                 _mm_unpacklo_epi8(c8, c8)));
+}
+
+template <bool FullRange>
+void row420Avx512(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int width)
+{
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        convert32<FullRange>(loadY32(y + x), loadChromaDup(u + x / 2), loadChromaDup(v + x / 2), dst + x * 4);
+    }
+    if (x < width) {
+        row420Scalar<FullRange>(y + x, u + x / 2, v + x / 2, dst + x * 4, width - x);
+    }
+}
+
+template <bool FullRange>
+void rowNv12Avx512(const uint8_t *y, const uint8_t *uv, uint8_t *dst, int width)
+{
+    // vpshufb 按 128 位通道工作：每个通道 8 对 UV 正好展开为 16 个像素
+    const __m256i uMask = _mm256_setr_epi8(0, 0, 2, 2, 4, 4, 6, 6, 8, 8, 10, 10, 12, 12, 14, 14,
+                                           0, 0, 2, 2, 4, 4, 6, 6, 8, 8, 10, 10, 12, 12, 14, 14);
+    const __m256i vMask = _mm256_setr_epi8(1, 1, 3, 3, 5, 5, 7, 7, 9, 9, 11, 11, 13, 13, 15, 15,
+                                           1, 1, 3, 3, 5, 5, 7, 7, 9, 9, 11, 11, 13, 13, 15, 15);
+
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(uv + x));
+        convert32<FullRange>(loadY32(y + x),
+                  _mm512_cvtepu8_epi16(_mm256_shuffle_epi8(c, uMask)),
+                  _mm512_cvtepu8_epi16(_mm256_shuffle_epi8(c, vMask)),
+                  dst + x * 4);
+    }
+    if (x < width) {
+        rowNv12Scalar<FullRange>(y + x, uv + x, dst + x * 4, width - x);
+    }
+}
+
+template <bool FullRange>
+void row444Avx512(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int width)
+{
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        convert32<FullRange>(loadY32(y + x), loadY32(u + x), loadY32(v + x), dst + x * 4);
+    }
+    if (x < width) {
+        row444Scalar<FullRange>(y + x, u + x, v + x, dst + x * 4, width - x);
+    }
+}
+
+} // namespace
+
+YuvKernels::KernelTable YuvKernels::avx512Kernels()
+{
+    KernelTable table;
+    table.row420[0] = row420Avx512<false>;
+    table.row420[1] = row420Avx512<true>;
+    table.rowNv12[0] = rowNv12Avx512<false>;
+    table.rowNv12[1] = rowNv12Avx512<true>;
+    table.row444[0] = row444Avx512<false>;
+    table.row444[1] = row444Avx512<true>;
+    table.name = "AVX-512BW";
+    return table;
+}
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * @file YuvConverterKernels.h
+ * @brief YuvConverter 内部：逐行转换内核接口
+ *
+ * 每个指令集一个翻译单元，各自带编译选项（见 CMakeLists.txt），
+ * 只通过这里声明的函数表对外暴露。
+ */
+
+#ifndef YUVCONVERTERKERNELS_H
+#define YUVCONVERTERKERNELS_H
+
+#include <cstdint>
+
+namespace YuvKernels {
+
+// 一行 YUV420P：u/v 为半宽
+using Row420Fn = void (*)(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int width);
+// 一行 NV12：uv 为交织半宽
+using RowNv12Fn = void (*)(const uint8_t *y, const uint8_t *uv, uint8_t *dst, int width);
+// 一行 4:4:4：缩小后的 Y/U/V 同宽
+using Row444Fn = void (*)(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int width);
+
+/**
+ * @brief 每个指令集的内核：各函数按颜色范围索引（[0] 有限范围，[1] 全范围）
+ */
+struct KernelTable {
+    Row420Fn row420[2] = {};
+    RowNv12Fn rowNv12[2] = {};
+    Row444Fn row444[2] = {};
+    const char *name = nullptr;
+};
+
+/**
+ * @brief BT.601 颜色矩阵，6 位定点系数（×64）
+ */
+struct ColorMatrix {
+    int yOffset;
+    int yMul;
+    int vToR;
+    int uToG;
+    int vToG;
+    int uToB;
+};
+
+// 有限范围（Y 16..235、UV 16..240，与 sws_scale 对 YUV420P 的默认处理一致）
+inline constexpr ColorMatrix kLimitedRange = { 16, 74, 102, 25, 52, 129 };   // 1.164 1.596 0.391 0.813 2.018
+// 全范围（YUVJ / color_range = JPEG：Y、UV 都占满 0..255）
+inline constexpr ColorMatrix kFullRange = { 0, 64, 90, 22, 46, 113 };        // 1.000 1.402 0.344 0.714 1.772
+constexpr int kRound = 32;
+
+template <bool FullRange>
+constexpr const ColorMatrix &colorMatrix()
+{
+    return FullRange ? kFullRange : kLimitedRange;
+}
+
+inline uint8_t clampToByte(int value)
+{
+    return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+}
+
+/**
+ * @brief 单像素标量转换（SIMD 内核的参考实现，也用于处理行尾）
+ *
+ * SIMD 内核使用 16 位饱和加法：只有有限范围的 B 分量可能饱和，饱和后结果仍 > 255，
+ * 与这里先算后钳位的结果一致；全范围系数下所有中间值都在 int16 以内。
+ */
+template <bool FullRange>
+inline void yuvToBgra(int y, int u, int v, uint8_t *dst)
+{
+    constexpr const ColorMatrix &m = colorMatrix<FullRange>();
+    const int yt = (y - m.yOffset) * m.yMul + kRound;
+    const int ut = u - 128;
+    const int vt = v - 128;
+    dst[0] = clampToByte((yt + m.uToB * ut) >> 6);
+    dst[1] = clampToByte((yt - m.uToG * ut - m.vToG * vt) >> 6);
+    dst[2] = clampToByte((yt + m.vToR * vt) >> 6);
+    dst[3] = 255;
+}
+
+template <bool FullRange>
+inline void row420Scalar(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int width)
+{
+    for (int x = 0; x < width; x++) {
+        yuvToBgra<FullRange>(y[x], u[x >> 1], v[x >> 1], dst + x * 4);
+    }
+}
+
+template <bool FullRange>
+inline void rowNv12Scalar(const uint8_t *y, const uint8_t *uv, uint8_t *dst, int width)
+{
+    for (int x = 0; x < width; x++) {
+        const int c = (x >> 1) * 2;
+        yuvToBgra<FullRange>(y[x], uv[c], uv[c + 1], dst + x * 4);
+    }
+}
+
+template <bool FullRange>
+inline void row444Scalar(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int width)
+{
+    for (int x = 0; x < width; x++) {
+        yuvToBgra<FullRange>(y[x], u[x], v[x], dst + x * 4);
+    }
+}
+
+KernelTable scalarKernels();
+
+#if defined(__x86_64__) || defined(_M_X64)
+KernelTable avx2Kernels();
+KernelTable avx512Kernels();
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+KernelTable neonKernels();
+#endif
+
+} // namespace YuvKernels
+
+#endif // YUVCONVERTERKERNELS_H
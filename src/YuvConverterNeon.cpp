@@ -0,0 +1,115 @@
+/**
+ * @file YuvConverterNeon.cpp
+ * @brief YUV → BGRA NEON 内核（AArch64）
+ */
+
+#include "YuvConverterKernels.h"
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+
+#include <arm_neon.h>
+
+namespace {
+
+using namespace YuvKernels;
+
+// 8 个像素的一个分量：返回未钳位的 16 位结果
+struct Bgr16 {
+    int16x8_t b, g, r;
+};
+
+template <bool FullRange>
+inline Bgr16 convert8(uint8x8_t y, uint8x8_t u, uint8x8_t v)
+{
+    constexpr const ColorMatrix &m = colorMatrix<FullRange>();
+    const int16x8_t yt = vaddq_s16(
+        vmulq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(y)), vdupq_n_s16(m.yOffset)), m.yMul),
+        vdupq_n_s16(kRound));
+    const int16x8_t ut = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u)), vdupq_n_s16(128));
+    const int16x8_t vt = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v)), vdupq_n_s16(128));
+
+    Bgr16 out;
+    out.b = vshrq_n_s16(vqaddq_s16(yt, vmulq_n_s16(ut, m.uToB)), 6);
+    out.g = vshrq_n_s16(vsubq_s16(vsubq_s16(yt, vmulq_n_s16(ut, m.uToG)), vmulq_n_s16(vt, m.vToG)), 6);
+    out.r = vshrq_n_s16(vaddq_s16(yt, vmulq_n_s16(vt, m.vToR)), 6);
+    return out;
+}
+
+/**
+ * @brief 16 个像素：色度已展开到每像素，vst4 直接交织写出 BGRA
+ */
+template <bool FullRange>
+inline void convert16(uint8x16_t y, uint8x16_t u, uint8x16_t v, uint8_t *dst)
+{
+    const Bgr16 lo = convert8<FullRange>(vget_low_u8(y), vget_low_u8(u), vget_low_u8(v));
+    const Bgr16 hi = convert8<FullRange>(vget_high_u8(y), vget_high_u8(u), vget_high_u8(v));
+
+    uint8x16x4_t bgra;
+    bgra.val[0] = vcombine_u8(vqmovun_s16(lo.b), vqmovun_s16(hi.b));
+    bgra.val[1] = vcombine_u8(vqmovun_s16(lo.g), vqmovun_s16(hi.g));
+    bgra.val[2] = vcombine_u8(vqmovun_s16(lo.r), vqmovun_s16(hi.r));
+    bgra.val[3] = vdupq_n_u8(255);
+    vst4q_u8(dst, bgra);
+}
+
+// 8 个半宽色度样本展开为 16 个
+inline uint8x16_t dupChroma(uint8x8_t c)
+{
+    const uint8x8x2_t zipped = vzip_u8(c, c);
+    return vcombine_u8(zipped.val[0], zipped.val[1]);
+}
+
+template <bool FullRange>
+void row420Neon(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int width)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        convert16<FullRange>(vld1q_u8(y + x), dupChroma(vld1_u8(u + x / 2)), dupChroma(vld1_u8(v + x / 2)),
+                  dst + x * 4);
+    }
+    if (x < width) {
+        row420Scalar<FullRange>(y + x, u + x / 2, v + x / 2, dst + x * 4, width - x);
+    }
+}
+
+template <bool FullRange>
+void rowNv12Neon(const uint8_t *y, const uint8_t *uv, uint8_t *dst, int width)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const uint8x8x2_t c = vld2_u8(uv + x);   // 拆分交织 UV
+        convert16<FullRange>(vld1q_u8(y + x), dupChroma(c.val[0]), dupChroma(c.val[1]), dst + x * 4);
+    }
+    if (x < width) {
+        rowNv12Scalar<FullRange>(y + x, uv + x, dst + x * 4, width - x);
+    }
+}
+
+template <bool FullRange>
+void row444Neon(const uint8_t *y, const uint8_t *u, const uint8_t *v, uint8_t *dst, int width)
+{
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        convert16<FullRange>(vld1q_u8(y + x), vld1q_u8(u + x), vld1q_u8(v + x), dst + x * 4);
+    }
+    if (x < width) {
+        row444Scalar<FullRange>(y + x, u + x, v + x, dst + x * 4, width - x);
+    }
+}
+
+} // namespace
+
+YuvKernels::KernelTable YuvKernels::neonKernels()
+{
+    KernelTable table;
+    table.row420[0] = row420Neon<false>;
+    table.row420[1] = row420Neon<true>;
+    table.rowNv12[0] = rowNv12Neon<false>;
+    table.rowNv12[1] = rowNv12Neon<true>;
+    table.row444[0] = row444Neon<false>;
+    table.row444[1] = row444Neon<true>;
+    table.name = "NEON";
+    return table;
+}
+
+#endif
@@ -1,7 +1,22 @@
 #include <QApplication>
 #include <QCommandLineParser>
 #include <QFileInfo>
+#include <cstring>
+#include <memory>
 #include "FloatingVideoPlayer.h"
+#include "AbrTest.h"
+#include "Conformance.h"
+#include "CueTest.h"
+#include "MediaProbe.h"
+#include "MetricsExporter.h"
+#include "SessionResume.h"
+#include "SoakTest.h"
+#include "Storyboard.h"
+#include "StartupTimeline.h"
+
+#if KMS_OUTPUT_AVAILABLE
+#include "KmsPlayer.h"
+#endif
 
 /**
  * @brief 主程序入口
@@ -10,19 +25,202 @@
  * 基于 libmpv，支持几乎所有视频格式
  * 
  * 使用方式：
- * - LoopVideoPlayer              启动空白播放器
+ * - LoopVideoPlayer              恢复上次会话（无记录时启动空白播放器）
  * - LoopVideoPlayer video.mp4    启动并播放视频
+ * - LoopVideoPlayer --kms /dev/dri/card0 video.mp4
+ *                                无桌面 KMS 全屏播放（kiosk）
+ * - LoopVideoPlayer --conformance conformance/goldens.json
+ *                                输出一致性检查（golden 帧校验）
+ * - LoopVideoPlayer --soak 5000 --soak-log soak.csv
+ *                                加速浸泡测试（长时间循环的泄漏与漂移检查）
+ * - LoopVideoPlayer --storyboard 16 [--storyboard-out dir] library/
+ *                                批量生成故事板（网格预览图 + JSON 索引）
+ * - LoopVideoPlayer --cue-test 20
+ *                                排期切换精度测试（上屏时刻相对截止时间的偏差）
+ * - LoopVideoPlayer --abr-test
+ *                                自适应码率测试（本地限速 HLS 阶梯）
+ * - LoopVideoPlayer --proxy-cache video.mp4
+ *                                空闲时后台生成全帧内代理，拖动进度条显示预览帧
+ * - LoopVideoPlayer --frame-cache overlay.mp4
+ *                                短循环解码帧写入磁盘缓存，之后启动直接从映射播放
+ * - LoopVideoPlayer --max-fps 30 overlay.mp4
+ *                                限制呈现帧率（按整数步长选帧，跳过不呈现帧的解码与转换）
+ * - LoopVideoPlayer --metrics 9464 video.mp4
+ *                                在 127.0.0.1:9464/metrics 导出运行指标（也可 unix:<路径>）
  */
 int main(int argc, char *argv[])
 {
-    QApplication app(argc, argv);
-    app.setApplicationName("Loop Video Player");
-    app.setApplicationVersion("2.0.0");
-    app.setOrganizationName("LoopPlayer");
-    app.setStyle("Fusion");
+    StartupTimeline::begin();
+
+    // KMS 模式、浸泡测试与故事板不连接窗口系统，只需要 QCoreApplication
+    bool kmsMode = false;
+    bool soakMode = false;
+    bool storyboardMode = false;
+    for (int i = 1; i < argc; i++) {
+        if (std::strncmp(argv[i], "--kms", 5) == 0) kmsMode = true;
+        if (std::strncmp(argv[i], "--soak", 6) == 0) soakMode = true;
+        if (std::strncmp(argv[i], "--storyboard", 12) == 0) storyboardMode = true;
+    }
+
+    std::unique_ptr<QCoreApplication> app;
+    if (kmsMode || soakMode || storyboardMode) {
+        app = std::make_unique<QCoreApplication>(argc, argv);
+    } else {
+        app = std::make_unique<QApplication>(argc, argv);
+    }
+    app->setApplicationName("Loop Video Player");
+    app->setApplicationVersion("2.0.0");
+    app->setOrganizationName("LoopPlayer");
+    StartupTimeline::mark("application");
+
+    // 命令行解析
+    QCommandLineParser parser;
+    parser.setApplicationDescription("悬浮视频循环播放器 - 基于 libmpv，支持几乎所有视频格式");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("file", "视频文件路径", "[video file]");
+
+    QCommandLineOption kmsOption("kms", "直接驱动 DRM/KMS 全屏输出（无桌面）", "device");
+    QCommandLineOption kmsOverlayOption("kms-nv12", "KMS 模式下使用 NV12 overlay 平面");
+    QCommandLineOption kmsFlipsOption("kms-flips", "翻页指定次数后退出（CI 冒烟测试）", "count");
+    parser.addOption(kmsOption);
+    parser.addOption(kmsOverlayOption);
+    parser.addOption(kmsFlipsOption);
+
+    QCommandLineOption conformanceOption("conformance", "运行输出一致性检查并与 golden 文件比较", "goldens");
+    QCommandLineOption conformanceUpdateOption("conformance-update", "重新生成 golden 文件");
+    parser.addOption(conformanceOption);
+    parser.addOption(conformanceUpdateOption);
+
+    QCommandLineOption soakOption("soak", "运行加速浸泡测试（指定循环次数）", "loops");
+    QCommandLineOption soakLogOption("soak-log", "浸泡测试采样写入 CSV", "csv");
+    parser.addOption(soakOption);
+    parser.addOption(soakLogOption);
+
+    QCommandLineOption storyboardOption("storyboard", "为文件或目录批量生成故事板（指定格子数）", "count");
+    QCommandLineOption storyboardOutOption("storyboard-out", "故事板输出目录（默认写在源文件旁）", "dir");
+    parser.addOption(storyboardOption);
+    parser.addOption(storyboardOutOption);
+
+    QCommandLineOption cueTestOption("cue-test", "运行排期切换精度测试（指定切换次数）", "count");
+    parser.addOption(cueTestOption);
+
+    QCommandLineOption abrTestOption("abr-test", "运行自适应码率测试（本地限速 HLS 阶梯）");
+    parser.addOption(abrTestOption);
+
+    QCommandLineOption proxyCacheOption("proxy-cache", "空闲时后台生成全帧内代理（拖动预览、故事板精确取帧）");
+    parser.addOption(proxyCacheOption);
+
+    QCommandLineOption frameCacheOption("frame-cache", "短循环的解码帧缓存到磁盘，之后播放不再解码");
+    parser.addOption(frameCacheOption);
+
+    QCommandLineOption maxFpsOption("max-fps", "呈现帧率上限（无风扇设备的功耗预算，音频不受影响）", "fps");
+    parser.addOption(maxFpsOption);
+
+    QCommandLineOption metricsOption("metrics", "导出 Prometheus 指标：本机端口或 unix:<套接字路径>", "address");
+    parser.addOption(metricsOption);
+    parser.process(*app);
+
+    // 指标端点在独立线程中应答，只读取各播放器的原子量快照
+    std::unique_ptr<MetricsExporter> metricsExporter;
+    if (parser.isSet(metricsOption)) {
+        metricsExporter = std::make_unique<MetricsExporter>();
+        if (!metricsExporter->listen(parser.value(metricsOption))) {
+            return 1;
+        }
+    }
+
+    const QStringList args = parser.positionalArguments();
+
+    // 播放模式：文件探测在后台线程进行，与窗口创建、GPU 初始化并行
+    QString startupFile;
+    SessionState session;
+    if (!soakMode && !storyboardMode && !parser.isSet(conformanceOption)
+        && !parser.isSet(cueTestOption) && !parser.isSet(abrTestOption)) {
+        if (!args.isEmpty()) {
+            const QFileInfo fileInfo(args.first());
+            if (fileInfo.exists() && fileInfo.isFile()) {
+                startupFile = fileInfo.absoluteFilePath();
+            }
+        }
+        // 窗口模式：未指定文件时恢复上次会话；指定的正是上次的文件时同样从上次位置继续
+        if (!kmsMode) {
+            session = SessionResume::load();
+            if (startupFile.isEmpty()) {
+                startupFile = session.file;
+            } else if (session.file != startupFile) {
+                session = SessionState();
+            }
+        }
+        if (!startupFile.isEmpty()) {
+            SessionResume::prefetch(startupFile);
+            MediaProbe::start(startupFile);
+        }
+    }
+
+    if (soakMode) {
+        return SoakTest::run(parser.value(soakOption).toInt(), parser.value(soakLogOption),
+                             metricsExporter.get());
+    }
+
+    if (storyboardMode) {
+        if (args.isEmpty()) {
+            qCritical("故事板模式需要指定文件或目录");
+            return 1;
+        }
+        return Storyboard::run(parser.value(storyboardOption).toInt(), args, parser.value(storyboardOutOption));
+    }
+
+    if (kmsMode) {
+#if KMS_OUTPUT_AVAILABLE
+        if (args.isEmpty()) {
+            qCritical("KMS 模式需要指定视频文件");
+            return 1;
+        }
+
+        KmsPlayer kmsPlayer;
+        if (!kmsPlayer.open(parser.value(kmsOption), parser.isSet(kmsOverlayOption))) {
+            return 1;
+        }
+        kmsPlayer.setMaxFlips(parser.value(kmsFlipsOption).toInt());
+        if (metricsExporter) {
+            metricsExporter->addSource(QStringLiteral("kms"), kmsPlayer.metrics());
+        }
+        QObject::connect(&kmsPlayer, &KmsPlayer::finished, app.get(), &QCoreApplication::exit,
+                         Qt::QueuedConnection);
+        kmsPlayer.play(QFileInfo(args.first()).absoluteFilePath());
+        const int result = app->exec();
+        MediaProbe::discard();
+        if (metricsExporter) {
+            metricsExporter->removeSource(kmsPlayer.metrics());
+        }
+        return result;
+#else
+        qCritical("此版本未启用 KMS 输出（需要 libdrm）");
+        return 1;
+#endif
+    }
+
+    // 一致性检查需要 QApplication（RHI 离屏渲染），可配合 QT_QPA_PLATFORM=offscreen
+    if (parser.isSet(conformanceOption)) {
+        return Conformance::run(parser.value(conformanceOption), parser.isSet(conformanceUpdateOption));
+    }
+
+    // 排期切换测试需要真实窗口与 vsync 才能反映上屏时刻
+    if (parser.isSet(cueTestOption)) {
+        return CueTest::run(parser.value(cueTestOption).toInt());
+    }
+
+    // 自适应码率测试需要实际播放（丢帧计入判定）
+    if (parser.isSet(abrTestOption)) {
+        return AbrTest::run();
+    }
+
+    auto *guiApp = static_cast<QApplication*>(app.get());
+    guiApp->setStyle("Fusion");
 
     // 全局样式
-    app.setStyleSheet(R"(
+    guiApp->setStyleSheet(R"(
         QToolTip {
             background-color: #1a1a2e;
             color: white;
@@ -32,26 +230,32 @@ int main(int argc, char *argv[])
         }
     )");
 
-    // 命令行解析
-    QCommandLineParser parser;
-    parser.setApplicationDescription("悬浮视频循环播放器 - 基于 libmpv，支持几乎所有视频格式");
-    parser.addHelpOption();
-    parser.addVersionOption();
-    parser.addPositionalArgument("file", "视频文件路径", "[video file]");
-    parser.process(app);
-
     // 创建播放器
     FloatingVideoPlayer player;
+    player.setProxyCacheEnabled(parser.isSet(proxyCacheOption));
+    player.setFrameCacheEnabled(parser.isSet(frameCacheOption));
+    if (parser.isSet(maxFpsOption)) {
+        player.setMaxPresentRate(parser.value(maxFpsOption).toDouble());
+    }
+    player.showSnapshot(session.snapshot);
     player.show();
+    StartupTimeline::mark("window shown");
+    if (metricsExporter) {
+        metricsExporter->addSource(QStringLiteral("main"), player.metrics());
+    }
 
-    // 打开命令行指定的文件
-    const QStringList args = parser.positionalArguments();
-    if (!args.isEmpty()) {
-        QFileInfo fileInfo(args.first());
-        if (fileInfo.exists() && fileInfo.isFile()) {
-            player.openVideo(fileInfo.absoluteFilePath());
-        }
+    // 打开命令行指定（或上次会话）的文件
+    if (!startupFile.isEmpty()) {
+        // 先让窗口与快照上屏，探测仍在后台进行；openFile 随后取走探测结果
+        QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+        StartupTimeline::mark("window painted");
+        player.openVideo(startupFile, session.position);
     }
 
-    return app.exec();
+    const int result = app->exec();
+    MediaProbe::discard();  // 渲染器未取走（如打开前已退出）时释放
+    if (metricsExporter) {
+        metricsExporter->removeSource(player.metrics());
+    }
+    return result;
 }
@@ -0,0 +1,197 @@
+#version 440
+
+// YUV420P → RGB 片段着色器（与 OpenGLRenderer 相同的 BT.709 转换）
+//
+// HDR（PQ / HLG）在同一遍内完成：BT.2020 矩阵 → 线性亮度 → BT.2390 EETF 色调映射
+// → BT.2020 到 BT.709 色域映射 → SDR 伽马。高位深平面以 R16 上传，按 sampleScale 还原。
+//
+// 隔行帧按场显示（输出为场频）：
+// - 当前场的行直接采样
+// - 另一场的行：bob 取上下两行平均；运动自适应时与上一帧同一行比较，
+//   静止区域直接使用交织行（保留全部垂直分辨率），运动区域使用 bob
+
+layout(location = 0) in vec2 vTexCoord;
+layout(location = 0) out vec4 fragColor;
+
+layout(std140, binding = 0) uniform buf {
+    mat4 mvp;
+    vec4 deint;     // x: 模式（0 逐行 / 1 bob / 2 运动自适应） y: 显示场（0 顶场 / 1 底场）
+                    // z: 亮度高度（行） w: 运动阈值
+    vec4 color;     // x: 传递函数（0 SDR / 1 PQ / 2 HLG） y: BT.2020（0/1）
+                    // z: 样本缩放（16 位容器中的 10 位数据） w: 内容峰值亮度（nit）
+    vec4 colorExt;  // x: 全范围（0/1） y: SDR 参考白（nit）
+};
+
+layout(binding = 1) uniform sampler2D textureY;
+layout(binding = 2) uniform sampler2D textureU;
+layout(binding = 3) uniform sampler2D textureV;
+layout(binding = 4) uniform sampler2D texturePrevY;   // 上一帧亮度（运动自适应）
+
+// 采样某一行中心，垂直方向不跨行插值
+float sampleLine(sampler2D tex, float x, float line, float height)
+{
+    line = clamp(line, 0.0, height - 1.0);
+    return texture(tex, vec2(x, (line + 0.5) / height)).r;
+}
+
+// 当前场的行返回原值，另一场的行按运动量在交织行与 bob 之间混合
+float sampleField(sampler2D tex, float height, float motion)
+{
+    float line = floor(vTexCoord.y * height);
+    float woven = sampleLine(tex, vTexCoord.x, line, height);
+    if (abs(mod(line, 2.0) - deint.y) < 0.5) {
+        return woven;
+    }
+    float bob = 0.5 * (sampleLine(tex, vTexCoord.x, line - 1.0, height)
+                       + sampleLine(tex, vTexCoord.x, line + 1.0, height));
+    return mix(woven, bob, motion);
+}
+
+// SMPTE ST 2084 (PQ)
+const float PQ_M1 = 0.1593017578125;
+const float PQ_M2 = 78.84375;
+const float PQ_C1 = 0.8359375;
+const float PQ_C2 = 18.8515625;
+const float PQ_C3 = 18.6875;
+
+float pqToNits(float e)
+{
+    float p = pow(clamp(e, 0.0, 1.0), 1.0 / PQ_M2);
+    return 10000.0 * pow(max(p - PQ_C1, 0.0) / (PQ_C2 - PQ_C3 * p), 1.0 / PQ_M1);
+}
+
+float nitsToPq(float nits)
+{
+    float y = pow(clamp(nits / 10000.0, 0.0, 1.0), PQ_M1);
+    return pow((PQ_C1 + PQ_C2 * y) / (1.0 + PQ_C3 * y), PQ_M2);
+}
+
+// ARIB STD-B67 (HLG)：反 OETF + 系统伽马随峰值亮度调整的 OOTF
+vec3 hlgToNits(vec3 e, float peak)
+{
+    const float a = 0.17883277;
+    const float b = 0.28466892;
+    const float c = 0.55991073;
+    vec3 scene;
+    for (int i = 0; i < 3; i++) {
+        scene[i] = e[i] <= 0.5 ? e[i] * e[i] / 3.0 : (exp((e[i] - c) / a) + b) / 12.0;
+    }
+    float gamma = 1.2 + 0.42 * log(peak / 1000.0) / log(10.0);
+    float ys = dot(scene, vec3(0.2627, 0.6780, 0.0593));
+    return peak * pow(max(ys, 1e-6), gamma - 1.0) * scene;
+}
+
+// ITU-R BT.2390 EETF：在 PQ 域把 [0, srcPeak] 压到 [0, dstPeak]，膝点以下保持不变
+float eetf(float nits, float srcPeak, float dstPeak)
+{
+    if (srcPeak <= dstPeak) {
+        return nits;
+    }
+    float srcPq = nitsToPq(srcPeak);
+    float maxLum = nitsToPq(dstPeak) / srcPq;
+    float e1 = min(nitsToPq(nits) / srcPq, 1.0);
+    float ks = 1.5 * maxLum - 0.5;
+    float e2 = e1;
+    if (e1 > ks) {
+        float t = (e1 - ks) / (1.0 - ks);
+        float t2 = t * t;
+        float t3 = t2 * t;
+        e2 = (2.0 * t3 - 3.0 * t2 + 1.0) * ks + (t3 - 2.0 * t2 + t) * (1.0 - ks)
+           + (-2.0 * t3 + 3.0 * t2) * maxLum;
+    }
+    return pqToNits(e2 * srcPq);
+}
+
+vec3 toneMapHdr(float y, float u, float v)
+{
+    if (colorExt.x < 0.5) {
+        y = (y - 16.0 / 255.0) * (255.0 / 219.0);
+        u = (u - 128.0 / 255.0) * (255.0 / 224.0);
+        v = (v - 128.0 / 255.0) * (255.0 / 224.0);
+    } else {
+        u -= 0.5;
+        v -= 0.5;
+    }
+
+    // 非恒定亮度矩阵（BT.2020 / BT.709）
+    vec3 e = color.y > 0.5
+        ? vec3(y + 1.4746 * v, y - 0.16455 * u - 0.57135 * v, y + 1.8814 * u)
+        : vec3(y + 1.5748 * v, y - 0.1873 * u - 0.4681 * v, y + 1.8556 * u);
+    e = clamp(e, 0.0, 1.0);
+
+    float peak = color.w;
+    vec3 nits = color.x < 1.5
+        ? vec3(pqToNits(e.r), pqToNits(e.g), pqToNits(e.b))
+        : hlgToNits(e, peak);
+
+    // 按 maxRGB 做色调映射，三通道同比例缩放保持色相
+    float white = colorExt.y;
+    float peakChannel = max(max(nits.r, nits.g), nits.b);
+    if (peakChannel > 0.0) {
+        nits *= eetf(peakChannel, peak, white) / peakChannel;
+    }
+    vec3 rgb = nits / white;
+
+    // BT.2020 → BT.709，超出色域的颜色向同亮度灰压缩而不是逐通道裁剪
+    if (color.y > 0.5) {
+        const mat3 bt2020ToBt709 = mat3( 1.6605, -0.1246, -0.0182,
+                                        -0.5876,  1.1329, -0.1006,
+                                        -0.0728, -0.0083,  1.1187);
+        rgb = bt2020ToBt709 * rgb;
+        float luma = dot(rgb, vec3(0.2126, 0.7152, 0.0722));
+        float lowest = min(min(rgb.r, rgb.g), rgb.b);
+        if (lowest < 0.0 && luma > 0.0) {
+            rgb = mix(vec3(luma), rgb, luma / (luma - lowest));
+        }
+    }
+
+    return pow(clamp(rgb, 0.0, 1.0), vec3(1.0 / 2.2));
+}
+
+void main()
+{
+    float y;
+    float u;
+    float v;
+
+    if (deint.x < 0.5) {
+        y = texture(textureY, vTexCoord).r;
+        u = texture(textureU, vTexCoord).r;
+        v = texture(textureV, vTexCoord).r;
+    } else {
+        float lumaHeight = deint.z;
+        float chromaHeight = floor((lumaHeight + 1.0) * 0.5);
+
+        // 运动量：交织行与上一帧同一行的差异（bob 模式恒为 1）
+        float motion = 1.0;
+        if (deint.x > 1.5) {
+            float line = floor(vTexCoord.y * lumaHeight);
+            float current = sampleLine(textureY, vTexCoord.x, line, lumaHeight);
+            float previous = sampleLine(texturePrevY, vTexCoord.x, line, lumaHeight);
+            motion = smoothstep(deint.w, 2.0 * deint.w, abs(current - previous) * color.z);
+        }
+
+        y = sampleField(textureY, lumaHeight, motion);
+        u = sampleField(textureU, chromaHeight, motion);
+        v = sampleField(textureV, chromaHeight, motion);
+    }
+
+    y *= color.z;
+    u *= color.z;
+    v *= color.z;
+
+    if (color.x > 0.5) {
+        fragColor = vec4(toneMapHdr(y, u, v), 1.0);
+        return;
+    }
+
+    u -= 0.5;
+    v -= 0.5;
+
+    // BT.709 YUV to RGB
+    float r = y + 1.5748 * v;
+    float g = y - 0.1873 * u - 0.4681 * v;
+    float b = y + 1.8556 * u;
+
+    fragColor = vec4(clamp(r, 0.0, 1.0), clamp(g, 0.0, 1.0), clamp(b, 0.0, 1.0), 1.0);
+}
@@ -0,0 +1,21 @@
+#version 440
+
+// 视频四边形顶点着色器（qt_add_shaders 预编译为 .qsb）
+
+layout(location = 0) in vec2 position;
+layout(location = 1) in vec2 texCoord;
+
+layout(location = 0) out vec2 vTexCoord;
+
+layout(std140, binding = 0) uniform buf {
+    mat4 mvp;       // 裁剪空间校正 × 黑边缩放
+    vec4 deint;     // 去隔行参数（片段着色器使用）
+    vec4 color;     // 色彩参数（片段着色器使用）
+    vec4 colorExt;
+};
+
+void main()
+{
+    vTexCoord = texCoord;
+    gl_Position = mvp * vec4(position, 0.0, 1.0);
+}